@@ -58,6 +58,7 @@
 #include <wiretap/wtap.h>
 
 #include <wsutil/cmdarg_err.h>
+#include <wsutil/clopts_common.h>
 #include <wsutil/filesystem.h>
 #include <wsutil/privileges.h>
 #include <cli_main.h>
@@ -90,6 +91,19 @@
 
 static bool stop_after_failure;
 
+/*
+ * Files are scanned by a pool of worker threads, num_jobs at a time,
+ * and reported in command line order by the main thread.
+ */
+static unsigned num_jobs;
+
+/*
+ * In quick mode, the packet count and capture times of a pcapng file are
+ * taken from the Interface Statistics Blocks at the end of the file, if
+ * there are complete ones, rather than by reading every record.
+ */
+static bool quick_mode;
+
 /*
  * table report variables
  */
@@ -146,17 +160,6 @@ static bool cap_file_hashes    = true;  /* Calculate file hashes */
 #define HASH_STR_SIZE (65) /* Max hash size * 2 + '\0' */
 #define HASH_BUF_SIZE (1024 * 1024)
 
-
-static char file_sha256[HASH_STR_SIZE];
-static char file_sha1[HASH_STR_SIZE];
-
-static char  *hash_buf;
-static gcry_md_hd_t hd;
-
-static unsigned int num_ipv4_addresses;
-static unsigned int num_ipv6_addresses;
-static unsigned int num_decryption_secrets;
-
 /*
  * If we have at least two packets with time stamps, and they're not in
  * order - i.e., the later packet has a time stamp older than the earlier
@@ -173,6 +176,17 @@ typedef enum {
     ORDER_UNKNOWN
 } order_t;
 
+/*
+ * What went wrong while scanning a file, so that the main thread can
+ * report it when it gets to that file.
+ */
+typedef enum {
+    SCAN_OK,
+    SCAN_OPEN_FAILED,
+    SCAN_READ_FAILED,
+    SCAN_SIZE_FAILED
+} scan_failure_t;
+
 typedef struct _pkt_cmt {
   int recno;
   char *cmt;
@@ -216,8 +230,33 @@ typedef struct _capture_info {
     GArray               *interface_packet_counts;  /* array of per_packet interface_id counts; one entry per file IDB */
     uint32_t              pkt_interface_id_unknown; /* counts if packet interface_id didn't match a known one */
     GArray               *idb_info_strings;         /* array of IDB info strings */
+
+    bool                  packet_bytes_known;       /* false if the records weren't read (quick mode) */
+    unsigned int          num_ipv4_addresses;
+    unsigned int          num_ipv6_addresses;
+    unsigned int          num_decryption_secrets;
+
+    /* Hashes, computed from the data read by wiretap */
+    gcry_md_hd_t          hd;
+    int64_t               hashed_upto;              /* number of bytes of the file hashed so far */
+    FILE                 *hash_fh;                  /* for reading data that wiretap didn't hand us */
+    char                  file_sha256[HASH_STR_SIZE];
+    char                  file_sha1[HASH_STR_SIZE];
+
+    /* Result of the scan */
+    int                   status;                   /* 0 = OK, 1 = short read, 2 = failed */
+    scan_failure_t        failure;
+    int                   err;
+    char                 *err_info;
+    bool                  scan_done;                /* protected by scan_mutex */
 } capture_info;
 
+static GMutex scan_mutex;
+static GCond scan_cond;
+
+/* The capture_info of the file being scanned by the current thread. */
+static GPrivate current_capture_info = G_PRIVATE_INIT(NULL);
+
 static char *decimal_point;
 
 static void
@@ -540,7 +579,9 @@ print_stats(const char *filename, capture_info *cf_info)
     }
     if (cap_data_size) {
         printf     ("Data size:           ");
-        if (machine_readable) {
+        if (!cf_info->packet_bytes_known) {
+            printf ("n/a\n");
+        } else if (machine_readable) {
             printf     ("%" PRIu64 " bytes\n", cf_info->packet_bytes);
         } else {
             size_string = format_size(cf_info->packet_bytes, FORMAT_SIZE_UNIT_BYTES, 0);
@@ -557,7 +598,9 @@ print_stats(const char *filename, capture_info *cf_info)
             printf("Latest packet time:   %s\n", absolute_time_string(&cf_info->latest_packet_time, cf_info->latest_packet_time_tsprec, cf_info));
         if (cap_data_rate_byte) {
             printf("Data byte rate:      ");
-            if (machine_readable) {
+            if (!cf_info->packet_bytes_known) {
+                printf ("n/a\n");
+            } else if (machine_readable) {
                 print_value("", 2, " bytes/sec",   cf_info->data_rate);
             } else {
                 size_string = format_size((int64_t)cf_info->data_rate, FORMAT_SIZE_UNIT_BYTES_S, 0);
@@ -567,7 +610,9 @@ print_stats(const char *filename, capture_info *cf_info)
         }
         if (cap_data_rate_bit) {
             printf("Data bit rate:       ");
-            if (machine_readable) {
+            if (!cf_info->packet_bytes_known) {
+                printf ("n/a\n");
+            } else if (machine_readable) {
                 print_value("", 2, " bits/sec",    cf_info->data_rate*8);
             } else {
                 size_string = format_size((int64_t)(cf_info->data_rate*8), FORMAT_SIZE_UNIT_BITS_S, 0);
@@ -576,7 +621,12 @@ print_stats(const char *filename, capture_info *cf_info)
             }
         }
     }
-    if (cap_packet_size)    printf("Average packet size: %.2f bytes\n",        cf_info->packet_size);
+    if (cap_packet_size) {
+        if (cf_info->packet_bytes_known)
+            printf("Average packet size: %.2f bytes\n",        cf_info->packet_size);
+        else
+            printf("Average packet size: n/a\n");
+    }
     if (cf_info->times_known) {
         if (cap_packet_rate) {
             printf("Average packet rate: ");
@@ -590,8 +640,8 @@ print_stats(const char *filename, capture_info *cf_info)
         }
     }
     if (cap_file_hashes) {
-        printf     ("SHA256:              %s\n", file_sha256);
-        printf     ("SHA1:                %s\n", file_sha1);
+        printf     ("SHA256:              %s\n", cf_info->file_sha256);
+        printf     ("SHA1:                %s\n", cf_info->file_sha1);
     }
     if (cap_order)          printf     ("Strict time order:   %s\n", order_string(cf_info->order));
 
@@ -656,14 +706,14 @@ print_stats(const char *filename, capture_info *cf_info)
     }
 
     if (cap_file_nrb) {
-        if (num_ipv4_addresses != 0)
-            printf   ("Number of resolved IPv4 addresses in file: %u\n", num_ipv4_addresses);
-        if (num_ipv6_addresses != 0)
-            printf   ("Number of resolved IPv6 addresses in file: %u\n", num_ipv6_addresses);
+        if (cf_info->num_ipv4_addresses != 0)
+            printf   ("Number of resolved IPv4 addresses in file: %u\n", cf_info->num_ipv4_addresses);
+        if (cf_info->num_ipv6_addresses != 0)
+            printf   ("Number of resolved IPv6 addresses in file: %u\n", cf_info->num_ipv6_addresses);
     }
     if (cap_file_dsb) {
-        if (num_decryption_secrets != 0)
-            printf   ("Number of decryption secrets in file: %u\n", num_decryption_secrets);
+        if (cf_info->num_decryption_secrets != 0)
+            printf   ("Number of decryption secrets in file: %u\n", cf_info->num_decryption_secrets);
     }
 }
 
@@ -832,7 +882,10 @@ print_stats_table(const char *filename, capture_info *cf_info)
     if (cap_data_size) {
         putsep();
         putquote();
-        printf("%" PRIu64, cf_info->packet_bytes);
+        if (cf_info->packet_bytes_known)
+            printf("%" PRIu64, cf_info->packet_bytes);
+        else
+            printf("n/a");
         putquote();
     }
 
@@ -860,7 +913,7 @@ print_stats_table(const char *filename, capture_info *cf_info)
     if (cap_data_rate_byte) {
         putsep();
         putquote();
-        if (cf_info->times_known)
+        if (cf_info->times_known && cf_info->packet_bytes_known)
             printf("%.2f", cf_info->data_rate);
         else
             printf("n/a");
@@ -870,7 +923,7 @@ print_stats_table(const char *filename, capture_info *cf_info)
     if (cap_data_rate_bit) {
         putsep();
         putquote();
-        if (cf_info->times_known)
+        if (cf_info->times_known && cf_info->packet_bytes_known)
             printf("%.2f", cf_info->data_rate*8);
         else
             printf("n/a");
@@ -880,7 +933,10 @@ print_stats_table(const char *filename, capture_info *cf_info)
     if (cap_packet_size) {
         putsep();
         putquote();
-        printf("%.2f", cf_info->packet_size);
+        if (cf_info->packet_bytes_known)
+            printf("%.2f", cf_info->packet_size);
+        else
+            printf("n/a");
         putquote();
     }
 
@@ -897,12 +953,12 @@ print_stats_table(const char *filename, capture_info *cf_info)
     if (cap_file_hashes) {
         putsep();
         putquote();
-        printf("%s", file_sha256);
+        printf("%s", cf_info->file_sha256);
         putquote();
 
         putsep();
         putquote();
-        printf("%s", file_sha1);
+        printf("%s", cf_info->file_sha1);
         putquote();
     }
 
@@ -1025,21 +1081,27 @@ cleanup_capture_info(capture_info *cf_info)
 static void
 count_ipv4_address(const unsigned int addr _U_, const char *name _U_, const bool static_entry _U_)
 {
-    num_ipv4_addresses++;
+    capture_info *cf_info = (capture_info *)g_private_get(&current_capture_info);
+
+    cf_info->num_ipv4_addresses++;
 }
 
 static void
 count_ipv6_address(const ws_in6_addr *addrp _U_, const char *name _U_, const bool static_entry _U_)
 {
-    num_ipv6_addresses++;
+    capture_info *cf_info = (capture_info *)g_private_get(&current_capture_info);
+
+    cf_info->num_ipv6_addresses++;
 }
 
 static void
 count_decryption_secret(uint32_t secrets_type _U_, const void *secrets _U_, unsigned int size _U_)
 {
+    capture_info *cf_info = (capture_info *)g_private_get(&current_capture_info);
+
     /* XXX - count them based on the secrets type (which is an opaque code,
        not a small integer)? */
-    num_decryption_secrets++;
+    cf_info->num_decryption_secrets++;
 }
 
 static void
@@ -1052,34 +1114,235 @@ hash_to_str(const unsigned char *hash, size_t length, char *str)
     }
 }
 
+/*
+ * Hash the part of the file from offset "start" up to offset "end", or
+ * up to the end of the file if "end" is -1, reading it ourselves.
+ * That's only needed for data that wiretap read before we could register
+ * hash_raw_data() (i.e., while it was determining the file type), or that
+ * it skipped or never got to.
+ */
+static bool
+hash_file_range(capture_info *cf_info, int64_t start, int64_t end)
+{
+    char  *buf;
+    size_t to_read, hash_bytes;
+
+    if (end != -1 && end <= start)
+        return true;
+
+    if (cf_info->hash_fh == NULL) {
+        cf_info->hash_fh = ws_fopen(cf_info->filename, "rb");
+        if (cf_info->hash_fh == NULL)
+            return false;
+    }
+    if (ws_fseek64(cf_info->hash_fh, start, SEEK_SET) != 0)
+        return false;
+
+    buf = (char *)g_malloc(HASH_BUF_SIZE);
+    for (;;) {
+        to_read = HASH_BUF_SIZE;
+        if (end != -1 && (int64_t)to_read > end - start)
+            to_read = (size_t)(end - start);
+        if (to_read == 0)
+            break;
+        hash_bytes = fread(buf, 1, to_read, cf_info->hash_fh);
+        if (hash_bytes == 0)
+            break;
+        gcry_md_write(cf_info->hd, buf, hash_bytes);
+        start += hash_bytes;
+    }
+    g_free(buf);
+    cf_info->hashed_upto = start;
+
+    return !ferror(cf_info->hash_fh) && (end == -1 || start == end);
+}
+
 static void
-calculate_hashes(const char *filename)
+hash_abort(capture_info *cf_info)
 {
-    FILE  *fh;
-    size_t hash_bytes;
+    gcry_md_close(cf_info->hd);
+    cf_info->hd = NULL;
+}
 
-    (void) g_strlcpy(file_sha256, "<unknown>", HASH_STR_SIZE);
-    (void) g_strlcpy(file_sha1, "<unknown>", HASH_STR_SIZE);
+/*
+ * Called by wiretap with each block of raw file data it reads, so that
+ * the file only has to be read once to both hash it and scan its records.
+ * Data arrives in file order, except that wiretap may go back and read
+ * some of it again; that's ignored.
+ */
+static void
+hash_raw_data(const uint8_t *data, size_t len, int64_t offset, void *user_data)
+{
+    capture_info *cf_info = (capture_info *)user_data;
+    int64_t       end = offset + (int64_t)len;
 
-    if (cap_file_hashes) {
-        fh = ws_fopen(filename, "rb");
-        if (fh && hd) {
-            while((hash_bytes = fread(hash_buf, 1, HASH_BUF_SIZE, fh)) > 0) {
-                gcry_md_write(hd, hash_buf, hash_bytes);
+    if (cf_info->hd == NULL || end <= cf_info->hashed_upto)
+        return;
+
+    if (offset > cf_info->hashed_upto) {
+        if (!hash_file_range(cf_info, cf_info->hashed_upto, offset)) {
+            hash_abort(cf_info);
+            return;
+        }
+    }
+    gcry_md_write(cf_info->hd, data + (cf_info->hashed_upto - offset),
+                  (size_t)(end - cf_info->hashed_upto));
+    cf_info->hashed_upto = end;
+}
+
+static void
+hash_start(capture_info *cf_info)
+{
+    (void) g_strlcpy(cf_info->file_sha256, "<unknown>", HASH_STR_SIZE);
+    (void) g_strlcpy(cf_info->file_sha1, "<unknown>", HASH_STR_SIZE);
+
+    if (!cap_file_hashes)
+        return;
+
+    if (gcry_md_open(&cf_info->hd, GCRY_MD_SHA256, 0) != 0) {
+        cf_info->hd = NULL;
+        return;
+    }
+    gcry_md_enable(cf_info->hd, GCRY_MD_SHA1);
+    cf_info->hashed_upto = 0;
+    wtap_set_cb_raw_data(cf_info->wth, hash_raw_data, cf_info);
+}
+
+static void
+hash_finish(capture_info *cf_info)
+{
+    wtap_set_cb_raw_data(cf_info->wth, NULL, NULL);
+    if (cf_info->hd != NULL) {
+        /* Hash whatever wiretap didn't read. */
+        if (hash_file_range(cf_info, cf_info->hashed_upto, -1)) {
+            gcry_md_final(cf_info->hd);
+            hash_to_str(gcry_md_read(cf_info->hd, GCRY_MD_SHA256), HASH_SIZE_SHA256, cf_info->file_sha256);
+            hash_to_str(gcry_md_read(cf_info->hd, GCRY_MD_SHA1), HASH_SIZE_SHA1, cf_info->file_sha1);
+        }
+        hash_abort(cf_info);
+    }
+    if (cf_info->hash_fh != NULL) {
+        fclose(cf_info->hash_fh);
+        cf_info->hash_fh = NULL;
+    }
+}
+
+static void
+ticks_to_nstime(nstime_t *ts, uint64_t ticks, uint64_t units_per_second)
+{
+    uint64_t frac;
+
+    ts->secs = (time_t)(ticks / units_per_second);
+    frac = ticks % units_per_second;
+    if (units_per_second <= 1000000000)
+        ts->nsecs = (int)(frac * 1000000000 / units_per_second);
+    else
+        ts->nsecs = (int)(frac / (units_per_second / 1000000000));
+}
+
+/*
+ * Quick mode: fill in the packet count and times from the last Interface
+ * Statistics Block of each interface, which is usually written when the
+ * capture is stopped.  Every interface must have an ISB with a start time,
+ * an end time, and a packet count (isb_usrdeliv, or isb_ifrecv if nothing
+ * was dropped); otherwise the file has to be read after all.
+ *
+ * The times are when capturing started and stopped, which might be a
+ * little before the first packet and after the last one.
+ */
+static bool
+get_stats_from_isbs(capture_info *cf_info)
+{
+    int           err;
+    char         *err_info;
+    wtapng_iface_descriptions_t *idb_info;
+    uint32_t      packets = 0;
+    bool          have_times = false;
+    bool          ok = true;
+    unsigned int  i;
+
+    if (!wtap_read_trailing_if_stats(cf_info->wth, &err, &err_info)) {
+        g_free(err_info);
+        return false;
+    }
+
+    idb_info = wtap_file_get_idb_info(cf_info->wth);
+    if (idb_info->interface_data->len == 0)
+        ok = false;
+    g_array_set_size(cf_info->interface_packet_counts, idb_info->interface_data->len);
+    for (i = 0; ok && i < idb_info->interface_data->len; i++) {
+        wtap_block_t if_descr = g_array_index(idb_info->interface_data, wtap_block_t, i);
+        wtapng_if_descr_mandatory_t *if_descr_mand = (wtapng_if_descr_mandatory_t *)wtap_block_get_mandatory_data(if_descr);
+        wtap_block_t if_stats;
+        uint64_t      starttime, endtime, count, drops;
+        nstime_t      start_ts, end_ts;
+
+        if (if_descr_mand->interface_statistics == NULL ||
+                if_descr_mand->interface_statistics->len == 0 ||
+                if_descr_mand->time_units_per_second == 0) {
+            ok = false;
+            break;
+        }
+        if_stats = g_array_index(if_descr_mand->interface_statistics, wtap_block_t,
+                                 if_descr_mand->interface_statistics->len - 1);
+        if (wtap_block_get_uint64_option_value(if_stats, OPT_ISB_STARTTIME, &starttime) != WTAP_OPTTYPE_SUCCESS ||
+                wtap_block_get_uint64_option_value(if_stats, OPT_ISB_ENDTIME, &endtime) != WTAP_OPTTYPE_SUCCESS) {
+            ok = false;
+            break;
+        }
+        if (wtap_block_get_uint64_option_value(if_stats, OPT_ISB_USRDELIV, &count) != WTAP_OPTTYPE_SUCCESS) {
+            if (wtap_block_get_uint64_option_value(if_stats, OPT_ISB_IFRECV, &count) != WTAP_OPTTYPE_SUCCESS ||
+                    wtap_block_get_uint64_option_value(if_stats, OPT_ISB_IFDROP, &drops) != WTAP_OPTTYPE_SUCCESS ||
+                    drops != 0) {
+                ok = false;
+                break;
             }
-            gcry_md_final(hd);
-            hash_to_str(gcry_md_read(hd, GCRY_MD_SHA256), HASH_SIZE_SHA256, file_sha256);
-            hash_to_str(gcry_md_read(hd, GCRY_MD_SHA1), HASH_SIZE_SHA1, file_sha1);
         }
-        if (fh) fclose(fh);
-        if (hd) gcry_md_reset(hd);
+        if (count > UINT32_MAX - packets) {
+            ok = false;
+            break;
+        }
+        packets += (uint32_t)count;
+        g_array_index(cf_info->interface_packet_counts, uint32_t, i) = (uint32_t)count;
+
+        ticks_to_nstime(&start_ts, starttime, if_descr_mand->time_units_per_second);
+        ticks_to_nstime(&end_ts, endtime, if_descr_mand->time_units_per_second);
+        if (!have_times || nstime_cmp(&start_ts, &cf_info->earliest_packet_time) < 0) {
+            cf_info->earliest_packet_time = start_ts;
+            cf_info->earliest_packet_time_tsprec = if_descr_mand->tsprecision;
+        }
+        if (!have_times || nstime_cmp(&end_ts, &cf_info->latest_packet_time) > 0) {
+            cf_info->latest_packet_time = end_ts;
+            cf_info->latest_packet_time_tsprec = if_descr_mand->tsprecision;
+        }
+        have_times = true;
+    }
+    g_free(idb_info);
+
+    if (!ok) {
+        /* Start over with the counts when reading the records. */
+        g_array_set_size(cf_info->interface_packet_counts, 0);
+        g_array_set_size(cf_info->interface_packet_counts, cf_info->num_interfaces);
+        return false;
     }
+
+    cf_info->packet_count = packets;
+    cf_info->times_known = true;
+    cf_info->packet_bytes_known = false;
+    cf_info->order = ORDER_UNKNOWN;
+    return true;
 }
 
-static int
-process_cap_file(const char *filename, bool need_separator)
+/*
+ * Open a file and gather its statistics and hashes.  This is run by a
+ * worker thread, so nothing is printed here; the result is left in
+ * cf_info for report_cap_file(), with the file still open if it
+ * succeeded.
+ */
+static void
+scan_cap_file(capture_info *cf_info)
 {
-    int                   status = 0;
+    const char           *filename = cf_info->filename;
     int                   err;
     char                 *err_info;
     int64_t               size;
@@ -1090,7 +1353,6 @@ process_cap_file(const char *filename, bool need_separator)
     uint32_t              snaplen_min_inferred = 0xffffffff;
     uint32_t              snaplen_max_inferred =          0;
     wtap_rec              rec;
-    capture_info          cf_info;
     bool                  have_times = true;
     nstime_t              earliest_packet_time;
     int                   earliest_packet_time_tsprec;
@@ -1105,22 +1367,22 @@ process_cap_file(const char *filename, bool need_separator)
 
     pkt_cmt *pc = NULL, *prev = NULL;
 
-    cf_info.wth = wtap_open_offline(filename, WTAP_TYPE_AUTO, &err, &err_info, false);
-    if (!cf_info.wth) {
-        cfile_open_failure_message(filename, err, err_info);
-        return 2;
+    /* Random access is only used by quick mode, to get at the end of the file. */
+    cf_info->wth = wtap_open_offline(filename, WTAP_TYPE_AUTO, &err, &err_info, quick_mode);
+    if (!cf_info->wth) {
+        cf_info->status = 2;
+        cf_info->failure = SCAN_OPEN_FAILED;
+        cf_info->err = err;
+        cf_info->err_info = err_info;
+        return;
     }
 
     /*
-     * Calculate the checksums. Do this after wtap_open_offline, so we don't
-     * bother calculating them for files that are not known capture types
-     * where we wouldn't print them anyway.
+     * Calculate the checksums from the data wiretap reads.  Do this after
+     * wtap_open_offline, so we don't bother calculating them for files
+     * that are not known capture types where we wouldn't print them anyway.
      */
-    calculate_hashes(filename);
-
-    if (need_separator && long_report) {
-        printf("\n");
-    }
+    hash_start(cf_info);
 
     nstime_set_zero(&earliest_packet_time);
     earliest_packet_time_tsprec = WTAP_TSPREC_UNKNOWN;
@@ -1129,35 +1391,44 @@ process_cap_file(const char *filename, bool need_separator)
     nstime_set_zero(&cur_time);
     nstime_set_zero(&prev_time);
 
-    cf_info.encap_counts = g_new0(int,WTAP_NUM_ENCAP_TYPES);
+    cf_info->encap_counts = g_new0(int,WTAP_NUM_ENCAP_TYPES);
 
-    idb_info = wtap_file_get_idb_info(cf_info.wth);
+    idb_info = wtap_file_get_idb_info(cf_info->wth);
 
     ws_assert(idb_info->interface_data != NULL);
 
-    cf_info.pkt_cmts = NULL;
-    cf_info.num_interfaces = idb_info->interface_data->len;
-    cf_info.interface_packet_counts  = g_array_sized_new(false, true, sizeof(uint32_t), cf_info.num_interfaces);
-    g_array_set_size(cf_info.interface_packet_counts, cf_info.num_interfaces);
-    cf_info.pkt_interface_id_unknown = 0;
+    cf_info->pkt_cmts = NULL;
+    cf_info->num_interfaces = idb_info->interface_data->len;
+    cf_info->interface_packet_counts  = g_array_sized_new(false, true, sizeof(uint32_t), cf_info->num_interfaces);
+    g_array_set_size(cf_info->interface_packet_counts, cf_info->num_interfaces);
+    cf_info->pkt_interface_id_unknown = 0;
 
     g_free(idb_info);
     idb_info = NULL;
 
-    /* Zero out the counters for the callbacks. */
-    num_ipv4_addresses = 0;
-    num_ipv6_addresses = 0;
-    num_decryption_secrets = 0;
-
     /* Register callbacks for new name<->address maps from the file and
        decryption secrets from the file. */
-    wtap_set_cb_new_ipv4(cf_info.wth, count_ipv4_address);
-    wtap_set_cb_new_ipv6(cf_info.wth, count_ipv6_address);
-    wtap_set_cb_new_secrets(cf_info.wth, count_decryption_secret);
+    g_private_set(&current_capture_info, cf_info);
+    wtap_set_cb_new_ipv4(cf_info->wth, count_ipv4_address);
+    wtap_set_cb_new_ipv6(cf_info->wth, count_ipv6_address);
+    wtap_set_cb_new_secrets(cf_info->wth, count_decryption_secret);
+
+    cf_info->packet_bytes_known = true;
+    err = 0;
+    err_info = NULL;
+    if (quick_mode && get_stats_from_isbs(cf_info)) {
+        packet = cf_info->packet_count;
+        earliest_packet_time = cf_info->earliest_packet_time;
+        earliest_packet_time_tsprec = cf_info->earliest_packet_time_tsprec;
+        latest_packet_time = cf_info->latest_packet_time;
+        latest_packet_time_tsprec = cf_info->latest_packet_time_tsprec;
+        order = ORDER_UNKNOWN;
+        goto records_done;
+    }
 
     /* Tally up data that we need to parse through the file to find */
     wtap_rec_init(&rec, 1514);
-    while (wtap_read(cf_info.wth, &rec, &err, &err_info, &data_offset))  {
+    while (wtap_read(cf_info->wth, &rec, &err, &err_info, &data_offset))  {
         if (rec.presence_flags & WTAP_HAS_TS) {
             prev_time = cur_time;
             cur_time = rec.ts;
@@ -1199,7 +1470,7 @@ process_cap_file(const char *filename, bool need_separator)
                 pc->next = NULL;
 
                 if (prev == NULL)
-                  cf_info.pkt_cmts = pc;
+                  cf_info->pkt_cmts = pc;
                 else
                   prev->next = pc;
 
@@ -1220,7 +1491,7 @@ process_cap_file(const char *filename, bool need_separator)
 
             if ((rec.rec_header.packet_header.pkt_encap > 0) &&
                     (rec.rec_header.packet_header.pkt_encap < WTAP_NUM_ENCAP_TYPES)) {
-                cf_info.encap_counts[rec.rec_header.packet_header.pkt_encap] += 1;
+                cf_info->encap_counts[rec.rec_header.packet_header.pkt_encap] += 1;
             } else {
                 fprintf(stderr, "capinfos: Unknown packet encapsulation %d in frame %u of file \"%s\"\n",
                         rec.rec_header.packet_header.pkt_encap, packet, filename);
@@ -1228,37 +1499,37 @@ process_cap_file(const char *filename, bool need_separator)
 
             /* Packet interface_id info */
             if (rec.presence_flags & WTAP_HAS_INTERFACE_ID) {
-                /* cf_info.num_interfaces is size, not index, so it's one more than max index */
-                if (rec.rec_header.packet_header.interface_id >= cf_info.num_interfaces) {
+                /* cf_info->num_interfaces is size, not index, so it's one more than max index */
+                if (rec.rec_header.packet_header.interface_id >= cf_info->num_interfaces) {
                     /*
                      * OK, re-fetch the number of interfaces, as there might have
                      * been an interface that was in the middle of packets, and
                      * grow the array to be big enough for the new number of
                      * interfaces.
                      */
-                    idb_info = wtap_file_get_idb_info(cf_info.wth);
+                    idb_info = wtap_file_get_idb_info(cf_info->wth);
 
-                    cf_info.num_interfaces = idb_info->interface_data->len;
-                    g_array_set_size(cf_info.interface_packet_counts, cf_info.num_interfaces);
+                    cf_info->num_interfaces = idb_info->interface_data->len;
+                    g_array_set_size(cf_info->interface_packet_counts, cf_info->num_interfaces);
 
                     g_free(idb_info);
                     idb_info = NULL;
                 }
-                if (rec.rec_header.packet_header.interface_id < cf_info.num_interfaces) {
-                    g_array_index(cf_info.interface_packet_counts, uint32_t,
+                if (rec.rec_header.packet_header.interface_id < cf_info->num_interfaces) {
+                    g_array_index(cf_info->interface_packet_counts, uint32_t,
                             rec.rec_header.packet_header.interface_id) += 1;
                 }
                 else {
-                    cf_info.pkt_interface_id_unknown += 1;
+                    cf_info->pkt_interface_id_unknown += 1;
                 }
             }
             else {
                 /* it's for interface_id 0 */
-                if (cf_info.num_interfaces != 0) {
-                    g_array_index(cf_info.interface_packet_counts, uint32_t, 0) += 1;
+                if (cf_info->num_interfaces != 0) {
+                    g_array_index(cf_info->interface_packet_counts, uint32_t, 0) += 1;
                 }
                 else {
-                    cf_info.pkt_interface_id_unknown += 1;
+                    cf_info->pkt_interface_id_unknown += 1;
                 }
             }
         }
@@ -1267,6 +1538,9 @@ process_cap_file(const char *filename, bool need_separator)
     } /* while */
     wtap_rec_cleanup(&rec);
 
+records_done:
+    g_private_set(&current_capture_info, NULL);
+
     /*
      * Get IDB info strings.
      * We do this at the end, so we can get information for all IDBs in
@@ -1274,116 +1548,173 @@ process_cap_file(const char *filename, bool need_separator)
      * we get, for example, a count of the number of statistics entries
      * for each interface as of the *end* of the file.
      */
-    idb_info = wtap_file_get_idb_info(cf_info.wth);
+    idb_info = wtap_file_get_idb_info(cf_info->wth);
 
-    cf_info.idb_info_strings = g_array_sized_new(false, false, sizeof(char*), cf_info.num_interfaces);
-    cf_info.num_interfaces = idb_info->interface_data->len;
-    for (i = 0; i < cf_info.num_interfaces; i++) {
+    cf_info->idb_info_strings = g_array_sized_new(false, false, sizeof(char*), cf_info->num_interfaces);
+    cf_info->num_interfaces = idb_info->interface_data->len;
+    for (i = 0; i < cf_info->num_interfaces; i++) {
         const wtap_block_t if_descr = g_array_index(idb_info->interface_data, wtap_block_t, i);
         char *s = wtap_get_debug_if_descr(if_descr, 21, "\n");
-        g_array_append_val(cf_info.idb_info_strings, s);
+        g_array_append_val(cf_info->idb_info_strings, s);
     }
 
     g_free(idb_info);
     idb_info = NULL;
 
     if (err != 0) {
-        fprintf(stderr,
-                "capinfos: An error occurred after reading %u packets from \"%s\".\n",
-                packet, filename);
-        cfile_read_failure_message(filename, err, err_info);
+        cf_info->failure = SCAN_READ_FAILED;
+        cf_info->err = err;
+        cf_info->err_info = err_info;
+        cf_info->packet_count = packet;
         if (err == WTAP_ERR_SHORT_READ) {
             /* Don't give up completely with this one. */
-            status = 1;
-            fprintf(stderr,
-                    "  (will continue anyway, checksums might be incorrect)\n");
+            cf_info->status = 1;
         } else {
-            cleanup_capture_info(&cf_info);
-            wtap_close(cf_info.wth);
-            return 2;
+            cf_info->status = 2;
+            hash_abort(cf_info);
+            hash_finish(cf_info);
+            cleanup_capture_info(cf_info);
+            wtap_close(cf_info->wth);
+            cf_info->wth = NULL;
+            return;
         }
     }
 
+    hash_finish(cf_info);
+
     /* File size */
-    size = wtap_file_size(cf_info.wth, &err);
+    size = wtap_file_size(cf_info->wth, &err);
     if (size == -1) {
-        fprintf(stderr,
-                "capinfos: Can't get size of \"%s\": %s.\n",
-                filename, g_strerror(err));
-        cleanup_capture_info(&cf_info);
-        wtap_close(cf_info.wth);
-        return 2;
+        cf_info->status = 2;
+        cf_info->failure = SCAN_SIZE_FAILED;
+        cf_info->err = err;
+        cleanup_capture_info(cf_info);
+        wtap_close(cf_info->wth);
+        cf_info->wth = NULL;
+        return;
     }
 
-    cf_info.filesize = size;
+    cf_info->filesize = size;
 
     /* File Type */
-    cf_info.file_type = wtap_file_type_subtype(cf_info.wth);
-    cf_info.compression_type = wtap_get_compression_type(cf_info.wth);
+    cf_info->file_type = wtap_file_type_subtype(cf_info->wth);
+    cf_info->compression_type = wtap_get_compression_type(cf_info->wth);
 
     /* File Encapsulation */
-    cf_info.file_encap = wtap_file_encap(cf_info.wth);
+    cf_info->file_encap = wtap_file_encap(cf_info->wth);
 
-    cf_info.file_tsprec = wtap_file_tsprec(cf_info.wth);
+    cf_info->file_tsprec = wtap_file_tsprec(cf_info->wth);
 
     /* Packet size limit (snaplen) */
-    cf_info.snaplen = wtap_snapshot_length(cf_info.wth);
-    if (cf_info.snaplen > 0)
-        cf_info.snap_set = true;
+    cf_info->snaplen = wtap_snapshot_length(cf_info->wth);
+    if (cf_info->snaplen > 0)
+        cf_info->snap_set = true;
     else
-        cf_info.snap_set = false;
+        cf_info->snap_set = false;
 
-    cf_info.snaplen_min_inferred = snaplen_min_inferred;
-    cf_info.snaplen_max_inferred = snaplen_max_inferred;
+    cf_info->snaplen_min_inferred = snaplen_min_inferred;
+    cf_info->snaplen_max_inferred = snaplen_max_inferred;
 
     /* # of packets */
-    cf_info.packet_count = packet;
+    cf_info->packet_count = packet;
 
     /* File Times */
-    cf_info.times_known = have_times;
-    cf_info.earliest_packet_time = earliest_packet_time;
-    cf_info.earliest_packet_time_tsprec = earliest_packet_time_tsprec;
-    cf_info.latest_packet_time = latest_packet_time;
-    cf_info.latest_packet_time_tsprec = latest_packet_time_tsprec;
-    nstime_delta(&cf_info.duration, &latest_packet_time, &earliest_packet_time);
+    cf_info->times_known = have_times;
+    cf_info->earliest_packet_time = earliest_packet_time;
+    cf_info->earliest_packet_time_tsprec = earliest_packet_time_tsprec;
+    cf_info->latest_packet_time = latest_packet_time;
+    cf_info->latest_packet_time_tsprec = latest_packet_time_tsprec;
+    nstime_delta(&cf_info->duration, &latest_packet_time, &earliest_packet_time);
     /* Duration precision is the higher of the earliest and latest packet timestamp precisions. */
-    if (cf_info.latest_packet_time_tsprec > cf_info.earliest_packet_time_tsprec)
-        cf_info.duration_tsprec = cf_info.latest_packet_time_tsprec;
+    if (cf_info->latest_packet_time_tsprec > cf_info->earliest_packet_time_tsprec)
+        cf_info->duration_tsprec = cf_info->latest_packet_time_tsprec;
     else
-        cf_info.duration_tsprec = cf_info.earliest_packet_time_tsprec;
-    cf_info.know_order = know_order;
-    cf_info.order = order;
+        cf_info->duration_tsprec = cf_info->earliest_packet_time_tsprec;
+    cf_info->know_order = know_order;
+    cf_info->order = order;
 
     /* Number of packet bytes */
-    cf_info.packet_bytes = bytes;
+    cf_info->packet_bytes = bytes;
 
-    cf_info.data_rate   = 0.0;
-    cf_info.packet_rate = 0.0;
-    cf_info.packet_size = 0.0;
+    cf_info->data_rate   = 0.0;
+    cf_info->packet_rate = 0.0;
+    cf_info->packet_size = 0.0;
 
     if (packet > 0) {
         double delta_time = nstime_to_sec(&latest_packet_time) - nstime_to_sec(&earliest_packet_time);
         if (delta_time > 0.0) {
-            cf_info.data_rate   = (double)bytes  / delta_time; /* Data rate per second */
-            cf_info.packet_rate = (double)packet / delta_time; /* packet rate per second */
+            cf_info->data_rate   = (double)bytes  / delta_time; /* Data rate per second */
+            cf_info->packet_rate = (double)packet / delta_time; /* packet rate per second */
+        }
+        cf_info->packet_size = (double)bytes / packet;                  /* Avg packet size      */
+    }
+}
+
+static void
+scan_cap_file_worker(void *data, void *user_data _U_)
+{
+    capture_info *cf_info = (capture_info *)data;
+
+    scan_cap_file(cf_info);
+
+    g_mutex_lock(&scan_mutex);
+    cf_info->scan_done = true;
+    g_cond_broadcast(&scan_cond);
+    g_mutex_unlock(&scan_mutex);
+}
+
+/*
+ * Report the results of scan_cap_file() for a file, and close it.
+ */
+static int
+report_cap_file(capture_info *cf_info, bool need_separator)
+{
+    const char *filename = cf_info->filename;
+
+    if (cf_info->failure == SCAN_OPEN_FAILED) {
+        cfile_open_failure_message(filename, cf_info->err, cf_info->err_info);
+        cf_info->err_info = NULL;
+        return cf_info->status;
+    }
+
+    if (need_separator && long_report) {
+        printf("\n");
+    }
+
+    if (cf_info->failure == SCAN_READ_FAILED) {
+        fprintf(stderr,
+                "capinfos: An error occurred after reading %u packets from \"%s\".\n",
+                cf_info->packet_count, filename);
+        cfile_read_failure_message(filename, cf_info->err, cf_info->err_info);
+        cf_info->err_info = NULL;
+        if (cf_info->status != 2) {
+            fprintf(stderr,
+                    "  (will continue anyway, checksums might be incorrect)\n");
         }
-        cf_info.packet_size = (double)bytes / packet;                  /* Avg packet size      */
+    } else if (cf_info->failure == SCAN_SIZE_FAILED) {
+        fprintf(stderr,
+                "capinfos: Can't get size of \"%s\": %s.\n",
+                filename, g_strerror(cf_info->err));
+    }
+    if (cf_info->status == 2) {
+        return cf_info->status;
     }
 
     if (!long_report && table_report_header) {
-      print_stats_table_header(&cf_info);
+      print_stats_table_header(cf_info);
     }
 
     if (long_report) {
-        print_stats(filename, &cf_info);
+        print_stats(filename, cf_info);
     } else {
-        print_stats_table(filename, &cf_info);
+        print_stats_table(filename, cf_info);
     }
 
-    cleanup_capture_info(&cf_info);
-    wtap_close(cf_info.wth);
+    cleanup_capture_info(cf_info);
+    wtap_close(cf_info->wth);
+    cf_info->wth = NULL;
 
-    return status;
+    return cf_info->status;
 }
 
 static void
@@ -1445,6 +1776,12 @@ print_usage(FILE *output)
     fprintf(output, "  -h, --help               display this help and exit\n");
     fprintf(output, "  -v, --version            display version info and exit\n");
     fprintf(output, "  -C cancel processing if file open fails (default is to continue)\n");
+    fprintf(output, "  -j <jobs>                process up to <jobs> files in parallel\n");
+    fprintf(output, "                           (default is the number of processors)\n");
+    fprintf(output, "  --quick                  take the packet count and capture times of pcapng\n");
+    fprintf(output, "                           files from their interface statistics, if present,\n");
+    fprintf(output, "                           instead of reading every packet (hashes, -H, are\n");
+    fprintf(output, "                           still computed over the whole file)\n");
     fprintf(output, "  -A generate all infos (default)\n");
     fprintf(output, "  -K disable displaying the capture comment\n");
     fprintf(output, "  -P disable displaying individual packet comments\n");
@@ -1463,13 +1800,19 @@ main(int argc, char *argv[])
     bool need_separator = false;
     int    opt;
     int    overall_error_status = EXIT_SUCCESS;
+#define LONGOPT_QUICK LONGOPT_BASE_APPLICATION+1
     static const struct ws_option long_options[] = {
         {"help", ws_no_argument, NULL, 'h'},
         {"version", ws_no_argument, NULL, 'v'},
+        {"quick", ws_no_argument, NULL, LONGOPT_QUICK},
         {0, 0, 0, 0 }
     };
 
     int status = 0;
+    int num_files = 0;
+    capture_info *cf_infos = NULL;
+    GThreadPool *scan_pool = NULL;
+    int next_scan;
 
     /* Set the program name. */
     g_set_prgname("capinfos");
@@ -1526,7 +1869,7 @@ main(int argc, char *argv[])
     wtap_init(true);
 
     /* Process the options */
-    while ((opt = ws_getopt_long(argc, argv, "abcdehiklmnopqrstuvxyzABCDEFHIKLMNPQRST", long_options, NULL)) !=-1) {
+    while ((opt = ws_getopt_long(argc, argv, "abcdehij:klmnopqrstuvxyzABCDEFHIKLMNPQRST", long_options, NULL)) !=-1) {
 
         switch (opt) {
 
@@ -1651,6 +1994,14 @@ main(int argc, char *argv[])
                 stop_after_failure = true;
                 break;
 
+            case 'j':
+                num_jobs = get_positive_int(ws_optarg, "number of jobs");
+                break;
+
+            case LONGOPT_QUICK:
+                quick_mode = true;
+                break;
+
             case 'A':
                 enable_all_infos();
                 break;
@@ -1726,18 +2077,41 @@ main(int argc, char *argv[])
 
     if (cap_file_hashes) {
         gcry_check_version(NULL);
-        gcry_md_open(&hd, GCRY_MD_SHA256, 0);
-        if (hd)
-            gcry_md_enable(hd, GCRY_MD_SHA1);
-
-        hash_buf = (char *)g_malloc(HASH_BUF_SIZE);
     }
 
+    if (num_jobs == 0)
+        num_jobs = g_get_num_processors();
+
     overall_error_status = 0;
 
-    for (opt = ws_optind; opt < argc; opt++) {
+    /*
+     * Scan the files in a pool of worker threads and report them here,
+     * in order.  At most twice as many files as there are workers are
+     * scanned ahead of the one being reported, so that we don't keep
+     * thousands of files open.
+     */
+    num_files = argc - ws_optind;
+    cf_infos = g_new0(capture_info, num_files);
+    for (opt = 0; opt < num_files; opt++)
+        cf_infos[opt].filename = argv[ws_optind + opt];
+    if (num_jobs > 1 && num_files > 1)
+        scan_pool = g_thread_pool_new(scan_cap_file_worker, NULL, num_jobs, false, NULL);
+    for (next_scan = 0; scan_pool != NULL && next_scan < num_files && next_scan < (int)num_jobs * 2; next_scan++)
+        g_thread_pool_push(scan_pool, &cf_infos[next_scan], NULL);
+
+    for (opt = 0; opt < num_files; opt++) {
+        if (scan_pool != NULL) {
+            g_mutex_lock(&scan_mutex);
+            while (!cf_infos[opt].scan_done)
+                g_cond_wait(&scan_cond, &scan_mutex);
+            g_mutex_unlock(&scan_mutex);
+            if (next_scan < num_files)
+                g_thread_pool_push(scan_pool, &cf_infos[next_scan++], NULL);
+        } else {
+            scan_cap_file(&cf_infos[opt]);
+        }
 
-        status = process_cap_file(argv[opt], need_separator);
+        status = report_cap_file(&cf_infos[opt], need_separator);
         if (status) {
             /* Something failed.  It's been reported; remember that processing
                one file failed and, if -C was specified, stop. */
@@ -1755,8 +2129,21 @@ main(int argc, char *argv[])
     }
 
 exit:
-    g_free(hash_buf);
-    gcry_md_close(hd);
+    if (scan_pool != NULL) {
+        /* Don't start on any more files, and wait for the ones in progress. */
+        g_thread_pool_free(scan_pool, true, true);
+    }
+    if (cf_infos != NULL) {
+        /* Close any files that were scanned but not reported (-C). */
+        for (opt = 0; opt < num_files; opt++) {
+            if (cf_infos[opt].wth != NULL) {
+                cleanup_capture_info(&cf_infos[opt]);
+                wtap_close(cf_infos[opt].wth);
+            }
+            g_free(cf_infos[opt].err_info);
+        }
+        g_free(cf_infos);
+    }
     wtap_cleanup();
     free_progdirs();
     return overall_error_status;
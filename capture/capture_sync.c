@@ -774,6 +774,13 @@ sync_pipe_start(capture_options *capture_opts, GPtrArray *capture_comments,
             g_free(print_name);
         }
 
+        if (capture_opts->ring_compress_type) {
+            char *ring_compress = g_strdup_printf("compress:%s", capture_opts->ring_compress_type);
+            argv = sync_pipe_add_arg(argv, &argc, "-b");
+            argv = sync_pipe_add_arg(argv, &argc, ring_compress);
+            g_free(ring_compress);
+        }
+
         if (capture_opts->has_nametimenum) {
             char nametimenum[ARGV_NUMBER_LEN];
             argv = sync_pipe_add_arg(argv, &argc, "-b");
@@ -92,7 +92,7 @@ typedef struct _capture_file {
     dfilter_t                  *rfcode;               /* Compiled read filter program */
     dfilter_t                  *dfcode;               /* Compiled display filter program */
     char                       *dfilter;              /* Display filter string */
-    bool                        redissecting;         /* true if currently redissecting (cf_redissect_packets) */
+    bool                        redissecting;         /* true if currently rescanning or redissecting (rescan_packets) */
     bool                        read_lock;            /* true if currently processing a file (cf_read) */
     rescan_type                 redissection_queued;  /* Queued redissection type. */
     /* search */
@@ -532,6 +532,8 @@ print_usage(FILE *output)
     fprintf(output, "                                          an exact multiple of NUM secs\n");
     fprintf(output, "                          printname:FILE - print filename to FILE when written\n");
     fprintf(output, "                                           (can use 'stdout' or 'stderr')\n");
+    fprintf(output, "                           compress:TYPE - compress completed files with TYPE\n");
+    fprintf(output, "                                           in the background\n");
     fprintf(output, "  -F                       output file type (default: pcapng)\n");
     fprintf(output, "                           an empty \"-F\" option will list the file types\n");
     fprintf(output, "  -n                       use pcapng format instead of pcap (default)\n");
@@ -1157,9 +1159,18 @@ capture_cleanup_handler(int signum _U_)
 static void
 report_capture_count(bool reportit)
 {
+    unsigned pending, failed;
+    uint64_t in_bytes, out_bytes;
+
     /* Don't print this if we're a capture child. */
     if (!capture_child && reportit) {
         fprintf(stderr, "\rPackets captured: %d\n", global_ld.packets_captured);
+        if (ringbuf_is_initialized() &&
+            ringbuf_get_compress_stats(&pending, &failed, &in_bytes, &out_bytes)) {
+            fprintf(stderr, "Files waiting for compression: %u, failed: %u, "
+                    "compressed %" PRIu64 " kB to %" PRIu64 " kB\n",
+                    pending, failed, in_bytes / 1000, out_bytes / 1000);
+        }
         /* stderr could be line buffered */
         fflush(stderr);
     }
@@ -3927,6 +3938,15 @@ capture_loop_open_output(capture_options *capture_opts, int *save_file_fd,
                         return false;
                     }
                 }
+                if (capture_opts->ring_compress_type) {
+                    if (!ringbuf_set_post_compression(capture_opts->ring_compress_type)) {
+                        snprintf(errmsg, errmsg_len, "Could not compress ring buffer files as %s.\n",
+                                   capture_opts->ring_compress_type);
+                        g_free(capfile_name);
+                        ringbuf_error_cleanup();
+                        return false;
+                    }
+                }
             } else {
                 /* Try to open/create the specified file for use as a capture buffer. */
                 *save_file_fd = ws_open(capfile_name, O_WRONLY|O_BINARY|O_TRUNC|O_CREAT,
@@ -5762,6 +5782,10 @@ main(int argc, char *argv[])
                 cmdarg_err("Ring buffer file duration and interval can't be used at the same time.");
                 exit_main(1);
             }
+            if (global_capture_opts.ring_compress_type && global_capture_opts.compress_type) {
+                cmdarg_err("--compress-type and -b compress can't be used at the same time.");
+                exit_main(1);
+            }
         }
     }
 
@@ -19,6 +19,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <time.h>
 
 #include <wsutil/strtoi.h>
 #include <wsutil/ws_assert.h>
@@ -107,6 +108,7 @@
 #define ENAME_VLANS     "vlans"
 #define ENAME_SS7PCS    "ss7pcs"
 #define ENAME_ENTERPRISES "enterprises"
+#define ENAME_DNS_CACHE "dns_cache"
 
 #define HASHETHSIZE      2048
 #define HASHHOSTSIZE     2048
@@ -320,6 +322,34 @@ e_addr_resolve gbl_resolv_flags = {
 static unsigned name_resolve_concurrency = 500;
 static bool resolve_synchronously;
 
+/*
+ * Bulk resolution: instead of sending reverse lookups one by one as names
+ * are displayed, collect every address seen on the first pass, whether or
+ * not a tree is built, and send them in batches from
+ * host_name_lookup_bulk() (after reading a file, and after each batch of
+ * packets in a live capture) with a much higher concurrency. The answers
+ * are processed by host_name_lookup_process() as usual.
+ */
+static bool bulk_name_resolution;
+static unsigned bulk_name_resolve_concurrency = 10000;
+static wmem_list_t *bulk_dns_queue;     /* async_dns_queue_msg_t */
+
+/*
+ * Persistent DNS cache. Names returned by reverse lookups are stored in
+ * the "dns_cache" file of the current profile, along with the time they
+ * expire, so that reopening a capture doesn't have to query them again.
+ */
+typedef struct _dns_cache_entry {
+    char   *name;
+    time_t  expires;
+} dns_cache_entry_t;
+
+static bool use_dns_cache_file;
+static unsigned dns_cache_ttl = 86400;
+static GHashTable *dns_cache;       /* Address string -> dns_cache_entry_t */
+static char *dns_cache_path;        /* File the cache was loaded from */
+static bool dns_cache_dirty;
+
 /*
  *  Global variables (can be changed in GUI sections)
  *  XXX - they could be changed in GUI code, but there's currently no
@@ -460,6 +490,48 @@ dnsserver_uat_fld_port_chk_cb(void* r _U_, const char* p, unsigned len _U_, cons
     return true;
 }
 
+static void
+dns_cache_entry_free(void *data)
+{
+    dns_cache_entry_t *entry = (dns_cache_entry_t *)data;
+
+    g_free(entry->name);
+    g_free(entry);
+}
+
+static void
+dns_cache_insert(const char *addr_str, const char *name, time_t expires)
+{
+    dns_cache_entry_t *entry = g_new(dns_cache_entry_t, 1);
+
+    entry->name = g_strdup(name);
+    entry->expires = expires;
+    g_hash_table_replace(dns_cache, g_strdup(addr_str), entry);
+}
+
+/* Remember the result of a reverse lookup in the persistent cache. */
+static void
+dns_cache_add(int family, const void *addrp, const char *name)
+{
+    char addr_str[WS_INET6_ADDRSTRLEN];
+
+    if (!use_dns_cache_file || dns_cache == NULL || !name || name[0] == '\0')
+        return;
+
+    switch (family) {
+        case AF_INET:
+            ws_inet_ntop4(addrp, addr_str, sizeof(addr_str));
+            break;
+        case AF_INET6:
+            ws_inet_ntop6(addrp, addr_str, sizeof(addr_str));
+            break;
+        default:
+            return;
+    }
+    dns_cache_insert(addr_str, name, time(NULL) + dns_cache_ttl);
+    dns_cache_dirty = true;
+}
+
 static void
 c_ares_ghba_sync_cb(void *arg, int status, int timeouts _U_, struct hostent *he) {
     sync_dns_data_t *sdd = (sync_dns_data_t *)arg;
@@ -479,7 +551,7 @@ c_ares_ghba_sync_cb(void *arg, int status, int timeouts _U_, struct hostent *he)
                     break;
             }
         }
-
+        dns_cache_add(sdd->family, &sdd->addr, he->h_name);
     }
 
     /*
@@ -540,7 +612,7 @@ wait_for_sync_resolv(bool *completed) {
 }
 
 static void
-process_async_dns_queue(void)
+process_async_dns_queue(unsigned max_in_flight)
 {
     wmem_list_frame_t* head;
     async_dns_queue_msg_t *caqm;
@@ -553,7 +625,7 @@ process_async_dns_queue(void)
 
     head = wmem_list_head(async_dns_queue_head);
 
-    while (head != NULL && async_dns_in_flight <= name_resolve_concurrency) {
+    while (head != NULL && async_dns_in_flight <= max_in_flight) {
         caqm = (async_dns_queue_msg_t *)wmem_list_frame_data(head);
         wmem_list_remove_frame(async_dns_queue_head, head);
         if (caqm->family == AF_INET) {
@@ -572,26 +644,21 @@ process_async_dns_queue(void)
     g_mutex_unlock(&async_dns_queue_mtx);
 }
 
+/* Process the asynchronous queue until it is empty and all of the
+ * requests have been answered (or timed out).
+ */
 static void
-wait_for_async_queue(void)
+drain_async_dns_queue(unsigned max_in_flight)
 {
     struct timeval tv = { 0, 0 };
     int nfds;
     fd_set rfds, wfds;
 
-    new_resolved_objects = false;
-
-    if (!async_dns_initialized) {
-        maxmind_db_lookup_process();
-        return;
-    }
-
     while (1) {
-        /* We're switching to synchronous lookups, so process anything in
-         * the asynchronous queue. There might be more in the queue than
-         * name_resolve_concurrency allows, so check each cycle.
+        /* There might be more in the queue than max_in_flight allows,
+         * so check each cycle.
          */
-        process_async_dns_queue();
+        process_async_dns_queue(max_in_flight);
 
         FD_ZERO(&rfds);
         FD_ZERO(&wfds);
@@ -616,9 +683,28 @@ wait_for_async_queue(void)
         }
         ares_process(ghba_chan, &rfds, &wfds);
     }
+}
+
+/* The number of asynchronous requests allowed in flight */
+static unsigned
+async_dns_concurrency(void)
+{
+    return bulk_name_resolution ? bulk_name_resolve_concurrency : name_resolve_concurrency;
+}
+
+static void
+wait_for_async_queue(void)
+{
+    new_resolved_objects = false;
+
+    if (async_dns_initialized) {
+        /* We're switching to synchronous lookups, so process anything in
+         * the asynchronous queue.
+         */
+        drain_async_dns_queue(async_dns_concurrency());
+    }
 
     maxmind_db_lookup_process();
-    return;
 }
 
 static void
@@ -1304,6 +1390,7 @@ c_ares_ghba_cb(void *arg, int status, int timeouts _U_, struct hostent *he) {
                     break;
             }
         }
+        dns_cache_add(caqm->family, &caqm->addr, he->h_name);
     }
     wmem_free(addr_resolv_scope, caqm);
 }
@@ -1351,7 +1438,15 @@ host_lookup(const unsigned addr)
 
         if (async_dns_initialized) {
             /* c-ares is initialized, so we can use it */
-            if (resolve_synchronously || name_resolve_concurrency == 0) {
+            if (bulk_name_resolution && !resolve_synchronously) {
+                /* Send it with the next batch. */
+                async_dns_queue_msg_t *caqm;
+
+                caqm = wmem_new(addr_resolv_scope, async_dns_queue_msg_t);
+                caqm->family = AF_INET;
+                caqm->addr.ip4 = addr;
+                wmem_list_append(bulk_dns_queue, (void *) caqm);
+            } else if (resolve_synchronously || name_resolve_concurrency == 0) {
                 /*
                  * Either all names are to be resolved synchronously or
                  * the concurrencly level is 0; do the resolution
@@ -1426,7 +1521,15 @@ host_lookup6(const ws_in6_addr *addr)
 
         if (async_dns_initialized) {
             /* c-ares is initialized, so we can use it */
-            if (resolve_synchronously || name_resolve_concurrency == 0) {
+            if (bulk_name_resolution && !resolve_synchronously) {
+                /* Send it with the next batch. */
+                async_dns_queue_msg_t *caqm;
+
+                caqm = wmem_new(addr_resolv_scope, async_dns_queue_msg_t);
+                caqm->family = AF_INET6;
+                memcpy(&caqm->addr.ip6, addr, sizeof(caqm->addr.ip6));
+                wmem_list_append(bulk_dns_queue, (void *) caqm);
+            } else if (resolve_synchronously || name_resolve_concurrency == 0) {
                 /*
                  * Either all names are to be resolved synchronously or
                  * the concurrencly level is 0; do the resolution
@@ -3469,6 +3572,35 @@ addr_resolve_pref_init(module_t *nameres)
             10,
             &name_resolve_concurrency);
 
+    prefs_register_bool_preference(nameres, "bulk_name_resolution",
+            "Resolve addresses in bulk while reading a capture",
+            "Instead of resolving each address as its name is first shown,"
+            " collect all addresses while the capture is read and resolve"
+            " them in batches (after reading a file, or as packets arrive in"
+            " a live capture), with many more requests in flight.",
+            &bulk_name_resolution);
+
+    prefs_register_uint_preference(nameres, "bulk_name_resolve_concurrency",
+            "Maximum concurrent requests for bulk resolution",
+            "The maximum number of DNS requests that may"
+            " be active at any time when resolving addresses in bulk.",
+            10,
+            &bulk_name_resolve_concurrency);
+
+    prefs_register_bool_preference(nameres, "dns_cache",
+            "Cache DNS lookups on disk",
+            "Store the names returned by reverse DNS lookups in the profile's"
+            " \"" ENAME_DNS_CACHE "\" file, so that they are available"
+            " immediately when a capture is opened again.",
+            &use_dns_cache_file);
+
+    prefs_register_uint_preference(nameres, "dns_cache_ttl",
+            "DNS cache lifetime (seconds)",
+            "How long names in the DNS cache file are used before they are"
+            " looked up again.",
+            10,
+            &dns_cache_ttl);
+
     prefs_register_obsolete_preference(nameres, "hosts_file_handling");
 
     prefs_register_bool_preference(nameres, "vlan_name",
@@ -3520,7 +3652,7 @@ host_name_lookup_process(void) {
         /* c-ares not initialized. Bail out and cancel timers. */
         return nro;
 
-    process_async_dns_queue();
+    process_async_dns_queue(async_dns_concurrency());
 
     FD_ZERO(&rfds);
     FD_ZERO(&wfds);
@@ -3542,6 +3674,7 @@ host_name_lookup_process(void) {
 static void
 _host_name_lookup_cleanup(void) {
     async_dns_queue_head = NULL;
+    bulk_dns_queue = NULL;
 
     if (async_dns_initialized) {
         ares_destroy(ghba_chan);
@@ -3708,6 +3841,160 @@ add_manually_resolved(void)
     }
 }
 
+static bool
+bulk_name_resolution_active(void)
+{
+    return bulk_name_resolution && !resolve_synchronously && async_dns_initialized &&
+        gbl_resolv_flags.network_name && gbl_resolv_flags.use_external_net_name_resolver;
+}
+
+void
+host_name_lookup_queue_ipv4(const unsigned addr)
+{
+    if (bulk_name_resolution_active())
+        host_lookup(addr);
+}
+
+void
+host_name_lookup_queue_ipv6(const ws_in6_addr *addr)
+{
+    if (bulk_name_resolution_active())
+        host_lookup6(addr);
+}
+
+void
+host_name_lookup_bulk(void)
+{
+    wmem_list_frame_t *frame;
+
+    if (!bulk_name_resolution_active() || wmem_list_count(bulk_dns_queue) == 0)
+        return;
+
+    /*
+     * Move the batch to the asynchronous queue and send as much of it as
+     * the concurrency allows; host_name_lookup_process() sends the rest
+     * and processes the answers. Don't wait for them here.
+     */
+    g_mutex_lock(&async_dns_queue_mtx);
+    while ((frame = wmem_list_head(bulk_dns_queue)) != NULL) {
+        wmem_list_append(async_dns_queue_head, wmem_list_frame_data(frame));
+        wmem_list_remove_frame(bulk_dns_queue, frame);
+    }
+    g_mutex_unlock(&async_dns_queue_mtx);
+
+    process_async_dns_queue(bulk_name_resolve_concurrency);
+}
+
+static void
+dns_cache_load(void)
+{
+    FILE *cache_file;
+    char line[MAX_LINELEN];
+    time_t now = time(NULL);
+
+    dns_cache = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, dns_cache_entry_free);
+    dns_cache_dirty = false;
+
+    if (!use_dns_cache_file)
+        return;
+
+    dns_cache_path = get_persconffile_path(ENAME_DNS_CACHE, true);
+    if ((cache_file = ws_fopen(dns_cache_path, "r")) == NULL)
+        return;
+
+    /* <address> TAB <name> TAB <expiry, seconds since the Epoch> */
+    while (fgetline(line, sizeof(line), cache_file) >= 0) {
+        char **fields;
+        uint64_t expires;
+        uint32_t ip4;
+        ws_in6_addr ip6;
+
+        if (line[0] == '#')
+            continue;
+
+        fields = g_strsplit(line, "\t", 3);
+        if (g_strv_length(fields) == 3 &&
+            ws_strtou64(fields[2], NULL, &expires) && (time_t)expires > now) {
+            if (ws_inet_pton4(fields[0], &ip4)) {
+                add_ipv4_name(ip4, fields[1], false);
+                dns_cache_insert(fields[0], fields[1], (time_t)expires);
+            } else if (ws_inet_pton6(fields[0], &ip6)) {
+                add_ipv6_name(&ip6, fields[1], false);
+                dns_cache_insert(fields[0], fields[1], (time_t)expires);
+            }
+        } else {
+            /* Expired or invalid; drop it when the file is written. */
+            dns_cache_dirty = true;
+        }
+        g_strfreev(fields);
+    }
+    fclose(cache_file);
+}
+
+static void
+dns_cache_write(void)
+{
+    GHashTableIter iter;
+    void *key, *value;
+    FILE *cache_file;
+    char *tmp_path;
+    char *pf_dir_path;
+    time_t now = time(NULL);
+
+    if (!dns_cache_dirty || dns_cache_path == NULL)
+        return;
+
+    if (create_persconffile_dir(&pf_dir_path) == -1) {
+        ws_warning("Can't create directory %s for DNS cache file: %s", pf_dir_path, g_strerror(errno));
+        g_free(pf_dir_path);
+        return;
+    }
+
+    /* Write to a temporary file and rename it, so that an interrupted
+     * write (or a concurrent instance) doesn't leave a truncated cache.
+     */
+    tmp_path = ws_strdup_printf("%s.tmp", dns_cache_path);
+    if ((cache_file = ws_fopen(tmp_path, "w")) == NULL) {
+        ws_warning("Can't write DNS cache file %s: %s", tmp_path, g_strerror(errno));
+        g_free(tmp_path);
+        return;
+    }
+
+    fputs("# DNS cache file for Wireshark " VERSION ".\n"
+          "# This file is regenerated each time a capture file is closed.\n", cache_file);
+    g_hash_table_iter_init(&iter, dns_cache);
+    while (g_hash_table_iter_next(&iter, &key, &value)) {
+        dns_cache_entry_t *entry = (dns_cache_entry_t *)value;
+
+        if (entry->expires > now) {
+            fprintf(cache_file, "%s\t%s\t%" PRIu64 "\n", (const char *)key, entry->name, (uint64_t)entry->expires);
+        }
+    }
+
+    if (fclose(cache_file) == 0) {
+        if (ws_rename(tmp_path, dns_cache_path) == -1) {
+            ws_warning("Can't rename %s to %s: %s", tmp_path, dns_cache_path, g_strerror(errno));
+            ws_unlink(tmp_path);
+        }
+    } else {
+        ws_unlink(tmp_path);
+    }
+    g_free(tmp_path);
+}
+
+static void
+dns_cache_cleanup(void)
+{
+    dns_cache_write();
+    if (dns_cache) {
+        g_hash_table_destroy(dns_cache);
+        dns_cache = NULL;
+    }
+    g_free(dns_cache_path);
+    dns_cache_path = NULL;
+    dns_cache_dirty = false;
+}
+
 static void
 host_name_lookup_init(void)
 {
@@ -3725,6 +4012,7 @@ host_name_lookup_init(void)
 
     ws_assert(async_dns_queue_head == NULL);
     async_dns_queue_head = wmem_list_new(addr_resolv_scope);
+    bulk_dns_queue = wmem_list_new(addr_resolv_scope);
 
     /*
      * The manually resolved lists are the only address resolution maps
@@ -3773,6 +4061,8 @@ host_name_lookup_init(void)
         }
     }
 
+    dns_cache_load();
+
     subnet_name_lookup_init();
 
     add_manually_resolved();
@@ -3788,6 +4078,8 @@ host_name_lookup_cleanup(void)
 
     _host_name_lookup_cleanup();
 
+    dns_cache_cleanup();
+
     ipxnet_hash_table = NULL;
     ipv4_hash_table = NULL;
     ipv6_hash_table = NULL;
@@ -218,6 +218,32 @@ WS_DLL_PUBLIC void disable_name_resolution(void);
  */
 WS_DLL_PUBLIC bool host_name_lookup_process(void);
 
+/** If bulk name resolution is enabled, send lookups for the addresses
+ *  queued since the last call, with up to the
+ *  "bulk_name_resolve_concurrency" preference requests in flight. This
+ *  doesn't wait: host_name_lookup_process() processes the answers, and
+ *  set_resolution_synchrony(true) waits for them. It is called after
+ *  reading a capture file and after each batch of packets of a live
+ *  capture.
+ */
+WS_DLL_PUBLIC void host_name_lookup_bulk(void);
+
+/** If bulk name resolution is enabled, queue an address seen in a packet
+ *  for the next host_name_lookup_bulk(), whether or not its name is
+ *  displayed. Dissectors of network layer addresses call this on the
+ *  first pass.
+ *
+ *  @param addr the IPv4 address, in network byte order
+ */
+WS_DLL_PUBLIC void host_name_lookup_queue_ipv4(const unsigned addr);
+
+/** If bulk name resolution is enabled, queue an IPv6 address seen in a
+ *  packet for the next host_name_lookup_bulk().
+ *
+ *  @param addr the IPv6 address
+ */
+WS_DLL_PUBLIC void host_name_lookup_queue_ipv6(const ws_in6_addr *addr);
+
 /* get_hostname returns the host name or "%d.%d.%d.%d" if not found.
  * The string does not have to be freed; it will be freed when the
  * address hashtables are emptied (e.g., when preferences change or
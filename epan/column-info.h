@@ -112,6 +112,19 @@ void col_custom_prime_edt(struct epan_dissect *edt, column_info *cinfo);
 WS_DLL_PUBLIC
 char* col_custom_get_filter(struct epan_dissect *edt, column_info *cinfo, const int col);
 
+/** Prime an epan_dissect_t with only the fields of a custom column,
+ * so that its sort key can be extracted without a visible tree or
+ * column text.
+ */
+WS_DLL_PUBLIC
+void col_custom_prime_edt_sort_key(struct epan_dissect *edt, column_info *cinfo, const int col);
+
+/** Get the 64-bit numeric sort key of a custom column from a dissection
+ * primed with col_custom_prime_edt_sort_key().
+ */
+WS_DLL_PUBLIC
+uint64_t col_custom_get_sort_key(struct epan_dissect *edt, column_info *cinfo, const int col);
+
 WS_DLL_PUBLIC
 bool have_custom_cols(column_info *cinfo);
 
@@ -451,6 +451,52 @@ col_custom_get_filter(epan_dissect_t *edt, column_info *cinfo, const int col)
   return NULL;
 }
 
+void
+col_custom_prime_edt_sort_key(epan_dissect_t *edt, column_info *cinfo, const int col)
+{
+  col_item_t* col_item;
+  col_custom_t *col_custom;
+
+  ws_assert(cinfo);
+  ws_assert(col < cinfo->num_cols);
+
+  col_item = &cinfo->columns[col];
+  if (!col_item->fmt_matx[COL_CUSTOM])
+    return;
+
+  /* Prime the individual fields where we can; that does not force
+   * the values of other fields in an expression to be generated.
+   */
+  for (GSList *iter = col_item->col_custom_fields_ids; iter; iter = iter->next) {
+    col_custom = (col_custom_t*)iter->data;
+    if (col_custom->field_id != 0) {
+      epan_dissect_prime_with_hfid(edt, col_custom->field_id);
+    } else if (col_custom->dfilter) {
+      epan_dissect_prime_with_dfilter(edt, col_custom->dfilter);
+    }
+  }
+}
+
+uint64_t
+col_custom_get_sort_key(epan_dissect_t *edt, column_info *cinfo, const int col)
+{
+  col_item_t* col_item;
+
+  ws_assert(cinfo);
+  ws_assert(col < cinfo->num_cols);
+
+  col_item = &cinfo->columns[col];
+  if (col_item->fmt_matx[COL_CUSTOM] &&
+      col_item->col_custom_fields &&
+      col_item->col_custom_fields_ids &&
+      edt->tree) {
+
+      return proto_custom_get_sort_key(edt->tree, col_item->col_custom_fields_ids,
+                                       col_item->col_custom_occurrence);
+  }
+  return PROTO_CUSTOM_SORT_KEY_NONE;
+}
+
 void
 col_append_lstr(column_info *cinfo, const int el, const char *str1, ...)
 {
@@ -1079,6 +1079,214 @@ add_hostlist_table_data(conv_hash_t *ch, const address *addr, uint32_t port, boo
     add_endpoint_table_data(ch, addr, port, sender, num_frames, num_bytes, et_info, etype);
 }
 
+/*
+ * The conversation table store.
+ */
+
+/* Flags of the store's tap listeners. The store is only fed on the first
+ * pass, so it doesn't need retaps, and it has the same default flags as
+ * the GUI tables. */
+#define CT_STORE_TAP_FLAGS (TL_IS_DISSECTOR_HELPER|TL_IGNORE_DISPLAY_FILTER|TL_IP_AGGREGATION_ORI)
+/* Flags of a table that change what it contains without a filter */
+#define CT_STORE_TABLE_FLAGS (TL_LIMIT_TO_DISPLAY_FILTER|TL_IP_AGGREGATION_NULL|TL_IP_AGGREGATION_ORI|TL_IP_AGGREGATION_RESERVED)
+
+typedef struct {
+    register_ct_t *table;
+    conv_hash_t conv_hash;
+    conv_hash_t endpoint_hash;
+    bool complete;          /* Added before the file was opened */
+} ct_store_t;
+
+static wmem_list_t *ct_stores;
+static bool ct_store_file_open;
+
+static tap_packet_status
+ct_store_packet(void *tapdata, packet_info *pinfo, epan_dissect_t *edt, const void *data, tap_flags_t flags)
+{
+    ct_store_t *store = (ct_store_t *)tapdata;
+
+    /* Count each frame once, when it is first dissected; retaps for other
+     * listeners see it again. The frame is already marked visited when
+     * taps are pushed, so rely on the flag from when it was queued. */
+    if (!(flags & TL_FIRST_PASS))
+        return TAP_PACKET_DONT_REDRAW;
+    flags &= ~TL_FIRST_PASS;
+
+    if (store->table->conv_func)
+        store->table->conv_func(&store->conv_hash, pinfo, edt, data, flags);
+    if (store->table->endpoint_func)
+        store->table->endpoint_func(&store->endpoint_hash, pinfo, edt, data, flags);
+
+    return TAP_PACKET_DONT_REDRAW;
+}
+
+static ct_store_t *
+ct_store_lookup(register_ct_t *ct)
+{
+    wmem_list_frame_t *frame;
+
+    if (ct_stores == NULL)
+        return NULL;
+
+    for (frame = wmem_list_head(ct_stores); frame; frame = wmem_list_frame_next(frame)) {
+        ct_store_t *store = (ct_store_t *)wmem_list_frame_data(frame);
+        if (store->table == ct)
+            return store;
+    }
+    return NULL;
+}
+
+void
+conversation_table_store_add(register_ct_t *ct)
+{
+    ct_store_t *store;
+    GString *error_string;
+
+    if (ct == NULL || ct_store_lookup(ct) != NULL)
+        return;
+
+    store = wmem_new0(wmem_epan_scope(), ct_store_t);
+    store->table = ct;
+    store->complete = !ct_store_file_open;
+
+    error_string = register_tap_listener(proto_get_protocol_filter_name(ct->proto_id), store, NULL,
+            CT_STORE_TAP_FLAGS, NULL, ct_store_packet, NULL, NULL);
+    if (error_string) {
+        /* The table is simply filled by retaps. */
+        g_string_free(error_string, TRUE);
+        wmem_free(wmem_epan_scope(), store);
+        return;
+    }
+
+    if (ct_stores == NULL)
+        ct_stores = wmem_list_new(wmem_epan_scope());
+    wmem_list_append(ct_stores, store);
+}
+
+void
+conversation_table_store_init(void)
+{
+    wmem_list_frame_t *frame;
+
+    ct_store_file_open = true;
+    if (ct_stores == NULL)
+        return;
+
+    for (frame = wmem_list_head(ct_stores); frame; frame = wmem_list_frame_next(frame)) {
+        ct_store_t *store = (ct_store_t *)wmem_list_frame_data(frame);
+        store->complete = true;
+    }
+}
+
+void
+conversation_table_store_cleanup(void)
+{
+    wmem_list_frame_t *frame;
+
+    ct_store_file_open = false;
+    if (ct_stores == NULL)
+        return;
+
+    for (frame = wmem_list_head(ct_stores); frame; frame = wmem_list_frame_next(frame)) {
+        ct_store_t *store = (ct_store_t *)wmem_list_frame_data(frame);
+        reset_conversation_table_data(&store->conv_hash);
+        reset_endpoint_table_data(&store->endpoint_hash);
+    }
+}
+
+static ct_store_t *
+ct_store_lookup_complete(register_ct_t *ct, unsigned flags)
+{
+    ct_store_t *store = ct_store_lookup(ct);
+
+    if (store == NULL || !store->complete || !ct_store_file_open)
+        return NULL;
+    if ((flags & CT_STORE_TABLE_FLAGS) != (CT_STORE_TAP_FLAGS & CT_STORE_TABLE_FLAGS))
+        return NULL;
+    return store;
+}
+
+bool
+conversation_table_store_get_conversations(register_ct_t *ct, unsigned flags, conv_hash_t *ch)
+{
+    ct_store_t *store = ct_store_lookup_complete(ct, flags);
+    const conv_hash_t *src;
+
+    if (store == NULL)
+        return false;
+
+    reset_conversation_table_data(ch);
+    src = &store->conv_hash;
+    ch->flags = src->flags;
+    if (src->conv_array == NULL)
+        return true;
+
+    ch->conv_array = g_array_sized_new(false, false, sizeof(conv_item_t), MAX(src->conv_array->len, 10000));
+    ch->hashtable = g_hash_table_new_full(conversation_hash,
+                                          conversation_equal, /* key_equal_func */
+                                          g_free,             /* key_destroy_func */
+                                          NULL);              /* value_destroy_func */
+
+    for (unsigned i = 0; i < src->conv_array->len; i++) {
+        conv_item_t conv_item = g_array_index(src->conv_array, conv_item_t, i);
+        conv_item_t *new_item;
+        conv_key_t *new_key;
+
+        copy_address(&conv_item.src_address, &g_array_index(src->conv_array, conv_item_t, i).src_address);
+        copy_address(&conv_item.dst_address, &g_array_index(src->conv_array, conv_item_t, i).dst_address);
+        g_array_append_val(ch->conv_array, conv_item);
+        new_item = &g_array_index(ch->conv_array, conv_item_t, i);
+
+        new_key = g_new(conv_key_t, 1);
+        set_address(&new_key->addr1, new_item->src_address.type, new_item->src_address.len, new_item->src_address.data);
+        set_address(&new_key->addr2, new_item->dst_address.type, new_item->dst_address.len, new_item->dst_address.data);
+        new_key->port1 = new_item->src_port;
+        new_key->port2 = new_item->dst_port;
+        new_key->conv_id = new_item->conv_id;
+        g_hash_table_insert(ch->hashtable, new_key, GUINT_TO_POINTER(i));
+    }
+    return true;
+}
+
+bool
+conversation_table_store_get_endpoints(register_ct_t *ct, unsigned flags, conv_hash_t *ch)
+{
+    ct_store_t *store = ct_store_lookup_complete(ct, flags);
+    const conv_hash_t *src;
+
+    if (store == NULL)
+        return false;
+
+    reset_endpoint_table_data(ch);
+    src = &store->endpoint_hash;
+    ch->flags = src->flags;
+    if (src->conv_array == NULL)
+        return true;
+
+    ch->conv_array = g_array_sized_new(false, false, sizeof(endpoint_item_t), MAX(src->conv_array->len, 10000));
+    ch->hashtable = g_hash_table_new_full(endpoint_hash,
+                                          endpoint_match, /* key_equal_func */
+                                          g_free,     /* key_destroy_func */
+                                          NULL);      /* value_destroy_func */
+
+    for (unsigned i = 0; i < src->conv_array->len; i++) {
+        endpoint_item_t endpoint_item = g_array_index(src->conv_array, endpoint_item_t, i);
+        endpoint_item_t *new_item;
+        endpoint_key_t *new_key;
+
+        copy_address(&endpoint_item.myaddress, &g_array_index(src->conv_array, endpoint_item_t, i).myaddress);
+        endpoint_item.modified = true;
+        g_array_append_val(ch->conv_array, endpoint_item);
+        new_item = &g_array_index(ch->conv_array, endpoint_item_t, i);
+
+        new_key = g_new(endpoint_key_t, 1);
+        set_address(&new_key->myaddress, new_item->myaddress.type, new_item->myaddress.len, new_item->myaddress.data);
+        new_key->port = new_item->port;
+        g_hash_table_insert(ch->hashtable, new_key, GUINT_TO_POINTER(i));
+    }
+    return true;
+}
+
 /*
  * Editor modelines
  *
@@ -254,6 +254,47 @@ WS_DLL_PUBLIC void conversation_table_iterate_tables(wmem_foreach_func func, voi
  */
 WS_DLL_PUBLIC unsigned conversation_table_get_num(void);
 
+/*
+ * The conversation table store accumulates the conversation and endpoint
+ * tables of selected protocols while a capture file is read, from the
+ * first dissection of each frame, including the frames of a live capture
+ * as they arrive. A table without a filter can then be copied from the
+ * store instead of retapping the whole file.
+ */
+
+/** Accumulate a conversation table and its endpoint table in the store,
+ * from the next capture file on if one is already open.
+ *
+ * @param ct the registered table; nothing is done if it is NULL or
+ * already stored
+ */
+WS_DLL_PUBLIC void conversation_table_store_add(register_ct_t *ct);
+
+/** Copy a conversation table from the store.
+ *
+ * @param ct the registered table
+ * @param flags the tap flags of the table to fill
+ * @param ch the table to fill, which is reset first
+ * @return true if the table was copied, false if the store has no complete
+ * table of the file for these flags and the table must be filled by a retap
+ */
+WS_DLL_PUBLIC bool conversation_table_store_get_conversations(register_ct_t *ct, unsigned flags, conv_hash_t *ch);
+
+/** Copy an endpoint table from the store.
+ *
+ * @param ct the registered table
+ * @param flags the tap flags of the table to fill
+ * @param ch the table to fill, which is reset first
+ * @return true if the table was copied, false if the store has no complete
+ * table of the file for these flags and the table must be filled by a retap
+ */
+WS_DLL_PUBLIC bool conversation_table_store_get_endpoints(register_ct_t *ct, unsigned flags, conv_hash_t *ch);
+
+/* Start storing the tables of a new file (called from init_dissection) */
+void conversation_table_store_init(void);
+/* Free the stored tables (called from cleanup_dissection) */
+void conversation_table_store_cleanup(void);
+
 /** Remove all entries from the conversation table.
  *
  * @param ch the table to reset
@@ -13,11 +13,14 @@
 /* Keep this first after config.h so that WS_LOG_DOMAIN is set correctly. */
 #include "dot11decrypt_debug.h"
 
+#include <errno.h>
 #include <stdint.h>
 #include <glib.h>
 
 #include <wsutil/wsgcrypt.h>
 #include <wsutil/crc32.h>
+#include <wsutil/file_util.h>
+#include <wsutil/filesystem.h>
 #include <wsutil/pint.h>
 
 #include <epan/proto.h> /* for DISSECTOR_ASSERT. */
@@ -149,6 +152,47 @@ static int Dot11DecryptRsnaPwd2Psk(
     unsigned char *output)
     ;
 
+/**
+ * Gets the PSK of a password from the cache of derived PSKs, deriving
+ * it (and adding it to the cache) if it isn't there.
+ * @param ctx [IN] pointer to the current context
+ * @param userPwd [IN] pointer to the struct containing a password
+ * and SSID
+ * @param output [OUT] calculated PSK (to use as PMK in WPA)
+ */
+static void Dot11DecryptGetPwdPsk(
+    PDOT11DECRYPT_CONTEXT ctx,
+    const struct DOT11DECRYPT_KEY_ITEMDATA_PWD *userPwd,
+    unsigned char *output)
+    ;
+
+/**
+ * Derives in parallel the PSKs of the passwords among the given keys
+ * that aren't in the cache of derived PSKs yet, and adds them to it.
+ * @param ctx [IN] pointer to the current context
+ * @param keys [IN] keys, of which only passwords are considered
+ * @param keys_nr [IN] number of keys
+ * @param wildcard_ssid [IN] if not NULL, only passwords without an SSID
+ * are considered, and this SSID is used for them
+ * @param wildcard_ssid_len [IN] length of wildcard_ssid
+ */
+static void Dot11DecryptDerivePwdPsks(
+    PDOT11DECRYPT_CONTEXT ctx,
+    const DOT11DECRYPT_KEY_ITEM *keys,
+    size_t keys_nr,
+    const char *wildcard_ssid,
+    size_t wildcard_ssid_len)
+    ;
+
+/**
+ * Derives in parallel the PSKs of all the "wildcard" passwords for the
+ * last seen SSID that aren't in the cache of derived PSKs yet.
+ * @param ctx [IN] pointer to the current context
+ */
+static void Dot11DecryptDeriveWildcardPsks(
+    PDOT11DECRYPT_CONTEXT ctx)
+    ;
+
 static int Dot11DecryptRsnaMng(
     unsigned char *decrypt_data,
     unsigned mac_header_len,
@@ -1075,16 +1119,21 @@ int Dot11DecryptSetKeys(
     /* check and insert keys */
     for (i=0, success=0; i<(int)keys_nr; i++) {
         if (Dot11DecryptValidateKey(keys+i)==true) {
-            if (keys[i].KeyType==DOT11DECRYPT_KEY_TYPE_WPA_PWD) {
-                Dot11DecryptRsnaPwd2Psk(&keys[i].UserPwd, keys[i].KeyData.Wpa.Psk);
-                keys[i].KeyData.Wpa.PskLen = DOT11DECRYPT_WPA_PWD_PSK_LEN;
-            }
             memcpy(&ctx->keys[success], &keys[i], sizeof(keys[i]));
             success++;
         }
     }
-
     ctx->keys_nr=success;
+
+    /* derive the PSKs of the passwords that aren't cached, all at once */
+    Dot11DecryptDerivePwdPsks(ctx, ctx->keys, ctx->keys_nr, NULL, 0);
+    for (i=0; i<success; i++) {
+        if (ctx->keys[i].KeyType==DOT11DECRYPT_KEY_TYPE_WPA_PWD) {
+            Dot11DecryptGetPwdPsk(ctx, &ctx->keys[i].UserPwd, ctx->keys[i].KeyData.Wpa.Psk);
+            ctx->keys[i].KeyData.Wpa.PskLen = DOT11DECRYPT_WPA_PWD_PSK_LEN;
+        }
+    }
+
     return success;
 }
 
@@ -1148,9 +1197,15 @@ int Dot11DecryptSetLastSSID(
 static unsigned
 Dot11DecryptSaHash(const void *key)
 {
-    GBytes *bytes = g_bytes_new_static(key, sizeof(DOT11DECRYPT_SEC_ASSOCIATION_ID));
-    unsigned hash = g_bytes_hash(bytes);
-    g_bytes_unref(bytes);
+    /* Hash the BSSID and STA addresses directly (FNV-1a) rather than
+     * allocating a GBytes for every lookup. */
+    const unsigned char *p = (const unsigned char *)key;
+    unsigned hash = 2166136261U;
+
+    for (size_t i = 0; i < sizeof(DOT11DECRYPT_SEC_ASSOCIATION_ID); i++) {
+        hash ^= p[i];
+        hash *= 16777619U;
+    }
     return hash;
 }
 
@@ -1192,6 +1247,12 @@ int Dot11DecryptDestroyContext(
 
     Dot11DecryptCleanKeys(ctx);
     Dot11DecryptCleanSecAssoc(ctx);
+    if (ctx->psk_cache != NULL) {
+        g_hash_table_destroy(ctx->psk_cache);
+        ctx->psk_cache = NULL;
+    }
+    g_free(ctx->psk_cache_path);
+    ctx->psk_cache_path = NULL;
 
     ws_debug("Context destroyed!");
     return DOT11DECRYPT_RET_SUCCESS;
@@ -1668,6 +1729,8 @@ Dot11DecryptRsna4WHandshake(
         uint8_t ptk[DOT11DECRYPT_WPA_PTK_MAX_LEN];
         size_t ptk_len = 0;
 
+        Dot11DecryptDeriveWildcardPsks(ctx);
+
         /* now you can derive the PTK */
         for (key_index=0; key_index<(int)ctx->keys_nr || useCache; key_index++) {
             /* use the cached one, or try all keys */
@@ -1693,7 +1756,7 @@ Dot11DecryptRsna4WHandshake(
                 memcpy(&pkt_key, tmp_key, sizeof(pkt_key));
                 memcpy(&pkt_key.UserPwd.Ssid, ctx->pkt_ssid, ctx->pkt_ssid_len);
                 pkt_key.UserPwd.SsidLen = ctx->pkt_ssid_len;
-                Dot11DecryptRsnaPwd2Psk(&pkt_key.UserPwd, pkt_key.KeyData.Wpa.Psk);
+                Dot11DecryptGetPwdPsk(ctx, &pkt_key.UserPwd, pkt_key.KeyData.Wpa.Psk);
                 tmp_pkt_key = &pkt_key;
             } else {
                 tmp_pkt_key = tmp_key;
@@ -1877,6 +1940,8 @@ Dot11DecryptScanFtAssocForKeys(
     uint8_t ptk[DOT11DECRYPT_WPA_PTK_MAX_LEN];
     size_t ptk_len;
 
+    Dot11DecryptDeriveWildcardPsks(ctx);
+
     /* now you can derive the PTK */
     for (key_index = 0; key_index < ctx->keys_nr || useCache; key_index++) {
         /* use the cached one, or try all keys */
@@ -1902,7 +1967,7 @@ Dot11DecryptScanFtAssocForKeys(
             memcpy(&pkt_key, tmp_key, sizeof(pkt_key));
             memcpy(&pkt_key.UserPwd.Ssid, ctx->pkt_ssid, ctx->pkt_ssid_len);
             pkt_key.UserPwd.SsidLen = ctx->pkt_ssid_len;
-            Dot11DecryptRsnaPwd2Psk(&pkt_key.UserPwd, pkt_key.KeyData.Wpa.Psk);
+            Dot11DecryptGetPwdPsk(ctx, &pkt_key.UserPwd, pkt_key.KeyData.Wpa.Psk);
             tmp_pkt_key = &pkt_key;
         } else {
             tmp_pkt_key = tmp_key;
@@ -2729,6 +2794,351 @@ Dot11DecryptRsnaPwd2Psk(
     return 0;
 }
 
+/*
+ * Cache of PSKs derived from passwords.
+ *
+ * Deriving a PSK takes 8192 HMAC-SHA1 operations, and for "wildcard"
+ * passwords it has to be done for every SSID with a handshake. Derived PSKs
+ * are kept in a hash table keyed by the SSID and an HMAC of the passphrase,
+ * which survives new key sets. If a cache file is set (normally in the
+ * profile), they are loaded from and saved to it, so that each PSK is only
+ * derived once. PSKs that have to be derived are derived in parallel.
+ *
+ * The HMAC is keyed with a random salt that is saved in the file, so that
+ * passphrases can't be looked up in precomputed tables. The file holds
+ * PSKs, so it is only readable by the user.
+ */
+
+typedef struct {
+    uint8_t ssid_len;
+    char ssid[DOT11DECRYPT_WPA_SSID_MAX_LEN];
+    uint8_t pwd_hmac[HASH_SHA2_256_LENGTH];
+} DOT11DECRYPT_PSK_ID;
+
+typedef struct {
+    DOT11DECRYPT_PSK_ID id;
+    struct DOT11DECRYPT_KEY_ITEMDATA_PWD pwd;
+    unsigned char psk[DOT11DECRYPT_WPA_PWD_PSK_LEN];
+} DOT11DECRYPT_PSK_JOB;
+
+typedef struct {
+    DOT11DECRYPT_PSK_JOB *jobs;
+    int jobs_nr;
+    int next;
+} DOT11DECRYPT_PSK_WORK;
+
+/* The salt must be set, see Dot11DecryptGetPskCache() */
+static void
+Dot11DecryptGetPskId(
+    PDOT11DECRYPT_CONTEXT ctx,
+    const struct DOT11DECRYPT_KEY_ITEMDATA_PWD *userPwd,
+    DOT11DECRYPT_PSK_ID *id)
+{
+    /* Zero the padding too, as IDs are hashed and compared as bytes */
+    memset(id, 0, sizeof(*id));
+    id->ssid_len = (uint8_t)userPwd->SsidLen;
+    memcpy(id->ssid, userPwd->Ssid, userPwd->SsidLen);
+    ws_hmac_buffer(GCRY_MD_SHA256, id->pwd_hmac, userPwd->Passphrase, userPwd->PassphraseLen,
+                   ctx->psk_cache_salt, DOT11DECRYPT_PSK_CACHE_SALT_LEN);
+}
+
+static unsigned
+Dot11DecryptPskIdHash(const void *key)
+{
+    const DOT11DECRYPT_PSK_ID *id = (const DOT11DECRYPT_PSK_ID *)key;
+    unsigned hash = pntohu32(id->pwd_hmac);
+
+    for (unsigned i = 0; i < id->ssid_len; i++) {
+        hash = hash * 31 + (uint8_t)id->ssid[i];
+    }
+    return hash;
+}
+
+static gboolean
+Dot11DecryptIsPskIdEqual(const void *key1, const void *key2)
+{
+    return memcmp(key1, key2, sizeof(DOT11DECRYPT_PSK_ID)) == 0;
+}
+
+/*
+ * The first line of the cache file after the comments is "salt" and the
+ * salt, and each following line is the passphrase HMAC, the PSK and the
+ * SSID (which can be empty), in hex. Lines before the salt (from files
+ * without one) are ignored, and such files are replaced when PSKs are
+ * saved.
+ */
+static void
+Dot11DecryptLoadPskCache(
+    PDOT11DECRYPT_CONTEXT ctx)
+{
+    FILE *fp;
+    char line[256];
+    GByteArray *pwd_hmac, *psk, *ssid;
+    unsigned loaded = 0;
+
+    fp = ws_fopen(ctx->psk_cache_path, "r");
+    if (fp == NULL) {
+        return;
+    }
+
+    pwd_hmac = g_byte_array_new();
+    psk = g_byte_array_new();
+    ssid = g_byte_array_new();
+    while (fgets(line, sizeof line, fp) != NULL) {
+        char **fields;
+
+        if (line[0] == '#') {
+            continue;
+        }
+        /* Don't strip spaces; the SSID field is empty for an empty SSID */
+        line[strcspn(line, "\r\n")] = '\0';
+        fields = g_strsplit(line, " ", 3);
+        if (!ctx->psk_cache_salt_saved) {
+            if (g_strv_length(fields) == 2 && strcmp(fields[0], "salt") == 0 &&
+                hex_str_to_bytes(fields[1], psk, false) && psk->len == DOT11DECRYPT_PSK_CACHE_SALT_LEN)
+            {
+                memcpy(ctx->psk_cache_salt, psk->data, DOT11DECRYPT_PSK_CACHE_SALT_LEN);
+                ctx->psk_cache_salt_saved = true;
+            }
+        } else if (g_strv_length(fields) == 3 &&
+            hex_str_to_bytes(fields[0], pwd_hmac, false) && pwd_hmac->len == HASH_SHA2_256_LENGTH &&
+            hex_str_to_bytes(fields[1], psk, false) && psk->len == DOT11DECRYPT_WPA_PWD_PSK_LEN &&
+            hex_str_to_bytes(fields[2], ssid, false) && ssid->len <= DOT11DECRYPT_WPA_SSID_MAX_LEN)
+        {
+            DOT11DECRYPT_PSK_ID *id = g_new0(DOT11DECRYPT_PSK_ID, 1);
+
+            id->ssid_len = (uint8_t)ssid->len;
+            memcpy(id->ssid, ssid->data, ssid->len);
+            memcpy(id->pwd_hmac, pwd_hmac->data, HASH_SHA2_256_LENGTH);
+            g_hash_table_replace(ctx->psk_cache, id, g_memdup2(psk->data, psk->len));
+            loaded++;
+        }
+        g_strfreev(fields);
+    }
+    g_byte_array_free(pwd_hmac, true);
+    g_byte_array_free(psk, true);
+    g_byte_array_free(ssid, true);
+    fclose(fp);
+
+    ws_debug("Loaded %u derived PSKs from %s", loaded, ctx->psk_cache_path);
+}
+
+/* Replace the cache file with one that only has the salt */
+static FILE *
+Dot11DecryptCreatePskCacheFile(
+    PDOT11DECRYPT_CONTEXT ctx)
+{
+    FILE *fp;
+    int fd;
+
+    /* Remove the file first, so that it is created with our mode */
+    ws_unlink(ctx->psk_cache_path);
+    fd = ws_open(ctx->psk_cache_path, O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, 0600);
+    if (fd == -1) {
+        return NULL;
+    }
+    fp = ws_fdopen(fd, "w");
+    if (fp == NULL) {
+        ws_close(fd);
+        return NULL;
+    }
+
+    fputs("# PSKs derived from WPA passwords: passphrase HMAC-SHA256, PSK, SSID.\n"
+          "# This file is generated automatically and may be deleted.\n"
+          "salt ", fp);
+    for (unsigned j = 0; j < DOT11DECRYPT_PSK_CACHE_SALT_LEN; j++) {
+        fprintf(fp, "%02x", ctx->psk_cache_salt[j]);
+    }
+    fputc('\n', fp);
+    ctx->psk_cache_salt_saved = true;
+    return fp;
+}
+
+static void
+Dot11DecryptSavePsks(
+    PDOT11DECRYPT_CONTEXT ctx,
+    const DOT11DECRYPT_PSK_JOB *jobs,
+    int jobs_nr)
+{
+    FILE *fp;
+
+    if (ctx->psk_cache_path == NULL) {
+        return;
+    }
+    if (ctx->psk_cache_salt_saved && file_exists(ctx->psk_cache_path)) {
+        fp = ws_fopen(ctx->psk_cache_path, "a");
+    } else {
+        fp = Dot11DecryptCreatePskCacheFile(ctx);
+    }
+    if (fp == NULL) {
+        ws_debug("Can't open %s: %s", ctx->psk_cache_path, g_strerror(errno));
+        return;
+    }
+    for (int i = 0; i < jobs_nr; i++) {
+        for (unsigned j = 0; j < HASH_SHA2_256_LENGTH; j++) {
+            fprintf(fp, "%02x", jobs[i].id.pwd_hmac[j]);
+        }
+        fputc(' ', fp);
+        for (unsigned j = 0; j < DOT11DECRYPT_WPA_PWD_PSK_LEN; j++) {
+            fprintf(fp, "%02x", jobs[i].psk[j]);
+        }
+        fputc(' ', fp);
+        for (unsigned j = 0; j < jobs[i].id.ssid_len; j++) {
+            fprintf(fp, "%02x", (uint8_t)jobs[i].id.ssid[j]);
+        }
+        fputc('\n', fp);
+    }
+    fclose(fp);
+}
+
+/* Also sets the salt of the passphrase HMACs */
+static GHashTable *
+Dot11DecryptGetPskCache(
+    PDOT11DECRYPT_CONTEXT ctx)
+{
+    if (ctx->psk_cache == NULL) {
+        ctx->psk_cache = g_hash_table_new_full(Dot11DecryptPskIdHash, Dot11DecryptIsPskIdEqual,
+                                               g_free, g_free);
+        ctx->psk_cache_salt_saved = false;
+        if (ctx->psk_cache_path != NULL) {
+            Dot11DecryptLoadPskCache(ctx);
+        }
+        if (!ctx->psk_cache_salt_saved) {
+            gcry_create_nonce(ctx->psk_cache_salt, DOT11DECRYPT_PSK_CACHE_SALT_LEN);
+        }
+    }
+    return ctx->psk_cache;
+}
+
+static void *
+Dot11DecryptPskWorker(
+    void *data)
+{
+    DOT11DECRYPT_PSK_WORK *work = (DOT11DECRYPT_PSK_WORK *)data;
+    int i;
+
+    while ((i = g_atomic_int_add(&work->next, 1)) < work->jobs_nr) {
+        Dot11DecryptRsnaPwd2Psk(&work->jobs[i].pwd, work->jobs[i].psk);
+    }
+    return NULL;
+}
+
+static void
+Dot11DecryptDerivePwdPsks(
+    PDOT11DECRYPT_CONTEXT ctx,
+    const DOT11DECRYPT_KEY_ITEM *keys,
+    size_t keys_nr,
+    const char *wildcard_ssid,
+    size_t wildcard_ssid_len)
+{
+    GHashTable *cache = Dot11DecryptGetPskCache(ctx);
+    DOT11DECRYPT_PSK_WORK work = { 0 };
+    GThread **threads;
+    int threads_nr;
+
+    work.jobs = g_new(DOT11DECRYPT_PSK_JOB, keys_nr);
+    for (size_t i = 0; i < keys_nr; i++) {
+        DOT11DECRYPT_PSK_JOB *job = &work.jobs[work.jobs_nr];
+        bool dup = false;
+
+        if (keys[i].KeyType != DOT11DECRYPT_KEY_TYPE_WPA_PWD) {
+            continue;
+        }
+        job->pwd = keys[i].UserPwd;
+        if (wildcard_ssid != NULL) {
+            if (keys[i].UserPwd.SsidLen != 0) {
+                continue;
+            }
+            memcpy(job->pwd.Ssid, wildcard_ssid, wildcard_ssid_len);
+            job->pwd.SsidLen = wildcard_ssid_len;
+        }
+        Dot11DecryptGetPskId(ctx, &job->pwd, &job->id);
+        if (g_hash_table_contains(cache, &job->id)) {
+            continue;
+        }
+        for (int j = 0; j < work.jobs_nr && !dup; j++) {
+            dup = Dot11DecryptIsPskIdEqual(&work.jobs[j].id, &job->id);
+        }
+        if (!dup) {
+            work.jobs_nr++;
+        }
+    }
+
+    if (work.jobs_nr > 0) {
+        ws_debug("Deriving %d PSKs", work.jobs_nr);
+
+        /* The calling thread does its share of the work */
+        threads_nr = MIN((int)g_get_num_processors(), work.jobs_nr) - 1;
+        threads = g_new(GThread *, threads_nr + 1);
+        for (int t = 0; t < threads_nr; t++) {
+            threads[t] = g_thread_new("dot11decrypt-psk", Dot11DecryptPskWorker, &work);
+        }
+        Dot11DecryptPskWorker(&work);
+        for (int t = 0; t < threads_nr; t++) {
+            g_thread_join(threads[t]);
+        }
+        g_free(threads);
+
+        for (int j = 0; j < work.jobs_nr; j++) {
+            g_hash_table_replace(cache, g_memdup2(&work.jobs[j].id, sizeof(DOT11DECRYPT_PSK_ID)),
+                                 g_memdup2(work.jobs[j].psk, DOT11DECRYPT_WPA_PWD_PSK_LEN));
+        }
+        Dot11DecryptSavePsks(ctx, work.jobs, work.jobs_nr);
+    }
+    g_free(work.jobs);
+}
+
+static void
+Dot11DecryptGetPwdPsk(
+    PDOT11DECRYPT_CONTEXT ctx,
+    const struct DOT11DECRYPT_KEY_ITEMDATA_PWD *userPwd,
+    unsigned char *output)
+{
+    DOT11DECRYPT_PSK_ID id;
+    const unsigned char *psk;
+
+    GHashTable *cache = Dot11DecryptGetPskCache(ctx);
+
+    Dot11DecryptGetPskId(ctx, userPwd, &id);
+    psk = (const unsigned char *)g_hash_table_lookup(cache, &id);
+    if (psk == NULL) {
+        DOT11DECRYPT_KEY_ITEM key = { 0 };
+
+        key.KeyType = DOT11DECRYPT_KEY_TYPE_WPA_PWD;
+        key.UserPwd = *userPwd;
+        Dot11DecryptDerivePwdPsks(ctx, &key, 1, NULL, 0);
+        psk = (const unsigned char *)g_hash_table_lookup(ctx->psk_cache, &id);
+    }
+    memcpy(output, psk, DOT11DECRYPT_WPA_PWD_PSK_LEN);
+}
+
+static void
+Dot11DecryptDeriveWildcardPsks(
+    PDOT11DECRYPT_CONTEXT ctx)
+{
+    if (ctx->pkt_ssid_len > 0 && ctx->pkt_ssid_len <= DOT11DECRYPT_WPA_SSID_MAX_LEN) {
+        Dot11DecryptDerivePwdPsks(ctx, ctx->keys, ctx->keys_nr, ctx->pkt_ssid, ctx->pkt_ssid_len);
+    }
+}
+
+void
+Dot11DecryptSetPskCacheFile(
+    PDOT11DECRYPT_CONTEXT ctx,
+    const char *path)
+{
+    if (ctx == NULL || g_strcmp0(ctx->psk_cache_path, path) == 0) {
+        return;
+    }
+
+    /* Start over with the PSKs from the new file */
+    if (ctx->psk_cache != NULL) {
+        g_hash_table_destroy(ctx->psk_cache);
+        ctx->psk_cache = NULL;
+    }
+    g_free(ctx->psk_cache_path);
+    ctx->psk_cache_path = g_strdup(path);
+}
+
 /*
  * Returns the decryption_key_t struct given a string describing the key.
  * Returns NULL if the input_string cannot be parsed.
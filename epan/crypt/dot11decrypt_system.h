@@ -121,12 +121,18 @@ typedef struct _DOT11DECRYPT_SEC_ASSOCIATION {
 
 } DOT11DECRYPT_SEC_ASSOCIATION, *PDOT11DECRYPT_SEC_ASSOCIATION;
 
+#define DOT11DECRYPT_PSK_CACHE_SALT_LEN 32
+
 typedef struct _DOT11DECRYPT_CONTEXT {
 	GHashTable *sa_hash;
 	DOT11DECRYPT_KEY_ITEM keys[DOT11DECRYPT_MAX_KEYS_NR];
 	size_t keys_nr;
 	char pkt_ssid[DOT11DECRYPT_WPA_SSID_MAX_LEN];
 	size_t pkt_ssid_len;
+	GHashTable *psk_cache;	/* PSKs derived from passwords, by SSID and passphrase HMAC */
+	char *psk_cache_path;	/* File the derived PSKs are saved to, or NULL */
+	unsigned char psk_cache_salt[DOT11DECRYPT_PSK_CACHE_SALT_LEN];	/* HMAC key of the passphrases */
+	bool psk_cache_salt_saved;	/* The file has the salt above */
 } DOT11DECRYPT_CONTEXT, *PDOT11DECRYPT_CONTEXT;
 
 typedef enum _DOT11DECRYPT_HS_MSG_TYPE {
@@ -404,6 +410,25 @@ extern int Dot11DecryptSetKeys(
 	const size_t keys_nr)
 	;
 
+/**
+ * Sets the file in which PSKs derived from passwords (passphrase and SSID)
+ * are cached, so that the expensive derivation is done only once for each
+ * password and SSID. The file is read the next time a PSK is needed, and
+ * new PSKs are appended to it; it is created readable only by the user.
+ * Derived PSKs are also cached in memory (until the file changes) whether
+ * or not a file is set.
+ * @param ctx [IN|OUT] pointer to the current context
+ * @param path [IN] path of the cache file, or NULL for none
+ * @note
+ * This function is not thread-safe when used in parallel with context
+ * management functions and the packet process function on the same
+ * context.
+ */
+extern void Dot11DecryptSetPskCacheFile(
+	PDOT11DECRYPT_CONTEXT ctx,
+	const char *path)
+	;
+
 /**
  * Sets the "last seen" SSID.  This allows us to pick up previous
  * SSIDs and use them when "wildcard" passphrases are specified
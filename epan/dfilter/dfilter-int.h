@@ -48,6 +48,9 @@ struct epan_dfilter {
 	GSList		*function_stack;
 	GSList		*set_stack;
 	ftenum_t	 ret_type;
+	/* Field tests that a frame must pass (dfilter_index_term_t). */
+	GPtrArray	*index_terms;
+	bool		 index_terms_exact;
 };
 
 typedef struct {
@@ -14,6 +14,8 @@
 
 #include "dfilter-int.h"
 #include "syntax-tree.h"
+#include "sttype-field.h"
+#include "sttype-op.h"
 #include "gencode.h"
 #include "semcheck.h"
 #include "dfvm.h"
@@ -198,6 +200,9 @@ dfilter_free(dfilter_t *df)
 	if (df->warnings)
 		g_slist_free_full(df->warnings, g_free);
 
+	if (df->index_terms)
+		g_ptr_array_free(df->index_terms, true);
+
 	g_free(df->registers);
 	g_free(df->expanded_text);
 	g_free(df->syntax_tree_str);
@@ -468,11 +473,93 @@ dfwork_parse(const char *expanded_text, dfsyntax_t *dfs)
 	return dfs->error == NULL;
 }
 
+static void
+free_index_term(void *data)
+{
+	dfilter_index_term_t *term = data;
+
+	if (term->value)
+		fvalue_free(term->value);
+	g_free(term);
+}
+
+static header_field_info *
+index_term_field(stnode_t *node)
+{
+	header_field_info *hfinfo;
+
+	if (stnode_type_id(node) != STTYPE_FIELD)
+		return NULL;
+	if (sttype_field_drange(node) || sttype_field_raw(node) ||
+			sttype_field_value_string(node))
+		return NULL;
+
+	/* Index terms refer to the first field with the name. */
+	hfinfo = sttype_field_hfinfo(node);
+	while (hfinfo->same_name_prev_id != -1)
+		hfinfo = proto_registrar_get_nth(hfinfo->same_name_prev_id);
+	return hfinfo;
+}
+
+/* Collect the field tests that must all be true for the node to be
+ * true. Returns true if the node is nothing but those tests. */
+static bool
+collect_index_terms(stnode_t *node, GPtrArray *terms)
+{
+	stnode_op_t op;
+	stnode_t *left, *right;
+	header_field_info *hfinfo;
+	dfilter_index_term_t *term;
+
+	if (stnode_type_id(node) == STTYPE_FIELD) {
+		/* Field existence */
+		hfinfo = index_term_field(node);
+		if (hfinfo == NULL)
+			return false;
+		term = g_new(dfilter_index_term_t, 1);
+		term->hfinfo = hfinfo;
+		term->value = NULL;
+		g_ptr_array_add(terms, term);
+		return true;
+	}
+
+	if (stnode_type_id(node) != STTYPE_TEST)
+		return false;
+
+	sttype_oper_get(node, &op, &left, &right);
+	if (op == STNODE_OP_AND) {
+		bool left_exact = collect_index_terms(left, terms);
+		bool right_exact = collect_index_terms(right, terms);
+		return left_exact && right_exact;
+	}
+	if (op != STNODE_OP_ANY_EQ || sttype_test_get_match(node) == STNODE_MATCH_ALL)
+		return false;
+
+	if (stnode_type_id(right) != STTYPE_FVALUE) {
+		stnode_t *tmp = left;
+		left = right;
+		right = tmp;
+	}
+	if (stnode_type_id(right) != STTYPE_FVALUE)
+		return false;
+	hfinfo = index_term_field(left);
+	if (hfinfo == NULL)
+		return false;
+
+	term = g_new(dfilter_index_term_t, 1);
+	term->hfinfo = hfinfo;
+	term->value = fvalue_dup(stnode_data(right));
+	g_ptr_array_add(terms, term);
+	return true;
+}
+
 static dfilter_t *
 dfwork_build(dfwork_t *dfw)
 {
 	dfilter_t	*dfilter;
 	char		*tree_str;
+	GPtrArray	*index_terms;
+	bool		index_terms_exact;
 
 	log_syntax_tree(LOG_LEVEL_NOISY, dfw->st_root, "Syntax tree before semantic check", NULL);
 
@@ -488,11 +575,18 @@ dfwork_build(dfwork_t *dfw)
 		tree_str = dump_syntax_tree_str(dfw->st_root);
 	}
 
+	/* Find the field tests for the field value index. This must be done
+	 * before generating code, which takes the values out of the tree. */
+	index_terms = g_ptr_array_new_with_free_func(free_index_term);
+	index_terms_exact = collect_index_terms(dfw->st_root, index_terms);
+
 	/* Create bytecode */
 	dfw_gencode(dfw);
 
 	/* Tuck away the bytecode in the dfilter_t */
 	dfilter = dfilter_new(dfw->deprecated);
+	dfilter->index_terms = index_terms;
+	dfilter->index_terms_exact = index_terms_exact;
 	dfilter->insns = dfw->insns;
 	dfw->insns = NULL;
 	dfilter->interesting_fields = dfw_interesting_fields(dfw,
@@ -793,6 +887,13 @@ dfilter_deprecated_tokens(dfilter_t *df) {
 	return NULL;
 }
 
+const GPtrArray *
+dfilter_get_index_terms(const dfilter_t *df, bool *exact_ptr)
+{
+	*exact_ptr = df->index_terms_exact;
+	return df->index_terms;
+}
+
 GSList *
 dfilter_get_warnings(dfilter_t *df)
 {
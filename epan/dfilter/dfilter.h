@@ -180,6 +180,28 @@ WS_DLL_PUBLIC
 GPtrArray *
 dfilter_deprecated_tokens(dfilter_t *df);
 
+/* A test on a field that a frame must pass to match a filter:
+ * "<field> == <value>", or the existence of the field if value is NULL.
+ * hfinfo is the first of the fields with that name. */
+typedef struct {
+	header_field_info *hfinfo;
+	fvalue_t *value;
+} dfilter_index_term_t;
+
+/* Get the field tests (dfilter_index_term_t) joined by "and" at the
+ * top level of a filter, which can be looked up in an index of field
+ * values to find the frames that can match. *exact_ptr is set to true
+ * if the filter is nothing but those tests, so that a frame passing all
+ * of them matches the filter.
+ *
+ * @param df The dfilter
+ * @param exact_ptr Set to true if the tests are the whole filter
+ * @return The tests, possibly empty
+ */
+WS_DLL_PUBLIC
+const GPtrArray *
+dfilter_get_index_terms(const dfilter_t *df, bool *exact_ptr);
+
 WS_DLL_PUBLIC
 GSList *
 dfilter_get_warnings(dfilter_t *df);
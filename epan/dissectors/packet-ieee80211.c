@@ -73,6 +73,7 @@
 #include <epan/tfs.h>
 #include <epan/unit_strings.h>
 #include <wsutil/array.h>
+#include <wsutil/filesystem.h>
 
 #include "packet-wps.h"
 #include "packet-e212.h"
@@ -283,6 +284,9 @@ UAT_CSTRING_CB_DEF(uat_wep_key_records, string, uat_wep_key_record_t)
 
 /* Stuff for the WEP/WPA/WPA2 decoder */
 static bool enable_decryption = true;
+static bool cache_derived_keys;
+
+#define PSK_CACHE_FILE_NAME "80211_psk_cache"
 
 static void
 ieee_80211_add_tagged_parameters(tvbuff_t *tvb, int offset, packet_info *pinfo,
@@ -42410,6 +42414,15 @@ set_dot11decrypt_keys(void)
     }
   }
 
+  /* Keep the PSKs derived from passwords with the keys, in the profile */
+  if (cache_derived_keys) {
+    char *cache_path = get_persconffile_path(PSK_CACHE_FILE_NAME, true);
+    Dot11DecryptSetPskCacheFile(&dot11decrypt_ctx, cache_path);
+    g_free(cache_path);
+  } else {
+    Dot11DecryptSetPskCacheFile(&dot11decrypt_ctx, NULL);
+  }
+
   /* Now set the keys */
   Dot11DecryptSetKeys(&dot11decrypt_ctx, keys->Keys, keys->nKeys);
   g_free(keys);
@@ -61626,6 +61639,15 @@ proto_register_ieee80211(void)
     "Enable decryption", "Enable WEP and WPA/WPA2 decryption",
     &enable_decryption);
 
+  prefs_register_bool_preference(wlan_module, "cache_derived_keys",
+    "Cache keys derived from passwords",
+    "Save the keys derived from WPA passwords (\"wpa-pwd\") in the profile, in the file \""
+    PSK_CACHE_FILE_NAME "\", so that they aren't derived again every time. "
+    "Key derivation is slow, especially when passwords without an SSID are "
+    "tried on many networks. The keys give access to the networks, so only "
+    "enable this on a profile that is kept private.",
+    &cache_derived_keys);
+
   wep_uat = uat_new("WEP and WPA Decryption Keys",
             sizeof(uat_wep_key_record_t), /* record size */
             "80211_keys",                 /* filename */
@@ -1944,11 +1944,24 @@ get_ip_conversation_data(conversation_t *conv, packet_info *pinfo)
   return ipd;
 }
 
+/* Fixed-position fields of the IPv4 header that are added as is. */
+static const proto_fixed_field ip_ttl_proto_fields[] = {
+  { &hf_ip_ttl,   8, 1, ENC_BIG_ENDIAN },
+  { &hf_ip_proto, 9, 1, ENC_BIG_ENDIAN },
+};
+
+static const proto_fixed_field ip_src_fields[] = {
+  { &hf_ip_src,  IPH_SRC, 4, ENC_BIG_ENDIAN },
+  { &hf_ip_addr, IPH_SRC, 4, ENC_BIG_ENDIAN },
+};
+
 static int
 dissect_ip_v4(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree, void* data _U_)
 {
   proto_tree *ip_tree, *field_tree = NULL;
   proto_item *ti, *tf;
+  proto_item *ttl_proto_items[G_N_ELEMENTS(ip_ttl_proto_fields)];
+  proto_item *src_items[G_N_ELEMENTS(ip_src_fields)];
   uint32_t   addr;
   int        offset = 0, dst_off;
   unsigned   hlen, optlen;
@@ -2144,12 +2157,10 @@ dissect_ip_v4(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree, void*
                                         iph->ip_off, "%u", (iph->ip_off & IP_OFFSET) * 8);
 
   iph->ip_ttl = tvb_get_uint8(tvb, offset + 8);
-  ttl_item = proto_tree_add_item(ip_tree, hf_ip_ttl, tvb, offset + 8, 1, ENC_BIG_ENDIAN);
-
   iph->ip_proto = tvb_get_uint8(tvb, offset + 9);
-  if (tree) {
-    proto_tree_add_item(ip_tree, hf_ip_proto, tvb, offset + 9, 1, ENC_BIG_ENDIAN);
-  }
+  proto_tree_add_fixed_items(ip_tree, tvb, offset, ip_ttl_proto_fields,
+                             G_N_ELEMENTS(ip_ttl_proto_fields), ttl_proto_items);
+  ttl_item = ttl_proto_items[0];
 
   iph->ip_sum = tvb_get_ntohs(tvb, offset + 10);
 
@@ -2224,9 +2235,9 @@ dissect_ip_v4(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree, void*
     if (ip_summary_in_tree) {
       proto_item_append_text(ti, ", Src: %s", address_with_resolution_to_str(pinfo->pool, &iph->ip_src));
     }
-    proto_tree_add_ipv4(ip_tree, hf_ip_src, tvb, offset + 12, 4, addr);
-    item = proto_tree_add_ipv4(ip_tree, hf_ip_addr, tvb, offset + 12, 4, addr);
-    proto_item_set_hidden(item);
+    proto_tree_add_fixed_items(ip_tree, tvb, offset, ip_src_fields,
+                               G_N_ELEMENTS(ip_src_fields), src_items);
+    proto_item_set_hidden(src_items[1]);
     if (proto_field_is_referenced(ip_tree, hf_ip_src_host) || proto_field_is_referenced(ip_tree, hf_ip_host)) {
       src_host = get_hostname_wmem(pinfo->pool, addr);
       item = proto_tree_add_string(ip_tree, hf_ip_src_host, tvb, offset + 12, 4,
@@ -2261,6 +2272,12 @@ dissect_ip_v4(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree, void*
   copy_address_shallow(&pinfo->dst, &pinfo->net_dst);
   copy_address_shallow(&iph->ip_dst, &pinfo->net_dst);
 
+  /* Queue the addresses for bulk name resolution, even without a tree. */
+  if (!PINFO_FD_VISITED(pinfo)) {
+    host_name_lookup_queue_ipv4(g_htonl(src32));
+    host_name_lookup_queue_ipv4(g_htonl(dst32));
+  }
+
   /* If an IP is destined for an IP address in the Local Network Control Block
    * (e.g. 224.0.0.0/24), the packet should never be routed and the TTL would
    * be expected to be 1.  (see RFC 3171)  Flag a TTL greater than 1.
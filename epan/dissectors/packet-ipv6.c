@@ -3681,6 +3681,12 @@ dissect_ipv6(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void* data _U_
     alloc_address_wmem_ipv6(pinfo->pool, &pinfo->net_dst, ip6_dst);
     copy_address_shallow(&pinfo->dst, &pinfo->net_dst);
 
+    /* Queue the addresses for bulk name resolution, even without a tree. */
+    if (!PINFO_FD_VISITED(pinfo)) {
+        host_name_lookup_queue_ipv6(ip6_src);
+        host_name_lookup_queue_ipv6(ip6_dst);
+    }
+
     if (tree) {
         if (ipv6_summary_in_tree) {
             proto_item_append_text(ipv6_item, ", Src: %s, Dst: %s",
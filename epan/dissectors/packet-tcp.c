@@ -8331,6 +8331,15 @@ static void tcp_tap_cleanup(void *data)
     tap_queue_packet(tcp_tap, cleanup->pinfo, cleanup->tcph);
 }
 
+/* The port fields at the start of the header: tcp.srcport, tcp.dstport
+ * and the two hidden tcp.port items. */
+static const proto_fixed_field tcp_port_fields[] = {
+    { &hf_tcp_srcport, 0, 2, ENC_BIG_ENDIAN },
+    { &hf_tcp_dstport, 2, 2, ENC_BIG_ENDIAN },
+    { &hf_tcp_port,    0, 2, ENC_BIG_ENDIAN },
+    { &hf_tcp_port,    2, 2, ENC_BIG_ENDIAN },
+};
+
 static int
 dissect_tcp(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void* data _U_)
 {
@@ -8338,7 +8347,8 @@ dissect_tcp(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void* data _U_)
     uint16_t th_sum;
     uint32_t th_urp;
     proto_tree *tcp_tree = NULL, *field_tree = NULL;
-    proto_item *ti = NULL, *tf, *hidden_item;
+    proto_item *ti = NULL, *tf;
+    proto_item *port_items[G_N_ELEMENTS(tcp_port_fields)];
     proto_item *options_item, *hide_seqack_abs_item;
     proto_tree *options_tree;
     int        offset = 0;
@@ -8384,12 +8394,10 @@ dissect_tcp(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void* data _U_)
         tcp_tree = proto_item_add_subtree(ti, ett_tcp);
         p_add_proto_data(pinfo->pool, pinfo, proto_tcp, pinfo->curr_layer_num, tcp_tree);
 
-        proto_tree_add_item(tcp_tree, hf_tcp_srcport, tvb, offset, 2, ENC_BIG_ENDIAN);
-        proto_tree_add_item(tcp_tree, hf_tcp_dstport, tvb, offset + 2, 2, ENC_BIG_ENDIAN);
-        hidden_item = proto_tree_add_item(tcp_tree, hf_tcp_port, tvb, offset, 2, ENC_BIG_ENDIAN);
-        proto_item_set_hidden(hidden_item);
-        hidden_item = proto_tree_add_item(tcp_tree, hf_tcp_port, tvb, offset + 2, 2, ENC_BIG_ENDIAN);
-        proto_item_set_hidden(hidden_item);
+        proto_tree_add_fixed_items(tcp_tree, tvb, offset, tcp_port_fields,
+                                   G_N_ELEMENTS(tcp_port_fields), port_items);
+        proto_item_set_hidden(port_items[2]);
+        proto_item_set_hidden(port_items[3]);
 
         /*  If we're dissecting the headers of a TCP packet in an ICMP packet
          *  then go ahead and put the sequence numbers in the tree now (because
@@ -8571,6 +8579,7 @@ dissect_tcp(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void* data _U_)
     if (tcpd) {
         item = proto_tree_add_uint(tcp_tree, hf_tcp_stream, tvb, offset, 0, tcpd->stream);
         proto_item_set_generated(item);
+        follow_index_stream_frame(hf_tcp_stream, tcpd->stream, pinfo);
         tcpinfo.stream = tcpd->stream;
 
         if (tcp_calculate_ts) {
@@ -1140,6 +1140,7 @@ proto_register_tftp(void)
 
   /* Register the tap for the "Export Object" function */
   tftp_eo_tap = register_export_object(proto_tftp, tftp_eo_packet, NULL);
+  set_eo_entries_complete(proto_tftp);
 }
 
 void
@@ -6335,7 +6335,7 @@ ssl_common_init(ssl_master_key_map_t *mk_map,
 }
 
 void
-ssl_common_cleanup(ssl_master_key_map_t *mk_map, FILE **ssl_keylog_file,
+ssl_common_cleanup(ssl_master_key_map_t *mk_map, tls_keylog_file_t *ssl_keylog_file,
                    StringInfo *decrypted_data, StringInfo *compressed_data)
 {
     g_hash_table_destroy(mk_map->session);
@@ -6361,9 +6361,15 @@ ssl_common_cleanup(ssl_master_key_map_t *mk_map, FILE **ssl_keylog_file,
 
     /* close the previous keylog file now that the cache are cleared, this
      * allows the cache to be filled with the full keylog file contents. */
-    if (*ssl_keylog_file) {
-        fclose(*ssl_keylog_file);
-        *ssl_keylog_file = NULL;
+    if (ssl_keylog_file->fp) {
+        fclose(ssl_keylog_file->fp);
+        ssl_keylog_file->fp = NULL;
+    }
+    ssl_keylog_file->offset = 0;
+    ssl_keylog_file->size = -1;
+    if (ssl_keylog_file->pending_blocks) {
+        g_ptr_array_free(ssl_keylog_file->pending_blocks, true);
+        ssl_keylog_file->pending_blocks = NULL;
     }
 }
 /* }}} */
@@ -6788,200 +6794,322 @@ tls_save_crandom(SslDecryptSession *ssl, ssl_master_key_map_t *mk_map)
 
 /** SSL keylog file handling. {{{ */
 
-static GRegex *
-ssl_compile_keyfile_regex(void)
-{
-#define OCTET "(?:[[:xdigit:]]{2})"
-    const char *pattern =
-        "(?:"
-        /* Matches Client Hellos having this Client Random */
-        "PMS_CLIENT_RANDOM (?<client_random_pms>" OCTET "{32}) "
-        /* Matches first part of encrypted RSA pre-master secret */
-        "|RSA (?<encrypted_pmk>" OCTET "{8}) "
-        /* Pre-Master-Secret is given, it is 48 bytes for RSA,
-           but it can be of any length for DHE */
-        ")(?<pms>" OCTET "+)"
-        "|(?:"
-        /* Matches Server Hellos having a Session ID */
-        "RSA Session-ID:(?<session_id>" OCTET "+) Master-Key:"
-        /* Matches Client Hellos having this Client Random */
-        "|CLIENT_RANDOM (?<client_random>" OCTET "{32}) "
-        /* Master-Secret is given, its length is fixed */
-        ")(?<master_secret>" OCTET "{" G_STRINGIFY(SSL_MASTER_SECRET_LENGTH) "})"
-        "|(?"
-        /* TLS 1.3 Client Random to Derived Secrets mapping. */
-        ":CLIENT_EARLY_TRAFFIC_SECRET (?<client_early>" OCTET "{32})"
-        "|CLIENT_HANDSHAKE_TRAFFIC_SECRET (?<client_handshake>" OCTET "{32})"
-        "|SERVER_HANDSHAKE_TRAFFIC_SECRET (?<server_handshake>" OCTET "{32})"
-        "|CLIENT_TRAFFIC_SECRET_0 (?<client_appdata>" OCTET "{32})"
-        "|SERVER_TRAFFIC_SECRET_0 (?<server_appdata>" OCTET "{32})"
-        "|EARLY_EXPORTER_SECRET (?<early_exporter>" OCTET "{32})"
-        "|EXPORTER_SECRET (?<exporter>" OCTET "{32})"
-        /* ECH. Secret length is defined by HPKE KEM Nsecret and can vary between 32 and 64 bytes */
-        /* These labels and their notation are specified in draft-ietf-tls-ech-keylogfile-01 */
-        "|ECH_SECRET (?<ech_secret>" OCTET "{32,64})"
-        "|ECH_CONFIG (?<ech_config>" OCTET "{22,})"
-        ") (?<derived_secret>" OCTET "+)";
-#undef OCTET
-    static GRegex *regex = NULL;
-    GError *gerr = NULL;
-
-    if (!regex) {
-        regex = g_regex_new(pattern,
-                (GRegexCompileFlags)(G_REGEX_OPTIMIZE | G_REGEX_ANCHORED | G_REGEX_RAW),
-                G_REGEX_MATCH_ANCHORED, &gerr);
-        if (gerr) {
-            ssl_debug_printf("%s failed to compile regex: %s\n", G_STRFUNC,
-                             gerr->message);
-            g_error_free(gerr);
-            regex = NULL;
-        }
-    }
-
-    return regex;
-}
-
-typedef struct ssl_master_key_match_group {
-    const char *re_group_name;
-    GHashTable *master_key_ht;
-} ssl_master_key_match_group_t;
+/* The format of the file is a series of records with one of the following formats:
+ *   - "RSA xxxx yyyy"
+ *     Where xxxx are the first 8 bytes of the encrypted pre-master secret (hex-encoded)
+ *     Where yyyy is the cleartext pre-master secret (hex-encoded)
+ *     (this is the original format introduced with bug 4349)
+ *
+ *   - "RSA Session-ID:xxxx Master-Key:yyyy"
+ *     Where xxxx is the SSL session ID (hex-encoded)
+ *     Where yyyy is the cleartext master secret (hex-encoded)
+ *     (added to support openssl s_client Master-Key output)
+ *     This is somewhat is a misnomer because there's nothing RSA specific
+ *     about this.
+ *
+ *   - "PMS_CLIENT_RANDOM xxxx yyyy"
+ *     Where xxxx is the client_random from the ClientHello (hex-encoded)
+ *     Where yyyy is the cleartext pre-master secret (hex-encoded)
+ *     (This format allows SSL connections to be decrypted, if a user can
+ *     capture the PMS but could not recover the MS for a specific session
+ *     with a SSL Server.)
+ *
+ *   - "CLIENT_RANDOM xxxx yyyy"
+ *     Where xxxx is the client_random from the ClientHello (hex-encoded)
+ *     Where yyyy is the cleartext master secret (hex-encoded)
+ *     (This format allows non-RSA SSL connections to be decrypted, i.e.
+ *     ECDHE-RSA.)
+ *
+ *   - "CLIENT_EARLY_TRAFFIC_SECRET xxxx yyyy"
+ *   - "CLIENT_HANDSHAKE_TRAFFIC_SECRET xxxx yyyy"
+ *   - "SERVER_HANDSHAKE_TRAFFIC_SECRET xxxx yyyy"
+ *   - "CLIENT_TRAFFIC_SECRET_0 xxxx yyyy"
+ *   - "SERVER_TRAFFIC_SECRET_0 xxxx yyyy"
+ *   - "EARLY_EXPORTER_SECRET xxxx yyyy"
+ *   - "EXPORTER_SECRET xxxx yyyy"
+ *     Where xxxx is the client_random from the ClientHello (hex-encoded)
+ *     Where yyyy is the secret (hex-encoded) derived from the early,
+ *     handshake or master secrets. (This format is introduced with TLS 1.3
+ *     and supported by BoringSSL, OpenSSL, etc. See bug 12779.)
+ *
+ *   - "ECH_SECRET xxxx yyyy"
+ *   - "ECH_CONFIG xxxx yyyy"
+ *     Where xxxx is the client_random from the ClientHello (hex-encoded)
+ *     (These labels and their notation are specified in
+ *     draft-ietf-tls-ech-keylogfile-01.)
+ *
+ * Anything following the secret on the same line is ignored.
+ */
+typedef struct {
+    const char *name;           /* for debug output */
+    const char *label;          /* start of the line, up to the key */
+    unsigned    key_min;        /* key length, in octets */
+    unsigned    key_max;        /* key length, in octets, 0 for no limit */
+    const char *key_sep;        /* between the key and the secret */
+    unsigned    secret_len;     /* in octets, 0 for any length */
+    size_t      ht_offset;      /* of the secrets map in ssl_master_key_map_t */
+} tls_keylog_format_t;
+
+#define TLS_KEYLOG_MAP(field) offsetof(ssl_master_key_map_t, field)
+
+static const tls_keylog_format_t tls_keylog_formats[] = {
+    /* Pre-Master-Secret is given, it is 48 bytes for RSA,
+       but it can be of any length for DHE */
+    { "encrypted_pmk",      "RSA ",              8,  8, " ", 0, TLS_KEYLOG_MAP(pre_master) },
+    /* Master-Secret is given, its length is fixed */
+    { "session_id",         "RSA Session-ID:",   1,  0, " Master-Key:", SSL_MASTER_SECRET_LENGTH, TLS_KEYLOG_MAP(session) },
+    { "client_random",      "CLIENT_RANDOM ",   32, 32, " ", SSL_MASTER_SECRET_LENGTH, TLS_KEYLOG_MAP(crandom) },
+    { "client_random_pms",  "PMS_CLIENT_RANDOM ", 32, 32, " ", 0, TLS_KEYLOG_MAP(pms) },
+    /* TLS 1.3 Client Random to Derived Secrets mapping. */
+    { "client_early",       "CLIENT_EARLY_TRAFFIC_SECRET ",     32, 32, " ", 0, TLS_KEYLOG_MAP(tls13_client_early) },
+    { "client_handshake",   "CLIENT_HANDSHAKE_TRAFFIC_SECRET ", 32, 32, " ", 0, TLS_KEYLOG_MAP(tls13_client_handshake) },
+    { "server_handshake",   "SERVER_HANDSHAKE_TRAFFIC_SECRET ", 32, 32, " ", 0, TLS_KEYLOG_MAP(tls13_server_handshake) },
+    { "client_appdata",     "CLIENT_TRAFFIC_SECRET_0 ",         32, 32, " ", 0, TLS_KEYLOG_MAP(tls13_client_appdata) },
+    { "server_appdata",     "SERVER_TRAFFIC_SECRET_0 ",         32, 32, " ", 0, TLS_KEYLOG_MAP(tls13_server_appdata) },
+    { "early_exporter",     "EARLY_EXPORTER_SECRET ",           32, 32, " ", 0, TLS_KEYLOG_MAP(tls13_early_exporter) },
+    { "exporter",           "EXPORTER_SECRET ",                 32, 32, " ", 0, TLS_KEYLOG_MAP(tls13_exporter) },
+    /* ECH. Secret length is defined by HPKE KEM Nsecret and can vary between 32 and 64 bytes */
+    { "ech_secret",         "ECH_SECRET ",                      32, 64, " ", 0, TLS_KEYLOG_MAP(ech_secret) },
+    { "ech_config",         "ECH_CONFIG ",                      22,  0, " ", 0, TLS_KEYLOG_MAP(ech_config) },
+};
+
+#undef TLS_KEYLOG_MAP
 
-void
-tls_keylog_process_lines(const ssl_master_key_map_t *mk_map, const uint8_t *data, unsigned datalen)
+/* A line of the key log, with the hex-encoded key and secret if it has one
+ * of the formats above. */
+typedef struct {
+    const char *line;
+    unsigned    line_len;
+    int         format;         /* index in tls_keylog_formats, -1 if none */
+    const char *key;
+    unsigned    key_len;        /* in hex digits */
+    const char *secret;
+    unsigned    secret_len;     /* in hex digits */
+} tls_keylog_entry_t;
+
+/* Key log data is read by blocks of this size, and split into chunks of at
+ * least TLS_KEYLOG_CHUNK_SIZE that are parsed in parallel. */
+#define TLS_KEYLOG_READ_SIZE    (16 * 1024 * 1024)
+#define TLS_KEYLOG_CHUNK_SIZE   (1024 * 1024)
+
+static size_t
+tls_keylog_hex_len(const char *p, const char *end)
 {
-    ssl_master_key_match_group_t mk_groups[] = {
-        { "encrypted_pmk",  mk_map->pre_master },
-        { "session_id",     mk_map->session },
-        { "client_random",  mk_map->crandom },
-        { "client_random_pms",  mk_map->pms },
-        /* TLS 1.3 map from Client Random to derived secret. */
-        { "client_early",       mk_map->tls13_client_early },
-        { "client_handshake",   mk_map->tls13_client_handshake },
-        { "server_handshake",   mk_map->tls13_server_handshake },
-        { "client_appdata",     mk_map->tls13_client_appdata },
-        { "server_appdata",     mk_map->tls13_server_appdata },
-        { "early_exporter",     mk_map->tls13_early_exporter },
-        { "exporter",           mk_map->tls13_exporter },
-        { "ech_secret",         mk_map->ech_secret },
-        { "ech_config",         mk_map->ech_config },
-    };
+    const char *start = p;
 
-    /* The format of the file is a series of records with one of the following formats:
-     *   - "RSA xxxx yyyy"
-     *     Where xxxx are the first 8 bytes of the encrypted pre-master secret (hex-encoded)
-     *     Where yyyy is the cleartext pre-master secret (hex-encoded)
-     *     (this is the original format introduced with bug 4349)
-     *
-     *   - "RSA Session-ID:xxxx Master-Key:yyyy"
-     *     Where xxxx is the SSL session ID (hex-encoded)
-     *     Where yyyy is the cleartext master secret (hex-encoded)
-     *     (added to support openssl s_client Master-Key output)
-     *     This is somewhat is a misnomer because there's nothing RSA specific
-     *     about this.
-     *
-     *   - "PMS_CLIENT_RANDOM xxxx yyyy"
-     *     Where xxxx is the client_random from the ClientHello (hex-encoded)
-     *     Where yyyy is the cleartext pre-master secret (hex-encoded)
-     *     (This format allows SSL connections to be decrypted, if a user can
-     *     capture the PMS but could not recover the MS for a specific session
-     *     with a SSL Server.)
-     *
-     *   - "CLIENT_RANDOM xxxx yyyy"
-     *     Where xxxx is the client_random from the ClientHello (hex-encoded)
-     *     Where yyyy is the cleartext master secret (hex-encoded)
-     *     (This format allows non-RSA SSL connections to be decrypted, i.e.
-     *     ECDHE-RSA.)
-     *
-     *   - "CLIENT_EARLY_TRAFFIC_SECRET xxxx yyyy"
-     *   - "CLIENT_HANDSHAKE_TRAFFIC_SECRET xxxx yyyy"
-     *   - "SERVER_HANDSHAKE_TRAFFIC_SECRET xxxx yyyy"
-     *   - "CLIENT_TRAFFIC_SECRET_0 xxxx yyyy"
-     *   - "SERVER_TRAFFIC_SECRET_0 xxxx yyyy"
-     *   - "EARLY_EXPORTER_SECRET xxxx yyyy"
-     *   - "EXPORTER_SECRET xxxx yyyy"
-     *     Where xxxx is the client_random from the ClientHello (hex-encoded)
-     *     Where yyyy is the secret (hex-encoded) derived from the early,
-     *     handshake or master secrets. (This format is introduced with TLS 1.3
-     *     and supported by BoringSSL, OpenSSL, etc. See bug 12779.)
-     */
-    GRegex *regex = ssl_compile_keyfile_regex();
-    if (!regex)
-        return;
+    while (p < end && g_ascii_isxdigit(*p)) {
+        p++;
+    }
+    return p - start;
+}
+
+static bool
+tls_keylog_parse_line(tls_keylog_entry_t *entry)
+{
+    const char *end = entry->line + entry->line_len;
+
+    for (unsigned i = 0; i < G_N_ELEMENTS(tls_keylog_formats); i++) {
+        const tls_keylog_format_t *fmt = &tls_keylog_formats[i];
+        size_t label_len = strlen(fmt->label);
+        size_t sep_len = strlen(fmt->key_sep);
+        const char *p = entry->line;
+        size_t n;
+
+        if (entry->line_len < label_len || memcmp(p, fmt->label, label_len) != 0) {
+            continue;
+        }
+        p += label_len;
+
+        /* The key is a whole number of octets, followed by the separator. */
+        n = tls_keylog_hex_len(p, end);
+        if ((n & 1) || n / 2 < fmt->key_min || (fmt->key_max && n / 2 > fmt->key_max)) {
+            continue;
+        }
+        if ((size_t)(end - p) - n < sep_len || memcmp(p + n, fmt->key_sep, sep_len) != 0) {
+            continue;
+        }
+        entry->key = p;
+        entry->key_len = (unsigned)n;
+        p += n + sep_len;
+
+        n = tls_keylog_hex_len(p, end);
+        if (fmt->secret_len) {
+            if (n < 2 * fmt->secret_len) {
+                continue;
+            }
+            n = 2 * fmt->secret_len;
+        } else {
+            n &= ~(size_t)1;
+            if (n == 0) {
+                continue;
+            }
+        }
+        entry->secret = p;
+        entry->secret_len = (unsigned)n;
+        entry->format = i;
+        return true;
+    }
+    return false;
+}
+
+static void
+tls_keylog_parse_chunk(const char *data, size_t datalen, GArray *entries)
+{
+    const char *next_line = data;
+    const char *line_end = data + datalen;
 
-    const char *next_line = (const char *)data;
-    const char *line_end = next_line + datalen;
     while (next_line && next_line < line_end) {
+        tls_keylog_entry_t entry = { 0 };
         const char *line = next_line;
         next_line = (const char *)memchr(line, '\n', line_end - line);
-        ssize_t linelen;
+        size_t linelen;
 
         if (next_line) {
             linelen = next_line - line;
             next_line++;    /* drop LF */
         } else {
-            linelen = (ssize_t)(line_end - line);
+            linelen = line_end - line;
         }
         if (linelen > 0 && line[linelen - 1] == '\r') {
             linelen--;      /* drop CR */
         }
 
-        ssl_debug_printf("  checking keylog line: %.*s\n", (int)linelen, line);
-        GMatchInfo *mi;
-        if (g_regex_match_full(regex, line, linelen, 0, G_REGEX_MATCH_ANCHORED, &mi, NULL)) {
-            char *hex_key, *hex_pre_ms_or_ms;
-            StringInfo *key = wmem_new(wmem_file_scope(), StringInfo);
-            StringInfo *pre_ms_or_ms = NULL;
-            GHashTable *ht = NULL;
+        entry.line = line;
+        entry.line_len = (unsigned)linelen;
+        entry.format = -1;
+        tls_keylog_parse_line(&entry);
+        g_array_append_val(entries, entry);
+    }
+}
 
-            /* Is the PMS being supplied with the PMS_CLIENT_RANDOM
-             * otherwise we will use the Master Secret
-             */
-            hex_pre_ms_or_ms = g_match_info_fetch_named(mi, "master_secret");
-            if (hex_pre_ms_or_ms == NULL || !*hex_pre_ms_or_ms) {
-                g_free(hex_pre_ms_or_ms);
-                hex_pre_ms_or_ms = g_match_info_fetch_named(mi, "pms");
-            }
-            if (hex_pre_ms_or_ms == NULL || !*hex_pre_ms_or_ms) {
-                g_free(hex_pre_ms_or_ms);
-                hex_pre_ms_or_ms = g_match_info_fetch_named(mi, "derived_secret");
-            }
-            /* There is always a match, otherwise the regex is wrong. */
-            DISSECTOR_ASSERT(hex_pre_ms_or_ms && strlen(hex_pre_ms_or_ms));
+typedef struct {
+    const char *data;
+    size_t     *bounds;     /* chunk i is data[bounds[i]] to data[bounds[i + 1]] */
+    GArray    **entries;    /* per chunk */
+    int         chunks_nr;
+    int         next;       /* next chunk to parse */
+} tls_keylog_work_t;
 
-            /* convert from hex to bytes and save to hashtable */
-            pre_ms_or_ms = wmem_new(wmem_file_scope(), StringInfo);
-            from_hex(pre_ms_or_ms, hex_pre_ms_or_ms, strlen(hex_pre_ms_or_ms));
-            g_free(hex_pre_ms_or_ms);
-
-            /* Find a master key from any format (CLIENT_RANDOM, SID, ...) */
-            for (unsigned i = 0; i < G_N_ELEMENTS(mk_groups); i++) {
-                ssl_master_key_match_group_t *g = &mk_groups[i];
-                hex_key = g_match_info_fetch_named(mi, g->re_group_name);
-                if (hex_key && *hex_key) {
-                    ssl_debug_printf("    matched %s\n", g->re_group_name);
-                    ht = g->master_key_ht;
-                    from_hex(key, hex_key, strlen(hex_key));
-                    g_free(hex_key);
-                    break;
+static void *
+tls_keylog_parse_worker(void *data)
+{
+    tls_keylog_work_t *work = (tls_keylog_work_t *)data;
+    int i;
+
+    while ((i = g_atomic_int_add(&work->next, 1)) < work->chunks_nr) {
+        tls_keylog_parse_chunk(work->data + work->bounds[i],
+                work->bounds[i + 1] - work->bounds[i], work->entries[i]);
+    }
+    return NULL;
+}
+
+void
+tls_keylog_process_lines(const ssl_master_key_map_t *mk_map, const uint8_t *data, unsigned datalen)
+{
+    tls_keylog_work_t work;
+    GThread **threads;
+    int threads_nr;
+
+    /* Parsing is done in parallel, on chunks split at line boundaries. The
+     * secrets are then added in order, so that the last one for a key wins
+     * as before. */
+    work.data = (const char *)data;
+    work.chunks_nr = (int)MIN(g_get_num_processors(), MAX(datalen / TLS_KEYLOG_CHUNK_SIZE, 1));
+    work.next = 0;
+    work.bounds = g_new(size_t, work.chunks_nr + 1);
+    work.entries = g_new(GArray *, work.chunks_nr);
+    work.bounds[0] = 0;
+    for (int c = 1; c < work.chunks_nr; c++) {
+        size_t pos = MAX((size_t)datalen / work.chunks_nr * c, work.bounds[c - 1]);
+        const char *lf = (const char *)memchr(work.data + pos, '\n', datalen - pos);
+        work.bounds[c] = lf ? (size_t)(lf - work.data) + 1 : datalen;
+    }
+    work.bounds[work.chunks_nr] = datalen;
+    for (int c = 0; c < work.chunks_nr; c++) {
+        work.entries[c] = g_array_new(false, false, sizeof(tls_keylog_entry_t));
+    }
+
+    threads_nr = work.chunks_nr - 1;
+    threads = g_new(GThread *, MAX(threads_nr, 1));
+    for (int t = 0; t < threads_nr; t++) {
+        threads[t] = g_thread_new("tls-keylog", tls_keylog_parse_worker, &work);
+    }
+    tls_keylog_parse_worker(&work);
+    for (int t = 0; t < threads_nr; t++) {
+        g_thread_join(threads[t]);
+    }
+    g_free(threads);
+
+    for (int c = 0; c < work.chunks_nr; c++) {
+        for (unsigned i = 0; i < work.entries[c]->len; i++) {
+            const tls_keylog_entry_t *entry = &g_array_index(work.entries[c], tls_keylog_entry_t, i);
+
+            ssl_debug_printf("  checking keylog line: %.*s\n", (int)entry->line_len, entry->line);
+            if (entry->format < 0) {
+                if (entry->line_len > 0 && entry->line[0] != '#') {
+                    ssl_debug_printf("    unrecognized line\n");
                 }
-                g_free(hex_key);
+                continue;
             }
-            DISSECTOR_ASSERT(ht); /* Cannot be reached, or regex is wrong. */
 
-            g_hash_table_insert(ht, key, pre_ms_or_ms);
+            const tls_keylog_format_t *fmt = &tls_keylog_formats[entry->format];
+            GHashTable *ht = *(GHashTable * const *)((const char *)mk_map + fmt->ht_offset);
+            StringInfo *key = wmem_new(wmem_file_scope(), StringInfo);
+            StringInfo *pre_ms_or_ms = wmem_new(wmem_file_scope(), StringInfo);
 
-        } else if (linelen > 0 && line[0] != '#') {
-            ssl_debug_printf("    unrecognized line\n");
+            ssl_debug_printf("    matched %s\n", fmt->name);
+            /* convert from hex to bytes and save to hashtable */
+            from_hex(key, entry->key, entry->key_len);
+            from_hex(pre_ms_or_ms, entry->secret, entry->secret_len);
+            g_hash_table_insert(ht, key, pre_ms_or_ms);
         }
-        /* always free match info even if there is no match. */
-        g_match_info_free(mi);
+        g_array_free(work.entries[c], true);
+    }
+    g_free(work.entries);
+    g_free(work.bounds);
+}
+
+void
+tls_keylog_add_secrets_block(tls_keylog_file_t *keylog_file, const void *secrets, unsigned len)
+{
+    if (!keylog_file->pending_blocks) {
+        keylog_file->pending_blocks = g_ptr_array_new_with_free_func((GDestroyNotify)g_bytes_unref);
+    }
+    g_ptr_array_add(keylog_file->pending_blocks, g_bytes_new(secrets, len));
+}
+
+static void
+tls_keylog_close(tls_keylog_file_t *keylog_file)
+{
+    if (keylog_file->fp) {
+        fclose(keylog_file->fp);
+        keylog_file->fp = NULL;
     }
+    keylog_file->offset = 0;
+    keylog_file->size = -1;
 }
 
 void
-ssl_load_keyfile(const char *tls_keylog_filename, FILE **keylog_file,
+ssl_load_keyfile(const char *tls_keylog_filename, tls_keylog_file_t *keylog_file,
                  const ssl_master_key_map_t *mk_map)
 {
+    ws_statb64 statb;
+    char *buf;
+    size_t buf_len;
+
+    /* Secrets embedded in the capture file are only loaded when needed. */
+    if (keylog_file->pending_blocks && keylog_file->pending_blocks->len) {
+        for (unsigned i = 0; i < keylog_file->pending_blocks->len; i++) {
+            GBytes *block = (GBytes *)g_ptr_array_index(keylog_file->pending_blocks, i);
+            size_t block_len;
+            const uint8_t *block_data = (const uint8_t *)g_bytes_get_data(block, &block_len);
+
+            ssl_debug_printf("%s loading secrets block of %zu bytes\n", G_STRFUNC, block_len);
+            tls_keylog_process_lines(mk_map, block_data, (unsigned)block_len);
+        }
+        g_ptr_array_set_size(keylog_file->pending_blocks, 0);
+    }
+
     /* no need to try if no key log file is configured. */
     if (!tls_keylog_filename || !*tls_keylog_filename) {
         ssl_debug_printf("%s dtls/tls.keylog_file is not configured!\n",
@@ -6989,44 +7117,79 @@ ssl_load_keyfile(const char *tls_keylog_filename, FILE **keylog_file,
         return;
     }
 
-    /* Validate regexes before even trying to use it. */
-    if (!ssl_compile_keyfile_regex()) {
-        return;
-    }
-
     ssl_debug_printf("trying to use TLS keylog in %s\n", tls_keylog_filename);
 
     /* if the keylog file was deleted/overwritten, re-open it */
-    if (*keylog_file && file_needs_reopen(ws_fileno(*keylog_file), tls_keylog_filename)) {
+    if (keylog_file->fp && file_needs_reopen(ws_fileno(keylog_file->fp), tls_keylog_filename)) {
         ssl_debug_printf("%s file got deleted, trying to re-open\n", G_STRFUNC);
-        fclose(*keylog_file);
-        *keylog_file = NULL;
+        tls_keylog_close(keylog_file);
     }
 
-    if (*keylog_file == NULL) {
-        *keylog_file = ws_fopen(tls_keylog_filename, "r");
-        if (!*keylog_file) {
+    if (keylog_file->fp == NULL) {
+        keylog_file->fp = ws_fopen(tls_keylog_filename, "rb");
+        if (!keylog_file->fp) {
             ssl_debug_printf("%s failed to open SSL keylog\n", G_STRFUNC);
             return;
         }
+        keylog_file->offset = 0;
+        keylog_file->size = -1;
     }
 
+    /* Only read what was appended since the last time, unless the file was
+     * truncated, in which case all of it is read again. */
+    if (ws_fstat64(ws_fileno(keylog_file->fp), &statb) == 0) {
+        if ((int64_t)statb.st_size == keylog_file->size) {
+            return;
+        }
+        if ((int64_t)statb.st_size < keylog_file->offset) {
+            keylog_file->offset = 0;
+        }
+        keylog_file->size = (int64_t)statb.st_size;
+    }
+    if (ws_fseek64(keylog_file->fp, keylog_file->offset, SEEK_SET) != 0) {
+        ssl_debug_printf("%s Error while seeking in key log file, closing it!\n", G_STRFUNC);
+        tls_keylog_close(keylog_file);
+        return;
+    }
+
+    buf = (char *)g_malloc(TLS_KEYLOG_READ_SIZE);
+    buf_len = 0;
     for (;;) {
-        char buf[1110], *line;
-        line = fgets(buf, sizeof(buf), *keylog_file);
-        if (!line) {
-            if (feof(*keylog_file)) {
-                /* Ensure that newly appended keys can be read in the future. */
-                clearerr(*keylog_file);
-            } else if (ferror(*keylog_file)) {
-                ssl_debug_printf("%s Error while reading key log file, closing it!\n", G_STRFUNC);
-                fclose(*keylog_file);
-                *keylog_file = NULL;
+        size_t complete;
+        bool at_end;
+
+        buf_len += fread(buf + buf_len, 1, TLS_KEYLOG_READ_SIZE - buf_len, keylog_file->fp);
+        at_end = buf_len < TLS_KEYLOG_READ_SIZE;
+        if (ferror(keylog_file->fp)) {
+            ssl_debug_printf("%s Error while reading key log file, closing it!\n", G_STRFUNC);
+            tls_keylog_close(keylog_file);
+            break;
+        }
+
+        /* Process complete lines, and keep the last one for the next block. */
+        for (complete = buf_len; complete > 0 && buf[complete - 1] != '\n'; complete--)
+            ;
+        if (complete == 0 && !at_end) {
+            /* A line longer than the buffer, it cannot be a valid one. */
+            complete = buf_len;
+        }
+        tls_keylog_process_lines(mk_map, (uint8_t *)buf, (unsigned)complete);
+        keylog_file->offset += complete;
+
+        if (at_end) {
+            /* The last line may still be being written. Use what is there
+             * already, but read it again next time. */
+            if (complete < buf_len) {
+                tls_keylog_process_lines(mk_map, (uint8_t *)buf + complete, (unsigned)(buf_len - complete));
             }
+            /* Ensure that newly appended keys can be read in the future. */
+            clearerr(keylog_file->fp);
             break;
         }
-        tls_keylog_process_lines(mk_map, (uint8_t *)line, (int)strlen(line));
+        memmove(buf, buf + complete, buf_len - complete);
+        buf_len -= complete;
     }
+    g_free(buf);
 }
 /** SSL keylog file handling. }}} */
 
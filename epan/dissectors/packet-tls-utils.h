@@ -788,12 +788,21 @@ ssl_add_record_info(int proto, packet_info *pinfo, const unsigned char *data, in
 extern tvbuff_t*
 ssl_get_record_info(tvbuff_t *parent_tvb, int proto, packet_info *pinfo, int record_id, uint8_t curr_layer_num_ssl, SslRecordInfo **matched_record);
 
+/* State of the key log file and of the secrets embedded in the capture
+ * (Decryption Secrets Blocks) that were not loaded into the secrets map yet. */
+typedef struct {
+    FILE       *fp;
+    int64_t     offset;         /* start of the first line not read yet */
+    int64_t     size;           /* file size at the last read, -1 if unknown */
+    GPtrArray  *pending_blocks; /* GBytes of secrets blocks not processed yet */
+} tls_keylog_file_t;
+
 /* initialize/reset per capture state data (ssl sessions cache) */
 extern void
 ssl_common_init(ssl_master_key_map_t *master_key_map,
                 StringInfo *decrypted_data, StringInfo *compressed_data);
 extern void
-ssl_common_cleanup(ssl_master_key_map_t *master_key_map, FILE **ssl_keylog_file,
+ssl_common_cleanup(ssl_master_key_map_t *master_key_map, tls_keylog_file_t *ssl_keylog_file,
                    StringInfo *decrypted_data, StringInfo *compressed_data);
 
 /**
@@ -808,9 +817,15 @@ tls_get_master_key_map(bool load_secrets);
 extern void
 tls_keylog_process_lines(const ssl_master_key_map_t *mk_map, const uint8_t *data, unsigned len);
 
-/* tries to update the secrets cache from the given filename */
+/* Keep secrets from a Decryption Secrets Block until they are needed,
+ * i.e. until the next call to ssl_load_keyfile(). */
+extern void
+tls_keylog_add_secrets_block(tls_keylog_file_t *keylog_file, const void *secrets, unsigned len);
+
+/* tries to update the secrets cache from the given filename and the
+ * pending secrets blocks */
 extern void
-ssl_load_keyfile(const char *ssl_keylog_filename, FILE **keylog_file,
+ssl_load_keyfile(const char *ssl_keylog_filename, tls_keylog_file_t *keylog_file,
                  const ssl_master_key_map_t *mk_map);
 
 #ifdef HAVE_LIBGNUTLS
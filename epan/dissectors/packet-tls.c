@@ -259,7 +259,7 @@ static dissector_handle_t  tls_handle;
 static StringInfo          ssl_compressed_data;
 static StringInfo          ssl_decrypted_data;
 static int                 ssl_decrypted_data_avail;
-static FILE               *ssl_keylog_file;
+static tls_keylog_file_t    ssl_keylog_file;
 static ssl_common_options_t ssl_options;
 
 /* List of dissectors to call for TLS data */
@@ -4500,7 +4500,7 @@ ssl_both_prompt(packet_info *pinfo, char *result)
 static void
 tls_secrets_block_callback(const void *secrets, unsigned size)
 {
-    tls_keylog_process_lines(&ssl_master_key_map, (const uint8_t *)secrets, size);
+    tls_keylog_add_secrets_block(&ssl_keylog_file, secrets, size);
 }
 
 /*********************************************************************
@@ -950,12 +950,22 @@ udp_handle_timestamps(packet_info *pinfo, tvbuff_t *tvb, proto_tree *tree, struc
     udp_print_timestamps(pinfo, tvb, tree, udp_data, proto_id);
 }
 
+/* The port fields at the start of the header: udp.srcport, udp.dstport
+ * and the two hidden udp.port items. */
+static const proto_fixed_field udp_port_fields[] = {
+    { &hf_udp_srcport, 0, 2, ENC_BIG_ENDIAN },
+    { &hf_udp_dstport, 2, 2, ENC_BIG_ENDIAN },
+    { &hf_udp_port,    0, 2, ENC_BIG_ENDIAN },
+    { &hf_udp_port,    2, 2, ENC_BIG_ENDIAN },
+};
+
 static void
 dissect(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, uint32_t ip_proto)
 {
     proto_tree *udp_tree = NULL;
-    proto_item *ti, *item, *hidden_item, *calc_item;
+    proto_item *ti, *item, *calc_item;
     proto_item *src_port_item, *dst_port_item, *len_cov_item;
+    proto_item *port_items[G_N_ELEMENTS(udp_port_fields)];
     unsigned    len;
     unsigned    reported_len;
     vec_t       cksum_vec[4];
@@ -991,17 +1001,16 @@ dissect(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, uint32_t ip_proto)
     udp_tree = proto_item_add_subtree(ti, ett_udp);
     p_add_proto_data(pinfo->pool, pinfo, proto_udp, pinfo->curr_layer_num, udp_tree);
 
-    src_port_item = proto_tree_add_item(udp_tree, hf_udp_srcport, tvb, offset, 2, ENC_BIG_ENDIAN);
-    dst_port_item = proto_tree_add_item(udp_tree, hf_udp_dstport, tvb, offset + 2, 2, ENC_BIG_ENDIAN);
+    proto_tree_add_fixed_items(udp_tree, tvb, offset, udp_port_fields,
+                               G_N_ELEMENTS(udp_port_fields), port_items);
+    src_port_item = port_items[0];
+    dst_port_item = port_items[1];
+    proto_item_set_hidden(port_items[2]);
+    proto_item_set_hidden(port_items[3]);
 
     p_add_proto_data(pinfo->pool, pinfo, hf_udp_srcport, pinfo->curr_layer_num, GUINT_TO_POINTER(udph->uh_sport));
     p_add_proto_data(pinfo->pool, pinfo, hf_udp_dstport, pinfo->curr_layer_num, GUINT_TO_POINTER(udph->uh_dport));
 
-    hidden_item = proto_tree_add_item(udp_tree, hf_udp_port, tvb, offset, 2, ENC_BIG_ENDIAN);
-    proto_item_set_hidden(hidden_item);
-    hidden_item = proto_tree_add_item(udp_tree, hf_udp_port, tvb, offset + 2, 2, ENC_BIG_ENDIAN);
-    proto_item_set_hidden(hidden_item);
-
     /* The beginning port number, 32768 + 666 (33434), is from LBL's traceroute.c source code and this code
      * further assumes that 3 attempts are made per hop */
     if ((udph->uh_sport > (32768 + 666)) && (udph->uh_sport <= (32768 + 666 + 30))) {
@@ -1254,6 +1263,7 @@ dissect(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, uint32_t ip_proto)
     if (udpd) {
         item = proto_tree_add_uint(udp_tree, hf_udp_stream, tvb, offset, 0, udpd->stream);
         proto_item_set_generated(item);
+        follow_index_stream_frame(hf_udp_stream, udpd->stream, pinfo);
 
         /* Copy the stream index into the header as well to make it available
         * to tap listeners.
@@ -1413,6 +1413,7 @@ void proto_register_x509af(void) {
   proto_register_subtree_array(ett, array_length(ett));
 
   x509af_eo_tap = register_export_object(proto_x509af, x509af_eo_packet, NULL);
+  set_eo_entries_complete(proto_x509af);
 
   register_cleanup_routine(&x509af_cleanup_protocol);
 
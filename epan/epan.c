@@ -588,6 +588,7 @@ epan_dissect_init(epan_dissect_t *edt, epan_t *session, const bool create_proto_
 	}
 	else {
 		edt->pi.pool = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK_FAST);
+		wmem_allocator_set_stats_name(edt->pi.pool, "pinfo");
 	}
 
 	if (create_proto_tree) {
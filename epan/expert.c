@@ -14,6 +14,7 @@
 #define WS_LOG_DOMAIN LOG_DOMAIN_EPAN
 
 #include <stdio.h>
+#include <string.h>
 
 #include "packet.h"
 #include "expert.h"
@@ -37,6 +38,37 @@ static int proto_malformed;
 static int expert_tap;
 static int highest_severity;
 
+/* Expert info items recorded from a dissection of each frame after the
+ * first pass. Dissectors can add items on the first pass or only later
+ * ones, so the first pass doesn't show what a retap would. */
+typedef struct {
+	uint32_t    packet_num;
+	unsigned    seq;	/* Order within the frame, for sorting */
+	int         group;
+	int         severity;
+	int         hf_index;
+	const char *protocol;	/* Interned in store_strings */
+	char       *summary;	/* Interned in store_strings */
+} expert_store_item_t;
+
+#define STORE_SEVERITY_LEVELS	((PI_SEVERITY_MASK >> 20) + 1)
+
+static bool store_enabled;
+static wmem_array_t *store_items;	/* expert_store_item_t */
+static bool store_sorted;		/* store_items is in frame order */
+static GArray *store_pending;		/* Items of the frame being dissected */
+static uint32_t store_pending_num;
+static uint8_t *store_frames;		/* Bitmap of the recorded frames */
+static uint32_t store_frames_len;	/* in bytes */
+static uint32_t store_frames_count;
+static wmem_map_t *store_infos;		/* Info column of the frames with items, by number */
+static uint32_t store_infos_missing;	/* Frames with items recorded without columns */
+static wmem_map_t *store_strings;
+static unsigned store_counts[STORE_SEVERITY_LEVELS];
+
+/* Info of a frame recorded without columns */
+static char store_no_info[] = "";
+
 static int ett_expert;
 static int ett_subexpert;
 
@@ -317,6 +349,218 @@ expert_update_comment_count(uint64_t count)
 		highest_severity = 0;
 }
 
+void
+expert_store_init(void)
+{
+	memset(store_counts, 0, sizeof(store_counts));
+	store_sorted = true;
+	store_pending_num = 0;
+	store_frames = NULL;
+	store_frames_len = 0;
+	store_frames_count = 0;
+	store_infos_missing = 0;
+	if (!store_enabled) {
+		store_items = NULL;
+		store_infos = NULL;
+		store_strings = NULL;
+		return;
+	}
+	store_items = wmem_array_new(wmem_file_scope(), sizeof(expert_store_item_t));
+	if (store_pending == NULL)
+		store_pending = g_array_new(false, false, sizeof(expert_store_item_t));
+	store_infos = wmem_map_new(wmem_file_scope(), g_direct_hash, g_direct_equal);
+	store_strings = wmem_map_new(wmem_file_scope(), g_str_hash, g_str_equal);
+}
+
+void
+expert_store_cleanup(void)
+{
+	/* Everything but the pending items is in file scope. */
+	store_items = NULL;
+	if (store_pending != NULL) {
+		g_array_free(store_pending, true);
+		store_pending = NULL;
+	}
+	store_frames = NULL;
+	store_frames_len = 0;
+	store_frames_count = 0;
+	store_infos = NULL;
+	store_infos_missing = 0;
+	store_strings = NULL;
+	memset(store_counts, 0, sizeof(store_counts));
+}
+
+void
+expert_store_set_enabled(bool enabled)
+{
+	store_enabled = enabled;
+}
+
+bool
+expert_store_available(uint32_t frame_count, bool with_info)
+{
+	if (store_items == NULL || store_frames_count < frame_count)
+		return false;
+	return !with_info || store_infos_missing == 0;
+}
+
+static bool
+expert_store_has_frame(uint32_t num)
+{
+	return num / 8 < store_frames_len && (store_frames[num / 8] & (1 << (num % 8)));
+}
+
+static char *
+expert_store_intern(const char *str)
+{
+	char *interned;
+
+	if (str == NULL)
+		return NULL;
+
+	interned = (char *)wmem_map_lookup(store_strings, str);
+	if (interned == NULL) {
+		interned = wmem_strdup(wmem_file_scope(), str);
+		wmem_map_insert(store_strings, interned, interned);
+	}
+	return interned;
+}
+
+/* Items are kept aside until the dissection of their frame is done. */
+static void
+expert_store_add(packet_info *pinfo, int group, int severity, int hf_index, const char *summary)
+{
+	expert_store_item_t item;
+
+	if (pinfo->num != store_pending_num) {
+		g_array_set_size(store_pending, 0);
+		store_pending_num = pinfo->num;
+	}
+
+	item.packet_num = pinfo->num;
+	item.seq        = store_pending->len;
+	item.group      = group;
+	item.severity   = severity;
+	item.hf_index   = hf_index;
+	item.protocol   = expert_store_intern(pinfo->current_proto);
+	item.summary    = expert_store_intern(summary);
+	g_array_append_val(store_pending, item);
+}
+
+/* The Info column of a frame with columns, or NULL if it has none */
+static char *
+expert_store_frame_info(packet_info *pinfo)
+{
+	const char *info = col_get_text(pinfo->cinfo, COL_INFO);
+
+	return info ? wmem_strdup(wmem_file_scope(), info) : NULL;
+}
+
+void
+expert_store_frame_done(packet_info *pinfo)
+{
+	uint32_t num;
+	unsigned count;
+	char *info;
+
+	if (store_items == NULL || pinfo->fd == NULL || !PINFO_FD_VISITED(pinfo))
+		return;
+
+	num = pinfo->num;
+	if (expert_store_has_frame(num)) {
+		/* Fill in the Info column if the recording pass had none. */
+		if (pinfo->cinfo != NULL &&
+		    wmem_map_lookup(store_infos, GUINT_TO_POINTER(num)) == store_no_info) {
+			wmem_map_insert(store_infos, GUINT_TO_POINTER(num), expert_store_frame_info(pinfo));
+			store_infos_missing--;
+		}
+		return;
+	}
+
+	if (num / 8 >= store_frames_len) {
+		uint32_t len = MAX(num / 8 + 1, store_frames_len * 2);
+
+		store_frames = (uint8_t *)wmem_realloc(wmem_file_scope(), store_frames, len);
+		memset(store_frames + store_frames_len, 0, len - store_frames_len);
+		store_frames_len = len;
+	}
+	store_frames[num / 8] |= 1 << (num % 8);
+	store_frames_count++;
+
+	count = (store_pending_num == num) ? store_pending->len : 0;
+	if (count > 0) {
+		if (pinfo->cinfo != NULL) {
+			info = expert_store_frame_info(pinfo);
+		} else {
+			info = store_no_info;
+			store_infos_missing++;
+		}
+		wmem_map_insert(store_infos, GUINT_TO_POINTER(num), info);
+
+		for (unsigned i = 0; i < count; i++) {
+			const expert_store_item_t *item = &g_array_index(store_pending, expert_store_item_t, i);
+			store_counts[(item->severity & PI_SEVERITY_MASK) >> 20]++;
+		}
+		if (wmem_array_get_count(store_items) > 0 &&
+		    ((expert_store_item_t *)wmem_array_index(store_items, wmem_array_get_count(store_items) - 1))->packet_num > num)
+			store_sorted = false;
+		wmem_array_append(store_items, store_pending->data, count);
+	}
+	store_pending_num = 0;
+	g_array_set_size(store_pending, 0);
+}
+
+static int
+expert_store_item_compare(const void *a, const void *b)
+{
+	const expert_store_item_t *item_a = (const expert_store_item_t *)a;
+	const expert_store_item_t *item_b = (const expert_store_item_t *)b;
+
+	if (item_a->packet_num != item_b->packet_num)
+		return item_a->packet_num < item_b->packet_num ? -1 : 1;
+	if (item_a->seq != item_b->seq)
+		return item_a->seq < item_b->seq ? -1 : 1;
+	return 0;
+}
+
+bool
+expert_store_foreach(expert_store_func func, void *user_data)
+{
+	expert_info_t ei;
+
+	if (store_items == NULL)
+		return false;
+
+	/* Frames dissected out of order, e.g. selected before a retap */
+	if (!store_sorted) {
+		wmem_array_sort(store_items, expert_store_item_compare);
+		store_sorted = true;
+	}
+
+	for (unsigned i = 0; i < wmem_array_get_count(store_items); i++) {
+		const expert_store_item_t *item = (expert_store_item_t *)wmem_array_index(store_items, i);
+		const char *info = (const char *)wmem_map_lookup(store_infos, GUINT_TO_POINTER(item->packet_num));
+
+		ei.packet_num = item->packet_num;
+		ei.group      = item->group;
+		ei.severity   = item->severity;
+		ei.hf_index   = item->hf_index;
+		ei.protocol   = item->protocol;
+		ei.summary    = item->summary;
+		ei.pitem      = NULL;
+		func(&ei, info == store_no_info ? NULL : info, user_data);
+	}
+	return true;
+}
+
+unsigned
+expert_store_get_count(int severity)
+{
+	if (store_items == NULL)
+		return 0;
+	return store_counts[(severity & PI_SEVERITY_MASK) >> 20];
+}
+
 expert_module_t *expert_register_protocol(int id)
 {
 	expert_module_t *module;
@@ -600,6 +844,12 @@ expert_set_info_vformat(packet_info *pinfo, proto_item *pi, int group, int sever
 		ws_utf8_truncate(formatted, ITEM_LABEL_LENGTH - 1);
 	}
 
+	/* Record the items of one dissection of each frame after the first
+	 * pass; see expert_store_frame_done(). */
+	if (store_items != NULL && PINFO_FD_VISITED(pinfo) && !expert_store_has_frame(pinfo->num)) {
+		expert_store_add(pinfo, group, severity, hf_index, formatted);
+	}
+
 	tree = expert_create_tree(pi, group, severity, formatted);
 
 	if (hf_index <= 0) {
@@ -96,6 +96,67 @@ expert_get_highest_severity(void);
 WS_DLL_PUBLIC void
 expert_update_comment_count(uint64_t count);
 
+/* Set up the expert info store for a new file (called from init_dissection) */
+extern void
+expert_store_init(void);
+
+/* Free the expert info store (called from cleanup_dissection) */
+extern void
+expert_store_cleanup(void);
+
+/** Record the expert info items of each frame in a store that lasts as
+ * long as the capture file. Items are recorded from the first dissection
+ * of each frame after the first pass, since some dissectors only add items
+ * once they have seen the whole file, so the store is only complete after
+ * a full pass such as a retap. Takes effect when the next file is opened
+ * or the current one is redissected.
+ *
+ * @param enabled true to record expert info items
+ */
+WS_DLL_PUBLIC void
+expert_store_set_enabled(bool enabled);
+
+/* Record the items of a dissected frame (called from dissect_record) */
+extern void
+expert_store_frame_done(packet_info *pinfo);
+
+/** Check whether the store holds the expert info items of every frame.
+ *
+ * @param frame_count the number of frames in the file
+ * @param with_info true if the Info column of every frame with items is
+ * needed; frames recorded by a pass without columns don't have it
+ * @return true if the store can be used instead of a retap
+ */
+WS_DLL_PUBLIC bool
+expert_store_available(uint32_t frame_count, bool with_info);
+
+/** Called for each item in the store.
+ *
+ * @param ei the item; its protocol and summary last as long as the
+ * capture file, and pitem is always NULL
+ * @param info the Info column of the item's frame, or NULL if it has none
+ * @param user_data passed to expert_store_foreach()
+ */
+typedef void (*expert_store_func)(const expert_info_t *ei, const char *info, void *user_data);
+
+/** Call a function for each expert info item in the store, in frame order.
+ * Check expert_store_available() first.
+ *
+ * @param func the function to call
+ * @param user_data passed to func
+ * @return false if the store isn't enabled
+ */
+WS_DLL_PUBLIC bool
+expert_store_foreach(expert_store_func func, void *user_data);
+
+/** Get the number of expert info items in the store with a severity.
+ *
+ * @param severity one of the PI_ severity levels
+ * @return the number of items, or 0 if the store isn't enabled
+ */
+WS_DLL_PUBLIC unsigned
+expert_store_get_count(int severity);
+
 /** Add an expert info.
  Add an expert info tree to a protocol item using registered expert info item
  @param pinfo Packet info of the currently processed packet. May be NULL if
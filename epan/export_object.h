@@ -90,6 +90,23 @@ WS_DLL_PUBLIC tap_packet_cb get_eo_packet_func(register_eo_t* eo);
  */
 WS_DLL_PUBLIC export_object_gui_reset_cb get_eo_reset_func(register_eo_t* eo);
 
+/** Declare that the objects of a protocol are complete when they are
+ * added, i.e. its tap never changes an entry after passing it to
+ * add_entry (through get_entry or otherwise). The entries can then be
+ * saved and freed as soon as they're added, and extracted again later
+ * by retapping the capture.
+ *
+ * @param proto_id the protocol passed to register_export_object()
+ */
+WS_DLL_PUBLIC void set_eo_entries_complete(const int proto_id);
+
+/** Check whether the entries of an Export Object are complete when added
+ *
+ * @param eo Registered Export Object
+ * @return true if set_eo_entries_complete() was called for the protocol
+ */
+WS_DLL_PUBLIC bool get_eo_entries_complete(register_eo_t* eo);
+
 /** Get Export Object by its protocol filter name
  *
  * @param name protocol filter name to fetch.
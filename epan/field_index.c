@@ -0,0 +1,370 @@
+/* field_index.c
+ * Index of field values for display filtering
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <epan/epan_dissect.h>
+#include <epan/prefs.h>
+#include <epan/proto.h>
+#include <epan/wmem_scopes.h>
+#include <wsutil/inet_cidr.h>
+#include <wsutil/roaring_bitmap.h>
+
+#include "field_index.h"
+
+typedef enum {
+    INDEX_KIND_NONE,        /* Only the presence of the field is indexed */
+    INDEX_KIND_PRESENT,
+    INDEX_KIND_UINT,
+    INDEX_KIND_INT,
+    INDEX_KIND_IPV4,
+    INDEX_KIND_IPV6,
+    INDEX_KIND_ETHER
+} index_kind_t;
+
+typedef struct {
+    int hfid;               /* First field with the name */
+    uint8_t kind;
+    uint8_t len;
+    uint8_t data[16];
+} index_key_t;
+
+typedef struct {
+    int hfid;
+    int head_hfid;          /* First field with the name */
+    index_kind_t kind;      /* Of the values of all fields with the name */
+} indexed_field_t;
+
+static wmem_array_t *indexed_fields;    /* indexed_field_t */
+static wmem_map_t *value_bitmaps;       /* index_key_t -> roaring_bitmap_t */
+static uint32_t indexed_frames;
+static bool index_incomplete;
+
+static index_kind_t
+ftype_index_kind(ftenum_t ftype)
+{
+    if (FT_IS_UINT(ftype))
+        return INDEX_KIND_UINT;
+    if (FT_IS_INT(ftype))
+        return INDEX_KIND_INT;
+    switch (ftype) {
+        case FT_IPv4:
+            return INDEX_KIND_IPV4;
+        case FT_IPv6:
+            return INDEX_KIND_IPV6;
+        case FT_ETHER:
+            return INDEX_KIND_ETHER;
+        default:
+            return INDEX_KIND_NONE;
+    }
+}
+
+/* Make the key of a field value. Returns false if the value is not a
+ * single value of a kind that is indexed. */
+static bool
+index_key_set(index_key_t *key, int head_hfid, fvalue_t *fv)
+{
+    memset(key, 0, sizeof(*key));
+    key->hfid = head_hfid;
+    key->kind = ftype_index_kind(fvalue_type_ftenum(fv));
+
+    switch (key->kind) {
+        case INDEX_KIND_UINT:
+        {
+            uint64_t value = FT_IS_UINT32(fvalue_type_ftenum(fv)) ?
+                fvalue_get_uinteger(fv) : fvalue_get_uinteger64(fv);
+            key->len = sizeof(value);
+            memcpy(key->data, &value, sizeof(value));
+            return true;
+        }
+        case INDEX_KIND_INT:
+        {
+            int64_t value = FT_IS_INT32(fvalue_type_ftenum(fv)) ?
+                fvalue_get_sinteger(fv) : fvalue_get_sinteger64(fv);
+            key->len = sizeof(value);
+            memcpy(key->data, &value, sizeof(value));
+            return true;
+        }
+        case INDEX_KIND_IPV4:
+        {
+            const ipv4_addr_and_mask *ipv4 = fvalue_get_ipv4(fv);
+            if (ipv4->nmask != 0xffffffff)
+                return false;
+            key->len = sizeof(ipv4->addr);
+            memcpy(key->data, &ipv4->addr, sizeof(ipv4->addr));
+            return true;
+        }
+        case INDEX_KIND_IPV6:
+        {
+            const ipv6_addr_and_prefix *ipv6 = fvalue_get_ipv6(fv);
+            if (ipv6->prefix != 128)
+                return false;
+            key->len = sizeof(ipv6->addr.bytes);
+            memcpy(key->data, ipv6->addr.bytes, sizeof(ipv6->addr.bytes));
+            return true;
+        }
+        case INDEX_KIND_ETHER:
+            if (fvalue_get_bytes_size(fv) != FT_ETHER_LEN)
+                return false;
+            key->len = FT_ETHER_LEN;
+            memcpy(key->data, fvalue_get_bytes_data(fv), FT_ETHER_LEN);
+            return true;
+        default:
+            return false;
+    }
+}
+
+static unsigned
+index_key_hash(const void *k)
+{
+    return wmem_strong_hash((const uint8_t *)k, sizeof(index_key_t));
+}
+
+static gboolean
+index_key_equal(const void *a, const void *b)
+{
+    return memcmp(a, b, sizeof(index_key_t)) == 0;
+}
+
+static void
+field_index_add_field(header_field_info *hfinfo)
+{
+    header_field_info *hf;
+    index_kind_t kind;
+    indexed_field_t field;
+
+    /* Index everything under the first field with the name. */
+    while (hfinfo->same_name_prev_id != -1)
+        hfinfo = proto_registrar_get_nth(hfinfo->same_name_prev_id);
+
+    for (unsigned i = 0; i < wmem_array_get_count(indexed_fields); i++) {
+        if (((indexed_field_t *)wmem_array_index(indexed_fields, i))->head_hfid == hfinfo->id)
+            return;
+    }
+
+    /* Values can only be looked up if all the fields with the name have
+     * the same kind of value; otherwise just index where they appear. */
+    kind = ftype_index_kind(hfinfo->type);
+    for (hf = hfinfo->same_name_next; hf != NULL; hf = hf->same_name_next) {
+        if (ftype_index_kind(hf->type) != kind)
+            kind = INDEX_KIND_NONE;
+    }
+
+    for (hf = hfinfo; hf != NULL; hf = hf->same_name_next) {
+        field.hfid = hf->id;
+        field.head_hfid = hfinfo->id;
+        field.kind = kind;
+        wmem_array_append_one(indexed_fields, field);
+    }
+}
+
+void
+field_index_init(void)
+{
+    char **names;
+
+    indexed_fields = NULL;
+    value_bitmaps = NULL;
+    indexed_frames = 0;
+    index_incomplete = false;
+
+    if (prefs.filter_index_fields == NULL || prefs.filter_index_fields[0] == '\0')
+        return;
+
+    indexed_fields = wmem_array_new(wmem_file_scope(), sizeof(indexed_field_t));
+    names = g_strsplit_set(prefs.filter_index_fields, ", \t", -1);
+    for (char **name = names; *name != NULL; name++) {
+        header_field_info *hfinfo;
+
+        if (**name == '\0')
+            continue;
+        hfinfo = proto_registrar_get_byname(*name);
+        if (hfinfo == NULL)
+            continue;
+        field_index_add_field(hfinfo);
+    }
+    g_strfreev(names);
+
+    if (wmem_array_get_count(indexed_fields) == 0) {
+        indexed_fields = NULL;
+        return;
+    }
+    value_bitmaps = wmem_map_new(wmem_file_scope(), index_key_hash, index_key_equal);
+}
+
+void
+field_index_cleanup(void)
+{
+    /* Everything is in file scope. */
+    indexed_fields = NULL;
+    value_bitmaps = NULL;
+    indexed_frames = 0;
+    index_incomplete = false;
+}
+
+bool
+field_index_enabled(void)
+{
+    return indexed_fields != NULL;
+}
+
+void
+field_index_prime_edt(epan_dissect_t *edt, const frame_data *fd)
+{
+    if (indexed_fields == NULL || index_incomplete || fd->num <= indexed_frames)
+        return;
+
+    for (unsigned i = 0; i < wmem_array_get_count(indexed_fields); i++) {
+        epan_dissect_prime_with_hfid(edt,
+                ((indexed_field_t *)wmem_array_index(indexed_fields, i))->hfid);
+    }
+}
+
+static void
+field_index_add_key(const index_key_t *key, uint32_t frame_num)
+{
+    roaring_bitmap_t *bitmap;
+
+    bitmap = (roaring_bitmap_t *)wmem_map_lookup(value_bitmaps, key);
+    if (bitmap == NULL) {
+        bitmap = roaring_bitmap_new(wmem_file_scope());
+        wmem_map_insert(value_bitmaps, wmem_memdup(wmem_file_scope(), key, sizeof(*key)), bitmap);
+    }
+    roaring_bitmap_add(bitmap, frame_num);
+}
+
+void
+field_index_add_frame(epan_dissect_t *edt, const frame_data *fd)
+{
+    index_key_t key;
+
+    if (indexed_fields == NULL || index_incomplete || fd->num <= indexed_frames)
+        return;
+
+    if (fd->num != indexed_frames + 1 || edt->tree == NULL) {
+        /* A frame is missing; the index can't be used for this file. */
+        index_incomplete = true;
+        return;
+    }
+
+    for (unsigned i = 0; i < wmem_array_get_count(indexed_fields); i++) {
+        const indexed_field_t *field = (indexed_field_t *)wmem_array_index(indexed_fields, i);
+        GPtrArray *finfos = proto_get_finfo_ptr_array(edt->tree, field->hfid);
+
+        if (finfos == NULL || finfos->len == 0)
+            continue;
+
+        memset(&key, 0, sizeof(key));
+        key.hfid = field->head_hfid;
+        key.kind = INDEX_KIND_PRESENT;
+        field_index_add_key(&key, fd->num);
+
+        if (field->kind == INDEX_KIND_NONE)
+            continue;
+        for (unsigned j = 0; j < finfos->len; j++) {
+            field_info *finfo = (field_info *)g_ptr_array_index(finfos, j);
+
+            if (index_key_set(&key, field->head_hfid, finfo->value)) {
+                field_index_add_key(&key, fd->num);
+            }
+        }
+    }
+
+    indexed_frames = fd->num;
+}
+
+static const indexed_field_t *
+field_index_lookup_field(int head_hfid)
+{
+    for (unsigned i = 0; i < wmem_array_get_count(indexed_fields); i++) {
+        const indexed_field_t *field = (indexed_field_t *)wmem_array_index(indexed_fields, i);
+        if (field->head_hfid == head_hfid)
+            return field;
+    }
+    return NULL;
+}
+
+bool
+field_index_get_filter_frames(const dfilter_t *df, uint32_t frame_count,
+        uint32_t **frames, unsigned *count, bool *exact)
+{
+    const GPtrArray *terms;
+    roaring_bitmap_t *result = NULL;
+    bool result_owned = false;
+    bool all_terms;
+
+    *frames = NULL;
+    *count = 0;
+    *exact = false;
+
+    if (df == NULL || indexed_fields == NULL || index_incomplete || indexed_frames < frame_count)
+        return false;
+
+    terms = dfilter_get_index_terms(df, &all_terms);
+    if (terms == NULL)
+        return false;
+
+    /* Every term must hold for a frame to match, so the matching frames
+     * are in the intersection of the frames of the terms in the index.
+     * The result is exact if all the filter's terms were in the index. */
+    for (unsigned i = 0; i < terms->len; i++) {
+        const dfilter_index_term_t *term = (dfilter_index_term_t *)g_ptr_array_index(terms, i);
+        const indexed_field_t *field = field_index_lookup_field(term->hfinfo->id);
+        roaring_bitmap_t *bitmap;
+        index_key_t key;
+
+        if (field == NULL) {
+            all_terms = false;
+            continue;
+        }
+
+        if (term->value == NULL) {
+            memset(&key, 0, sizeof(key));
+            key.hfid = field->head_hfid;
+            key.kind = INDEX_KIND_PRESENT;
+        } else if (field->kind == INDEX_KIND_NONE ||
+                !index_key_set(&key, field->head_hfid, term->value) ||
+                key.kind != field->kind) {
+            all_terms = false;
+            continue;
+        }
+
+        bitmap = (roaring_bitmap_t *)wmem_map_lookup(value_bitmaps, &key);
+        if (bitmap == NULL) {
+            /* No frame has the value, so none can match. */
+            if (result_owned)
+                roaring_bitmap_free(result);
+            *frames = g_new0(uint32_t, 1);
+            *exact = true;
+            return true;
+        }
+
+        if (result == NULL) {
+            result = bitmap;
+        } else {
+            roaring_bitmap_t *both = roaring_bitmap_and(NULL, result, bitmap);
+            if (result_owned)
+                roaring_bitmap_free(result);
+            result = both;
+            result_owned = true;
+        }
+    }
+
+    if (result == NULL)
+        return false;
+
+    *frames = roaring_bitmap_to_array(result, count);
+    *exact = all_terms;
+    if (result_owned)
+        roaring_bitmap_free(result);
+    return true;
+}
@@ -0,0 +1,84 @@
+/** @file
+ *
+ * Index of field values for display filtering
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __FIELD_INDEX_H__
+#define __FIELD_INDEX_H__
+
+#include <epan/epan.h>
+#include <epan/frame_data.h>
+#include <epan/dfilter/dfilter.h>
+#include "ws_symbol_export.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * While a capture file is read, the values of the fields listed in the
+ * "filter_index_fields" preference are recorded, for each value, as a
+ * compressed bitmap of the frames it appears in. A display filter that
+ * requires "<field> == <value>" or the existence of an indexed field can
+ * then be answered by intersecting bitmaps, and only the frames in the
+ * result need to be dissected - or none of them, if the filter has no
+ * other tests.
+ *
+ * The index is only correct for fields whose values don't depend on
+ * later frames, such as addresses, ports and stream numbers.
+ */
+
+/* Set up the index for a new file (called from init_dissection) */
+void field_index_init(void);
+/* Free the index (called from cleanup_dissection) */
+void field_index_cleanup(void);
+
+/** Check whether any fields are indexed.
+ *
+ * @return true if the index is built during the first pass, which then
+ * needs a protocol tree.
+ */
+WS_DLL_PUBLIC bool field_index_enabled(void);
+
+/** Prime a dissection with the indexed fields, if the frame isn't
+ * indexed yet.
+ *
+ * @param edt The dissection about to be run
+ * @param fd The frame about to be dissected
+ */
+WS_DLL_PUBLIC void field_index_prime_edt(epan_dissect_t *edt, const frame_data *fd);
+
+/** Add the indexed field values of a dissected frame to the index.
+ * Frames must be added in order, on the first pass.
+ *
+ * @param edt The dissection of the frame, primed with field_index_prime_edt()
+ * @param fd The dissected frame
+ */
+WS_DLL_PUBLIC void field_index_add_frame(epan_dissect_t *edt, const frame_data *fd);
+
+/** Get the frames that can match a display filter, using the index.
+ *
+ * @param df [in] The display filter
+ * @param frame_count [in] Number of frames in the capture; the index must
+ * cover all of them
+ * @param frames [out] A g_malloc'ed array of frame numbers, in ascending order
+ * @param count [out] Number of frames
+ * @param exact [out] true if exactly those frames match the filter, false
+ * if the frames matching the filter are a subset of them
+ * @return true if the frames were found, false if the whole capture must
+ * be dissected.
+ */
+WS_DLL_PUBLIC bool field_index_get_filter_frames(const dfilter_t *df, uint32_t frame_count,
+        uint32_t **frames, unsigned *count, bool *exact);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __FIELD_INDEX_H__ */
@@ -19,6 +19,7 @@
 #include <epan/packet.h>
 #include "follow.h"
 #include <epan/tap.h>
+#include <wsutil/glib-compat.h>
 
 struct register_follow {
     int proto_id;              /* protocol id (0-indexed) */
@@ -242,6 +243,210 @@ follow_tvb_tap_listener(void *tapdata, packet_info *pinfo,
     return TAP_PACKET_DONT_REDRAW;
 }
 
+/*
+ * Stream frame index.
+ *
+ * For every field that numbers streams (tcp.stream, udp.stream,
+ * quic.connection.number, ...) the first pass records, per stream, the
+ * ascending list of frames the stream appears in. Following a stream or
+ * filtering on "<stream field> eq N" then only has to dissect those frames
+ * instead of the whole capture.
+ */
+static wmem_map_t *stream_frame_index;  /* hf_id -> (stream -> wmem_array_t of uint32_t frame numbers) */
+
+void
+follow_index_stream_frame(int hf_stream, uint32_t stream, packet_info *pinfo)
+{
+    wmem_map_t *streams;
+    wmem_array_t *frames;
+    unsigned count;
+
+    if (PINFO_FD_VISITED(pinfo))
+        return;
+
+    if (stream_frame_index == NULL) {
+        stream_frame_index = wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(), g_direct_hash, g_direct_equal);
+    }
+
+    streams = (wmem_map_t *)wmem_map_lookup(stream_frame_index, GINT_TO_POINTER(hf_stream));
+    if (streams == NULL) {
+        streams = wmem_map_new(wmem_file_scope(), g_direct_hash, g_direct_equal);
+        wmem_map_insert(stream_frame_index, GINT_TO_POINTER(hf_stream), streams);
+    }
+
+    frames = (wmem_array_t *)wmem_map_lookup(streams, GUINT_TO_POINTER(stream));
+    if (frames == NULL) {
+        frames = wmem_array_new(wmem_file_scope(), sizeof(uint32_t));
+        wmem_map_insert(streams, GUINT_TO_POINTER(stream), frames);
+    }
+
+    /* A frame can carry the same stream more than once (e.g. coalesced
+     * QUIC packets, or tunnels); keep each frame number only once. */
+    count = wmem_array_get_count(frames);
+    if (count == 0 || *(uint32_t *)wmem_array_index(frames, count - 1) != pinfo->num) {
+        wmem_array_append_one(frames, pinfo->num);
+    }
+}
+
+uint32_t *
+follow_get_stream_frames(int hf_stream, uint32_t stream, unsigned *count)
+{
+    wmem_map_t *streams;
+    wmem_array_t *frames;
+
+    *count = 0;
+    if (stream_frame_index == NULL)
+        return NULL;
+
+    streams = (wmem_map_t *)wmem_map_lookup(stream_frame_index, GINT_TO_POINTER(hf_stream));
+    if (streams == NULL)
+        return NULL;
+
+    frames = (wmem_array_t *)wmem_map_lookup(streams, GUINT_TO_POINTER(stream));
+    if (frames == NULL)
+        return g_new0(uint32_t, 1);
+
+    *count = wmem_array_get_count(frames);
+    return (uint32_t *)g_memdup2(wmem_array_get_raw(frames), *count * sizeof(uint32_t));
+}
+
+typedef enum {
+    FILTER_TOKEN_WORD,      /* field name, number or keyword */
+    FILTER_TOKEN_EQ,        /* "==" */
+    FILTER_TOKEN_AND,       /* "&&" */
+    FILTER_TOKEN_OTHER      /* any other punctuation */
+} filter_token_type_t;
+
+typedef struct {
+    filter_token_type_t type;
+    const char *start;
+    size_t len;
+} filter_token_t;
+
+static bool
+filter_token_is(const filter_token_t *token, const char *word)
+{
+    return token->type == FILTER_TOKEN_WORD && strlen(word) == token->len &&
+        g_ascii_strncasecmp(token->start, word, token->len) == 0;
+}
+
+/* Look up the frame list of a "<field> eq <number>" clause. */
+static uint32_t *
+follow_get_clause_frames(const filter_token_t *clause, unsigned n_tokens, unsigned *count)
+{
+    char *field;
+    int hf_stream;
+    uint32_t stream = 0;
+
+    if (n_tokens != 3 || clause[0].type != FILTER_TOKEN_WORD ||
+            !(clause[1].type == FILTER_TOKEN_EQ || filter_token_is(&clause[1], "eq")) ||
+            clause[2].type != FILTER_TOKEN_WORD)
+        return NULL;
+
+    /* Plain decimal only; the display filter engine reads a leading zero
+     * as octal and "0x" as hexadecimal. */
+    if (clause[2].len > 9 || (clause[2].len > 1 && clause[2].start[0] == '0'))
+        return NULL;
+    for (size_t i = 0; i < clause[2].len; i++) {
+        if (!g_ascii_isdigit(clause[2].start[i]))
+            return NULL;
+        stream = stream * 10 + (clause[2].start[i] - '0');
+    }
+
+    field = g_strndup(clause[0].start, clause[0].len);
+    hf_stream = proto_registrar_get_id_byname(field);
+    g_free(field);
+    if (hf_stream <= 0)
+        return NULL;
+
+    return follow_get_stream_frames(hf_stream, stream, count);
+}
+
+bool
+follow_get_filter_frames(const char *filter, uint32_t **frames, unsigned *count)
+{
+    GArray *tokens;
+    filter_token_t token;
+    const char *p;
+    unsigned clause_start = 0;
+    bool usable = true;
+
+    *frames = NULL;
+    *count = 0;
+    if (filter == NULL)
+        return false;
+
+    /* Split the filter into words and punctuation. Anything that could make
+     * the filter more than a conjunction of clauses (grouping, negation,
+     * alternatives, strings, macros) makes it unusable. */
+    tokens = g_array_new(FALSE, FALSE, sizeof(filter_token_t));
+    for (p = filter; *p != '\0' && usable; ) {
+        if (g_ascii_isspace(*p)) {
+            p++;
+            continue;
+        }
+        token.start = p;
+        if (g_ascii_isalnum(*p) || *p == '_' || *p == '.' || *p == '-') {
+            while (g_ascii_isalnum(*p) || *p == '_' || *p == '.' || *p == '-')
+                p++;
+            token.type = FILTER_TOKEN_WORD;
+        } else if (p[0] == '=' && p[1] == '=' && p[2] != '=') {
+            p += 2;
+            token.type = FILTER_TOKEN_EQ;
+        } else if (p[0] == '&' && p[1] == '&') {
+            p += 2;
+            token.type = FILTER_TOKEN_AND;
+        } else if (strchr("()[]{}\"'!|^$#@\\", *p) != NULL) {
+            usable = false;
+            break;
+        } else {
+            p++;
+            token.type = FILTER_TOKEN_OTHER;
+        }
+        token.len = p - token.start;
+        if (filter_token_is(&token, "or") || filter_token_is(&token, "xor") ||
+                filter_token_is(&token, "not")) {
+            usable = false;
+            break;
+        }
+        if (filter_token_is(&token, "and")) {
+            token.type = FILTER_TOKEN_AND;
+        }
+        g_array_append_val(tokens, token);
+    }
+
+    /* Each clause is ANDed with the rest, so the frames matching the whole
+     * filter are a subset of any indexed clause's frames. Use the shortest. */
+    for (unsigned i = 0; usable && i <= tokens->len; i++) {
+        uint32_t *clause_frames;
+        unsigned clause_count;
+
+        if (i < tokens->len && g_array_index(tokens, filter_token_t, i).type != FILTER_TOKEN_AND)
+            continue;
+
+        clause_frames = follow_get_clause_frames(&g_array_index(tokens, filter_token_t, clause_start),
+                                                 i - clause_start, &clause_count);
+        if (clause_frames != NULL) {
+            if (*frames == NULL || clause_count < *count) {
+                g_free(*frames);
+                *frames = clause_frames;
+                *count = clause_count;
+            } else {
+                g_free(clause_frames);
+            }
+        }
+        clause_start = i + 1;
+    }
+    g_array_free(tokens, TRUE);
+
+    if (!usable) {
+        g_free(*frames);
+        *frames = NULL;
+        *count = 0;
+    }
+    return *frames != NULL;
+}
+
 /*
  * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
  *
@@ -201,6 +201,40 @@ WS_DLL_PUBLIC void follow_reset_stream(follow_info_t* info);
  */
 WS_DLL_PUBLIC void follow_info_free(follow_info_t* follow_info);
 
+/** Record that a frame belongs to a stream, for follow_get_stream_frames().
+ * Called by dissectors on the first pass, wherever they add the field that
+ * numbers their streams (e.g. tcp.stream) to the tree.
+ *
+ * @param hf_stream [in] Field numbering the streams
+ * @param stream [in] Stream number
+ * @param pinfo [in] Packet info of the frame
+ */
+WS_DLL_PUBLIC void follow_index_stream_frame(int hf_stream, uint32_t stream, packet_info *pinfo);
+
+/** Get the frames in which a stream appears, in ascending order.
+ *
+ * @param hf_stream [in] Field numbering the streams
+ * @param stream [in] Stream number
+ * @param count [out] Number of frames
+ * @return A g_malloc'ed array of frame numbers, or NULL if no dissector
+ * indexes the field.
+ */
+WS_DLL_PUBLIC uint32_t *follow_get_stream_frames(int hf_stream, uint32_t stream, unsigned *count);
+
+/** Get the frames that can match a display filter, using the stream index.
+ * This works for filters that are a conjunction of clauses ("and" or "&&")
+ * where at least one clause is "<field> eq <number>" on an indexed stream
+ * field, such as the filters built by the followers and conversation
+ * filters. The frames matching the filter are a subset of the result.
+ *
+ * @param filter [in] Display filter text
+ * @param frames [out] A g_malloc'ed array of frame numbers, in ascending order
+ * @param count [out] Number of frames
+ * @return true if the frames were found, false if the whole capture must
+ * be dissected.
+ */
+WS_DLL_PUBLIC bool follow_get_filter_frames(const char *filter, uint32_t **frames, unsigned *count);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -160,6 +160,321 @@ static bool mmdbr_pipe_valid(void) {
     return pipe_valid;
 }
 
+#ifdef HAVE_MAXMINDDB_IN_PROCESS
+#include <maxminddb.h>
+
+// In-process lookups. The databases are mmap'd by libmaxminddb and a
+// lookup takes microseconds, so results are available immediately
+// instead of showing up as pending until mmdbresolve replies.
+//
+// Results are kept in a fixed-size open addressing cache. Slots are only
+// ever changed using compare-and-exchange and entries are immutable once
+// published, so lookups from several threads (maxmind_db_lookup_batch)
+// don't need a lock. If all of the probed slots are taken, the entry in
+// the first one is replaced.
+#define MMDB_CACHE_SLOTS        (1 << 18)
+#define MMDB_CACHE_MAX_PROBES   64
+#define MMDB_BATCH_CHUNK        1024
+
+static MMDB_s *mmdb_handles;
+static unsigned mmdb_handle_count;
+static mmdb_response_t **mmdb_cache; // MMDB_CACHE_SLOTS entries
+
+// Callers may hold on to lookup results (batch lookups, sharkd and the
+// GUI keep the returned pointers), so neither the caches of previous
+// database configurations nor the entries replaced in a cache are freed
+// before maxmind_db_pref_cleanup.
+static GPtrArray *mmdb_retired_caches;
+static GPtrArray *mmdb_evicted;
+static GMutex mmdb_evicted_mtx;
+
+static void mmdb_inproc_free_entry(mmdb_response_t *entry) {
+    g_free((char *) entry->mmdb_val.country_iso);
+    g_free((char *) entry->mmdb_val.country);
+    g_free((char *) entry->mmdb_val.city);
+    g_free((char *) entry->mmdb_val.as_org);
+    g_free(entry);
+}
+
+static void mmdb_inproc_free_cache(void *data) {
+    mmdb_response_t **cache = (mmdb_response_t **) data;
+
+    for (unsigned i = 0; i < MMDB_CACHE_SLOTS; i++) {
+        if (cache[i]) {
+            mmdb_inproc_free_entry(cache[i]);
+        }
+    }
+    g_free(cache);
+}
+
+static bool mmdb_inproc_open(void) {
+    mmdb_handles = g_new0(MMDB_s, mmdb_file_arr->len);
+    mmdb_handle_count = 0;
+
+    for (unsigned i = 0; i < mmdb_file_arr->len; i++) {
+        const char *path = (const char *) g_ptr_array_index(mmdb_file_arr, i);
+        int mmdb_err = MMDB_open(path, MMDB_MODE_MMAP, &mmdb_handles[mmdb_handle_count]);
+        if (mmdb_err == MMDB_SUCCESS) {
+            ws_debug("opened %s (%s)", path, mmdb_handles[mmdb_handle_count].metadata.database_type);
+            mmdb_handle_count++;
+        } else {
+            ws_debug("unable to open %s: %s", path, MMDB_strerror(mmdb_err));
+        }
+    }
+
+    if (mmdb_handle_count == 0) {
+        g_free(mmdb_handles);
+        mmdb_handles = NULL;
+        return false;
+    }
+
+    mmdb_cache = g_new0(mmdb_response_t *, MMDB_CACHE_SLOTS);
+    return true;
+}
+
+static void mmdb_inproc_close(void) {
+    for (unsigned i = 0; i < mmdb_handle_count; i++) {
+        MMDB_close(&mmdb_handles[i]);
+    }
+    g_free(mmdb_handles);
+    mmdb_handles = NULL;
+    mmdb_handle_count = 0;
+
+    if (mmdb_cache) {
+        if (!mmdb_retired_caches) {
+            mmdb_retired_caches = g_ptr_array_new_with_free_func(mmdb_inproc_free_cache);
+        }
+        g_ptr_array_add(mmdb_retired_caches, mmdb_cache);
+        mmdb_cache = NULL;
+    }
+}
+
+static void mmdb_inproc_free_retired(void) {
+    if (mmdb_retired_caches) {
+        g_ptr_array_free(mmdb_retired_caches, true);
+        mmdb_retired_caches = NULL;
+    }
+    if (mmdb_evicted) {
+        g_ptr_array_free(mmdb_evicted, true);
+        mmdb_evicted = NULL;
+    }
+}
+
+// The same keys mmdbresolve looks up. As with mmdbresolve, values from
+// later databases replace values from earlier ones.
+static const char *inproc_co_iso_key[]     = {"country", "iso_code", NULL};
+static const char *inproc_co_name_key[]    = {"country", "names", "en", NULL};
+static const char *inproc_ci_name_key[]    = {"city", "names", "en", NULL};
+static const char *inproc_asn_o_key[]      = {"autonomous_system_organization", NULL};
+static const char *inproc_asn_key[]        = {"autonomous_system_number", NULL};
+static const char *inproc_l_lat_key[]      = {"location", "latitude", NULL};
+static const char *inproc_l_lon_key[]      = {"location", "longitude", NULL};
+static const char *inproc_l_accuracy_key[] = {"location", "accuracy_radius", NULL};
+
+static bool mmdb_inproc_get_value(MMDB_entry_s *entry, const char **path, MMDB_entry_data_s *entry_data) {
+    return MMDB_aget_value(entry, entry_data, path) == MMDB_SUCCESS && entry_data->has_data;
+}
+
+static void mmdb_inproc_set_string(MMDB_entry_s *entry, const char **path, const char **value) {
+    MMDB_entry_data_s entry_data;
+
+    if (mmdb_inproc_get_value(entry, path, &entry_data) && entry_data.type == MMDB_DATA_TYPE_UTF8_STRING) {
+        g_free((char *) *value);
+        *value = g_strndup(entry_data.utf8_string, entry_data.data_size);
+    }
+}
+
+static mmdb_response_t *mmdb_inproc_resolve(const char *addr_str) {
+    mmdb_response_t *response = g_new0(mmdb_response_t, 1);
+    mmdb_lookup_t *val = &response->mmdb_val;
+    MMDB_entry_data_s entry_data;
+
+    init_lookup(val);
+
+    for (unsigned i = 0; i < mmdb_handle_count; i++) {
+        int gai_err, mmdb_err;
+        MMDB_lookup_result_s result = MMDB_lookup_string(&mmdb_handles[i], addr_str, &gai_err, &mmdb_err);
+
+        if (!result.found_entry || gai_err != 0 || mmdb_err != MMDB_SUCCESS) {
+            continue;
+        }
+
+        mmdb_inproc_set_string(&result.entry, inproc_co_iso_key, &val->country_iso);
+        mmdb_inproc_set_string(&result.entry, inproc_co_name_key, &val->country);
+        mmdb_inproc_set_string(&result.entry, inproc_ci_name_key, &val->city);
+        mmdb_inproc_set_string(&result.entry, inproc_asn_o_key, &val->as_org);
+        if (mmdb_inproc_get_value(&result.entry, inproc_asn_key, &entry_data) && entry_data.type == MMDB_DATA_TYPE_UINT32) {
+            val->as_number = entry_data.uint32;
+        }
+        if (mmdb_inproc_get_value(&result.entry, inproc_l_lat_key, &entry_data) && entry_data.type == MMDB_DATA_TYPE_DOUBLE) {
+            val->latitude = entry_data.double_value;
+        }
+        if (mmdb_inproc_get_value(&result.entry, inproc_l_lon_key, &entry_data) && entry_data.type == MMDB_DATA_TYPE_DOUBLE) {
+            val->longitude = entry_data.double_value;
+        }
+        if (mmdb_inproc_get_value(&result.entry, inproc_l_accuracy_key, &entry_data) && entry_data.type == MMDB_DATA_TYPE_UINT16) {
+            val->accuracy = entry_data.uint16;
+        }
+        val->found = val->country_iso || val->country || val->city || val->as_org ||
+            val->as_number || val->latitude != DBL_MAX || val->longitude != DBL_MAX || val->accuracy;
+    }
+
+    return response;
+}
+
+// Keep an entry that was replaced in the cache alive until the retired
+// caches are freed, since callers may still be using it.
+static void mmdb_inproc_evict(mmdb_response_t *entry) {
+    g_mutex_lock(&mmdb_evicted_mtx);
+    if (!mmdb_evicted) {
+        mmdb_evicted = g_ptr_array_new_with_free_func((GDestroyNotify) mmdb_inproc_free_entry);
+    }
+    g_ptr_array_add(mmdb_evicted, entry);
+    g_mutex_unlock(&mmdb_evicted_mtx);
+}
+
+// The slot index uses the low bits of the hash, so mix all of the input
+// bits into them (the MurmurHash3 finalizer). A plain multiplicative hash
+// only carries the low input bits into the low bits, which on
+// little-endian hosts would start every IPv4 address in a /18 probing at
+// the same slot.
+static unsigned mmdb_inproc_hash(bool is_ipv4, ws_in4_addr ipv4_addr, const ws_in6_addr *ipv6_addr) {
+    uint32_t h = is_ipv4 ? ipv4_addr : ipv6_oat_hash(ipv6_addr->bytes);
+
+    h ^= h >> 16;
+    h *= 0x85ebca6bU;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35U;
+    h ^= h >> 16;
+    return h;
+}
+
+static bool mmdb_inproc_entry_matches(const mmdb_response_t *entry, bool is_ipv4, ws_in4_addr ipv4_addr, const ws_in6_addr *ipv6_addr) {
+    if (entry->is_ipv4 != is_ipv4) {
+        return false;
+    }
+    if (is_ipv4) {
+        return entry->ipv4_addr == ipv4_addr;
+    }
+    return memcmp(&entry->ipv6_addr, ipv6_addr, sizeof(ws_in6_addr)) == 0;
+}
+
+/**
+ * Look up an address in the in-process cache, resolving it on a miss.
+ * May be called from any thread.
+ */
+static const mmdb_lookup_t *mmdb_inproc_lookup(bool is_ipv4, ws_in4_addr ipv4_addr, const ws_in6_addr *ipv6_addr) {
+    mmdb_response_t * volatile *cache = (mmdb_response_t * volatile *) mmdb_cache;
+    unsigned hash = mmdb_inproc_hash(is_ipv4, ipv4_addr, ipv6_addr);
+    mmdb_response_t *entry;
+    unsigned probe;
+
+    for (probe = 0; probe < MMDB_CACHE_MAX_PROBES; probe++) {
+        entry = (mmdb_response_t *) g_atomic_pointer_get(&cache[(hash + probe) & (MMDB_CACHE_SLOTS - 1)]);
+        if (!entry) {
+            break;
+        }
+        if (mmdb_inproc_entry_matches(entry, is_ipv4, ipv4_addr, ipv6_addr)) {
+            return &entry->mmdb_val;
+        }
+    }
+
+    char addr_str[WS_INET6_ADDRSTRLEN];
+    if (is_ipv4) {
+        ws_inet_ntop4(&ipv4_addr, addr_str, WS_INET6_ADDRSTRLEN);
+    } else {
+        ws_inet_ntop6(ipv6_addr, addr_str, WS_INET6_ADDRSTRLEN);
+    }
+    ws_noisy("looking up %s in-process", addr_str);
+
+    mmdb_response_t *response = mmdb_inproc_resolve(addr_str);
+    response->is_ipv4 = is_ipv4;
+    if (is_ipv4) {
+        response->ipv4_addr = ipv4_addr;
+    } else {
+        response->ipv6_addr = *ipv6_addr;
+    }
+
+    // Continue probing where the lookup stopped. Another thread may have
+    // published the same address in the meantime.
+    for (; probe < MMDB_CACHE_MAX_PROBES; probe++) {
+        mmdb_response_t * volatile *slot = &cache[(hash + probe) & (MMDB_CACHE_SLOTS - 1)];
+        if (g_atomic_pointer_compare_and_exchange(slot, NULL, response)) {
+            return &response->mmdb_val;
+        }
+        entry = (mmdb_response_t *) g_atomic_pointer_get(slot);
+        if (mmdb_inproc_entry_matches(entry, is_ipv4, ipv4_addr, ipv6_addr)) {
+            mmdb_inproc_free_entry(response);
+            return &entry->mmdb_val;
+        }
+    }
+
+    // The cache is too crowded around this address. Replace the entry in
+    // its first slot, which is the one the next lookup checks first.
+    mmdb_response_t * volatile *slot = &cache[hash & (MMDB_CACHE_SLOTS - 1)];
+    do {
+        entry = (mmdb_response_t *) g_atomic_pointer_get(slot);
+    } while (!g_atomic_pointer_compare_and_exchange(slot, entry, response));
+    mmdb_inproc_evict(entry);
+    return &response->mmdb_val;
+}
+
+static const mmdb_lookup_t *mmdb_inproc_lookup_address(const address *addr) {
+    if (addr->type == AT_IPv4) {
+        return mmdb_inproc_lookup(true, *(const ws_in4_addr *) addr->data, NULL);
+    } else if (addr->type == AT_IPv6) {
+        return mmdb_inproc_lookup(false, 0, (const ws_in6_addr *) addr->data);
+    }
+    return &mmdb_not_found;
+}
+
+typedef struct {
+    const address *addrs;
+    size_t count;
+} mmdb_batch_chunk_t;
+
+static void mmdb_inproc_batch_worker(void *data, void *user_data _U_) {
+    mmdb_batch_chunk_t *chunk = (mmdb_batch_chunk_t *) data;
+
+    for (size_t i = 0; i < chunk->count; i++) {
+        mmdb_inproc_lookup_address(&chunk->addrs[i]);
+    }
+}
+
+static void mmdb_inproc_lookup_batch(const address *addrs, size_t count) {
+    int max_threads = (int) g_get_num_processors();
+
+    if (count <= MMDB_BATCH_CHUNK || max_threads < 2) {
+        for (size_t i = 0; i < count; i++) {
+            mmdb_inproc_lookup_address(&addrs[i]);
+        }
+        return;
+    }
+
+    size_t n_chunks = (count + MMDB_BATCH_CHUNK - 1) / MMDB_BATCH_CHUNK;
+    mmdb_batch_chunk_t *chunks = g_new(mmdb_batch_chunk_t, n_chunks);
+    GThreadPool *pool = g_thread_pool_new(mmdb_inproc_batch_worker, NULL, max_threads, false, NULL);
+
+    for (size_t i = 0; i < n_chunks; i++) {
+        chunks[i].addrs = &addrs[i * MMDB_BATCH_CHUNK];
+        chunks[i].count = MIN(MMDB_BATCH_CHUNK, count - i * MMDB_BATCH_CHUNK);
+        g_thread_pool_push(pool, &chunks[i], NULL);
+    }
+    // Waits for all of the chunks to be processed.
+    g_thread_pool_free(pool, false, true);
+    g_free(chunks);
+}
+#endif // HAVE_MAXMINDDB_IN_PROCESS
+
+static bool mmdb_resolver_running(void) {
+#ifdef HAVE_MAXMINDDB_IN_PROCESS
+    if (mmdb_handle_count > 0) {
+        return true;
+    }
+#endif
+    return mmdbr_pipe_valid();
+}
+
 // Writing to mmdbr_pipe.stdin_fd can block. Do so in a separate thread.
 static void *
 write_mmdbr_stdin_worker(void *data _U_) {
@@ -373,6 +688,10 @@ static void mmdb_resolve_stop(void) {
     char *request;
     mmdb_response_t *response;
 
+#ifdef HAVE_MAXMINDDB_IN_PROCESS
+    mmdb_inproc_close();
+#endif
+
     while (mmdbr_request_q && (request = (char *) g_async_queue_try_pop(mmdbr_request_q)) != NULL) {
         g_free(request);
     }
@@ -485,6 +804,13 @@ static void mmdb_resolve_start(void) {
         return;
     }
 
+#ifdef HAVE_MAXMINDDB_IN_PROCESS
+    if (mmdb_inproc_open()) {
+        return;
+    }
+    ws_debug("no usable databases in-process, falling back to mmdbresolve");
+#endif
+
     GPtrArray *args = g_ptr_array_new();
     char *mmdbresolve = get_executable_path("mmdbresolve");
     g_ptr_array_add(args, mmdbresolve);
@@ -652,16 +978,19 @@ maxmind_db_pref_init(module_t *nameres)
 void maxmind_db_pref_cleanup(void)
 {
     mmdb_resolve_stop();
+#ifdef HAVE_MAXMINDDB_IN_PROCESS
+    mmdb_inproc_free_retired();
+#endif
 }
 
 void maxmind_db_pref_apply(void)
 {
     if (gbl_resolv_flags.maxmind_geoip) {
-        if (!mmdbr_pipe_valid()) {
+        if (!mmdb_resolver_running()) {
             mmdb_resolve_start();
         }
     } else {
-        if (mmdbr_pipe_valid()) {
+        if (mmdb_resolver_running()) {
             mmdb_resolve_stop();
         }
     }
@@ -741,6 +1070,12 @@ maxmind_db_lookup_ipv4(const ws_in4_addr *addr) {
         return &mmdb_not_found;
     }
 
+#ifdef HAVE_MAXMINDDB_IN_PROCESS
+    if (mmdb_handle_count > 0) {
+        return mmdb_inproc_lookup(true, *addr, NULL);
+    }
+#endif
+
     mmdb_lookup_t *result = (mmdb_lookup_t *) wmem_map_lookup(mmdb_ipv4_map, GUINT_TO_POINTER(*addr));
 
     if (!result) {
@@ -768,6 +1103,12 @@ maxmind_db_lookup_ipv6(const ws_in6_addr *addr) {
         return &mmdb_not_found;
     }
 
+#ifdef HAVE_MAXMINDDB_IN_PROCESS
+    if (mmdb_handle_count > 0) {
+        return mmdb_inproc_lookup(false, 0, addr);
+    }
+#endif
+
     mmdb_lookup_t * result = (mmdb_lookup_t *) wmem_map_lookup(mmdb_ipv6_map, addr->bytes);
 
     if (!result) {
@@ -789,6 +1130,30 @@ maxmind_db_lookup_ipv6(const ws_in6_addr *addr) {
     return result;
 }
 
+void
+maxmind_db_lookup_batch(const address *addrs, size_t count) {
+    if (!gbl_resolv_flags.maxmind_geoip) {
+        return;
+    }
+
+#ifdef HAVE_MAXMINDDB_IN_PROCESS
+    if (mmdb_handle_count > 0) {
+        mmdb_inproc_lookup_batch(addrs, count);
+        return;
+    }
+#endif
+
+    // Queue all of the requests before waiting for any responses, so that
+    // mmdbresolve can work through them back to back.
+    for (size_t i = 0; i < count; i++) {
+        if (addrs[i].type == AT_IPv4) {
+            maxmind_db_lookup_ipv4((const ws_in4_addr *) addrs[i].data);
+        } else if (addrs[i].type == AT_IPv6) {
+            maxmind_db_lookup_ipv6((const ws_in6_addr *) addrs[i].data);
+        }
+    }
+}
+
 char *
 maxmind_db_get_paths(void) {
     GString* path_str = NULL;
@@ -845,6 +1210,9 @@ maxmind_db_lookup_ipv6(const ws_in6_addr *addr _U_) {
     return &mmdb_not_found;
 }
 
+void
+maxmind_db_lookup_batch(const address *addrs _U_, size_t count _U_) {}
+
 char *
 maxmind_db_get_paths(void) {
     return g_strdup("");
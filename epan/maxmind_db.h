@@ -13,6 +13,7 @@
 #ifndef __MAXMIND_DB_H__
 #define __MAXMIND_DB_H__
 
+#include <epan/address.h>
 #include <epan/prefs.h>
 #include <wsutil/inet_addr.h>
 #include "ws_symbol_export.h"
@@ -63,6 +64,20 @@ WS_DLL_PUBLIC WS_RETNONNULL const mmdb_lookup_t *maxmind_db_lookup_ipv4(const ws
  */
 WS_DLL_PUBLIC WS_RETNONNULL const mmdb_lookup_t *maxmind_db_lookup_ipv6(const ws_in6_addr *addr);
 
+/**
+ * Look up a set of addresses at once, e.g. all of the endpoints of a
+ * conversation table, so that subsequent calls to maxmind_db_lookup_ipv4
+ * and maxmind_db_lookup_ipv6 are served from the cache.
+ *
+ * With the in-process backend the addresses are resolved in parallel
+ * before this returns. Otherwise all of them are queued for mmdbresolve.
+ * Addresses which aren't IPv4 or IPv6 are ignored.
+ *
+ * @param addrs Addresses to look up
+ * @param count Number of addresses
+ */
+WS_DLL_PUBLIC void maxmind_db_lookup_batch(const address *addrs, size_t count);
+
 /**
  * Get all configured paths
  *
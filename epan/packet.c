@@ -33,10 +33,13 @@
 #include <epan/wmem_scopes.h>
 
 #include <epan/column-info.h>
+#include <epan/conversation.h>
 #include <epan/exceptions.h>
 #include <epan/reassemble.h>
 #include <epan/stream.h>
 #include <epan/expert.h>
+#include <epan/field_index.h>
+#include <epan/conversation_table.h>
 #include <epan/prefs.h>
 #include <epan/range.h>
 
@@ -83,6 +86,16 @@ struct data_source {
  *
  * "protocol" is the protocol associated with the dissector table. Used
  * for determining dependencies.
+ *
+ * "dense_pages" is, for FT_UINT8 and FT_UINT16 tables, a copy of
+ * "hash_table" that is directly indexed by value, so that dispatching
+ * on a port number or similar doesn't need to hash. It is split into
+ * pages of DENSE_PAGE_SIZE entries that are only allocated once a value
+ * in their range is added, so that the many sparsely populated 16-bit
+ * tables don't cost 64k pointers each. "hash_table" remains the master
+ * copy, used for enumeration and Decode As; "dense_pages" is updated
+ * with every change to it. Values above "dense_max" are only in the hash
+ * table.
  */
 struct dissector_table {
 	GHashTable	*hash_table;
@@ -93,8 +106,13 @@ struct dissector_table {
 	protocol_t	*protocol;
 	GHashFunc	hash_func;
 	bool	supports_decode_as;
+	struct dtbl_entry ***dense_pages;
+	uint32_t	dense_max;
 };
 
+#define DENSE_PAGE_BITS	8
+#define DENSE_PAGE_SIZE	(1U << DENSE_PAGE_BITS)
+
 /*
  * Dissector tables. const char * -> dissector_table *
  */
@@ -163,10 +181,35 @@ struct heur_dissector_list {
 	const char	*ui_name;
 	protocol_t	*protocol;
 	GSList		*dissectors;
+	unsigned	 num_indices;	/* next heur_dtbl_entry_t list_index */
 };
 
 static GHashTable *heur_dissector_lists;
 
+/*
+ * Per-flow state of a heuristic dissector list, used to skip the heuristics
+ * that rejected the first "heuristic_probe_packets" packets of a flow.
+ *
+ * "rejected" has a bit for each entry of the list (by list_index) that
+ * is set as long as the entry rejected every probed packet of the flow.
+ * Once the flow has been probed enough, "retired_at" is set to the number
+ * of the last probed frame and entries whose bit is still set are not
+ * called for later frames of the flow. Using the frame number rather than
+ * the probe count keeps the decision identical when packets are dissected
+ * again, out of order, after the first pass.
+ */
+typedef struct heur_flow_state {
+	struct heur_flow_state *next;	/* state of another list in the same conversation */
+	heur_dissector_list_t	list;
+	unsigned		probes;
+	uint32_t		retired_at;
+	unsigned		nbits;
+	uint8_t		       *rejected;
+} heur_flow_state_t;
+
+/* conversation_t * -> heur_flow_state_t *, in file scope */
+static wmem_map_t *heur_flow_states;
+
 /* Name hashtables for fast detection of duplicate names */
 static GHashTable* heuristic_short_names;
 
@@ -196,6 +239,11 @@ destroy_dissector_table(void *data)
 
 	g_hash_table_destroy(table->hash_table);
 	g_slist_free(table->dissector_handles);
+	if (table->dense_pages) {
+		for (uint32_t i = 0; i <= table->dense_max >> DENSE_PAGE_BITS; i++)
+			g_free(table->dense_pages[i]);
+		g_free(table->dense_pages);
+	}
 	g_slice_free(struct dissector_table, data);
 }
 
@@ -355,6 +403,9 @@ init_dissection(void)
 	/* Initialize the table of conversations. */
 	epan_conversation_init();
 
+	/* Initialize the per-flow heuristic rejection cache. */
+	heur_flow_states = wmem_map_new(wmem_file_scope(), g_direct_hash, g_direct_equal);
+
 	/* Initialize protocol-specific variables. */
 	g_slist_foreach(init_routines, &call_routine, NULL);
 
@@ -363,6 +414,13 @@ init_dissection(void)
 
 	/* Initialize the expert infos */
 	expert_packet_init();
+	expert_store_init();
+
+	/* Initialize the field value index */
+	field_index_init();
+
+	/* Initialize the conversation table store */
+	conversation_table_store_init();
 }
 
 void
@@ -376,6 +434,15 @@ cleanup_dissection(void)
 
 	/* Cleanup the expert infos */
 	expert_packet_cleanup();
+	expert_store_cleanup();
+
+	/* Cleanup the field value index */
+	field_index_cleanup();
+
+	/* Cleanup the conversation table store */
+	conversation_table_store_cleanup();
+
+	heur_flow_states = NULL;
 
 	wmem_leave_file_scope();
 
@@ -656,6 +723,7 @@ dissect_record(epan_dissect_t *edt, int file_type_subtype, wtap_rec *rec,
 	edt->pi.src_win_scale = -1; /* unknown Rcv.Wind.Shift */
 	edt->pi.dst_win_scale = -1; /* unknown Rcv.Wind.Shift */
 	edt->pi.layers = wmem_list_new(edt->pi.pool);
+	edt->pi.layer_info = wmem_array_sized_new(edt->pi.pool, sizeof(layer_info_t), 8);
 	edt->tvb = NULL;
 
 	frame_delta_abs_time(edt->session, fd, 1, &edt->pi.rel_ts);
@@ -723,6 +791,8 @@ dissect_record(epan_dissect_t *edt, int file_type_subtype, wtap_rec *rec,
 	wtap_block_unref(rec->block);
 	rec->block = NULL;
 
+	expert_store_frame_done(&edt->pi);
+
 	fd->visited = 1;
 }
 
@@ -756,6 +826,7 @@ dissect_file(epan_dissect_t *edt, wtap_rec *rec,
 	edt->pi.p2p_dir = P2P_DIR_UNKNOWN;
 	edt->pi.link_dir = LINK_DIR_UNKNOWN;
 	edt->pi.layers = wmem_list_new(edt->pi.pool);
+	edt->pi.layer_info = wmem_array_sized_new(edt->pi.pool, sizeof(layer_info_t), 8);
 	edt->tvb = NULL;
 
 	frame_delta_abs_time(edt->session, fd, 1, &edt->pi.rel_ts);
@@ -823,13 +894,27 @@ struct dissector_handle {
 };
 
 static void
-add_layer(packet_info *pinfo, int proto_id)
+add_layer(packet_info *pinfo, int proto_id, tvbuff_t *tvb)
 {
 	int *proto_layer_num_ptr;
+	unsigned layer_idx;
+	layer_info_t info;
 
 	pinfo->curr_layer_num++;
 	wmem_list_append(pinfo->layers, GINT_TO_POINTER(proto_id));
 
+	/* Record the length of the data handed to the layer, and whether
+	 * it is part of an error packet. Entries of removed layers are
+	 * overwritten rather than removed. */
+	layer_idx = wmem_list_count(pinfo->layers) - 1;
+	info.length = tvb_reported_length(tvb);
+	info.in_error_pkt = pinfo->flags.in_error_pkt;
+	if (layer_idx < wmem_array_get_count(pinfo->layer_info)) {
+		*(layer_info_t *)wmem_array_index(pinfo->layer_info, layer_idx) = info;
+	} else {
+		wmem_array_append_one(pinfo->layer_info, info);
+	}
+
 	/* Increment layer number for this proto id. */
 	if (pinfo->proto_layers == NULL) {
 		pinfo->proto_layers = wmem_map_new(pinfo->pool, g_direct_hash, g_direct_equal);
@@ -874,6 +959,29 @@ remove_last_layer(packet_info *pinfo, bool reduce_count)
 }
 
 
+static int
+call_dissector_func(dissector_handle_t handle, tvbuff_t *tvb,
+		    packet_info *pinfo, proto_tree *tree, void *data)
+{
+	switch (handle->dissector_type) {
+
+	case DISSECTOR_TYPE_SIMPLE:
+		return (handle->dissector_func.dissector_type_simple)(tvb, pinfo, tree, data);
+
+	case DISSECTOR_TYPE_CALLBACK:
+		return (handle->dissector_func.dissector_type_callback)(tvb, pinfo, tree, data, handle->dissector_data);
+
+	default:
+		ws_assert_not_reached();
+	}
+}
+
+static void
+restore_wmem_stats_tag(void *saved_tag)
+{
+	wmem_stats_set_tag(*(const char **)saved_tag);
+}
+
 /* This function will return
  *   >0  this protocol was successfully dissected and this was this protocol.
  *   0   this packet did not match this protocol.
@@ -888,6 +996,7 @@ call_dissector_through_handle(dissector_handle_t handle, tvbuff_t *tvb,
 			      packet_info *pinfo, proto_tree *tree, void *data)
 {
 	const char *saved_proto;
+	const char *saved_stats_tag;
 	int	    saved_proto_layer_num;
 	int         len;
 
@@ -899,18 +1008,15 @@ call_dissector_through_handle(dissector_handle_t handle, tvbuff_t *tvb,
 			proto_get_protocol_short_name(handle->protocol);
 	}
 
-	switch (handle->dissector_type) {
-
-	case DISSECTOR_TYPE_SIMPLE:
-		len = (handle->dissector_func.dissector_type_simple)(tvb, pinfo, tree, data);
-		break;
-
-	case DISSECTOR_TYPE_CALLBACK:
-		len = (handle->dissector_func.dissector_type_callback)(tvb, pinfo, tree, data, handle->dissector_data);
-		break;
-
-	default:
-		ws_assert_not_reached();
+	if (G_UNLIKELY(wmem_stats_enabled())) {
+		/* Charge the dissector's allocations to its protocol, and
+		 * restore the caller's tag even if the dissector throws. */
+		saved_stats_tag = wmem_stats_set_tag(pinfo->current_proto);
+		CLEANUP_PUSH(restore_wmem_stats_tag, &saved_stats_tag);
+		len = call_dissector_func(handle, tvb, pinfo, tree, data);
+		CLEANUP_CALL_AND_POP;
+	} else {
+		len = call_dissector_func(handle, tvb, pinfo, tree, data);
 	}
 	pinfo->current_proto = saved_proto;
 	pinfo->curr_proto_layer_num = saved_proto_layer_num;
@@ -983,7 +1089,7 @@ call_dissector_work(dissector_handle_t handle, tvbuff_t *tvb, packet_info *pinfo
 		 */
 		/* XXX Should we check for a duplicate layer here? */
 		if (add_proto_name) {
-			add_layer(pinfo, proto_get_id(handle->protocol));
+			add_layer(pinfo, proto_get_id(handle->protocol), tvb);
 		}
 	}
 
@@ -1176,10 +1282,75 @@ find_dissector_table(const char *name)
 	return dissector_table;
 }
 
+/* Set the dense copy of an entry in a uint dissector table, if it has one. */
+static void
+dense_uint_dtbl_entry_set(dissector_table_t sub_dissectors, const uint32_t pattern,
+			  dtbl_entry_t *dtbl_entry)
+{
+	dtbl_entry_t **page;
+
+	if (sub_dissectors->dense_pages == NULL || pattern > sub_dissectors->dense_max)
+		return;
+
+	page = sub_dissectors->dense_pages[pattern >> DENSE_PAGE_BITS];
+	if (page == NULL) {
+		if (dtbl_entry == NULL)
+			return;
+		page = g_new0(dtbl_entry_t *, DENSE_PAGE_SIZE);
+		sub_dissectors->dense_pages[pattern >> DENSE_PAGE_BITS] = page;
+	}
+	page[pattern & (DENSE_PAGE_SIZE - 1)] = dtbl_entry;
+}
+
+static void
+dense_uint_dtbl_entry_copy(void *key, void *value, void *user_data)
+{
+	dense_uint_dtbl_entry_set((dissector_table_t)user_data,
+				  GPOINTER_TO_UINT(key), (dtbl_entry_t *)value);
+}
+
+/* Rebuild the dense copy of a uint dissector table after bulk removals. */
+static void
+dense_uint_dtbl_rebuild(dissector_table_t sub_dissectors)
+{
+	if (sub_dissectors->dense_pages == NULL)
+		return;
+
+	for (uint32_t i = 0; i <= sub_dissectors->dense_max >> DENSE_PAGE_BITS; i++) {
+		if (sub_dissectors->dense_pages[i])
+			memset(sub_dissectors->dense_pages[i], 0, DENSE_PAGE_SIZE * sizeof(dtbl_entry_t *));
+	}
+	g_hash_table_foreach(sub_dissectors->hash_table, dense_uint_dtbl_entry_copy, sub_dissectors);
+}
+
+/* Add or replace an entry in a uint dissector table. */
+static void
+insert_uint_dtbl_entry(dissector_table_t sub_dissectors, const uint32_t pattern,
+		       dtbl_entry_t *dtbl_entry)
+{
+	g_hash_table_insert(sub_dissectors->hash_table,
+			     GUINT_TO_POINTER(pattern), (void *)dtbl_entry);
+	dense_uint_dtbl_entry_set(sub_dissectors, pattern, dtbl_entry);
+}
+
+/* Remove an entry from a uint dissector table. */
+static void
+remove_uint_dtbl_entry(dissector_table_t sub_dissectors, const uint32_t pattern)
+{
+	dense_uint_dtbl_entry_set(sub_dissectors, pattern, NULL);
+	g_hash_table_remove(sub_dissectors->hash_table,
+			    GUINT_TO_POINTER(pattern));
+}
+
 /* Find an entry in a uint dissector table. */
 static dtbl_entry_t *
 find_uint_dtbl_entry(dissector_table_t sub_dissectors, const uint32_t pattern)
 {
+	if (sub_dissectors->dense_pages != NULL && pattern <= sub_dissectors->dense_max) {
+		dtbl_entry_t **page = sub_dissectors->dense_pages[pattern >> DENSE_PAGE_BITS];
+		return page ? page[pattern & (DENSE_PAGE_SIZE - 1)] : NULL;
+	}
+
 	switch (sub_dissectors->type) {
 
 	case FT_UINT8:
@@ -1292,8 +1463,7 @@ dissector_add_uint(const char *name, const uint32_t pattern, dissector_handle_t
 	dtbl_entry->initial = dtbl_entry->current;
 
 	/* do the table insertion */
-	g_hash_table_insert(sub_dissectors->hash_table,
-			     GUINT_TO_POINTER(pattern), (void *)dtbl_entry);
+	insert_uint_dtbl_entry(sub_dissectors, pattern, dtbl_entry);
 
 	/*
 	 * Now, if this table supports "Decode As", add this handle
@@ -1448,8 +1618,7 @@ dissector_delete_uint(const char *name, const uint32_t pattern,
 		/*
 		 * Found - remove it.
 		 */
-		g_hash_table_remove(sub_dissectors->hash_table,
-				    GUINT_TO_POINTER(pattern));
+		remove_uint_dtbl_entry(sub_dissectors, pattern);
 	}
 }
 
@@ -1521,6 +1690,7 @@ void dissector_delete_all(const char *name, dissector_handle_t handle)
 	ws_assert (sub_dissectors);
 
 	g_hash_table_foreach_remove (sub_dissectors->hash_table, dissector_delete_all_check, handle);
+	dense_uint_dtbl_rebuild(sub_dissectors);
 }
 
 static void
@@ -1529,7 +1699,8 @@ dissector_delete_from_table(gpointer key _U_, gpointer value, gpointer user_data
 	dissector_table_t sub_dissectors = (dissector_table_t) value;
 	ws_assert (sub_dissectors);
 
-	g_hash_table_foreach_remove(sub_dissectors->hash_table, dissector_delete_all_check, user_data);
+	if (g_hash_table_foreach_remove(sub_dissectors->hash_table, dissector_delete_all_check, user_data) > 0)
+		dense_uint_dtbl_rebuild(sub_dissectors);
 	sub_dissectors->dissector_handles = g_slist_remove(sub_dissectors->dissector_handles, user_data);
 }
 
@@ -1561,8 +1732,7 @@ dissector_change_uint(const char *name, const uint32_t pattern, dissector_handle
 		 * to decode it, just remove the entry to save memory.
 		 */
 		if (handle == NULL && dtbl_entry->initial == NULL) {
-			g_hash_table_remove(sub_dissectors->hash_table,
-					    GUINT_TO_POINTER(pattern));
+			remove_uint_dtbl_entry(sub_dissectors, pattern);
 			return;
 		}
 		dtbl_entry->current = handle;
@@ -1582,8 +1752,7 @@ dissector_change_uint(const char *name, const uint32_t pattern, dissector_handle
 	dtbl_entry->current = handle;
 
 	/* do the table insertion */
-	g_hash_table_insert(sub_dissectors->hash_table,
-			     GUINT_TO_POINTER(pattern), (void *)dtbl_entry);
+	insert_uint_dtbl_entry(sub_dissectors, pattern, dtbl_entry);
 }
 
 /* Reset an entry in a uint dissector table to its initial value. */
@@ -1610,8 +1779,7 @@ dissector_reset_uint(const char *name, const uint32_t pattern)
 	if (dtbl_entry->initial != NULL) {
 		dtbl_entry->current = dtbl_entry->initial;
 	} else {
-		g_hash_table_remove(sub_dissectors->hash_table,
-				    GUINT_TO_POINTER(pattern));
+		remove_uint_dtbl_entry(sub_dissectors, pattern);
 	}
 }
 
@@ -2715,6 +2883,8 @@ register_dissector_table(const char *name, const char *ui_name, const int proto,
 	/* Create and register the dissector table for this name; returns */
 	/* a pointer to the dissector table. */
 	sub_dissectors = g_slice_new(struct dissector_table);
+	sub_dissectors->dense_pages = NULL;
+	sub_dissectors->dense_max = 0;
 	switch (type) {
 
 	case FT_UINT8:
@@ -2730,6 +2900,11 @@ register_dissector_table(const char *name, const char *ui_name, const int proto,
 							       g_direct_equal,
 							       NULL,
 							       &g_free);
+		if (type == FT_UINT8 || type == FT_UINT16) {
+			sub_dissectors->dense_max = (type == FT_UINT8) ? 0xFF : 0xFFFF;
+			sub_dissectors->dense_pages = g_new0(dtbl_entry_t **,
+							     (sub_dissectors->dense_max >> DENSE_PAGE_BITS) + 1);
+		}
 		break;
 
 	case FT_STRING:
@@ -2788,6 +2963,8 @@ dissector_table_t register_custom_dissector_table(const char *name,
 	/* Create and register the dissector table for this name; returns */
 	/* a pointer to the dissector table. */
 	sub_dissectors = g_slice_new(struct dissector_table);
+	sub_dissectors->dense_pages = NULL;
+	sub_dissectors->dense_max = 0;
 	sub_dissectors->hash_func = hash_func;
 	sub_dissectors->hash_table = g_hash_table_new_full(hash_func,
 							       key_equal_func,
@@ -2956,6 +3133,10 @@ heur_dissector_add(const char *name, heur_dissector_t dissector, const char *dis
 	hdtbl_entry->list_name = g_strdup(name);
 	hdtbl_entry->enabled   = (enable == HEURISTIC_ENABLE);
 	hdtbl_entry->enabled_by_default = (enable == HEURISTIC_ENABLE);
+	hdtbl_entry->list_index = sub_dissectors->num_indices++;
+	hdtbl_entry->calls     = 0;
+	hdtbl_entry->accepts   = 0;
+	hdtbl_entry->skips     = 0;
 
 	/* do the table insertion */
 	g_hash_table_insert(heuristic_short_names, (void *)hdtbl_entry->short_name, hdtbl_entry);
@@ -3010,6 +3191,52 @@ heur_dissector_delete(const char *name, heur_dissector_t dissector, const int pr
 	}
 }
 
+/*
+ * Find the state of a heuristic dissector list for the flow of this
+ * packet, creating it on the first pass if necessary. Returns NULL if
+ * the packet isn't part of a conversation.
+ */
+static heur_flow_state_t *
+heur_flow_state_get(heur_dissector_list_t sub_dissectors, packet_info *pinfo)
+{
+	conversation_t    *conv;
+	heur_flow_state_t *head, *state;
+
+	if (heur_flow_states == NULL)
+		return NULL;
+
+	conv = find_conversation_pinfo_ro(pinfo, 0);
+	if (conv == NULL)
+		return NULL;
+
+	head = (heur_flow_state_t *)wmem_map_lookup(heur_flow_states, conv);
+	for (state = head; state != NULL; state = state->next) {
+		if (state->list == sub_dissectors)
+			return state;
+	}
+
+	if (PINFO_FD_VISITED(pinfo))
+		return NULL;
+
+	state = wmem_new(wmem_file_scope(), heur_flow_state_t);
+	state->next = head;
+	state->list = sub_dissectors;
+	state->probes = 0;
+	state->retired_at = 0;
+	state->nbits = sub_dissectors->num_indices;
+	state->rejected = (uint8_t *)wmem_alloc(wmem_file_scope(), (state->nbits + 7) / 8);
+	memset(state->rejected, 0xff, (state->nbits + 7) / 8);
+	wmem_map_insert(heur_flow_states, conv, state);
+	return state;
+}
+
+static inline bool
+heur_flow_state_rejected(const heur_flow_state_t *state, const heur_dtbl_entry_t *hdtbl_entry)
+{
+	return hdtbl_entry->list_index < state->nbits &&
+	       (state->rejected[hdtbl_entry->list_index / 8] & (1U << (hdtbl_entry->list_index % 8)));
+}
+
 bool
 dissector_try_heuristic(heur_dissector_list_t sub_dissectors, tvbuff_t *tvb,
 			packet_info *pinfo, proto_tree *tree, heur_dtbl_entry_t **heur_dtbl_entry, void *data)
@@ -3028,6 +3255,9 @@ dissector_try_heuristic(heur_dissector_list_t sub_dissectors, tvbuff_t *tvb,
 	bool               consumed_none;
 	unsigned           saved_desegment_len;
 	unsigned           saved_tree_count = tree ? tree->tree_data->count : 0;
+	heur_flow_state_t *flow_state = NULL;
+	uint8_t           *rejected_now = NULL;
+	bool               skip_rejected = false;
 
 	/* can_desegment is set to 2 by anyone which offers this api/service.
 	   then every time a subdissector is called it is decremented by one.
@@ -3052,6 +3282,18 @@ dissector_try_heuristic(heur_dissector_list_t sub_dissectors, tvbuff_t *tvb,
 
 	DISSECTOR_ASSERT(saved_layers_len < prefs.gui_max_tree_depth);
 
+	if (prefs.heuristic_probe_packets > 0) {
+		flow_state = heur_flow_state_get(sub_dissectors, pinfo);
+		if (flow_state != NULL) {
+			if (flow_state->retired_at != 0) {
+				skip_rejected = pinfo->num > flow_state->retired_at;
+			} else if (!PINFO_FD_VISITED(pinfo)) {
+				/* Still probing; note which entries reject this packet. */
+				rejected_now = (uint8_t *)wmem_alloc0(pinfo->pool, (flow_state->nbits + 7) / 8);
+			}
+		}
+	}
+
 	for (entry = sub_dissectors->dissectors; entry != NULL;
 	    entry = g_slist_next(entry)) {
 		/* XXX - why set this now and above? */
@@ -3066,6 +3308,16 @@ dissector_try_heuristic(heur_dissector_list_t sub_dissectors, tvbuff_t *tvb,
 			continue;
 		}
 
+		if (skip_rejected && heur_flow_state_rejected(flow_state, hdtbl_entry)) {
+			/*
+			 * It rejected the first packets of this flow;
+			 * don't bother trying it again.
+			 */
+			hdtbl_entry->skips++;
+			prev_entry = entry;
+			continue;
+		}
+
 		if (hdtbl_entry->protocol != NULL) {
 			proto_id = proto_get_id(hdtbl_entry->protocol);
 			/* do NOT change this behavior - wslua uses the protocol short name set here in order
@@ -3077,12 +3329,13 @@ dissector_try_heuristic(heur_dissector_list_t sub_dissectors, tvbuff_t *tvb,
 			 * Add the protocol name to the layers; we'll remove it
 			 * if the dissector fails.
 			 */
-			add_layer(pinfo, proto_id);
+			add_layer(pinfo, proto_id, tvb);
 		}
 
 		pinfo->heur_list_name = hdtbl_entry->list_name;
 
 		saved_desegment_len = pinfo->desegment_len;
+		hdtbl_entry->calls++;
 		len = (hdtbl_entry->dissector)(tvb, pinfo, tree, data);
 		consumed_none = len == 0 || (pinfo->desegment_len != saved_desegment_len && pinfo->desegment_offset == 0);
 		if (hdtbl_entry->protocol != NULL &&
@@ -3108,6 +3361,7 @@ dissector_try_heuristic(heur_dissector_list_t sub_dissectors, tvbuff_t *tvb,
 			}
 
 			*heur_dtbl_entry = hdtbl_entry;
+			hdtbl_entry->accepts++;
 
 			/* Bubble the matched entry to the top for faster search next time. */
 			if (prev_entry != NULL) {
@@ -3117,9 +3371,25 @@ dissector_try_heuristic(heur_dissector_list_t sub_dissectors, tvbuff_t *tvb,
 			status = true;
 			break;
 		}
+		if (rejected_now != NULL && hdtbl_entry->list_index < flow_state->nbits) {
+			rejected_now[hdtbl_entry->list_index / 8] |= 1U << (hdtbl_entry->list_index % 8);
+		}
 		prev_entry = entry;
 	}
 
+	if (rejected_now != NULL) {
+		/*
+		 * Entries that weren't tried (because they are disabled or
+		 * another one accepted the packet first) didn't reject it.
+		 */
+		for (unsigned i = 0; i < (flow_state->nbits + 7) / 8; i++) {
+			flow_state->rejected[i] &= rejected_now[i];
+		}
+		if (++flow_state->probes >= prefs.heuristic_probe_packets) {
+			flow_state->retired_at = pinfo->num;
+		}
+	}
+
 	pinfo->current_proto = saved_curr_proto;
 	pinfo->curr_proto_layer_num = saved_proto_layer_num;
 	pinfo->heur_list_name = saved_heur_list_name;
@@ -3263,6 +3533,36 @@ dissector_dump_heur_decodes(void)
 	dissector_all_heur_tables_foreach_table(dissector_dump_heur_decodes_display, NULL, NULL);
 }
 
+static void
+display_heur_dissector_table_stats(const char *table_name,
+    heur_dtbl_entry_t *hdtbl_entry, void *user_data)
+{
+	FILE *fh = (FILE *)user_data;
+
+	if (hdtbl_entry->calls == 0 && hdtbl_entry->skips == 0)
+		return;
+
+	fprintf(fh, "%s\t%s\t%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\n",
+	        table_name, hdtbl_entry->short_name,
+	        hdtbl_entry->calls, hdtbl_entry->accepts, hdtbl_entry->skips);
+}
+
+static void
+dissector_dump_heur_stats_display(const char *table_name, struct heur_dissector_list *listptr _U_, void *user_data)
+{
+	heur_dissector_table_foreach(table_name, display_heur_dissector_table_stats, user_data);
+}
+
+/*
+ * For each heuristic dissector that was used, dump its call counters
+ */
+void
+dissector_dump_heur_stats(FILE *fh)
+{
+	fprintf(fh, "List\tHeuristic\tCalls\tAccepted\tSkipped\n");
+	dissector_all_heur_tables_foreach_table(dissector_dump_heur_stats_display, fh, NULL);
+}
+
 
 heur_dissector_list_t
 register_heur_dissector_list_with_description(const char *name, const char *ui_name, const int proto)
@@ -3280,6 +3580,7 @@ register_heur_dissector_list_with_description(const char *name, const char *ui_n
 	sub_dissectors->protocol  = (proto == -1) ? NULL : find_protocol_by_id(proto);
 	sub_dissectors->ui_name = ui_name;
 	sub_dissectors->dissectors = NULL;	/* initially empty */
+	sub_dissectors->num_indices = 0;
 	g_hash_table_insert(heur_dissector_lists, (void *)name,
 			    (void *) sub_dissectors);
 	return sub_dissectors;
@@ -3725,7 +4026,7 @@ void call_heur_dissector_direct(heur_dtbl_entry_t *heur_dtbl_entry, tvbuff_t *tv
 		/* do NOT change this behavior - wslua uses the protocol short name set here in order
 			to determine which Lua-based heuristic dissector to call */
 		pinfo->current_proto = proto_get_protocol_short_name(heur_dtbl_entry->protocol);
-		add_layer(pinfo, proto_get_id(heur_dtbl_entry->protocol));
+		add_layer(pinfo, proto_get_id(heur_dtbl_entry->protocol), tvb);
 	}
 
 	pinfo->heur_list_name = heur_dtbl_entry->list_name;
@@ -11,6 +11,8 @@
 #ifndef __PACKET_H__
 #define __PACKET_H__
 
+#include <stdio.h>
+
 #include <wsutil/array.h>
 #include <wiretap/wtap_opttypes.h>
 #include "proto.h"
@@ -487,6 +489,10 @@ typedef struct heur_dtbl_entry {
 	char *short_name;     /* string used for "internal" use to uniquely identify heuristic */
 	bool enabled;
 	bool enabled_by_default;
+	unsigned list_index;  /* position of this entry in the per-flow rejection bitmaps of its list */
+	uint64_t calls;       /* number of times the dissector was called */
+	uint64_t accepts;     /* number of times it accepted the packet */
+	uint64_t skips;       /* number of times it was skipped for having rejected the flow */
 } heur_dtbl_entry_t;
 
 /** A protocol uses this function to register a heuristic sub-dissector list.
@@ -935,6 +941,13 @@ WS_DLL_PUBLIC void dissector_dump_decodes(void);
  */
 WS_DLL_PUBLIC void dissector_dump_heur_decodes(void);
 
+/*
+ * For each heuristic dissector that was called or skipped, dump how often
+ * it was called, accepted a packet, and was skipped by the per-flow
+ * rejection cache (see the "protocols.heuristic_probe_packets" preference).
+ */
+WS_DLL_PUBLIC void dissector_dump_heur_stats(FILE *fh);
+
 /*
  * postdissectors are to be called by packet-frame.c after every other
  * dissector has been called.
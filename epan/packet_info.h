@@ -40,6 +40,12 @@ struct conversation_element;
  */
 #define PINFO_HAS_TS            0x00000001  /**< time stamp */
 
+/** Information about a layer in packet_info.layers */
+typedef struct _layer_info {
+  uint32_t length;              /**< reported length of the data the layer was handed */
+  bool in_error_pkt;            /**< the layer is inside an {ICMP,CLNP,...} error packet */
+} layer_info_t;
+
 typedef struct _packet_info {
   const char *current_proto;        /**< name of protocol currently being dissected */
   struct epan_column_info *cinfo;   /**< Column formatting information */
@@ -136,6 +142,9 @@ typedef struct _packet_info {
   GHashTable *private_table;    /**< a hash table passed from one dissector to another */
 
   wmem_list_t *layers;          /**< layers of each protocol */
+  wmem_array_t *layer_info;     /**< layer_info_t of each layer, in the order
+                                     of layers; only the first
+                                     wmem_list_count(layers) entries are valid */
   wmem_map_t *proto_layers;     /** map of proto_id to curr_proto_layer_num. */
   uint8_t curr_layer_num;        /**< The current "depth" or layer number in the current frame */
   uint8_t curr_proto_layer_num;  /**< The current "depth" or layer number for this dissector in the current frame */
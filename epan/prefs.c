@@ -4017,6 +4017,23 @@ prefs_register_modules(void)
             "of cache entries to maintain. A 0 means no limit.",
             10, &prefs.ignore_dup_frames_cache_entries);
 
+    prefs_register_uint_preference(protocols_module, "heuristic_probe_packets",
+            "Stop trying heuristic dissectors that rejected the first packets of a conversation",
+            "If nonzero, the number of packets of a conversation that each heuristic "
+            "dissector is tried on. Heuristic dissectors that rejected all of them are "
+            "not tried on the rest of the conversation, which speeds up dissection of "
+            "traffic on unknown ports. A 0 means always try every heuristic dissector.",
+            10, &prefs.heuristic_probe_packets);
+
+    register_string_like_preference(protocols_module, "filter_index_fields",
+            "Fields to index for display filtering",
+            "Fields, separated by commas or spaces, whose values are indexed while a "
+            "capture file is read, such as \"ip.addr tcp.port tcp.stream\". Display "
+            "filters that test those fields for equality or existence are then applied "
+            "without dissecting every frame. Only list fields whose values don't depend "
+            "on later frames. Empty means no index is built.",
+            &prefs.filter_index_fields, PREF_STRING, NULL, true);
+
 
     /* Obsolete preferences
      * These "modules" were reorganized/renamed to correspond to their GUI
@@ -4463,6 +4480,9 @@ pre_init_prefs(void)
     prefs.display_abs_time_ascii = ABS_TIME_ASCII_TREE;
     prefs.ignore_dup_frames = false;
     prefs.ignore_dup_frames_cache_entries = 10000;
+    prefs.heuristic_probe_packets = 0;
+    g_free(prefs.filter_index_fields);
+    prefs.filter_index_fields = g_strdup("");
 
     /* set the default values for the io graph dialog */
     prefs.gui_io_graph_automatic_update = true;
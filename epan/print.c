@@ -26,6 +26,7 @@
 #include <epan/prefs.h>
 #include <epan/print.h>
 #include <wsutil/array.h>
+#include <wsutil/arrow_ipc.h>
 #include <wsutil/json_dumper.h>
 #include <wsutil/filesystem.h>
 #include <wsutil/utf8_entities.h>
@@ -62,6 +63,10 @@ typedef struct {
     bool            print_text;
     proto_node_children_grouper_func node_children_grouper;
     json_dumper    *dumper;
+    /* Packet scoped arena and scratch buffer, so that writing keys and
+     * values does not go through the heap for every node. */
+    wmem_allocator_t *pool;
+    wmem_strbuf_t  *scratch;
 } write_json_data;
 
 typedef struct {
@@ -79,6 +84,8 @@ struct _output_fields {
     GPtrArray    *field_dfilters;
     GHashTable   *field_indicies;
     GPtrArray   **field_values;
+    arrow_ipc_type_e *arrow_types;
+    unsigned     *arrow_counts;
     wmem_map_t   *protocolfilter;
     char          quote;
     bool          escape;
@@ -93,9 +100,36 @@ static struct data_source* get_field_data_source(GSList *src_list, field_info *f
 static const uint8_t *get_field_data(GSList *src_list, field_info *fi);
 static void pdml_write_field_hex_value(write_pdml_data *pdata, field_info *fi);
 static void json_write_field_hex_value(write_json_data *pdata, field_info *fi);
+#define JSON_VALUE_BUF_LEN  (20 + 1 + 1)   /* sign, 2^64-1 in decimal, NUL */
+static const char *json_field_value_repr(write_json_data *pdata, field_info *fi, char *buf);
+static void json_set_member_name_parts(write_json_data *pdata, const char *prefix, const char *name, const char *suffix);
 static bool print_hex_data_buffer(print_stream_t *stream, const unsigned char *cp,
                                       unsigned length, packet_char_enc encoding,
                                       unsigned hexdump_options);
+static void output_fields_prepare_indicies(output_fields_t *fields)
+{
+    unsigned i;
+
+    if (NULL != fields->field_indicies) {
+        return;
+    }
+
+    /* Prepare a lookup table from string abbreviation for field to its index. */
+    fields->field_indicies = g_hash_table_new(g_str_hash, g_str_equal);
+
+    i = 0;
+    while (i < fields->fields->len) {
+        char *field = (char *)g_ptr_array_index(fields->fields, i);
+        /* Store field indicies +1 so that zero is not a valid value,
+         * and can be distinguished from NULL as a pointer.
+         */
+        ++i;
+        if (proto_registrar_get_byname(field)) {
+            g_hash_table_insert(fields->field_indicies, field, GUINT_TO_POINTER(i));
+        }
+    }
+}
+
 static void write_specified_fields(fields_format format,
                                    output_fields_t *fields,
                                    epan_dissect_t *edt, column_info *cinfo,
@@ -373,6 +407,8 @@ write_ek_proto_tree(output_fields_t* fields,
     };
 
     data.dumper = &dumper;
+    data.pool = edt->pi.pool;
+    data.scratch = wmem_strbuf_new_sized(data.pool, 128);
 
     json_dumper_begin_object(&dumper);
     json_dumper_set_member_name(&dumper, "index");
@@ -728,20 +764,17 @@ write_json_finale(json_dumper *dumper)
 static void
 write_json_index(json_dumper *dumper, epan_dissect_t *edt)
 {
-    char ts[30];
+    char ts[40];
     struct tm * timeinfo;
-    char* str;
 
     timeinfo = localtime(&edt->pi.abs_ts.secs);
     if (timeinfo != NULL) {
-        strftime(ts, sizeof(ts), "%Y-%m-%d", timeinfo);
+        strftime(ts, sizeof(ts), "packets-%Y-%m-%d", timeinfo);
     } else {
-        (void) g_strlcpy(ts, "XXXX-XX-XX", sizeof(ts)); /* XXX - better way of saying "Not representable"? */
+        (void) g_strlcpy(ts, "packets-XXXX-XX-XX", sizeof(ts)); /* XXX - better way of saying "Not representable"? */
     }
     json_dumper_set_member_name(dumper, "_index");
-    str = ws_strdup_printf("packets-%s", ts);
-    json_dumper_value_string(dumper, str);
-    g_free(str);
+    json_dumper_value_string(dumper, ts);
 }
 
 void
@@ -755,6 +788,8 @@ write_json_proto_tree(output_fields_t* fields,
     write_json_data data;
 
     data.dumper = dumper;
+    data.pool = edt->pi.pool;
+    data.scratch = wmem_strbuf_new_sized(data.pool, 128);
 
     json_dumper_begin_object(dumper);
     write_json_index(dumper, edt);
@@ -829,16 +864,14 @@ write_json_proto_node_list(GSList *proto_node_list_head, write_json_data *pdata)
         bool is_filtered = pdata->filter != NULL && !check_protocolfilter(pdata->filter, json_key, &filter_flags);
 
         field_info *fi = first_value->finfo;
-        char *value_string_repr = fvalue_to_string_repr(NULL, fi->value, FTREPR_JSON, fi->hfinfo->display);
+        char value_buf[JSON_VALUE_BUF_LEN];
         bool has_children = any_has_children(node_values_list);
 
         // We assume all values of a json key have roughly the same layout. Thus we can use the first value to derive
         // attributes of all the values.
-        bool has_value = value_string_repr != NULL;
+        bool has_value = json_field_value_repr(pdata, fi, value_buf) != NULL;
         bool is_pseudo_text_field = fi->hfinfo->id == hf_text_only;
 
-        wmem_free(NULL, value_string_repr); // fvalue_to_string_repr returns allocated buffer
-
         // "-x" command line option. A "_raw" suffix is added to the json key so the textual value can be printed
         // with the original json key. If both hex and text writing are enabled the raw information of fields whose
         // length is equal to 0 is not written to the output. If the field is a special text pseudo field no raw
@@ -906,9 +939,7 @@ write_json_proto_node(GSList *node_values_head,
     // Retrieve json key from first value.
     proto_node *first_value = (proto_node *) node_values_head->data;
     const char *json_key = proto_node_to_json_key(first_value);
-    char* json_key_suffix = ws_strdup_printf("%s%s", json_key, suffix);
-    json_dumper_set_member_name(pdata->dumper, json_key_suffix);
-    g_free(json_key_suffix);
+    json_set_member_name_parts(pdata, NULL, json_key, *suffix ? suffix : NULL);
     write_json_proto_node_value_list(node_values_head, value_writer, pdata);
 }
 
@@ -1015,14 +1046,11 @@ static void
 write_json_proto_node_value(proto_node *node, write_json_data *pdata)
 {
     field_info *fi = node->finfo;
-    // Get the actual value of the node as a string.
-    char *value_string_repr = fvalue_to_string_repr(NULL, fi->value, FTREPR_JSON, fi->hfinfo->display);
+    char value_buf[JSON_VALUE_BUF_LEN];
 
     //TODO: Have FTREPR_JSON include quotes where appropriate and use json_dumper_value_anyf() here,
     // so we can output booleans and numbers and not only strings.
-    json_dumper_value_string(pdata->dumper, value_string_repr);
-
-    wmem_free(NULL, value_string_repr);
+    json_dumper_value_string(pdata->dumper, json_field_value_repr(pdata, fi, value_buf));
 }
 
 /**
@@ -1138,31 +1166,24 @@ proto_node_to_json_key(proto_node *node)
 }
 
 static bool
-ek_check_protocolfilter(wmem_map_t *protocolfilter, const char *str, pf_flags *filter_flags)
+ek_check_protocolfilter(write_json_data *pdata, const char *str, pf_flags *filter_flags)
 {
-    char *str_escaped = NULL;
-    bool check;
-    int i;
+    wmem_map_t *protocolfilter = pdata->filter;
+    const char *str_escaped = NULL;
 
     if (check_protocolfilter(protocolfilter, str, filter_flags))
         return true;
 
     /* to to thread the '.' and '_' equally. The '.' is replace by print_escaped_ek for '_' */
     if (str != NULL && strlen(str) > 0) {
-        str_escaped = g_strdup(str);
-
-        i = 0;
-        while (str_escaped[i] != '\0') {
-            if (str_escaped[i] == '.') {
-                str_escaped[i] = '_';
-            }
-            i++;
+        wmem_strbuf_truncate(pdata->scratch, 0);
+        for (; *str != '\0'; str++) {
+            wmem_strbuf_append_c(pdata->scratch, *str == '.' ? '_' : *str);
         }
+        str_escaped = wmem_strbuf_get_str(pdata->scratch);
     }
 
-    check = check_protocolfilter(protocolfilter, str_escaped, filter_flags);
-    g_free(str_escaped);
-    return check;
+    return check_protocolfilter(protocolfilter, str_escaped, filter_flags);
 }
 
 /**
@@ -1176,18 +1197,70 @@ write_ek_summary(column_info *cinfo, write_json_data* pdata)
     for (i = 0; i < cinfo->num_cols; i++) {
         if (!get_column_visible(i))
             continue;
-        json_dumper_set_member_name(pdata->dumper, g_ascii_strdown(cinfo->columns[i].col_title, -1));
+        wmem_strbuf_truncate(pdata->scratch, 0);
+        for (const char *p = cinfo->columns[i].col_title; *p != '\0'; p++) {
+            wmem_strbuf_append_c(pdata->scratch, g_ascii_tolower(*p));
+        }
+        json_dumper_set_member_name(pdata->dumper, wmem_strbuf_get_str(pdata->scratch));
         json_dumper_value_string(pdata->dumper, get_column_text(cinfo, i));
     }
 }
 
+/* Instances of one EK attribute (fields sharing an abbrev), in tree order. */
+typedef struct {
+    proto_node  *first;
+    proto_node **more;          /* further instances, in the packet scope */
+    unsigned     num_more;
+    unsigned     max_more;
+} ek_attr_t;
+
+typedef struct {
+    wmem_map_t   *by_abbrev;    /* abbrev -> index + 1 into attrs */
+    wmem_array_t *attrs;        /* ek_attr_t, in order of first appearance */
+} ek_attr_table_t;
+
+static inline unsigned
+ek_attr_count(const ek_attr_t *attr)
+{
+    return 1 + attr->num_more;
+}
+
+static inline proto_node *
+ek_attr_instance(const ek_attr_t *attr, unsigned i)
+{
+    return i == 0 ? attr->first : attr->more[i - 1];
+}
+
+static void
+ek_attr_add(ek_attr_table_t *attr_table, proto_node *node, write_json_data *pdata)
+{
+    const char *abbrev = PNODE_FINFO(node)->hfinfo->abbrev;
+    unsigned idx = GPOINTER_TO_UINT(wmem_map_lookup(attr_table->by_abbrev, abbrev));
+    ek_attr_t *attr;
+
+    if (idx == 0) {
+        ek_attr_t new_attr = { node, NULL, 0, 0 };
+        wmem_array_append_one(attr_table->attrs, new_attr);
+        wmem_map_insert(attr_table->by_abbrev, abbrev,
+                        GUINT_TO_POINTER(wmem_array_get_count(attr_table->attrs)));
+        return;
+    }
+
+    attr = (ek_attr_t *)wmem_array_index(attr_table->attrs, idx - 1);
+    if (attr->num_more == attr->max_more) {
+        attr->max_more = attr->max_more ? 2 * attr->max_more : 4;
+        attr->more = (proto_node **)wmem_realloc(pdata->pool, attr->more,
+                                                 attr->max_more * sizeof(proto_node *));
+    }
+    attr->more[attr->num_more++] = node;
+}
+
 /* Write out a tree's data, and any child nodes, as JSON for EK */
 static void
 // NOLINTNEXTLINE(misc-no-recursion)
-ek_fill_attr(proto_node *node, GHashTable *attr_table, write_json_data *pdata)
+ek_fill_attr(proto_node *node, ek_attr_table_t *attr_table, write_json_data *pdata)
 {
     field_info *fi         = NULL;
-    GSList *attr_instances = NULL;
 
     proto_node *current_node = node->first_child;
     while (current_node != NULL) {
@@ -1196,16 +1269,13 @@ ek_fill_attr(proto_node *node, GHashTable *attr_table, write_json_data *pdata)
         /* dissection with an invisible proto tree? */
         ws_assert(fi);
 
-        attr_instances = (GSList *) g_hash_table_lookup(attr_table, fi->hfinfo->abbrev);
-        attr_instances = g_slist_append(attr_instances, current_node);
-        // Update instance list for this attr in hash table
-        g_hash_table_insert(attr_table, g_strdup(fi->hfinfo->abbrev), attr_instances);
+        ek_attr_add(attr_table, current_node, pdata);
 
         /* Field, recurse through children*/
         if (fi->hfinfo->type != FT_PROTOCOL && current_node->first_child != NULL) {
             if (pdata->filter != NULL) {
                 pf_flags filter_flags = PF_NONE;
-                if (ek_check_protocolfilter(pdata->filter, fi->hfinfo->abbrev, &filter_flags)) {
+                if (ek_check_protocolfilter(pdata, fi->hfinfo->abbrev, &filter_flags)) {
                     wmem_map_t *_filter = NULL;
                     /* Remove protocol filter for children, if children should be included */
                     if ((filter_flags&PF_INCLUDE_CHILDREN) == PF_INCLUDE_CHILDREN) {
@@ -1236,20 +1306,16 @@ ek_fill_attr(proto_node *node, GHashTable *attr_table, write_json_data *pdata)
 }
 
 static void
-ek_write_name(proto_node *pnode, char* suffix, write_json_data* pdata)
+ek_write_name(proto_node *pnode, const char* suffix, write_json_data* pdata)
 {
     field_info *fi = PNODE_FINFO(pnode);
-    char       *str;
 
     if (fi->hfinfo->parent != -1) {
         header_field_info* parent = proto_registrar_get_nth(fi->hfinfo->parent);
-        str = ws_strdup_printf("%s_%s%s", parent->abbrev, fi->hfinfo->abbrev, suffix ? suffix : "");
-        json_dumper_set_member_name(pdata->dumper, str);
+        json_set_member_name_parts(pdata, parent->abbrev, fi->hfinfo->abbrev, suffix);
     } else {
-        str = ws_strdup_printf("%s%s", fi->hfinfo->abbrev, suffix ? suffix : "");
-        json_dumper_set_member_name(pdata->dumper, str);
+        json_set_member_name_parts(pdata, NULL, fi->hfinfo->abbrev, suffix);
     }
-    g_free(str);
 }
 
 static void
@@ -1262,7 +1328,7 @@ static void
 ek_write_field_value(field_info *fi, write_json_data* pdata)
 {
     char label_str[ITEM_LABEL_LENGTH];
-    char *dfilter_string;
+    char value_buf[JSON_VALUE_BUF_LEN];
 
     /* Text label */
     if (fi->hfinfo->id == hf_text_only && fi->rep) {
@@ -1286,72 +1352,63 @@ ek_write_field_value(field_info *fi, write_json_data* pdata)
                 json_dumper_value_anyf(pdata->dumper, "false");
             break;
         default:
-            dfilter_string = fvalue_to_string_repr(NULL, fi->value, FTREPR_JSON, fi->hfinfo->display);
-            json_dumper_value_string(pdata->dumper, dfilter_string);
-            wmem_free(NULL, dfilter_string);
+            json_dumper_value_string(pdata->dumper, json_field_value_repr(pdata, fi, value_buf));
             break;
         }
     }
 }
 
 static void
-ek_write_attr_hex(GSList *attr_instances, write_json_data *pdata)
+ek_write_attr_hex(const ek_attr_t *attr, write_json_data *pdata)
 {
-    GSList *current_node = attr_instances;
-    proto_node *pnode    = (proto_node *) current_node->data;
-    field_info *fi       = NULL;
+    unsigned count = ek_attr_count(attr);
 
     // Raw name
-    ek_write_name(pnode, "_raw", pdata);
+    ek_write_name(attr->first, "_raw", pdata);
 
-    if (g_slist_length(attr_instances) > 1) {
+    if (count > 1) {
         json_dumper_begin_array(pdata->dumper);
     }
 
     // Raw value(s)
-    while (current_node != NULL) {
-        pnode = (proto_node *) current_node->data;
-        fi    = PNODE_FINFO(pnode);
-
-        ek_write_hex(fi, pdata);
-
-        current_node = current_node->next;
+    for (unsigned i = 0; i < count; i++) {
+        ek_write_hex(PNODE_FINFO(ek_attr_instance(attr, i)), pdata);
     }
 
-    if (g_slist_length(attr_instances) > 1) {
+    if (count > 1) {
         json_dumper_end_array(pdata->dumper);
     }
 }
 
 static void
 // NOLINTNEXTLINE(misc-no-recursion)
-ek_write_attr(GSList *attr_instances, write_json_data *pdata)
+ek_write_attr(const ek_attr_t *attr, write_json_data *pdata)
 {
-    GSList *current_node  = attr_instances;
-    proto_node *pnode     = (proto_node *) current_node->data;
+    unsigned count        = ek_attr_count(attr);
+    proto_node *pnode     = attr->first;
     field_info *fi        = PNODE_FINFO(pnode);
     pf_flags filter_flags = PF_NONE;
 
     // Hex dump -x
     if (pdata->print_hex && fi && fi->length > 0 && fi->hfinfo->id != hf_text_only) {
-        ek_write_attr_hex(attr_instances, pdata);
+        ek_write_attr_hex(attr, pdata);
     }
 
     // Print attr name
     ek_write_name(pnode, NULL, pdata);
 
-    if (g_slist_length(attr_instances) > 1) {
+    if (count > 1) {
         json_dumper_begin_array(pdata->dumper);
     }
 
-    while (current_node != NULL) {
-        pnode = (proto_node *) current_node->data;
+    for (unsigned i = 0; i < count; i++) {
+        pnode = ek_attr_instance(attr, i);
         fi    = PNODE_FINFO(pnode);
 
         /* Field */
         if (fi->hfinfo->type != FT_PROTOCOL) {
             if (pdata->filter != NULL
-                && !ek_check_protocolfilter(pdata->filter, fi->hfinfo->abbrev, &filter_flags)) {
+                && !ek_check_protocolfilter(pdata, fi->hfinfo->abbrev, &filter_flags)) {
 
                 /* print dummy field */
                 json_dumper_begin_object(pdata->dumper);
@@ -1366,7 +1423,7 @@ ek_write_attr(GSList *attr_instances, write_json_data *pdata)
             json_dumper_begin_object(pdata->dumper);
 
             if (pdata->filter != NULL) {
-                if (ek_check_protocolfilter(pdata->filter, fi->hfinfo->abbrev, &filter_flags)) {
+                if (ek_check_protocolfilter(pdata, fi->hfinfo->abbrev, &filter_flags)) {
                     wmem_map_t *_filter = NULL;
                     /* Remove protocol filter for children, if children should be included */
                     if ((filter_flags&PF_INCLUDE_CHILDREN) == PF_INCLUDE_CHILDREN) {
@@ -1391,48 +1448,29 @@ ek_write_attr(GSList *attr_instances, write_json_data *pdata)
 
             json_dumper_end_object(pdata->dumper);
         }
-
-        current_node = current_node->next;
     }
 
-    if (g_slist_length(attr_instances) > 1) {
+    if (count > 1) {
         json_dumper_end_array(pdata->dumper);
     }
 }
 
-// NOLINTNEXTLINE(misc-no-recursion)
-void process_ek_attrs(gpointer key _U_, gpointer value, gpointer pdata)
-{
-    GSList *attr_instances = (GSList *) value;
-    ek_write_attr(attr_instances, pdata);
-}
-
 /* Write out a tree's data, and any child nodes, as JSON for EK */
 static void
 // NOLINTNEXTLINE(misc-no-recursion)
 proto_tree_write_node_ek(proto_node *node, write_json_data *pdata)
 {
-    GHashTable *attr_table  = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
-    GHashTableIter iter;
-    gpointer key, value;
-    ek_fill_attr(node, attr_table, pdata);
-
-    // Print attributes
-    g_hash_table_iter_init(&iter, attr_table);
-    while (g_hash_table_iter_next (&iter, &key, &value)) {
-        process_ek_attrs(key, value, pdata);
-        g_hash_table_iter_remove(&iter);
-        /* We lookup a list in the table, append to it, and re-insert it; as
-         * g_slist_append() can change the start pointer of the list we can't
-         * just append to the list without replacing the old value. In turn,
-         * that means we can't set the value_destroy_func when creating
-         * the hash table, because on re-insertion that would destroy the
-         * nodes of the old list, which are still being used by the new list.
-         * So free it here.
-         */
-        g_slist_free((GSList*)value);
+    ek_attr_table_t attr_table;
+
+    /* Everything lives in the packet scope, and is freed with it. */
+    attr_table.by_abbrev = wmem_map_new(pdata->pool, g_str_hash, g_str_equal);
+    attr_table.attrs = wmem_array_new(pdata->pool, sizeof(ek_attr_t));
+    ek_fill_attr(node, &attr_table, pdata);
+
+    // Print attributes, in the order in which they first appear
+    for (unsigned i = 0; i < wmem_array_get_count(attr_table.attrs); i++) {
+        ek_write_attr((const ek_attr_t *)wmem_array_index(attr_table.attrs, i), pdata);
     }
-    g_hash_table_destroy(attr_table);
 }
 
 /* Print info for a 'geninfo' pseudo-protocol. This is required by
@@ -1845,6 +1883,58 @@ pdml_write_field_hex_value(write_pdml_data *pdata, field_info *fi)
     }
 }
 
+/*
+ * Returns the FTREPR_JSON representation of a field value, or NULL if it
+ * has none. Decimal integers are formatted into "buf" (at least
+ * JSON_VALUE_BUF_LEN bytes), anything else into the packet scope;
+ * nothing needs to be freed.
+ */
+static const char *
+json_field_value_repr(write_json_data *pdata, field_info *fi, char *buf)
+{
+    enum ftenum type = fvalue_type_ftenum(fi->value);
+    int display = FIELD_DISPLAY(fi->hfinfo->display);
+    uint64_t uval;
+    int64_t sval;
+
+    if (FT_IS_INT(type) && fvalue_to_sinteger64(fi->value, &sval) == FT_OK) {
+        if (sval < 0) {
+            buf[0] = '-';
+            uint64_to_str_buf(-(uint64_t)sval, buf + 1, JSON_VALUE_BUF_LEN - 1);
+        } else {
+            uint64_to_str_buf((uint64_t)sval, buf, JSON_VALUE_BUF_LEN);
+        }
+        return buf;
+    }
+    if (FT_IS_UINT(type) && type != FT_CHAR &&
+            display != BASE_HEX && display != BASE_HEX_DEC &&
+            fvalue_to_uinteger64(fi->value, &uval) == FT_OK) {
+        uint64_to_str_buf(uval, buf, JSON_VALUE_BUF_LEN);
+        return buf;
+    }
+    return fvalue_to_string_repr(pdata->pool, fi->value, FTREPR_JSON, fi->hfinfo->display);
+}
+
+/* Sets the member name "prefix" "name" "suffix" without allocating. */
+static void
+json_set_member_name_parts(write_json_data *pdata, const char *prefix, const char *name, const char *suffix)
+{
+    if (!prefix && !suffix) {
+        json_dumper_set_member_name(pdata->dumper, name);
+        return;
+    }
+    wmem_strbuf_truncate(pdata->scratch, 0);
+    if (prefix) {
+        wmem_strbuf_append(pdata->scratch, prefix);
+        wmem_strbuf_append_c(pdata->scratch, '_');
+    }
+    wmem_strbuf_append(pdata->scratch, name);
+    if (suffix) {
+        wmem_strbuf_append(pdata->scratch, suffix);
+    }
+    json_dumper_set_member_name(pdata->dumper, wmem_strbuf_get_str(pdata->scratch));
+}
+
 static void
 json_write_field_hex_value(write_json_data *pdata, field_info *fi)
 {
@@ -1901,17 +1991,15 @@ json_write_field_hex_value(write_json_data *pdata, field_info *fi)
 
     if (pd) {
         int i;
-        char* str = (char*)g_malloc(fi->length*2 + 1);    /* no need to zero */
         static const char hex[] = "0123456789abcdef";
         /* Print a simple hex dump */
+        wmem_strbuf_truncate(pdata->scratch, 0);
         for (i = 0; i < fi->length; i++) {
             uint8_t c = pd[i];
-            str[2 * i] = hex[c >> 4];
-            str[2 * i + 1] = hex[c & 0xf];
+            wmem_strbuf_append_c(pdata->scratch, hex[c >> 4]);
+            wmem_strbuf_append_c(pdata->scratch, hex[c & 0xf]);
         }
-        str[2 * fi->length] = '\0';
-        json_dumper_value_string(pdata->dumper, str);
-        g_free(str);
+        json_dumper_value_string(pdata->dumper, wmem_strbuf_get_str(pdata->scratch));
     } else {
         // Should this be null instead of the empty string?
         json_dumper_value_string(pdata->dumper, "");
@@ -2015,6 +2103,9 @@ void output_fields_free(output_fields_t* fields)
             g_free(fields->field_values);
         }
 
+        g_free(fields->arrow_types);
+        g_free(fields->arrow_counts);
+
         for (i = 0; i < fields->fields->len; ++i) {
             char* field = (char *)g_ptr_array_index(fields->fields,i);
             g_free(field);
@@ -2453,22 +2544,7 @@ static void write_specified_fields(fields_format format, output_fields_t *fields
     data.fields = fields;
     data.edt = edt;
 
-    if (NULL == fields->field_indicies) {
-        /* Prepare a lookup table from string abbreviation for field to its index. */
-        fields->field_indicies = g_hash_table_new(g_str_hash, g_str_equal);
-
-        i = 0;
-        while (i < fields->fields->len) {
-            char *field = (char *)g_ptr_array_index(fields->fields, i);
-            /* Store field indicies +1 so that zero is not a valid value,
-             * and can be distinguished from NULL as a pointer.
-             */
-            ++i;
-            if (proto_registrar_get_byname(field)) {
-                g_hash_table_insert(fields->field_indicies, field, GUINT_TO_POINTER(i));
-            }
-        }
-    }
+    output_fields_prepare_indicies(fields);
 
     /* Array buffer to store values for this packet              */
     /*  Allocate an array for the 'GPtrarray *' the first time   */
@@ -2627,6 +2703,240 @@ void write_fields_finale(output_fields_t* fields _U_ , FILE *fh _U_)
     /* Nothing to do */
 }
 
+/*
+ * Arrow IPC output of the fields selected with -e. Each field is a typed
+ * column chosen from the ftenum of its hf; fields that share an abbrev
+ * but not a type, and display filter expressions, fall back to strings
+ * formatted as in "-T fields". With occurrence=a each column is a list of
+ * all occurrences, otherwise it holds the first or last occurrence.
+ */
+static arrow_ipc_type_e
+arrow_type_for_ftenum(enum ftenum type)
+{
+    switch (type) {
+    case FT_NONE:
+    case FT_BOOLEAN:
+        return ARROW_IPC_TYPE_BOOL;
+    case FT_INT8:
+    case FT_INT16:
+    case FT_INT24:
+    case FT_INT32:
+        return ARROW_IPC_TYPE_INT32;
+    case FT_UINT8:
+    case FT_UINT16:
+    case FT_UINT24:
+    case FT_UINT32:
+    case FT_FRAMENUM:
+        return ARROW_IPC_TYPE_UINT32;
+    case FT_INT40:
+    case FT_INT48:
+    case FT_INT56:
+    case FT_INT64:
+        return ARROW_IPC_TYPE_INT64;
+    case FT_UINT40:
+    case FT_UINT48:
+    case FT_UINT56:
+    case FT_UINT64:
+        return ARROW_IPC_TYPE_UINT64;
+    case FT_FLOAT:
+    case FT_DOUBLE:
+        return ARROW_IPC_TYPE_DOUBLE;
+    case FT_ABSOLUTE_TIME:
+        return ARROW_IPC_TYPE_TIMESTAMP_NS;
+    case FT_RELATIVE_TIME:
+        return ARROW_IPC_TYPE_DURATION_NS;
+    default:
+        return ARROW_IPC_TYPE_UTF8;
+    }
+}
+
+static arrow_ipc_type_e
+arrow_type_for_field(const char *field)
+{
+    header_field_info *hfinfo = proto_registrar_get_byname(field);
+    arrow_ipc_type_e type;
+
+    if (!hfinfo) {
+        return ARROW_IPC_TYPE_UTF8;
+    }
+
+    /* Rewind to the first hf of that name. */
+    while (hfinfo->same_name_prev_id != -1) {
+        hfinfo = proto_registrar_get_nth(hfinfo->same_name_prev_id);
+    }
+
+    type = arrow_type_for_ftenum(hfinfo->type);
+    for (hfinfo = hfinfo->same_name_next; hfinfo; hfinfo = hfinfo->same_name_next) {
+        if (arrow_type_for_ftenum(hfinfo->type) != type) {
+            return ARROW_IPC_TYPE_UTF8;
+        }
+    }
+    return type;
+}
+
+arrow_ipc_writer *write_arrow_preamble(output_fields_t* fields, FILE *fh)
+{
+    arrow_ipc_writer *writer;
+    size_t i;
+
+    ws_assert(fields);
+    ws_assert(fh);
+    ws_assert(fields->fields);
+
+    writer = arrow_ipc_writer_new(fh, 0);
+    fields->arrow_types = g_new(arrow_ipc_type_e, fields->fields->len);
+    fields->arrow_counts = g_new0(unsigned, fields->fields->len);
+    for (i = 0; i < fields->fields->len; ++i) {
+        const char *field = (const char *)g_ptr_array_index(fields->fields, i);
+
+        fields->arrow_types[i] = arrow_type_for_field(field);
+        arrow_ipc_writer_add_column(writer, field, fields->arrow_types[i],
+                                    fields->occurrence == 'a');
+    }
+    return writer;
+}
+
+static bool
+arrow_want_occurrence(output_fields_t *fields, unsigned indx)
+{
+    /* The writer replaces the value of scalar columns, which gives 'l'. */
+    return fields->occurrence != 'f' || fields->arrow_counts[indx]++ == 0;
+}
+
+static void
+write_arrow_fvalue(output_fields_t *fields, arrow_ipc_writer *writer, unsigned indx, const fvalue_t *fv)
+{
+    uint64_t uval;
+    int64_t sval;
+    double dval;
+    const nstime_t *ts;
+
+    switch (fields->arrow_types[indx]) {
+    case ARROW_IPC_TYPE_BOOL:
+    case ARROW_IPC_TYPE_UINT32:
+    case ARROW_IPC_TYPE_UINT64:
+        if (fvalue_to_uinteger64(fv, &uval) == FT_OK) {
+            arrow_ipc_writer_append_uint64(writer, indx, uval);
+        }
+        break;
+    case ARROW_IPC_TYPE_INT32:
+    case ARROW_IPC_TYPE_INT64:
+        if (fvalue_to_sinteger64(fv, &sval) == FT_OK) {
+            arrow_ipc_writer_append_int64(writer, indx, sval);
+        }
+        break;
+    case ARROW_IPC_TYPE_DOUBLE:
+        if (fvalue_to_double(fv, &dval) == FT_OK) {
+            arrow_ipc_writer_append_double(writer, indx, dval);
+        }
+        break;
+    case ARROW_IPC_TYPE_TIMESTAMP_NS:
+    case ARROW_IPC_TYPE_DURATION_NS:
+        ts = fvalue_get_time((fvalue_t *)fv);
+        arrow_ipc_writer_append_int64(writer, indx, (int64_t)ts->secs * INT64_C(1000000000) + ts->nsecs);
+        break;
+    case ARROW_IPC_TYPE_UTF8:
+        ws_assert_not_reached();
+        break;
+    }
+}
+
+typedef struct {
+    output_fields_t  *fields;
+    epan_dissect_t   *edt;
+    arrow_ipc_writer *writer;
+} write_arrow_data_t;
+
+static void proto_tree_write_node_arrow(proto_node *node, void *data)
+{
+    write_arrow_data_t *call_data = (write_arrow_data_t *)data;
+    output_fields_t *fields = call_data->fields;
+    field_info *fi = PNODE_FINFO(node);
+
+    /* check for a faked item with an invisible tree */
+    if (fi) {
+        void *field_index = g_hash_table_lookup(fields->field_indicies, fi->hfinfo->abbrev);
+
+        if (NULL != field_index) {
+            unsigned indx = GPOINTER_TO_UINT(field_index) - 1;
+
+            if (arrow_want_occurrence(fields, indx)) {
+                if (fields->arrow_types[indx] == ARROW_IPC_TYPE_UTF8) {
+                    char *str = get_node_field_value(fi, call_data->edt);
+                    if (str) {
+                        arrow_ipc_writer_append_string(call_data->writer, indx, str, -1);
+                        g_free(str);
+                    }
+                } else if (fi->hfinfo->type == FT_NONE) {
+                    /* Present, like the "1" of "-T fields" */
+                    arrow_ipc_writer_append_uint64(call_data->writer, indx, 1);
+                } else {
+                    write_arrow_fvalue(fields, call_data->writer, indx, fi->value);
+                }
+            }
+        }
+    }
+
+    /* Recurse here. */
+    if (node->first_child != NULL) {
+        proto_tree_children_foreach(node, proto_tree_write_node_arrow, call_data);
+    }
+}
+
+bool write_arrow_proto_tree(output_fields_t* fields, epan_dissect_t *edt, arrow_ipc_writer *writer)
+{
+    write_arrow_data_t data;
+    unsigned i;
+
+    ws_assert(fields);
+    ws_assert(fields->fields);
+    ws_assert(fields->arrow_types);
+    ws_assert(edt);
+    ws_assert(writer);
+
+    output_fields_prepare_indicies(fields);
+    memset(fields->arrow_counts, 0, fields->fields->len * sizeof(unsigned));
+
+    /* Display filter expressions; their values are always strings. */
+    for (i = 0; i < fields->fields->len; ++i) {
+        dfilter_t *dfilter = (dfilter_t *)g_ptr_array_index(fields->field_dfilters, i);
+
+        if (dfilter != NULL) {
+            GPtrArray *fvals = NULL;
+            bool passed = dfilter_apply_full(dfilter, edt->tree, &fvals);
+            char *str;
+            if (fvals != NULL) {
+                int len = g_ptr_array_len(fvals);
+                for (int j = 0; j < len; ++j) {
+                    if (arrow_want_occurrence(fields, i)) {
+                        str = fvalue_to_string_repr(NULL, fvals->pdata[j], FTREPR_DISPLAY, BASE_NONE);
+                        arrow_ipc_writer_append_string(writer, i, str, -1);
+                        wmem_free(NULL, str);
+                    }
+                }
+                g_ptr_array_unref(fvals);
+            } else if (passed) {
+                arrow_ipc_writer_append_string(writer, i, UTF8_CHECK_MARK, -1);
+            }
+        }
+    }
+
+    data.fields = fields;
+    data.edt = edt;
+    data.writer = writer;
+    proto_tree_children_foreach(edt->tree, proto_tree_write_node_arrow, &data);
+
+    return arrow_ipc_writer_end_row(writer);
+}
+
+bool write_arrow_finale(output_fields_t* fields _U_, arrow_ipc_writer *writer)
+{
+    bool ret = arrow_ipc_writer_finish(writer);
+
+    arrow_ipc_writer_free(writer);
+    return ret;
+}
+
 /* Returns an g_malloced string */
 char* get_node_field_value(field_info* fi, epan_dissect_t* edt)
 {
@@ -2763,6 +3073,8 @@ output_fields_t* output_fields_new(void)
     fields->field_dfilters      = NULL;
     fields->field_indicies      = NULL;
     fields->field_values        = NULL;
+    fields->arrow_types         = NULL;
+    fields->arrow_counts        = NULL;
     fields->protocolfilter      = NULL;
     fields->quote               ='\0';
     fields->escape              = true;
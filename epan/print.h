@@ -19,6 +19,7 @@
 #include <epan/packet.h>
 #include <epan/print_stream.h>
 
+#include <wsutil/arrow_ipc.h>
 #include <wsutil/json_dumper.h>
 
 #include "ws_symbol_export.h"
@@ -139,6 +140,15 @@ WS_DLL_PUBLIC void write_fields_preamble(output_fields_t* fields, FILE *fh);
 WS_DLL_PUBLIC void write_fields_proto_tree(output_fields_t* fields, epan_dissect_t *edt, column_info *cinfo, FILE *fh);
 WS_DLL_PUBLIC void write_fields_finale(output_fields_t* fields, FILE *fh);
 
+/*
+ * Arrow IPC stream of the user selected fields, with typed columns.
+ * The writer returned by write_arrow_preamble() is freed by
+ * write_arrow_finale(). Both write functions return false on I/O error.
+ */
+WS_DLL_PUBLIC arrow_ipc_writer *write_arrow_preamble(output_fields_t* fields, FILE *fh);
+WS_DLL_PUBLIC bool write_arrow_proto_tree(output_fields_t* fields, epan_dissect_t *edt, arrow_ipc_writer *writer);
+WS_DLL_PUBLIC bool write_arrow_finale(output_fields_t* fields, arrow_ipc_writer *writer);
+
 WS_DLL_PUBLIC char* get_node_field_value(field_info* fi, epan_dissect_t* edt);
 
 extern void print_cache_field_handles(void);
@@ -13,6 +13,7 @@
 #include "wireshark.h"
 
 #include <float.h>
+#include <math.h>
 #include <errno.h>
 
 #include <epan/tfs.h>
@@ -282,6 +283,10 @@ static int
 get_full_length(header_field_info *hfinfo, tvbuff_t *tvb, const int start,
 		int length, unsigned item_length, const int encoding);
 
+static void
+init_field_info(field_info *fi, proto_tree *tree, header_field_info *hfinfo,
+		tvbuff_t *tvb, const int start, const int item_length);
+
 static field_info *
 new_field_info(proto_tree *tree, header_field_info *hfinfo, tvbuff_t *tvb,
 	       const int start, const int item_length);
@@ -467,6 +472,10 @@ static header_field_info *same_name_hfinfo;
 /* Hash table protocol aliases. const char * -> const char * */
 static GHashTable *gpa_protocol_aliases;
 
+/* Indexes of field value_strings, built at registration.
+ * const value_string * -> value_string_ext * (or NULL if too small) */
+static GHashTable *value_string_indexes;
+
 /*
  * We're called repeatedly with the same field name when sorting a column.
  * Cache our last gpa_name_map hit for faster lookups.
@@ -594,6 +603,7 @@ proto_init(GSList *register_all_plugin_protocols_list,
 	gpa_hfinfo.hfi           = NULL;
 	gpa_name_map             = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, save_same_name_hfinfo);
 	gpa_protocol_aliases     = g_hash_table_new(g_str_hash, g_str_equal);
+	value_string_indexes     = g_hash_table_new(g_direct_hash, g_direct_equal);
 	deregistered_fields      = g_ptr_array_new();
 	deregistered_data        = g_ptr_array_new();
 	deregistered_slice       = g_ptr_array_new();
@@ -677,6 +687,10 @@ proto_cleanup_base(void)
 		g_hash_table_destroy(gpa_protocol_aliases);
 		gpa_protocol_aliases = NULL;
 	}
+	if (value_string_indexes) {
+		g_hash_table_destroy(value_string_indexes);
+		value_string_indexes = NULL;
+	}
 	g_free(last_field_name);
 	last_field_name = NULL;
 
@@ -4366,6 +4380,103 @@ proto_tree_add_item(proto_tree *tree, int hfindex, tvbuff_t *tvb,
 	return proto_tree_add_item_new(tree, hfinfo, tvb, start, length, encoding);
 }
 
+/*
+ * Add one field of a fixed-layout header. "data" points to the start of
+ * the header, whose extent has already been checked. The field_info is
+ * taken from "*fi_block", which is allocated on the first item that isn't
+ * faked with room for that item and the "remaining" ones after it.
+ */
+static proto_item *
+proto_tree_add_fixed_item(proto_tree *tree, tvbuff_t *tvb, const int start,
+			  const uint8_t *data, const proto_fixed_field *field,
+			  field_info **fi_block, unsigned remaining)
+{
+	header_field_info *hfinfo;
+	field_info        *fi;
+	const unsigned     encoding = field->encoding;
+	const int          length = field->length;
+	uint32_t           value;
+	ws_in4_addr        ipv4_value;
+
+	TRY_TO_FAKE_THIS_ITEM(tree, *field->p_id, hfinfo);
+
+	if (*fi_block == NULL)
+		*fi_block = wmem_alloc_array(PNODE_POOL(tree), field_info, remaining);
+	fi = (*fi_block)++;
+	init_field_info(fi, tree, hfinfo, tvb, start + field->offset, length);
+
+	data += field->offset;
+	switch (hfinfo->type) {
+
+	case FT_UINT8:
+	case FT_UINT16:
+	case FT_UINT24:
+	case FT_UINT32:
+		if (length > 4 || (encoding & ~ENC_LITTLE_ENDIAN) != 0)
+			break;
+		switch (length) {
+		case 1:
+			value = data[0];
+			break;
+		case 2:
+			value = encoding ? pletoh16(data) : pntoh16(data);
+			break;
+		case 3:
+			value = encoding ? pletoh24(data) : pntoh24(data);
+			break;
+		default:
+			value = encoding ? pletoh32(data) : pntoh32(data);
+			break;
+		}
+		proto_tree_set_uint(fi, value);
+		FI_SET_FLAG(fi, encoding ? FI_LITTLE_ENDIAN : FI_BIG_ENDIAN);
+		return proto_tree_add_node(tree, fi);
+
+	case FT_IPv4:
+		if (length != FT_IPv4_LEN || encoding != ENC_BIG_ENDIAN)
+			break;
+		memcpy(&ipv4_value, data, FT_IPv4_LEN);
+		proto_tree_set_ipv4(fi, ipv4_value);
+		FI_SET_FLAG(fi, FI_BIG_ENDIAN);
+		return proto_tree_add_node(tree, fi);
+
+	default:
+		break;
+	}
+
+	return proto_tree_new_item(fi, tree, tvb, start + field->offset, length, encoding);
+}
+
+void
+proto_tree_add_fixed_items(proto_tree *tree, tvbuff_t *tvb, const int start,
+			   const proto_fixed_field *fields, const unsigned num_fields,
+			   proto_item **items)
+{
+	const uint8_t *data;
+	field_info    *fi_block = NULL;
+	int            extent = 0;
+	unsigned       i;
+
+	for (i = 0; i < num_fields; i++) {
+		DISSECTOR_ASSERT(fields[i].offset >= 0 && fields[i].length > 0);
+		extent = MAX(extent, fields[i].offset + fields[i].length);
+	}
+
+	/* The one bounds check for the whole header; throws if it's short. */
+	data = tvb_get_ptr(tvb, start, extent);
+
+	for (i = 0; i < num_fields; i++) {
+		proto_item *item = NULL;
+
+		if (tree) {
+			item = proto_tree_add_fixed_item(tree, tvb, start, data,
+							 &fields[i], &fi_block, num_fields - i);
+		}
+		if (items)
+			items[i] = item;
+	}
+}
+
 /* Add an item to a proto_tree, using the text label registered to that item;
    the item is extracted from the tvbuff handed to it.
 
@@ -6822,14 +6933,10 @@ get_full_length(header_field_info *hfinfo, tvbuff_t *tvb, const int start,
 // We *could* make this a configurable option, but I (Gerald) would like to
 // avoid adding yet another nerd knob.
 # define PROTO_TREE_MAX_IDLE 50000
-static field_info *
-new_field_info(proto_tree *tree, header_field_info *hfinfo, tvbuff_t *tvb,
-	       const int start, const int item_length)
+static void
+init_field_info(field_info *fi, proto_tree *tree, header_field_info *hfinfo,
+		tvbuff_t *tvb, const int start, const int item_length)
 {
-	field_info *fi;
-
-	FIELD_INFO_NEW(PNODE_POOL(tree), fi);
-
 	fi->hfinfo     = hfinfo;
 	fi->start      = start;
 	fi->start     += (tvb)?tvb_raw_offset(tvb):0;
@@ -6866,6 +6973,16 @@ new_field_info(proto_tree *tree, header_field_info *hfinfo, tvbuff_t *tvb,
 
 	fi->total_layer_num = tree->tree_data->pinfo->curr_layer_num;
 	fi->proto_layer_num = tree->tree_data->pinfo->curr_proto_layer_num;
+}
+
+static field_info *
+new_field_info(proto_tree *tree, header_field_info *hfinfo, tvbuff_t *tvb,
+	       const int start, const int item_length)
+{
+	field_info *fi;
+
+	FIELD_INFO_NEW(PNODE_POOL(tree), fi);
+	init_field_info(fi, tree, hfinfo, tvb, start, item_length);
 
 	return fi;
 }
@@ -7702,6 +7819,224 @@ proto_custom_get_filter(epan_dissect_t* edt, GSList *field_ids, int occurrence)
 	return output;
 }
 
+/* Map a double onto an unsigned 64-bit integer with the same ordering:
+ * flip all the bits of negative values and only the sign bit of
+ * positive ones. NaNs are canonicalized so that they sort last.
+ */
+static uint64_t
+sort_key_from_double(double val)
+{
+	uint64_t bits;
+
+	if (isnan(val))
+		val = NAN;
+	else if (val == 0.0)
+		val = 0.0;	/* -0.0 and 0.0 compare equal */
+	memcpy(&bits, &val, sizeof(bits));
+	if (bits & UINT64_C(0x8000000000000000))
+		return ~bits;
+	return bits | UINT64_C(0x8000000000000000);
+}
+
+/* Keys 0 and 1 are PROTO_CUSTOM_SORT_KEY_UNSET and _NONE, so integer
+ * keys start at 2. The two largest values share the last key.
+ */
+static uint64_t
+sort_key_from_uint64(uint64_t val)
+{
+	return val < UINT64_MAX - 1 ? val + 2 : UINT64_MAX;
+}
+
+/* How the values of a custom column are turned into sort keys. All the
+ * keys of a column must be made the same way to be comparable, so this
+ * depends on the types of all of the column's fields.
+ */
+typedef enum {
+	SORT_KEY_UINT,		/* Unsigned integers that fit in an int64_t */
+	SORT_KEY_UINT64,	/* Unsigned integers */
+	SORT_KEY_INT,		/* Signed integers, with the sign bit flipped */
+	SORT_KEY_DOUBLE		/* Anything else, through a double */
+} sort_key_type_t;
+
+static sort_key_type_t
+sort_key_type_from_ftype(ftenum_t ftype)
+{
+	if (ftype == FT_UINT64)
+		return SORT_KEY_UINT64;
+	if (FT_IS_UINT(ftype))
+		return SORT_KEY_UINT;
+	if (FT_IS_INT(ftype))
+		return SORT_KEY_INT;
+	return SORT_KEY_DOUBLE;
+}
+
+static sort_key_type_t
+sort_key_type_merge(sort_key_type_t a, sort_key_type_t b)
+{
+	if (a == b)
+		return a;
+	if (a == SORT_KEY_DOUBLE || b == SORT_KEY_DOUBLE)
+		return SORT_KEY_DOUBLE;
+	if (a == SORT_KEY_INT || b == SORT_KEY_INT) {
+		/* Signed and 64-bit unsigned values don't fit in the same
+		 * 64 bits. */
+		if (a == SORT_KEY_UINT64 || b == SORT_KEY_UINT64)
+			return SORT_KEY_DOUBLE;
+		return SORT_KEY_INT;
+	}
+	return SORT_KEY_UINT64;
+}
+
+static sort_key_type_t
+proto_custom_sort_key_type(GSList *field_ids)
+{
+	sort_key_type_t     type = SORT_KEY_UINT;
+	header_field_info  *hfinfo;
+	col_custom_t       *col_custom;
+
+	for (GSList *iter = field_ids; iter; iter = iter->next) {
+		col_custom = (col_custom_t*)iter->data;
+		if (col_custom->field_id == 0) {
+			if (col_custom->dfilter == NULL)
+				return SORT_KEY_DOUBLE;
+			type = sort_key_type_merge(type,
+			    sort_key_type_from_ftype(dfilter_get_return_type(col_custom->dfilter)));
+			continue;
+		}
+
+		PROTO_REGISTRAR_GET_NTH((unsigned)col_custom->field_id, hfinfo);
+		while (hfinfo->same_name_prev_id != -1) {
+			PROTO_REGISTRAR_GET_NTH(hfinfo->same_name_prev_id, hfinfo);
+		}
+		for (; hfinfo; hfinfo = hfinfo->same_name_next) {
+			type = sort_key_type_merge(type, sort_key_type_from_ftype(hfinfo->type));
+		}
+	}
+	return type;
+}
+
+static bool
+sort_key_from_fvalue(fvalue_t *fv, sort_key_type_t type, uint64_t *key)
+{
+	uint64_t uval;
+	int64_t  sval;
+	double   val;
+
+	switch (type) {
+
+	case SORT_KEY_UINT:
+	case SORT_KEY_UINT64:
+		if (fvalue_to_uinteger64(fv, &uval) != FT_OK)
+			return false;
+		*key = sort_key_from_uint64(uval);
+		return true;
+
+	case SORT_KEY_INT:
+		if (fvalue_to_sinteger64(fv, &sval) != FT_OK)
+			return false;
+		*key = sort_key_from_uint64((uint64_t)sval ^ UINT64_C(0x8000000000000000));
+		return true;
+
+	case SORT_KEY_DOUBLE:
+		break;
+	}
+
+	if (fvalue_type_ftenum(fv) == FT_RELATIVE_TIME) {
+		val = nstime_to_sec(fvalue_get_time(fv));
+	} else if (fvalue_to_double(fv, &val) != FT_OK) {
+		return false;
+	}
+	*key = sort_key_from_double(val);
+	return true;
+}
+
+uint64_t
+proto_custom_get_sort_key(proto_tree* tree, GSList *field_ids, int occurrence)
+{
+	int                 len, prev_len, i;
+	GPtrArray          *finfos;
+	header_field_info*  hfinfo;
+	col_custom_t       *col_custom;
+	sort_key_type_t     type;
+	uint64_t            key;
+
+	ws_assert(field_ids != NULL);
+	type = proto_custom_sort_key_type(field_ids);
+	for (GSList *iter = field_ids; iter; iter = iter->next) {
+		col_custom = (col_custom_t*)iter->data;
+		if (col_custom->field_id == 0) {
+			GPtrArray *fvals = NULL;
+			dfilter_apply_full(col_custom->dfilter, tree, &fvals);
+			if (fvals == NULL) {
+				continue;
+			}
+			len = g_ptr_array_len(fvals);
+			if (occurrence < 0) {
+				i = occurrence + len;
+			} else if (occurrence > 0) {
+				i = occurrence - 1;
+			} else {
+				i = 0;
+			}
+			if (i >= 0 && i < len &&
+			    sort_key_from_fvalue((fvalue_t *)fvals->pdata[i], type, &key)) {
+				g_ptr_array_unref(fvals);
+				return key;
+			}
+			g_ptr_array_unref(fvals);
+			continue;
+		}
+
+		PROTO_REGISTRAR_GET_NTH((unsigned)col_custom->field_id, hfinfo);
+
+		if (occurrence < 0) {
+			/* Search other direction */
+			while (hfinfo->same_name_prev_id != -1) {
+				PROTO_REGISTRAR_GET_NTH(hfinfo->same_name_prev_id, hfinfo);
+			}
+		}
+
+		prev_len = 0; /* Reset handled occurrences */
+
+		/* Same walk as proto_custom_set(), but only the first
+		 * selected occurrence is needed: that is the value the
+		 * column text starts with.
+		 */
+		while (hfinfo) {
+			finfos = proto_get_finfo_ptr_array(tree, hfinfo->id);
+
+			if (!finfos || !(len = g_ptr_array_len(finfos)) ||
+			    ((occurrence - prev_len) > len) ||
+			    ((occurrence + prev_len) < -len)) {
+				if (finfos) {
+					prev_len += g_ptr_array_len(finfos);
+				}
+				if (occurrence < 0) {
+					hfinfo = hfinfo->same_name_next;
+				} else {
+					hfinfo = hfinfo_same_name_get_prev(hfinfo);
+				}
+				continue;
+			}
+
+			if (occurrence < 0) {
+				i = occurrence + len + prev_len;
+			} else if (occurrence > 0) {
+				i = occurrence - 1 - prev_len;
+			} else {
+				i = 0;
+			}
+
+			if (sort_key_from_fvalue(((field_info *)g_ptr_array_index(finfos, i))->value, type, &key)) {
+				return key;
+			}
+			break;
+		}
+	}
+
+	return PROTO_CUSTOM_SORT_KEY_NONE;
+}
+
 /* Set text of proto_item after having already been created. */
 void
 proto_item_set_text(proto_item *pi, const char *format, ...)
@@ -9068,6 +9403,10 @@ free_deregistered_field (void *data, void *user_data _U_)
 	g_free((char *)hfi->abbrev);
 	g_free((char *)hfi->blurb);
 
+	/* The strings may be freed below, and their address reused. */
+	if (hfi->strings_index)
+		g_hash_table_remove(value_string_indexes, hfi->strings);
+
 	proto_free_field_strings(hfi->type, hfi->display, hfi->strings);
 
 	if (hfi->parent == -1)
@@ -9765,6 +10104,49 @@ register_string_errors(void)
 	proto_set_cant_toggle(proto_string_errors);
 }
 
+/*
+ * Index a field's plain value_string, so that labelling the field doesn't
+ * need a linear search (as if the dissector had used BASE_EXT_STRING).
+ * Fields sharing a table share its index.
+ */
+static void
+hfinfo_index_strings(header_field_info *hfinfo)
+{
+	const value_string *vs;
+	value_string_ext   *vse;
+
+	hfinfo->strings_index = NULL;
+
+	if (hfinfo->strings == NULL)
+		return;
+
+	switch (hfinfo->type) {
+		case FT_CHAR:
+		case FT_UINT8:
+		case FT_UINT16:
+		case FT_UINT24:
+		case FT_UINT32:
+		case FT_INT8:
+		case FT_INT16:
+		case FT_INT24:
+		case FT_INT32:
+			break;
+		default:
+			return;
+	}
+
+	if ((hfinfo->display & (BASE_RANGE_STRING|BASE_EXT_STRING|BASE_VAL64_STRING|BASE_UNIT_STRING)) ||
+	    FIELD_DISPLAY(hfinfo->display) == BASE_CUSTOM)
+		return;
+
+	vs = (const value_string *)hfinfo->strings;
+	if (!g_hash_table_lookup_extended(value_string_indexes, vs, NULL, (void **)&vse)) {
+		vse = value_string_ext_new_indexed(vs, hfinfo->abbrev);
+		g_hash_table_insert(value_string_indexes, (void *)vs, vse);
+	}
+	hfinfo->strings_index = vse;
+}
+
 #define PROTO_PRE_ALLOC_HF_FIELDS_MEM (300000+PRE_ALLOC_EXPERT_FIELDS_MEM)
 static int
 proto_register_field_init(header_field_info *hfinfo, const int parent)
@@ -9775,6 +10157,7 @@ proto_register_field_init(header_field_info *hfinfo, const int parent)
 	hfinfo->parent         = parent;
 	hfinfo->same_name_next = NULL;
 	hfinfo->same_name_prev_id = -1;
+	hfinfo_index_strings(hfinfo);
 
 	/* if we always add and never delete, then id == len - 1 is correct */
 	if (gpa_hfinfo.len >= gpa_hfinfo.allocated_len) {
@@ -10330,6 +10713,9 @@ hf_try_val_to_str(uint32_t value, const header_field_info *hfinfo)
 	if (hfinfo->display & BASE_UNIT_STRING)
 		return unit_name_string_get_value(value, (const struct unit_name_string*) hfinfo->strings);
 
+	if (hfinfo->strings_index)
+		return try_val_to_str_ext(value, hfinfo->strings_index);
+
 	return try_val_to_str(value, (const value_string *) hfinfo->strings);
 }
 
@@ -780,6 +780,7 @@ struct _header_field_info {
     hf_ref_type        ref_type;          /**< is this field referenced by a filter */
     int                same_name_prev_id; /**< ID of previous hfinfo with same abbrev */
     header_field_info *same_name_next;    /**< Link to next hfinfo with same abbrev */
+    value_string_ext  *strings_index;     /**< Indexed form of a plain value_string "strings", or NULL */
 };
 
 /**
@@ -787,14 +788,15 @@ struct _header_field_info {
  * _header_field_info. If new fields are added or removed, it should
  * be changed as necessary.
  */
-#define HFILL -1, 0, HF_REF_TYPE_NONE, -1, NULL
+#define HFILL -1, 0, HF_REF_TYPE_NONE, -1, NULL, NULL
 
 #define HFILL_INIT(hf)   \
     (hf).hfinfo.id                = -1;   \
     (hf).hfinfo.parent            = 0;   \
     (hf).hfinfo.ref_type          = HF_REF_TYPE_NONE;   \
     (hf).hfinfo.same_name_prev_id = -1;   \
-    (hf).hfinfo.same_name_next    = NULL;
+    (hf).hfinfo.same_name_next    = NULL;   \
+    (hf).hfinfo.strings_index     = NULL;
 
 /** Used when registering many fields at once, using proto_register_field_array() */
 typedef struct hf_register_info {
@@ -1304,6 +1306,34 @@ WS_DLL_PUBLIC proto_item *
 proto_tree_add_item(proto_tree *tree, int hfindex, tvbuff_t *tvb,
     const int start, int length, const unsigned encoding);
 
+/** One field of a fixed-layout header, for proto_tree_add_fixed_items().
+    The offset is relative to the start of the header. */
+typedef struct {
+    int        *p_id;     /**< pointer to the hf index of the field */
+    int         offset;   /**< offset of the field from the start of the header */
+    int         length;   /**< length of the field; must be positive */
+    unsigned    encoding; /**< data encoding */
+} proto_fixed_field;
+
+/** Add the fields of a fixed-layout header (e.g. the ports of a TCP or
+   UDP header) to a proto_tree in one call. The extent of the header is
+   checked against the tvbuff once, so either all of the items are added
+   or an exception is thrown before any of them are; the field_info
+   structures are allocated as one block and common integer and address
+   fields are decoded directly from the packet data. Each item is otherwise
+   added exactly as proto_tree_add_item() would add it.
+ @param tree the tree to append the items to
+ @param tvb the tv buffer of the current data
+ @param start start of the header in tvb
+ @param fields the fields of the header, in the order they are to be added
+ @param num_fields the number of entries in fields
+ @param[out] items if not NULL, an array of num_fields entries that is set
+   to the added items (NULL if tree is NULL) */
+WS_DLL_PUBLIC void
+proto_tree_add_fixed_items(proto_tree *tree, tvbuff_t *tvb, const int start,
+    const proto_fixed_field *fields, const unsigned num_fields,
+    proto_item **items);
+
 /** Add an item to a proto_tree, using the text label registered to that item.
    The item is extracted from the tvbuff handed to it.
 
@@ -3572,6 +3602,26 @@ proto_custom_set(proto_tree* tree, GSList *field_id,
 char *
 proto_custom_get_filter(struct epan_dissect *edt, GSList *field_id, int occurrence);
 
+/** Sort key of a custom column whose key has not been extracted yet. */
+#define PROTO_CUSTOM_SORT_KEY_UNSET 0
+/** Sort key of a custom column without a numeric value. Sorts before
+ * all numeric values. */
+#define PROTO_CUSTOM_SORT_KEY_NONE  1
+
+/** Construct a 64-bit sort key for a numeric custom column.
+ Keys compare as unsigned integers in the same order as the numeric
+ value of the first selected occurrence of the fields, so they can be
+ sorted without formatting the column text. Integers keep their full
+ 64-bit precision (except that the two largest values compare equal),
+ unless the column mixes them with other types, or signed with 64-bit
+ unsigned integers; then the keys are made from doubles.
+ @param tree the tree the custom column fields were primed in
+ @param field_id the field ids used for custom column
+ @param occurrence the occurrence of the field used for custom column
+ @return the sort key, or PROTO_CUSTOM_SORT_KEY_NONE if there is no numeric value */
+WS_DLL_PUBLIC uint64_t
+proto_custom_get_sort_key(proto_tree* tree, GSList *field_id, int occurrence);
+
 /** @} */
 
 const char *
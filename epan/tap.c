@@ -74,6 +74,7 @@ typedef struct _tap_packet_t {
 } tap_packet_t;
 
 #define TAP_PACKET_IS_ERROR_PACKET	0x00000001	/* packet being queued is an error packet */
+#define TAP_PACKET_IS_FIRST_PASS	0x00000002	/* frame wasn't visited when the packet was queued */
 
 #define TAP_PACKET_QUEUE_LEN 5000
 static tap_packet_t tap_packet_array[TAP_PACKET_QUEUE_LEN];
@@ -248,6 +249,10 @@ tap_queue_packet(int tap_id, packet_info *pinfo, const void *tap_specific_data)
 	tpt->flags = 0;
 	if (pinfo->flags.in_error_pkt)
 		tpt->flags |= TAP_PACKET_IS_ERROR_PACKET;
+	/* dissect_record() marks the frame visited before the queue is
+	 * pushed, so note the first pass now. */
+	if (pinfo->fd && !PINFO_FD_VISITED(pinfo))
+		tpt->flags |= TAP_PACKET_IS_FIRST_PASS;
 	tpt->pinfo=pinfo;
 	tpt->tap_specific_data=tap_specific_data;
 	tap_packet_index++;
@@ -364,6 +369,8 @@ tap_push_tapped_queue(epan_dissect_t *edt)
 					 * packet passes.
 					 */
 					unsigned flags = tl->flags;
+					if (tp->flags & TAP_PACKET_IS_FIRST_PASS)
+						flags |= TL_FIRST_PASS;
 					if((tl->flags & TL_LIMIT_TO_DISPLAY_FILTER) && main_filter) {
 
 						if (!dfilter_apply_edt(main_filter, edt)){
@@ -831,6 +838,27 @@ have_filtering_tap_listeners(void)
 	return false;
 }
 
+/*
+ * Return true if no tap listener can see a frame that doesn't match the
+ * given display filter, i.e. if every listener either is limited to the
+ * main display filter or has this filter itself. Dissector helpers are
+ * fed during dissection and don't care about skipped frames.
+ */
+bool
+tap_listeners_limited_to_filter(const char *filter)
+{
+	tap_listener_t *tl;
+
+	for(tl=tap_listener_queue;tl;tl=tl->next){
+		if(tl->flags & (TL_LIMIT_TO_DISPLAY_FILTER|TL_IS_DISSECTOR_HELPER))
+			continue;
+		if(tl->fstring && filter && strcmp(tl->fstring, filter) == 0)
+			continue;
+		return false;
+	}
+	return true;
+}
+
 void
 tap_listeners_load_field_references(epan_dissect_t *edt)
 {
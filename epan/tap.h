@@ -62,6 +62,7 @@ typedef void (*tap_finish_cb)(void *tapdata);
 /** Flags to indicate what the packet cb should do */
 #define TL_IGNORE_DISPLAY_FILTER    0x00000010      /**< use packet, even if it would be filtered out */
 #define TL_DISPLAY_FILTER_IGNORED   0x00100000      /**< flag for the conversation handler */
+#define TL_FIRST_PASS               0x00200000      /**< flag for the packet cb: queued while the frame was first dissected */
 #define TL_LIMIT_TO_DISPLAY_FILTER  0x00000040      /**< limit to the main display filter, and retap if it changes. */
 
 /** Flags to indicate how the IP aggregation should behave during the statistics cb */
@@ -281,6 +282,10 @@ WS_DLL_PUBLIC bool have_tap_listener(int tap_id);
 /** Return true if we have any tap listeners with filters, false otherwise. */
 WS_DLL_PUBLIC bool have_filtering_tap_listeners(void);
 
+/** Return true if every tap listener is limited to the main display filter
+ * or has the given filter, so frames not matching it need not be tapped. */
+WS_DLL_PUBLIC bool tap_listeners_limited_to_filter(const char *filter);
+
 /** If any tap listeners have a filter with references to the currently
  * selected frame in the GUI (edt->tree), update them.
  */
@@ -9,6 +9,19 @@
 #include "config.h"
 
 #include "strutil.h"
+#include "value_string.h"
+#include <epan/epan.h>
+#include <epan/packet.h>
+#include <epan/column-info.h>
+#include <epan/exceptions.h>
+#include <epan/field_index.h>
+#include <epan/prefs.h>
+#include <epan/ftypes/ftypes.h>
+#include <epan/dfilter/dfilter.h>
+#include <wiretap/wtap.h>
+#include <wsutil/filesystem.h>
+#include <wsutil/inet_addr.h>
+#include <wsutil/time_util.h>
 #include <wsutil/utf8_entities.h>
 
 /*
@@ -74,6 +87,668 @@ void test_label_escape_control(void)
     g_assert_cmpuint(pos, ==, strlen(dst));
 }
 
+/* Unsorted, with duplicates and negative values. */
+static const value_string test_vals_unsorted[] = {
+    { 42, "Forty-two" },
+    { 7, "Seven" },
+    { (uint32_t)-1, "Minus one" },
+    { 1000, "Thousand" },
+    { 7, "Seven again" },
+    { 0, "Zero" },
+    { 99, "Ninety-nine" },
+    { 3, "Three" },
+    { 42, "Forty-two again" },
+    { 65535, "Max uint16" },
+    { 0, NULL }
+};
+
+static const value_string test_vals_contiguous[] = {
+    { (uint32_t)-2, "Minus two" },
+    { (uint32_t)-1, "Minus one" },
+    { 0, "Zero" },
+    { 1, "One" },
+    { 2, "Two" },
+    { 3, "Three" },
+    { 4, "Four" },
+    { 5, "Five" },
+    { 0, NULL }
+};
+
+static const value_string test_vals_small[] = {
+    { 1, "One" },
+    { 2, "Two" },
+    { 0, NULL }
+};
+
+static void check_indexed_value_string(const value_string *vs)
+{
+    value_string_ext *vse = value_string_ext_new_indexed(vs, "test");
+    uint32_t values[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 42, 43, 99, 1000, 65535,
+                          (uint32_t)-1, (uint32_t)-2, (uint32_t)-3 };
+
+    g_assert_nonnull(vse);
+    for (size_t i = 0; i < G_N_ELEMENTS(values); i++) {
+        g_assert_cmpstr(try_val_to_str_ext(values[i], vse), ==, try_val_to_str(values[i], vs));
+    }
+    value_string_ext_free(vse);
+}
+
+static void test_value_string_indexed(void)
+{
+    check_indexed_value_string(test_vals_unsorted);
+    check_indexed_value_string(test_vals_contiguous);
+    g_assert_null(value_string_ext_new_indexed(test_vals_small, "test"));
+}
+
+#define RESOURCE_USAGE_START get_resource_usage(&start_utime, &start_stime)
+
+#define RESOURCE_USAGE_END \
+    get_resource_usage(&end_utime, &end_stime); \
+    utime_ms = (end_utime - start_utime) * 1000.0; \
+    stime_ms = (end_stime - start_stime) * 1000.0
+
+static void test_value_string_indexed_perf(void)
+{
+#define VS_PERF_ENTRIES 256
+#define VS_PERF_LOOP_COUNT (10 * 1000 * 1000)
+    value_string       *vs;
+    value_string_ext   *vse;
+    const char         *str;
+    unsigned            hits = 0;
+    double              start_utime, start_stime, end_utime, end_stime, utime_ms, stime_ms;
+
+    /* A large table in descending order, like many generated ones. */
+    vs = g_new(value_string, VS_PERF_ENTRIES + 1);
+    for (unsigned i = 0; i < VS_PERF_ENTRIES; i++) {
+        vs[i].value = (VS_PERF_ENTRIES - i) * 3;
+        vs[i].strptr = "value";
+    }
+    vs[VS_PERF_ENTRIES].value = 0;
+    vs[VS_PERF_ENTRIES].strptr = NULL;
+
+    RESOURCE_USAGE_START;
+    for (unsigned i = 0; i < VS_PERF_LOOP_COUNT; i++) {
+        str = try_val_to_str(i % (VS_PERF_ENTRIES * 3), vs);
+        hits += str != NULL;
+    }
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "try_val_to_str(): u %.3f ms s %.3f ms", utime_ms, stime_ms);
+
+    vse = value_string_ext_new_indexed(vs, "perf");
+    RESOURCE_USAGE_START;
+    for (unsigned i = 0; i < VS_PERF_LOOP_COUNT; i++) {
+        str = try_val_to_str_ext(i % (VS_PERF_ENTRIES * 3), vse);
+        hits -= str != NULL;
+    }
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "try_val_to_str_ext() indexed: u %.3f ms s %.3f ms", utime_ms, stime_ms);
+
+    g_assert_cmpuint(hits, ==, 0);
+    value_string_ext_free(vse);
+    g_free(vs);
+}
+
+static void test_dissector_table_uint(void)
+{
+    dissector_table_t udp_port = find_dissector_table("udp.port");
+    dissector_table_t ip_proto = find_dissector_table("ip.proto");
+    dissector_handle_t dns_handle = find_dissector("dns");
+    dissector_handle_t udp_handle = find_dissector("udp");
+
+    g_assert_nonnull(udp_port);
+    g_assert_nonnull(ip_proto);
+    g_assert_true(dissector_get_uint_handle(udp_port, 53) == dns_handle);
+    g_assert_true(dissector_get_uint_handle(ip_proto, 17) == udp_handle);
+    g_assert_null(dissector_get_uint_handle(ip_proto, 0x1FF));
+
+    /* Decode As */
+    g_assert_null(dissector_get_uint_handle(udp_port, 64999));
+    dissector_change_uint("udp.port", 64999, dns_handle);
+    g_assert_true(dissector_get_uint_handle(udp_port, 64999) == dns_handle);
+    dissector_reset_uint("udp.port", 64999);
+    g_assert_null(dissector_get_uint_handle(udp_port, 64999));
+
+    dissector_change_uint("udp.port", 53, NULL);
+    g_assert_null(dissector_get_uint_handle(udp_port, 53));
+    g_assert_true(dissector_get_default_uint_handle("udp.port", 53) == dns_handle);
+    dissector_reset_uint("udp.port", 53);
+    g_assert_true(dissector_get_uint_handle(udp_port, 53) == dns_handle);
+
+    dissector_add_uint("udp.port", 64998, dns_handle);
+    g_assert_true(dissector_get_uint_handle(udp_port, 64998) == dns_handle);
+    dissector_delete_uint("udp.port", 64998, dns_handle);
+    g_assert_null(dissector_get_uint_handle(udp_port, 64998));
+}
+
+static void test_dissector_table_uint_perf(void)
+{
+#define DT_PERF_LOOP_COUNT (64 * 1000 * 1000)
+    dissector_table_t   udp_port = find_dissector_table("udp.port");
+    dissector_table_t   ip_proto = find_dissector_table("ip.proto");
+    unsigned            hits = 0;
+    double              start_utime, start_stime, end_utime, end_stime, utime_ms, stime_ms;
+
+    RESOURCE_USAGE_START;
+    for (unsigned i = 0; i < DT_PERF_LOOP_COUNT; i++) {
+        hits += dissector_get_uint_handle(udp_port, i & 0xFFFF) != NULL;
+    }
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "udp.port dispatch: u %.3f ms s %.3f ms", utime_ms, stime_ms);
+
+    RESOURCE_USAGE_START;
+    for (unsigned i = 0; i < DT_PERF_LOOP_COUNT; i++) {
+        hits += dissector_get_uint_handle(ip_proto, i & 0xFF) != NULL;
+    }
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "ip.proto dispatch: u %.3f ms s %.3f ms", utime_ms, stime_ms);
+
+    g_assert_cmpuint(hits, >, 0);
+}
+
+/* A TCP header: ports 49152 -> 80, seq 0x01020304, and the address
+ * 192.0.2.1 in the place of the checksum and urgent pointer. */
+static const uint8_t test_tcp_header[] = {
+    0xc0, 0x00, 0x00, 0x50, 0x01, 0x02, 0x03, 0x04,
+    0x00, 0x00, 0x00, 0x00, 0x50, 0x18, 0x01, 0x00,
+    0xc0, 0x00, 0x02, 0x01
+};
+
+static int test_hf_srcport;
+static int test_hf_dstport;
+static int test_hf_seq_raw;
+static int test_hf_ip_src;
+static int test_hf_data;
+
+static const proto_fixed_field test_fixed_fields[] = {
+    { &test_hf_srcport,  0, 2, ENC_BIG_ENDIAN },
+    { &test_hf_dstport,  2, 2, ENC_BIG_ENDIAN },
+    { &test_hf_seq_raw,  4, 4, ENC_BIG_ENDIAN },
+    { &test_hf_seq_raw,  4, 4, ENC_LITTLE_ENDIAN },
+    { &test_hf_ip_src,  16, 4, ENC_BIG_ENDIAN },
+    { &test_hf_data,     8, 4, ENC_NA },
+};
+
+static epan_dissect_t *test_new_edt(epan_t **session)
+{
+    static const struct packet_provider_funcs funcs = { 0 };
+
+    test_hf_srcport = proto_registrar_get_id_byname("tcp.srcport");
+    test_hf_dstport = proto_registrar_get_id_byname("tcp.dstport");
+    test_hf_seq_raw = proto_registrar_get_id_byname("tcp.seq_raw");
+    test_hf_ip_src = proto_registrar_get_id_byname("ip.src");
+    test_hf_data = proto_registrar_get_id_byname("data.data");
+
+    *session = epan_new(NULL, &funcs);
+    return epan_dissect_new(*session, true, true);
+}
+
+static void test_proto_fixed_items(void)
+{
+    epan_t             *session;
+    epan_dissect_t     *edt = test_new_edt(&session);
+    tvbuff_t           *tvb;
+    proto_item         *items[G_N_ELEMENTS(test_fixed_fields)];
+    volatile bool       thrown = false;
+
+    tvb = tvb_new_real_data(test_tcp_header, sizeof(test_tcp_header), sizeof(test_tcp_header));
+    proto_tree_add_fixed_items(edt->tree, tvb, 0, test_fixed_fields,
+                               G_N_ELEMENTS(test_fixed_fields), items);
+
+    /* Every item must be what proto_tree_add_item() would have added. */
+    for (unsigned i = 0; i < G_N_ELEMENTS(test_fixed_fields); i++) {
+        const proto_fixed_field *field = &test_fixed_fields[i];
+        proto_item *expected = proto_tree_add_item(edt->tree, *field->p_id, tvb,
+                                                   field->offset, field->length, field->encoding);
+        field_info *fi = PITEM_FINFO(items[i]);
+
+        g_assert_nonnull(fi);
+        g_assert_true(fi->hfinfo == PITEM_FINFO(expected)->hfinfo);
+        g_assert_cmpint(fi->start, ==, PITEM_FINFO(expected)->start);
+        g_assert_cmpint(fi->length, ==, PITEM_FINFO(expected)->length);
+        g_assert_cmpuint(fi->flags, ==, PITEM_FINFO(expected)->flags);
+        g_assert_true(fvalue_equal(fi->value, PITEM_FINFO(expected)->value));
+    }
+    g_assert_cmpuint(fvalue_get_uinteger(PITEM_FINFO(items[0])->value), ==, 49152);
+    g_assert_cmpuint(fvalue_get_uinteger(PITEM_FINFO(items[3])->value), ==, 0x04030201);
+    tvb_free(tvb);
+    epan_dissect_reset(edt);
+
+    /* A short header adds nothing. */
+    tvb = tvb_new_real_data(test_tcp_header, 12, sizeof(test_tcp_header));
+    TRY {
+        proto_tree_add_fixed_items(edt->tree, tvb, 0, test_fixed_fields,
+                                   G_N_ELEMENTS(test_fixed_fields), items);
+    }
+    CATCH(BoundsError) {
+        thrown = true;
+    }
+    ENDTRY;
+    g_assert_true(thrown);
+    g_assert_null(edt->tree->first_child);
+    tvb_free(tvb);
+
+    /* Without a tree the items are NULL. */
+    tvb = tvb_new_real_data(test_tcp_header, sizeof(test_tcp_header), sizeof(test_tcp_header));
+    proto_tree_add_fixed_items(NULL, tvb, 0, test_fixed_fields,
+                               G_N_ELEMENTS(test_fixed_fields), items);
+    g_assert_null(items[0]);
+    tvb_free(tvb);
+
+    epan_dissect_free(edt);
+    epan_free(session);
+}
+
+static void test_proto_fixed_items_perf(void)
+{
+#define FIXED_PERF_LOOP_COUNT (4 * 1000 * 1000)
+#define FIXED_PERF_RESET_INTERVAL 64
+    epan_t             *session;
+    epan_dissect_t     *edt = test_new_edt(&session);
+    tvbuff_t           *tvb;
+    double              start_utime, start_stime, end_utime, end_stime, utime_ms, stime_ms;
+    /* The port fields of the TCP header, as packet-tcp.c adds them. */
+    static const proto_fixed_field port_fields[] = {
+        { &test_hf_srcport, 0, 2, ENC_BIG_ENDIAN },
+        { &test_hf_dstport, 2, 2, ENC_BIG_ENDIAN },
+        { &test_hf_srcport, 0, 2, ENC_BIG_ENDIAN },
+        { &test_hf_dstport, 2, 2, ENC_BIG_ENDIAN },
+    };
+
+    tvb = tvb_new_real_data(test_tcp_header, sizeof(test_tcp_header), sizeof(test_tcp_header));
+
+    RESOURCE_USAGE_START;
+    for (unsigned i = 0; i < FIXED_PERF_LOOP_COUNT; i++) {
+        for (unsigned j = 0; j < G_N_ELEMENTS(port_fields); j++) {
+            proto_tree_add_item(edt->tree, *port_fields[j].p_id, tvb,
+                                port_fields[j].offset, port_fields[j].length, port_fields[j].encoding);
+        }
+        if (i % FIXED_PERF_RESET_INTERVAL == 0)
+            epan_dissect_reset(edt);
+    }
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "proto_tree_add_item() x4: u %.3f ms s %.3f ms", utime_ms, stime_ms);
+    epan_dissect_reset(edt);
+
+    RESOURCE_USAGE_START;
+    for (unsigned i = 0; i < FIXED_PERF_LOOP_COUNT; i++) {
+        proto_tree_add_fixed_items(edt->tree, tvb, 0, port_fields,
+                                   G_N_ELEMENTS(port_fields), NULL);
+        if (i % FIXED_PERF_RESET_INTERVAL == 0)
+            epan_dissect_reset(edt);
+    }
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "proto_tree_add_fixed_items(): u %.3f ms s %.3f ms", utime_ms, stime_ms);
+
+    tvb_free(tvb);
+    epan_dissect_free(edt);
+    epan_free(session);
+}
+
+/* A value of a custom column field, for the sort key tests. */
+typedef struct {
+    const char *field;
+    int64_t sval;       /* For signed integer fields */
+    uint64_t uval;      /* For unsigned integer fields */
+    double dval;        /* For floating point fields */
+} test_sort_value;
+
+static GSList *test_sort_columns(const char *fields[])
+{
+    GSList *field_ids = NULL;
+
+    for (unsigned i = 0; fields[i]; i++) {
+        col_custom_t *col_custom = g_new0(col_custom_t, 1);
+
+        col_custom->field_id = proto_registrar_get_id_byname(fields[i]);
+        g_assert_cmpint(col_custom->field_id, >, 0);
+        field_ids = g_slist_append(field_ids, col_custom);
+    }
+    return field_ids;
+}
+
+static uint64_t test_sort_key(epan_dissect_t *edt, GSList *field_ids, const test_sort_value *value)
+{
+    header_field_info *hfinfo = proto_registrar_get_byname(value->field);
+    uint64_t key;
+
+    for (GSList *iter = field_ids; iter; iter = iter->next) {
+        epan_dissect_prime_with_hfid(edt, ((col_custom_t *)iter->data)->field_id);
+    }
+    switch (hfinfo->type) {
+        case FT_INT32:
+            proto_tree_add_int(edt->tree, hfinfo->id, NULL, 0, 0, (int32_t)value->sval);
+            break;
+        case FT_INT64:
+            proto_tree_add_int64(edt->tree, hfinfo->id, NULL, 0, 0, value->sval);
+            break;
+        case FT_UINT16:
+            proto_tree_add_uint(edt->tree, hfinfo->id, NULL, 0, 0, (uint32_t)value->uval);
+            break;
+        case FT_UINT64:
+            proto_tree_add_uint64(edt->tree, hfinfo->id, NULL, 0, 0, value->uval);
+            break;
+        case FT_DOUBLE:
+            proto_tree_add_double(edt->tree, hfinfo->id, NULL, 0, 0, value->dval);
+            break;
+        default:
+            g_assert_not_reached();
+    }
+    key = proto_custom_get_sort_key(edt->tree, field_ids, 0);
+    epan_dissect_reset(edt);
+    return key;
+}
+
+/* Check that the values, in ascending order, get ascending keys. */
+static void test_sort_keys_ascending(epan_dissect_t *edt, const char *fields[],
+                                     const test_sort_value *values, unsigned count)
+{
+    GSList *field_ids = test_sort_columns(fields);
+    uint64_t prev_key = PROTO_CUSTOM_SORT_KEY_NONE;
+
+    for (unsigned i = 0; i < count; i++) {
+        uint64_t key = test_sort_key(edt, field_ids, &values[i]);
+
+        g_test_message("%s: %" PRId64 " %" PRIu64 " %g -> %" PRIx64, values[i].field,
+                       values[i].sval, values[i].uval, values[i].dval, key);
+        g_assert_cmpuint(key, >, prev_key);
+        prev_key = key;
+    }
+    g_slist_free_full(field_ids, g_free);
+}
+
+static void test_proto_custom_sort_key(void)
+{
+    epan_t             *session;
+    epan_dissect_t     *edt = test_new_edt(&session);
+
+    /* 64-bit integers don't lose precision beyond 2^53. */
+    {
+        const char *fields[] = { "frame.packet_id", NULL };
+        const test_sort_value values[] = {
+            { "frame.packet_id", 0, 0, 0 },
+            { "frame.packet_id", 0, 1, 0 },
+            { "frame.packet_id", 0, UINT64_C(9007199254740992), 0 },
+            { "frame.packet_id", 0, UINT64_C(9007199254740993), 0 },
+            { "frame.packet_id", 0, UINT64_MAX - 2, 0 },
+            { "frame.packet_id", 0, UINT64_MAX - 1, 0 },
+        };
+        const test_sort_value max_value = { "frame.packet_id", 0, UINT64_MAX, 0 };
+        GSList *field_ids = test_sort_columns(fields);
+
+        test_sort_keys_ascending(edt, fields, values, G_N_ELEMENTS(values));
+        /* Two keys are reserved, so the two largest values share one. */
+        g_assert_cmpuint(test_sort_key(edt, field_ids, &max_value), ==,
+                         test_sort_key(edt, field_ids, &values[G_N_ELEMENTS(values) - 1]));
+        g_slist_free_full(field_ids, g_free);
+    }
+    {
+        const char *fields[] = { "frame.file_off", NULL };
+        const test_sort_value values[] = {
+            { "frame.file_off", INT64_MIN, 0, 0 },
+            { "frame.file_off", INT64_MIN + 1, 0, 0 },
+            { "frame.file_off", -INT64_C(9007199254740993), 0, 0 },
+            { "frame.file_off", -INT64_C(9007199254740992), 0, 0 },
+            { "frame.file_off", -1, 0, 0 },
+            { "frame.file_off", 0, 0, 0 },
+            { "frame.file_off", 1, 0, 0 },
+            { "frame.file_off", INT64_C(9007199254740992), 0, 0 },
+            { "frame.file_off", INT64_C(9007199254740993), 0, 0 },
+            { "frame.file_off", INT64_MAX - 2, 0, 0 },
+        };
+
+        test_sort_keys_ascending(edt, fields, values, G_N_ELEMENTS(values));
+    }
+
+    /* Columns with several fields compare the values of all of them. */
+    {
+        /* Signed 32- and 64-bit integers */
+        const char *fields[] = { "frame.file_off", "tcp.window_size_scalefactor", NULL };
+        const test_sort_value values[] = {
+            { "frame.file_off", INT64_MIN, 0, 0 },
+            { "tcp.window_size_scalefactor", -5, 0, 0 },
+            { "frame.file_off", -4, 0, 0 },
+            { "tcp.window_size_scalefactor", 3, 0, 0 },
+            { "frame.file_off", INT64_C(9007199254740993), 0, 0 },
+        };
+
+        test_sort_keys_ascending(edt, fields, values, G_N_ELEMENTS(values));
+    }
+    {
+        /* Signed and narrow unsigned integers */
+        const char *fields[] = { "tcp.window_size_scalefactor", "tcp.srcport", NULL };
+        const test_sort_value values[] = {
+            { "tcp.window_size_scalefactor", -1, 0, 0 },
+            { "tcp.srcport", 0, 0, 0 },
+            { "tcp.window_size_scalefactor", 1, 0, 0 },
+            { "tcp.srcport", 0, 65535, 0 },
+            { "tcp.window_size_scalefactor", INT32_MAX, 0, 0 },
+        };
+
+        test_sort_keys_ascending(edt, fields, values, G_N_ELEMENTS(values));
+    }
+    {
+        /* Signed and 64-bit unsigned integers */
+        const char *fields[] = { "frame.file_off", "frame.packet_id", NULL };
+        const test_sort_value values[] = {
+            { "frame.file_off", -2, 0, 0 },
+            { "frame.packet_id", 0, 1, 0 },
+            { "frame.file_off", 2, 0, 0 },
+            { "frame.packet_id", 0, UINT64_MAX, 0 },
+        };
+
+        test_sort_keys_ascending(edt, fields, values, G_N_ELEMENTS(values));
+    }
+    {
+        /* Integers and floating point */
+        const char *fields[] = { "frame.packet_id", "ip.geoip.src_lat", NULL };
+        const test_sort_value values[] = {
+            { "ip.geoip.src_lat", 0, 0, -0.5 },
+            { "frame.packet_id", 0, 1, 0 },
+            { "ip.geoip.src_lat", 0, 0, 1.5 },
+            { "frame.packet_id", 0, 2, 0 },
+        };
+
+        test_sort_keys_ascending(edt, fields, values, G_N_ELEMENTS(values));
+    }
+
+    epan_dissect_free(edt);
+    epan_free(session);
+}
+
+static void test_dfilter_index_terms(void)
+{
+    static const struct {
+        const char *filter;
+        unsigned terms;
+        bool exact;
+    } tests[] = {
+        { "ip.addr == 10.0.0.1", 1, true },
+        { "ip.addr == 10.0.0.1 and tcp.port == 80", 2, true },
+        { "tcp", 1, true },
+        /* The index decides whether it can look up a CIDR block. */
+        { "ip.addr == 10.0.0.0/8", 1, true },
+        { "ip.addr == 10.0.0.1 and (tcp.port == 80 or udp.port == 53)", 1, false },
+        { "ip.addr == 10.0.0.1 and not tcp.port == 53", 1, false },
+        { "ip.addr == 10.0.0.1 or tcp.port == 80", 0, false },
+        { "not ip.addr == 10.0.0.1", 0, false },
+        { "ip.addr != 10.0.0.1", 0, false },
+        { "ip.addr === 10.0.0.1", 0, false },
+        { "ip.addr#2 == 10.0.0.1", 0, false },
+        { "tcp.port > 80", 0, false },
+    };
+
+    for (unsigned i = 0; i < G_N_ELEMENTS(tests); i++) {
+        dfilter_t *df;
+        df_error_t *err = NULL;
+        const GPtrArray *terms;
+        bool exact;
+
+        g_test_message("%s", tests[i].filter);
+        g_assert_true(dfilter_compile(tests[i].filter, &df, &err));
+        terms = dfilter_get_index_terms(df, &exact);
+        g_assert_nonnull(terms);
+        g_assert_cmpuint(terms->len, ==, tests[i].terms);
+        g_assert_true(exact == tests[i].exact);
+        dfilter_free(df);
+    }
+
+    /* Existence tests have no value and refer to the first field with
+     * the name. */
+    {
+        dfilter_t *df;
+        df_error_t *err = NULL;
+        const dfilter_index_term_t *term;
+        bool exact;
+
+        g_assert_true(dfilter_compile("tcp.port", &df, &err));
+        term = (const dfilter_index_term_t *)g_ptr_array_index(dfilter_get_index_terms(df, &exact), 0);
+        g_assert_null(term->value);
+        g_assert_cmpint(term->hfinfo->same_name_prev_id, ==, -1);
+        g_assert_cmpstr(term->hfinfo->abbrev, ==, "tcp.port");
+        dfilter_free(df);
+    }
+}
+
+/* Frames for the field value index tests. */
+static const struct {
+    const char *addrs[2];
+    unsigned ports[2];
+} test_index_frames[] = {
+    { { "10.0.0.1", "10.0.0.2" }, { 49152, 80 } },
+    { { "10.0.0.1", "10.0.0.3" }, { 49153, 53 } },
+    { { "10.0.0.2", "10.0.0.3" }, { 80, 49154 } },
+    { { NULL, NULL }, { 0, 0 } },
+};
+
+static void test_index_add_items(epan_dissect_t *edt, tvbuff_t *tvb, unsigned frame)
+{
+    int hf_addr = proto_registrar_get_id_byname("ip.addr");
+    int hf_port = proto_registrar_get_id_byname("tcp.port");
+
+    for (unsigned i = 0; i < 2; i++) {
+        if (test_index_frames[frame].addrs[i]) {
+            ws_in4_addr addr;
+
+            g_assert_true(ws_inet_pton4(test_index_frames[frame].addrs[i], &addr));
+            proto_tree_add_ipv4(edt->tree, hf_addr, tvb, 0, 4, addr);
+        }
+        if (test_index_frames[frame].ports[i]) {
+            proto_tree_add_uint(edt->tree, hf_port, tvb, 0, 2, test_index_frames[frame].ports[i]);
+        }
+    }
+}
+
+static void test_field_index_filter_frames(void)
+{
+    static const struct {
+        const char *filter;
+        bool found;         /* The index narrows the frames */
+        bool exact;         /* Those are the matching frames */
+        unsigned count;
+        uint32_t frames[4];
+    } tests[] = {
+        { "ip.addr == 10.0.0.1", true, true, 2, { 1, 2 } },
+        { "ip.addr == 10.0.0.1 and tcp.port == 80", true, true, 1, { 1 } },
+        { "tcp.port", true, true, 3, { 1, 2, 3 } },
+        { "ip.addr == 10.0.0.9", true, true, 0, { 0 } },
+        /* Only the top-level "and" terms are looked up; the rest of
+         * the filter needs the frames to be dissected. */
+        { "ip.addr == 10.0.0.3 and (tcp.port == 80 or tcp.port == 53)", true, false, 2, { 2, 3 } },
+        { "ip.addr == 10.0.0.1 and not tcp.port == 53", true, false, 2, { 1, 2 } },
+        { "ip.addr == 10.0.0.1 and ip.ttl == 64", true, false, 2, { 1, 2 } },
+        /* These need a full dissection. */
+        { "ip.addr == 10.0.0.1 or tcp.port == 80", false, false, 0, { 0 } },
+        { "not ip.addr == 10.0.0.1", false, false, 0, { 0 } },
+        { "ip.addr == 10.0.0.0/8", false, false, 0, { 0 } },
+        { "ip.addr#1 == 10.0.0.1", false, false, 0, { 0 } },
+        { "ip.ttl == 64", false, false, 0, { 0 } },
+    };
+    static const struct packet_provider_funcs funcs = { 0 };
+    char               *saved_fields = prefs.filter_index_fields;
+    unsigned            frame_count = G_N_ELEMENTS(test_index_frames);
+    epan_t             *session;
+    epan_dissect_t     *edt;
+    tvbuff_t           *tvb;
+
+    prefs.filter_index_fields = g_strdup("ip.addr tcp.port");
+    session = epan_new(NULL, &funcs);
+    edt = epan_dissect_new(session, true, true);
+    tvb = tvb_new_real_data(test_tcp_header, sizeof(test_tcp_header), sizeof(test_tcp_header));
+    g_assert_true(field_index_enabled());
+
+    /* Index the frames, as the first pass does. */
+    for (unsigned i = 0; i < frame_count; i++) {
+        frame_data fd = { 0 };
+
+        fd.num = i + 1;
+        field_index_prime_edt(edt, &fd);
+        test_index_add_items(edt, tvb, i);
+        field_index_add_frame(edt, &fd);
+        epan_dissect_reset(edt);
+    }
+
+    for (unsigned i = 0; i < G_N_ELEMENTS(tests); i++) {
+        dfilter_t *df;
+        df_error_t *err = NULL;
+        uint32_t *frames;
+        unsigned count;
+        bool exact;
+
+        g_test_message("%s", tests[i].filter);
+        g_assert_true(dfilter_compile(tests[i].filter, &df, &err));
+
+        /* The index must cover all of the frames. */
+        g_assert_false(field_index_get_filter_frames(df, frame_count + 1, &frames, &count, &exact));
+        g_free(frames);
+
+        g_assert_true(field_index_get_filter_frames(df, frame_count, &frames, &count, &exact) == tests[i].found);
+        if (!tests[i].found) {
+            g_free(frames);
+            dfilter_free(df);
+            continue;
+        }
+        g_assert_true(exact == tests[i].exact);
+        g_assert_cmpmem(frames, count * sizeof(uint32_t), tests[i].frames, tests[i].count * sizeof(uint32_t));
+
+        /* Compare with the filter applied to each frame: if the result
+         * is exact, rescan_packets() marks exactly those frames as
+         * displayed without dissecting them, so they must be the ones
+         * that match; otherwise they must include them. */
+        for (unsigned j = 0; j < frame_count; j++) {
+            bool listed = false;
+            bool matched;
+
+            for (unsigned k = 0; k < count; k++) {
+                if (frames[k] == j + 1)
+                    listed = true;
+            }
+            epan_dissect_prime_with_dfilter(edt, df);
+            test_index_add_items(edt, tvb, j);
+            matched = dfilter_apply_edt(df, edt);
+            epan_dissect_reset(edt);
+
+            if (exact)
+                g_assert_true(matched == listed);
+            else if (matched)
+                g_assert_true(listed);
+        }
+        g_free(frames);
+        dfilter_free(df);
+    }
+
+    tvb_free(tvb);
+    epan_dissect_free(edt);
+    epan_free(session);
+    g_free(prefs.filter_index_fields);
+    prefs.filter_index_fields = saved_fields;
+}
+
 int main(int argc, char **argv)
 {
     int ret;
@@ -85,12 +760,38 @@ int main(int argc, char **argv)
 
     g_test_init(&argc, &argv, NULL);
 
+    /* The dissector table tests need the registered dissectors. */
+    g_free(configuration_init(argv[0]));
+    wtap_init(false);
+    if (!epan_init(NULL, NULL, false)) {
+        return 1;
+    }
+
     g_test_add_func("/label/strcat", test_label_strcat);
     g_test_add_func("/label/escape_whitespace", test_label_strcat_escape_whitespace);
     g_test_add_func("/label/escape_control", test_label_escape_control);
 
+    g_test_add_func("/value_string/indexed", test_value_string_indexed);
+
+    g_test_add_func("/dissector_table/uint", test_dissector_table_uint);
+
+    g_test_add_func("/proto/fixed_items", test_proto_fixed_items);
+    g_test_add_func("/proto/custom_sort_key", test_proto_custom_sort_key);
+
+    g_test_add_func("/dfilter/index_terms", test_dfilter_index_terms);
+    g_test_add_func("/field_index/filter_frames", test_field_index_filter_frames);
+
+    if (g_test_perf()) {
+        g_test_add_func("/value_string/indexed_perf", test_value_string_indexed_perf);
+        g_test_add_func("/dissector_table/uint_perf", test_dissector_table_uint_perf);
+        g_test_add_func("/proto/fixed_items_perf", test_proto_fixed_items_perf);
+    }
+
     ret = g_test_run();
 
+    epan_cleanup();
+    wtap_cleanup();
+
     return ret;
 }
 
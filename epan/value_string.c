@@ -307,6 +307,76 @@ value_string_ext_free(value_string_ext *vse)
     wmem_free(wmem_epan_scope(), vse);
 }
 
+typedef struct {
+    value_string vs;
+    unsigned     idx;
+} value_string_sort_entry;
+
+/* Sort by value, then by position, so that the first of any duplicates
+ * sorts first */
+static int
+value_string_sort_entry_compare(const void *a, const void *b)
+{
+    const value_string_sort_entry *ea = (const value_string_sort_entry *)a;
+    const value_string_sort_entry *eb = (const value_string_sort_entry *)b;
+
+    if (ea->vs.value != eb->vs.value)
+        return ea->vs.value > eb->vs.value ? 1 : -1;
+    return ea->idx > eb->idx ? 1 : (ea->idx < eb->idx ? -1 : 0);
+}
+
+/* Create a value_string_ext for a plain (null-terminated) value_string so
+ * that it can be searched in constant or log(n) time rather than linearly.
+ * Tables that are already contiguous or strictly ascending are used in
+ * place; any other table is copied and sorted, keeping only the first of
+ * any duplicated values so that lookups give the same result as
+ * try_val_to_str().
+ * Returns NULL if the table has fewer than VALUE_STRING_INDEX_MIN_ENTRIES
+ * entries. The returned value_string_ext (and the copy, if any) are
+ * epan-scoped. */
+value_string_ext *
+value_string_ext_new_indexed(const value_string *vs, const char *vs_name)
+{
+    unsigned                 num_entries, i, j;
+    bool                     contiguous = true, ascending = true;
+    value_string_sort_entry *sorted;
+    value_string            *copy;
+
+    for (num_entries = 0; vs[num_entries].strptr != NULL; num_entries++) {
+        if (num_entries > 0) {
+            if (vs[num_entries].value != vs[0].value + num_entries)
+                contiguous = false;
+            if (vs[num_entries].value <= vs[num_entries - 1].value)
+                ascending = false;
+        }
+    }
+
+    if (num_entries < VALUE_STRING_INDEX_MIN_ENTRIES)
+        return NULL;
+
+    if (contiguous || ascending)
+        return value_string_ext_new(vs, num_entries + 1, vs_name);
+
+    sorted = g_new(value_string_sort_entry, num_entries);
+    for (i = 0; i < num_entries; i++) {
+        sorted[i].vs = vs[i];
+        sorted[i].idx = i;
+    }
+    qsort(sorted, num_entries, sizeof sorted[0], value_string_sort_entry_compare);
+
+    copy = wmem_alloc_array(wmem_epan_scope(), value_string, num_entries + 1);
+    for (i = 0, j = 0; i < num_entries; i++) {
+        if (j > 0 && sorted[i].vs.value == copy[j - 1].value)
+            continue;
+        copy[j++] = sorted[i].vs;
+    }
+    copy[j].value = 0;
+    copy[j].strptr = NULL;
+    g_free(sorted);
+
+    return value_string_ext_new(copy, j + 1, vs_name);
+}
+
 /* Like try_val_to_str for extended value strings */
 const char *
 try_val_to_str_ext(const uint32_t val, value_string_ext *vse)
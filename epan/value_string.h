@@ -192,6 +192,14 @@ WS_DLL_PUBLIC
 void
 value_string_ext_free(value_string_ext *vse);
 
+/* Tables with fewer entries than this are searched linearly; an index
+ * doesn't pay off for them. */
+#define VALUE_STRING_INDEX_MIN_ENTRIES 8
+
+WS_DLL_PUBLIC
+value_string_ext *
+value_string_ext_new_indexed(const value_string *vs, const char *vs_name);
+
 WS_DLL_PUBLIC
 const char *
 val_to_str_ext(const uint32_t val, value_string_ext *vse, const char *fmt)
@@ -127,6 +127,10 @@ wmem_init_scopes(void)
     file_scope   = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK);
     epan_scope   = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK);
 
+    wmem_allocator_set_stats_name(packet_scope, "packet");
+    wmem_allocator_set_stats_name(file_scope, "file");
+    wmem_allocator_set_stats_name(epan_scope, "epan");
+
     /* Scopes are initialized to true by default on creation */
     wmem_leave_scope(packet_scope);
     wmem_leave_scope(file_scope);
@@ -35,10 +35,12 @@
 #include <epan/packet.h>
 #include <epan/column-utils.h>
 #include <epan/expert.h>
+#include <epan/field_index.h>
 #include <epan/prefs.h>
 #include <epan/dfilter/dfilter.h>
 #include <epan/epan_dissect.h>
 #include <epan/tap.h>
+#include <epan/follow.h>
 #include <epan/timestamp.h>
 #include <epan/strutil.h>
 #include <epan/addr_resolv.h>
@@ -134,6 +136,10 @@ static bool find_packet(capture_file *cf, ws_match_function match_function,
 /* Show the progress bar after this many seconds. */
 #define PROGBAR_SHOW_DELAY 0.5
 
+/* Microseconds spent reading new packets in a live capture before
+ * returning to the UI; the rest are read on the next call. */
+#define TAIL_READ_TIME_BUDGET 100000
+
 /*
  * Maximum number of records we support in a file.
  *
@@ -552,11 +558,14 @@ cf_read(capture_file *cf, bool reloading)
      *    one of the tap listeners requires a protocol tree;
      *
      *    a postdissector wants field values or protocols on
-     *    the first pass.
+     *    the first pass;
+     *
+     *    we're building the field value index.
      */
     create_proto_tree =
         (cf->dfcode != NULL || have_filtering_tap_listeners() ||
-         (tap_flags & TL_REQUIRES_PROTO_TREE) || postdissectors_want_hfids());
+         (tap_flags & TL_REQUIRES_PROTO_TREE) || postdissectors_want_hfids() ||
+         field_index_enabled());
 
     reset_tap_listeners();
 
@@ -692,6 +701,10 @@ cf_read(capture_file *cf, bool reloading)
     /* We're done reading sequentially through the file. */
     cf->state = FILE_READ_DONE;
 
+    /* Now that we've seen all of the addresses, send lookups for them at
+       once; the answers are processed as they arrive. */
+    host_name_lookup_bulk();
+
     /* Destroy the progress bar if it was created. */
     if (progbar != NULL)
         destroy_progress_dlg(progbar);
@@ -789,11 +802,13 @@ cf_read(capture_file *cf, bool reloading)
 
 #ifdef HAVE_LIBPCAP
 cf_read_status_t
-cf_continue_tail(capture_file *cf, volatile int to_read, wtap_rec *rec,
+cf_continue_tail(capture_file *cf, int *to_read, wtap_rec *rec,
         int *err, fifo_string_cache_t *frame_dup_cache, GChecksum *frame_cksum)
 {
     char             *err_info;
     volatile int      newly_displayed_packets = 0;
+    volatile int      left = *to_read;
+    volatile bool     out_of_time = false;
     epan_dissect_t    edt;
     bool              create_proto_tree;
     unsigned          tap_flags;
@@ -839,11 +854,14 @@ cf_continue_tail(capture_file *cf, volatile int to_read, wtap_rec *rec,
      *    one of the tap listeners requires a protocol tree;
      *
      *    a postdissector wants field values or protocols on
-     *    the first pass.
+     *    the first pass;
+     *
+     *    we're building the field value index.
      */
     create_proto_tree =
         (cf->dfcode != NULL || have_filtering_tap_listeners() ||
-         (tap_flags & TL_REQUIRES_PROTO_TREE) || postdissectors_want_hfids());
+         (tap_flags & TL_REQUIRES_PROTO_TREE) || postdissectors_want_hfids() ||
+         field_index_enabled());
 
     *err = 0;
 
@@ -855,13 +873,15 @@ cf_continue_tail(capture_file *cf, volatile int to_read, wtap_rec *rec,
     TRY {
         int64_t data_offset = 0;
         column_info *cinfo;
+        int64_t start_time;
 
         /* If the display filter or any tap listeners require the columns,
          * construct them. */
         cinfo = (tap_listeners_require_columns() ||
             dfilter_requires_columns(cf->dfcode)) ? &cf->cinfo : NULL;
 
-        while (to_read != 0) {
+        start_time = g_get_monotonic_time();
+        while (left != 0) {
             wtap_cleareof(cf->provider.wth);
             if (!wtap_read(cf->provider.wth, rec, err, &err_info,
                         &data_offset)) {
@@ -876,7 +896,13 @@ cf_continue_tail(capture_file *cf, volatile int to_read, wtap_rec *rec,
             if (read_record(cf, rec, cf->dfcode, &edt, cinfo, data_offset, frame_dup_cache, frame_cksum)) {
                 newly_displayed_packets++;
             }
-            to_read--;
+            left--;
+            if (left != 0 && g_get_monotonic_time() - start_time > TAIL_READ_TIME_BUDGET) {
+                /* Packets arrive faster than we can dissect them; let the
+                   UI run, and leave the rest for the next call. */
+                out_of_time = true;
+                break;
+            }
         }
         wtap_rec_reset(rec);
     }
@@ -901,6 +927,13 @@ cf_continue_tail(capture_file *cf, volatile int to_read, wtap_rec *rec,
 
     epan_dissect_cleanup(&edt);
 
+    /* Send lookups for the new addresses, if we're resolving them in bulk. */
+    host_name_lookup_bulk();
+
+    /* Only carry over the packets we ran out of time for, not those we
+       failed to read. */
+    *to_read = out_of_time ? left : 0;
+
     /* Don't freeze/thaw the list when doing live capture */
     /*packet_list_thaw();*/
     /* With the new packet list the first packet
@@ -966,11 +999,14 @@ cf_finish_tail(capture_file *cf, wtap_rec *rec, int *err,
      *    one of the tap listeners requires a protocol tree;
      *
      *    a postdissector wants field values or protocols on
-     *    the first pass.
+     *    the first pass;
+     *
+     *    we're building the field value index.
      */
     create_proto_tree =
         (cf->dfcode != NULL || have_filtering_tap_listeners() ||
-         (tap_flags & TL_REQUIRES_PROTO_TREE) || postdissectors_want_hfids());
+         (tap_flags & TL_REQUIRES_PROTO_TREE) || postdissectors_want_hfids() ||
+         field_index_enabled());
 
     if (cf->provider.wth == NULL) {
         cf_close(cf);
@@ -996,6 +1032,9 @@ cf_finish_tail(capture_file *cf, wtap_rec *rec, int *err,
 
     epan_dissect_cleanup(&edt);
 
+    /* Send lookups for the last addresses, if we're resolving them in bulk. */
+    host_name_lookup_bulk();
+
     /* Don't freeze/thaw the list when doing live capture */
     /*packet_list_thaw();*/
 
@@ -1214,8 +1253,10 @@ add_packet_to_packet_list(frame_data *fdata, capture_file *cf,
 
     if (!fdata->visited) {
         /* This is the first pass, so prime the epan_dissect_t with the
-           hfids postdissectors want on the first pass. */
+           hfids postdissectors want on the first pass, and the fields
+           to index. */
         prime_epan_dissect_with_postdissector_wanted_hfids(edt);
+        field_index_prime_edt(edt, fdata);
     }
 
     /* Initialize passed_dfilter here so that dissectors can hide packets. */
@@ -1225,6 +1266,8 @@ add_packet_to_packet_list(frame_data *fdata, capture_file *cf,
     /* Dissect the frame. */
     epan_dissect_run_with_taps(edt, cf->cd_t, rec, fdata, cinfo);
 
+    field_index_add_frame(edt, fdata);
+
     if (fdata->passed_dfilter && dfcode != NULL) {
         fdata->passed_dfilter = dfilter_apply_edt(dfcode, edt) ? 1 : 0;
 
@@ -1660,8 +1703,11 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, bo
     unsigned    tap_flags;
     bool        add_to_packet_list = false;
     bool        compiled _U_;
-    uint32_t    frames_count;
+    uint32_t    frames_count, listed_count;
     rescan_type queued_rescan_type = RESCAN_NONE;
+    uint32_t   *index_frames = NULL;
+    unsigned    index_count = 0, index_pos = 0;
+    bool        index_exact = false;
 
     if (cf->state == FILE_CLOSED || cf->state == FILE_READ_PENDING) {
         return;
@@ -1736,7 +1782,8 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, bo
     create_proto_tree =
         (cf->dfcode != NULL || filtering_tap_listeners ||
          (tap_flags & TL_REQUIRES_PROTO_TREE) ||
-         (redissect && postdissectors_want_hfids()));
+         (redissect && postdissectors_want_hfids()) ||
+         (cf->state == FILE_READ_IN_PROGRESS && field_index_enabled()));
 
     reset_tap_listeners();
     /* Which frame, if any, is the currently selected frame?
@@ -1752,16 +1799,18 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, bo
        screen updates while it happens. */
     packet_list_freeze();
 
+    /* We might receive new packets in a live capture while rescanning, and
+       we don't want to dissect those before their time; the loop below
+       dissects them, in order, after the frames we already have. */
+    cf->redissecting = true;
+    listed_count = cf->count;
+
     if (redissect) {
         /* We need to re-initialize all the state information that protocols
            keep, because some preference that controls a dissector has changed,
            which might cause the state information to be constructed differently
            by that dissector. */
 
-        /* We might receive new packets while redissecting, and we don't
-           want to dissect those before their time. */
-        cf->redissecting = true;
-
         /* 'reset' dissection session */
         epan_free(cf->epan);
         if (cf->edt && cf->edt->pi.fd) {
@@ -1774,8 +1823,9 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, bo
         cf->cinfo.epan = cf->epan;
 
         /* A new Lua tap listener may be registered in lua_prime_all_fields()
-           called via epan_new() / init_dissection() when reloading Lua plugins. */
-        if (!create_proto_tree && have_filtering_tap_listeners()) {
+           called via epan_new() / init_dissection() when reloading Lua plugins.
+           The field value index is rebuilt with the current preferences. */
+        if (!create_proto_tree && (have_filtering_tap_listeners() || field_index_enabled())) {
             create_proto_tree = true;
         }
         if (!cinfo && tap_listeners_require_columns()) {
@@ -1786,6 +1836,32 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, bo
          * packet list store. */
         packet_list_clear();
         add_to_packet_list = true;
+    } else if (cf->dfilter && tap_listeners_limited_to_filter(cf->dfilter)) {
+        /* If the display filter selects a stream (e.g. "tcp.stream eq 5"
+           from Follow Stream or a conversation filter), only the frames of
+           that stream can match, and nobody else wants to see the rest.
+           The same goes for the frames the field value index finds; if
+           the filter is nothing but indexed tests, those frames are the
+           ones that match, and, unless a tap listener wants to see them,
+           they don't need to be dissected either. */
+        if (!field_index_get_filter_frames(cf->dfcode, cf->count, &index_frames, &index_count, &index_exact) ||
+                !index_exact) {
+            uint32_t *stream_frames;
+            unsigned  stream_count;
+
+            if (follow_get_filter_frames(cf->dfilter, &stream_frames, &stream_count) &&
+                    (index_frames == NULL || stream_count < index_count)) {
+                g_free(index_frames);
+                index_frames = stream_frames;
+                index_count = stream_count;
+                index_exact = false;
+            } else {
+                g_free(stream_frames);
+            }
+        }
+        if (index_exact && tap_listeners_require_dissection()) {
+            index_exact = false;
+        }
     }
 
     /* We don't yet know which will be the first and last frames displayed. */
@@ -1910,12 +1986,75 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, bo
              * data (the per-frame data itself was freed by
              * "init_dissection()"), and null out the GSList pointer. */
             frame_data_reset(fdata);
-            frames_count = cf->count;
         }
+        frames_count = cf->count;
 
         /* Frame dependencies from the previous dissection/filtering are no longer valid. */
         fdata->dependent_of_displayed = 0;
 
+        /* The frames found for the filter are among those we had when we
+           started; frames that arrived since have to be dissected. */
+        if (index_frames != NULL && framenum <= listed_count) {
+            while (index_pos < index_count && index_frames[index_pos] < framenum)
+                index_pos++;
+            if ((index_pos == index_count || index_frames[index_pos] != framenum) &&
+                    !fdata->ref_time) {
+                /* Not in the stream, so it can't pass the filter; skip
+                   dissecting it, but keep the frame state consistent. */
+                frame_data_set_before_dissect(fdata, &cf->elapsed_time,
+                        &cf->provider.ref, cf->provider.prev_dis);
+                cf->provider.prev_cap = fdata;
+                fdata->passed_dfilter = 0;
+                if (prev_frame_num != -1 && !selected_frame_seen && prev_frame->passed_dfilter) {
+                    preceding_frame_num = prev_frame_num;
+                    preceding_frame = prev_frame;
+                }
+                if (fdata == selected_frame)
+                    selected_frame_seen = true;
+                prev_frame_num = fdata->num;
+                prev_frame = fdata;
+                continue;
+            }
+            if (index_exact && !fdata->ref_time && !fdata->ignored) {
+                /* The frame matches the filter; mark it displayed the
+                   way add_packet_to_packet_list() would, without
+                   dissecting it. Ignored frames were indexed before they
+                   were ignored, so let the dissection decide for them. */
+                if (prev_frame_num != -1 && !selected_frame_seen && prev_frame->passed_dfilter) {
+                    preceding_frame_num = prev_frame_num;
+                    preceding_frame = prev_frame;
+                }
+                frame_data_set_before_dissect(fdata, &cf->elapsed_time,
+                        &cf->provider.ref, cf->provider.prev_dis);
+                cf->provider.prev_cap = fdata;
+                fdata->passed_dfilter = 1;
+                if (fdata->dependent_frames) {
+                    g_hash_table_foreach(fdata->dependent_frames, find_and_mark_frame_depended_upon, cf->provider.frames);
+                }
+                cf->displayed_count++;
+                fdata->dis_num = cf->displayed_count;
+                frame_data_set_after_dissect(fdata, &cf->cum_bytes);
+                if (fdata->has_ts) {
+                    cf->provider.prev_dis = fdata;
+                }
+                if (cf->first_displayed == 0)
+                    cf->first_displayed = fdata->num;
+                cf->last_displayed = fdata->num;
+
+                if (selected_frame_seen && following_frame_num == -1) {
+                    following_frame_num = fdata->num;
+                    following_frame = fdata;
+                }
+                if (fdata == selected_frame) {
+                    selected_frame_seen = true;
+                    selected_frame_num = fdata->num;
+                }
+                prev_frame_num = fdata->num;
+                prev_frame = fdata;
+                continue;
+            }
+        }
+
         if (!cf_read_record(cf, fdata, &rec))
             break; /* error reading the frame */
 
@@ -1928,7 +2067,7 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, bo
         }
 
         add_packet_to_packet_list(fdata, cf, &edt, cf->dfcode, cinfo, &rec,
-                add_to_packet_list);
+                add_to_packet_list || framenum > listed_count);
 
         /* If this frame is displayed, and this is the first frame we've
            seen displayed after the selected frame, remember this frame -
@@ -1951,8 +2090,21 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, bo
         wtap_rec_reset(&rec);
     }
 
+    if (!redissect) {
+        /* If the rescan was stopped, the frames that arrived during it
+           still need their first pass, and to be added to the list. */
+        for (framenum = MAX(framenum, listed_count + 1); framenum <= cf->count; framenum++) {
+            fdata = frame_data_sequence_find(cf->provider.frames, framenum);
+            if (!cf_read_record(cf, fdata, &rec))
+                break;
+            add_packet_to_packet_list(fdata, cf, &edt, cf->dfcode, cinfo, &rec, true);
+            wtap_rec_reset(&rec);
+        }
+    }
+
     epan_dissect_cleanup(&edt);
     wtap_rec_cleanup(&rec);
+    g_free(index_frames);
 
     /* We are done redissecting the packet list. */
     cf->redissecting = false;
@@ -181,13 +181,18 @@ bool cf_read_current_record(capture_file *cf);
 /**
  * Read packets from the "end" of a capture file.
  *
+ * Reading stops after a short while, so that the UI stays responsive when
+ * packets arrive faster than they can be dissected; the packets left are
+ * to be read by the next call.
+ *
  * @param cf the capture file to be read from
- * @param to_read the number of packets to read
+ * @param to_read the number of packets to read; set to the number of
+ * packets left to read
  * @param rec pointer to wtap_rec to use when reading
  * @param err the error code, if an error had occurred
  * @return one of cf_read_status_t
  */
-cf_read_status_t cf_continue_tail(capture_file *cf, volatile int to_read,
+cf_read_status_t cf_continue_tail(capture_file *cf, int *to_read,
                                   wtap_rec *rec, int *err,
                                   fifo_string_cache_t *frame_dup_cache, GChecksum *frame_cksum);
 
@@ -21,10 +21,12 @@
 
 #include <wiretap/wtap.h>
 
+#include <wsutil/clopts_common.h>
 #include <wsutil/cmdarg_err.h>
 #include <wsutil/filesystem.h>
 #include <wsutil/file_util.h>
 #include <wsutil/privileges.h>
+#include <wsutil/strtoi.h>
 #include <cli_main.h>
 #include <wsutil/version_info.h>
 #include <wiretap/wtap_opttypes.h>
@@ -40,6 +42,12 @@
 /* Additional exit codes */
 #define OUTPUT_FILE_ERROR 1
 
+/* Memory limit used when reading the standard input */
+#define DEFAULT_MEMORY_LIMIT    (256 * 1024 * 1024)
+
+/* Maximum number of spill runs merged at once */
+#define MAX_MERGE_RUNS          64
+
 /* Show command-line usage */
 static void
 print_usage(FILE *output)
@@ -49,6 +57,12 @@ print_usage(FILE *output)
     fprintf(output, "\n");
     fprintf(output, "Options:\n");
     fprintf(output, "  -n                don't write to output file if the input file is ordered.\n");
+    fprintf(output, "  -w <frames>       read the input once, reordering within a sliding window\n");
+    fprintf(output, "                    of <frames> frames; frames that are out of order by more\n");
+    fprintf(output, "                    than that are written as soon as they are read.\n");
+    fprintf(output, "  -m <size>         read the input once, sorting runs of up to <size> bytes\n");
+    fprintf(output, "                    (suffix k, M or G; default M) in memory and merging them\n");
+    fprintf(output, "                    from temporary files. The default when reading stdin.\n");
     fprintf(output, "  -h, --help        display this help and exit.\n");
     fprintf(output, "  -v, --version     print version information and exit.\n");
 }
@@ -61,6 +75,21 @@ typedef struct FrameRecord_t {
     nstime_t     frame_time;
 } FrameRecord_t;
 
+/* A frame held in memory, for the modes that read the input only once */
+typedef struct FrameBuffer_t {
+    unsigned     num;   /* frame number, or run index when merging */
+
+    nstime_t     frame_time;
+    wtap_rec     rec;
+} FrameBuffer_t;
+
+/* A sorted run spilled to a temporary file */
+typedef struct SpillRun_t {
+    FrameBuffer_t  frame;   /* the next frame of the run; must be first */
+    const char    *filename;
+    wtap          *wth;
+} SpillRun_t;
+
 
 /**************************************************/
 /* Debugging only                                 */
@@ -76,6 +105,42 @@ typedef struct FrameRecord_t {
 /**************************************************/
 
 
+/* Temporary files holding spilled runs, removed on exit */
+static GPtrArray *spill_files;
+
+static void
+spill_files_remove(void)
+{
+    if (spill_files == NULL)
+        return;
+    for (unsigned i = 0; i < spill_files->len; i++) {
+        ws_unlink((const char *)spill_files->pdata[i]);
+    }
+    g_ptr_array_free(spill_files, TRUE);
+    spill_files = NULL;
+}
+
+static WS_NORETURN void
+reorder_exit(int status)
+{
+    spill_files_remove();
+    exit(status);
+}
+
+static void
+rec_write(wtap_dumper *pdh, wtap_rec *rec, unsigned num,
+          const char *infile, const char *outfile, int file_type_subtype)
+{
+    int    err;
+    char   *err_info;
+
+    if (!wtap_dump(pdh, rec, &err, &err_info)) {
+        cfile_write_failure_message(infile, outfile, err, err_info, num,
+                                    file_type_subtype);
+        reorder_exit(1);
+    }
+}
+
 static void
 frame_write(FrameRecord_t *frame, wtap *wth, wtap_dumper *pdh,
             wtap_rec *rec, const char *infile, const char *outfile)
@@ -105,11 +170,7 @@ frame_write(FrameRecord_t *frame, wtap *wth, wtap_dumper *pdh,
     rec->ts = frame->frame_time;
 
     /* Dump frame to outfile */
-    if (!wtap_dump(pdh, rec, &err, &err_info)) {
-        cfile_write_failure_message(infile, outfile, err, err_info, frame->num,
-                                    wtap_file_type_subtype(wth));
-        exit(1);
-    }
+    rec_write(pdh, rec, frame->num, infile, outfile, wtap_file_type_subtype(wth));
     wtap_rec_reset(rec);
 }
 
@@ -130,117 +191,224 @@ frames_compare(const void *a, const void *b)
     return nstime_cmp(time1, time2);
 }
 
-/********************************************************************/
-/* Main function.                                                   */
-/********************************************************************/
-int
-main(int argc, char *argv[])
+static void
+frame_set_time(nstime_t *frame_time, const wtap_rec *rec)
 {
-    char *configuration_init_error;
-    wtap *wth = NULL;
-    wtap_dumper *pdh = NULL;
-    wtap_rec rec;
-    int err;
-    char *err_info;
-    int64_t data_offset;
-    unsigned wrong_order_count = 0;
-    bool write_output_regardless = true;
-    unsigned i;
-    wtap_dump_params params;
-    int                          ret = EXIT_SUCCESS;
+    if (rec->presence_flags & WTAP_HAS_TS) {
+        *frame_time = rec->ts;
+    } else {
+        nstime_set_unset(frame_time);
+    }
+}
 
-    GPtrArray *frames;
-    FrameRecord_t *prevFrame = NULL;
+/* As frames_compare(), but frames with equal timestamps keep their order */
+static int
+frame_buffers_compare(const FrameBuffer_t *frame1, const FrameBuffer_t *frame2)
+{
+    int cmp = nstime_cmp(&frame1->frame_time, &frame2->frame_time);
 
-    int opt;
-    static const struct ws_option long_options[] = {
-        {"help", ws_no_argument, NULL, 'h'},
-        {"version", ws_no_argument, NULL, 'v'},
-        {0, 0, 0, 0 }
-    };
-    int file_count;
-    char *infile;
-    const char *outfile;
+    if (cmp != 0)
+        return cmp;
+    return (frame1->num > frame2->num) - (frame1->num < frame2->num);
+}
 
-    /* Set the program name. */
-    g_set_prgname("reordercap");
+static int
+frame_buffer_ptrs_compare(const void *a, const void *b)
+{
+    return frame_buffers_compare(*(const FrameBuffer_t *const *) a,
+                                 *(const FrameBuffer_t *const *) b);
+}
 
-    cmdarg_err_init(stderr_cmdarg_err, stderr_cmdarg_err_cont);
+/* Binary min-heap of frames, ordered by frame_buffers_compare() */
+static void
+heap_push(GPtrArray *heap, FrameBuffer_t *frame)
+{
+    unsigned i = heap->len;
 
-    /* Initialize log handler early so we can have proper logging during startup. */
-    ws_log_init(vcmdarg_err);
+    g_ptr_array_add(heap, frame);
+    while (i > 0) {
+        unsigned parent = (i - 1) / 2;
 
-    /* Early logging command-line initialization. */
-    ws_log_parse_args(&argc, argv, vcmdarg_err, WS_EXIT_INVALID_OPTION);
+        if (frame_buffers_compare(heap->pdata[parent], frame) <= 0)
+            break;
+        heap->pdata[i] = heap->pdata[parent];
+        i = parent;
+    }
+    heap->pdata[i] = frame;
+}
 
-    ws_noisy("Finished log init and parsing command line log arguments");
+static FrameBuffer_t *
+heap_pop(GPtrArray *heap)
+{
+    FrameBuffer_t *top = heap->pdata[0];
+    FrameBuffer_t *last = g_ptr_array_remove_index(heap, heap->len - 1);
+    unsigned i = 0;
+
+    if (heap->len == 0)
+        return top;
+    for (;;) {
+        unsigned child = 2 * i + 1;
+
+        if (child >= heap->len)
+            break;
+        if (child + 1 < heap->len &&
+            frame_buffers_compare(heap->pdata[child + 1], heap->pdata[child]) < 0)
+            child++;
+        if (frame_buffers_compare(last, heap->pdata[child]) <= 0)
+            break;
+        heap->pdata[i] = heap->pdata[child];
+        i = child;
+    }
+    heap->pdata[i] = last;
+    return top;
+}
 
-    /*
-     * Get credential information for later use.
-     */
-    init_process_policies();
+/* Frame buffers are recycled, so that their record buffers are reused */
+static FrameBuffer_t *
+frame_buffer_get(GPtrArray *spare)
+{
+    FrameBuffer_t *frame;
 
-    /*
-     * Attempt to get the pathname of the directory containing the
-     * executable file.
-     */
-    configuration_init_error = configuration_init(argv[0]);
-    if (configuration_init_error != NULL) {
-        fprintf(stderr,
-                "reordercap: Can't get pathname of directory containing the reordercap program: %s.\n",
-                configuration_init_error);
-        g_free(configuration_init_error);
-    }
+    if (spare->len > 0)
+        return g_ptr_array_remove_index(spare, spare->len - 1);
+    frame = g_new(FrameBuffer_t, 1);
+    wtap_rec_init(&frame->rec, 1514);
+    return frame;
+}
 
-    /* Initialize the version information. */
-    ws_init_version_info("Reordercap", NULL, NULL);
+static void
+frame_buffer_put(GPtrArray *spare, FrameBuffer_t *frame)
+{
+    wtap_rec_reset(&frame->rec);
+    g_ptr_array_add(spare, frame);
+}
 
-    init_report_failure_message("reordercap");
+static void
+frame_buffer_free(void *data)
+{
+    FrameBuffer_t *frame = (FrameBuffer_t *)data;
 
-    wtap_init(true);
+    wtap_rec_cleanup(&frame->rec);
+    g_free(frame);
+}
 
-    /* Process the options first */
-    while ((opt = ws_getopt_long(argc, argv, "hnv", long_options, NULL)) != -1) {
-        switch (opt) {
-            case 'n':
-                write_output_regardless = false;
-                break;
-            case 'h':
-                show_help_header("Reorder timestamps of input file frames into output file.");
-                print_usage(stdout);
-                goto clean_exit;
-            case 'v':
-                show_version();
-                goto clean_exit;
-            case '?':
-                print_usage(stderr);
-                ret = WS_EXIT_INVALID_OPTION;
-                goto clean_exit;
+/*
+ * Save a copy of any interface descriptions read since the last call, and
+ * add them to pdh, if it isn't NULL and its file type has interfaces.
+ */
+static bool
+process_new_idbs(wtap *wth, wtap_dumper *pdh, GArray *idbs_seen,
+                 int *err, char **err_info)
+{
+    wtap_block_t if_data;
+
+    while ((if_data = wtap_get_next_interface_description(wth)) != NULL) {
+        wtap_block_t if_data_copy = wtap_block_make_copy(if_data);
+
+        g_array_append_val(idbs_seen, if_data_copy);
+        if (pdh != NULL &&
+            wtap_file_type_subtype_supports_block(wtap_dump_file_type_subtype(pdh),
+                                                  WTAP_BLOCK_IF_ID_AND_INFO) != BLOCK_NOT_SUPPORTED) {
+            /* wtap_dump_add_idb() makes its own copy. */
+            if (!wtap_dump_add_idb(pdh, if_data_copy, err, err_info))
+                return false;
         }
     }
+    return true;
+}
 
-    /* Remaining args are file names */
-    file_count = argc - ws_optind;
-    if (file_count == 2) {
-        infile  = argv[ws_optind];
-        outfile = argv[ws_optind+1];
+static void
+idbs_free(GArray *idbs_seen)
+{
+    for (unsigned i = 0; i < idbs_seen->len; i++) {
+        wtap_block_unref(g_array_index(idbs_seen, wtap_block_t, i));
     }
-    else {
-        print_usage(stderr);
-        ret = WS_EXIT_INVALID_OPTION;
-        goto clean_exit;
+    g_array_free(idbs_seen, TRUE);
+}
+
+/*
+ * Open an output file of the input file's type with all the interfaces
+ * seen so far. If tempnamep isn't NULL, a temporary file is opened, and
+ * its name is returned there and remembered for removal.
+ */
+static wtap_dumper *
+reorder_dump_open(const char *outfile, char **tempnamep, wtap *wth,
+                  const wtap_dump_params *params, GArray *idbs_seen)
+{
+    wtap_dumper *pdh;
+    int file_type_subtype = wtap_file_type_subtype(wth);
+    int err;
+    char *err_info;
+
+    if (tempnamep != NULL) {
+        pdh = wtap_dump_open_tempfile(NULL, tempnamep, "reordercap",
+                                      file_type_subtype, WTAP_UNCOMPRESSED,
+                                      params, &err, &err_info);
+        if (pdh != NULL) {
+            outfile = *tempnamep;
+            g_ptr_array_add(spill_files, *tempnamep);
+        } else {
+            outfile = "temporary file";
+        }
+    } else if (strcmp(outfile, "-") == 0) {
+        pdh = wtap_dump_open_stdout(file_type_subtype, WTAP_UNCOMPRESSED,
+                                    params, &err, &err_info);
+    } else {
+        pdh = wtap_dump_open(outfile, file_type_subtype, WTAP_UNCOMPRESSED,
+                             params, &err, &err_info);
+    }
+    if (pdh == NULL) {
+        cfile_dump_open_failure_message(outfile, err, err_info, file_type_subtype);
+        return NULL;
     }
 
-    /* Open infile */
-    /* TODO: if reordercap is ever changed to give the user a choice of which
-       open_routine reader to use, then the following needs to change. */
-    wth = wtap_open_offline(infile, WTAP_TYPE_AUTO, &err, &err_info, true);
-    if (wth == NULL) {
-        cfile_open_failure_message(infile, err, err_info);
-        ret = WS_EXIT_OPEN_ERROR;
-        goto clean_exit;
+    if (wtap_file_type_subtype_supports_block(file_type_subtype,
+                                              WTAP_BLOCK_IF_ID_AND_INFO) != BLOCK_NOT_SUPPORTED) {
+        for (unsigned i = 0; i < idbs_seen->len; i++) {
+            if (!wtap_dump_add_idb(pdh, g_array_index(idbs_seen, wtap_block_t, i),
+                                   &err, &err_info)) {
+                cfile_dump_open_failure_message(outfile, err, err_info, file_type_subtype);
+                wtap_dump_close(pdh, NULL, &err, &err_info);
+                g_free(err_info);
+                return NULL;
+            }
+        }
     }
-    DEBUG_PRINT("file_type_subtype is %d\n", wtap_file_type_subtype(wth));
+    return pdh;
+}
+
+static void
+reorder_dump_close(wtap_dumper *pdh, const char *outfile)
+{
+    int err;
+    char *err_info;
+
+    if (!wtap_dump_close(pdh, NULL, &err, &err_info)) {
+        cfile_close_failure_message(outfile, err, err_info);
+        reorder_exit(OUTPUT_FILE_ERROR);
+    }
+}
+
+/********************************************************************/
+/* Reordering by random access: read the whole input, sort the      */
+/* frame offsets, and re-read the frames in sorted order.           */
+/********************************************************************/
+static int
+reorder_random_access(wtap *wth, bool write_output_regardless,
+                      const char *infile, const char *outfile)
+{
+    wtap_dumper *pdh = NULL;
+    wtap_rec rec;
+    int err;
+    char *err_info;
+    int64_t data_offset;
+    unsigned wrong_order_count = 0;
+    unsigned i;
+    wtap_dump_params params;
+    int ret = EXIT_SUCCESS;
+
+    GPtrArray *frames;
+    FrameRecord_t *prevFrame = NULL;
 
     /* Allocate the array of frame pointers. */
     frames = g_ptr_array_new();
@@ -253,11 +421,7 @@ main(int argc, char *argv[])
         newFrameRecord = g_slice_new(FrameRecord_t);
         newFrameRecord->num = frames->len + 1;
         newFrameRecord->offset = data_offset;
-        if (rec.presence_flags & WTAP_HAS_TS) {
-            newFrameRecord->frame_time = rec.ts;
-        } else {
-            nstime_set_unset(&newFrameRecord->frame_time);
-        }
+        frame_set_time(&newFrameRecord->frame_time, &rec);
 
         if (prevFrame && frames_compare(&newFrameRecord, &prevFrame) < 0) {
            wrong_order_count++;
@@ -300,9 +464,8 @@ main(int argc, char *argv[])
         if (pdh == NULL) {
             cfile_dump_open_failure_message(outfile, err, err_info,
                                             wtap_file_type_subtype(wth));
-            wtap_dump_params_cleanup(&params);
             ret = OUTPUT_FILE_ERROR;
-            goto clean_exit;
+            goto out;
         }
 
 
@@ -312,8 +475,6 @@ main(int argc, char *argv[])
             FrameRecord_t *frame = (FrameRecord_t *)frames->pdata[i];
 
             frame_write(frame, wth, pdh, &rec, infile, outfile);
-
-            g_slice_free(FrameRecord_t, frame);
         }
 
         wtap_rec_cleanup(&rec);
@@ -323,27 +484,536 @@ main(int argc, char *argv[])
         /* Close outfile */
         if (!wtap_dump_close(pdh, NULL, &err, &err_info)) {
             cfile_close_failure_message(outfile, err, err_info);
-            wtap_dump_params_cleanup(&params);
             ret = OUTPUT_FILE_ERROR;
-            goto clean_exit;
+            goto out;
         }
     } else {
         printf("Not writing output file because input file is already in order.\n");
+    }
 
-        /* Free frame memory */
-        for (i = 0; i < frames->len; i++) {
-            FrameRecord_t *frame = (FrameRecord_t *)frames->pdata[i];
+out:
+    /* Free frame memory and the whole array */
+    for (i = 0; i < frames->len; i++) {
+        g_slice_free(FrameRecord_t, frames->pdata[i]);
+    }
+    g_ptr_array_free(frames, TRUE);
+
+    wtap_dump_params_cleanup(&params);
+
+    return ret;
+}
+
+/********************************************************************/
+/* Reordering within a sliding window: read the input once, holding */
+/* up to "window" frames in a heap and writing the earliest one     */
+/* whenever it is full. Memory use depends only on the window, and  */
+/* the input needn't be seekable. Frames that are out of order by   */
+/* more than the window are written as soon as they come out.       */
+/********************************************************************/
+static int
+reorder_window(wtap *wth, unsigned window,
+               const char *infile, const char *outfile)
+{
+    wtap_dumper *pdh;
+    wtap_dump_params params;
+    GArray *idbs_seen;
+    GPtrArray *heap, *spare;
+    FrameBuffer_t *frame;
+    nstime_t prev_time, last_written;
+    unsigned frame_count = 0;
+    unsigned wrong_order_count = 0;
+    unsigned late_count = 0;
+    int err;
+    char *err_info;
+    int64_t data_offset;
+
+    idbs_seen = g_array_new(FALSE, FALSE, sizeof(wtap_block_t));
+    wtap_dump_params_init_no_idbs(&params, wth);
+    pdh = reorder_dump_open(outfile, NULL, wth, &params, idbs_seen);
+    if (pdh == NULL) {
+        wtap_dump_params_cleanup(&params);
+        idbs_free(idbs_seen);
+        return OUTPUT_FILE_ERROR;
+    }
+
+    heap = g_ptr_array_sized_new(window + 1);
+    spare = g_ptr_array_new_with_free_func(frame_buffer_free);
+    nstime_set_unset(&prev_time);
+    nstime_set_unset(&last_written);
+
+    for (;;) {
+        frame = frame_buffer_get(spare);
+        if (!wtap_read(wth, &frame->rec, &err, &err_info, &data_offset)) {
+            frame_buffer_put(spare, frame);
+            break;
+        }
+        /* The frame may refer to an interface we've only just read about. */
+        if (!process_new_idbs(wth, pdh, idbs_seen, &err, &err_info)) {
+            cfile_write_failure_message(infile, outfile, err, err_info,
+                                        frame_count, wtap_file_type_subtype(wth));
+            reorder_exit(OUTPUT_FILE_ERROR);
+        }
+        frame->num = ++frame_count;
+        frame_set_time(&frame->frame_time, &frame->rec);
+        if (frame_count > 1 && nstime_cmp(&frame->frame_time, &prev_time) < 0) {
+            wrong_order_count++;
+        }
+        prev_time = frame->frame_time;
+
+        heap_push(heap, frame);
+        if (heap->len <= window)
+            continue;
+
+        frame = heap_pop(heap);
+        if (!nstime_is_unset(&last_written) &&
+            nstime_cmp(&frame->frame_time, &last_written) < 0) {
+            late_count++;
+        } else {
+            last_written = frame->frame_time;
+        }
+        rec_write(pdh, &frame->rec, frame->num, infile, outfile,
+                  wtap_file_type_subtype(wth));
+        frame_buffer_put(spare, frame);
+    }
+    if (err != 0) {
+        /* Print a message noting that the read failed somewhere along the line. */
+        cfile_read_failure_message(infile, err, err_info);
+    }
 
-            g_slice_free(FrameRecord_t, frame);
+    /* Write out what's left in the window */
+    while (heap->len > 0) {
+        frame = heap_pop(heap);
+        if (!nstime_is_unset(&last_written) &&
+            nstime_cmp(&frame->frame_time, &last_written) < 0) {
+            late_count++;
         }
+        rec_write(pdh, &frame->rec, frame->num, infile, outfile,
+                  wtap_file_type_subtype(wth));
+        frame_buffer_free(frame);
     }
+    reorder_dump_close(pdh, outfile);
 
+    printf("%u frames, %u out of order\n", frame_count, wrong_order_count);
+    if (late_count > 0) {
+        printf("%u frames were out of order by more than %u frames and are still out of order.\n",
+               late_count, window);
+    }
 
-    /* Free the whole array */
-    g_ptr_array_free(frames, TRUE);
+    g_ptr_array_free(heap, TRUE);
+    g_ptr_array_free(spare, TRUE);
+    wtap_dump_params_cleanup(&params);
+    idbs_free(idbs_seen);
+
+    return EXIT_SUCCESS;
+}
+
+/* Sort the buffered frames and write them to a new temporary file */
+static void
+spill_run(wtap *wth, GPtrArray *frames, GPtrArray *spare, GArray *idbs_seen,
+          GPtrArray *runs, const char *infile)
+{
+    wtap_dumper *pdh;
+    wtap_dump_params params;
+    char *runfile;
+
+    g_ptr_array_sort(frames, frame_buffer_ptrs_compare);
+
+    wtap_dump_params_init_no_idbs(&params, wth);
+    pdh = reorder_dump_open(NULL, &runfile, wth, &params, idbs_seen);
+    if (pdh == NULL)
+        reorder_exit(OUTPUT_FILE_ERROR);
+    for (unsigned i = 0; i < frames->len; i++) {
+        FrameBuffer_t *frame = (FrameBuffer_t *)frames->pdata[i];
+
+        rec_write(pdh, &frame->rec, frame->num, infile, runfile,
+                  wtap_file_type_subtype(wth));
+        frame_buffer_put(spare, frame);
+    }
+    g_ptr_array_set_size(frames, 0);
+    reorder_dump_close(pdh, runfile);
+    wtap_dump_params_cleanup(&params);
+
+    g_ptr_array_add(runs, runfile);
+}
+
+static bool
+run_read_next(SpillRun_t *run)
+{
+    int err;
+    char *err_info;
+    int64_t data_offset;
+
+    wtap_rec_reset(&run->frame.rec);
+    if (!wtap_read(run->wth, &run->frame.rec, &err, &err_info, &data_offset)) {
+        if (err != 0) {
+            cfile_read_failure_message(run->filename, err, err_info);
+            reorder_exit(1);
+        }
+        return false;
+    }
+    frame_set_time(&run->frame.frame_time, &run->frame.rec);
+    return true;
+}
+
+/* Merge "count" sorted runs, starting at "first", into pdh */
+static void
+merge_runs(GPtrArray *runs, unsigned first, unsigned count,
+           wtap_dumper *pdh, const char *outfile, int file_type_subtype)
+{
+    SpillRun_t *run_state;
+    GPtrArray *heap;
+    unsigned written = 0;
+    int err;
+    char *err_info;
+
+    run_state = g_new0(SpillRun_t, count);
+    heap = g_ptr_array_sized_new(count);
+    for (unsigned i = 0; i < count; i++) {
+        SpillRun_t *run = &run_state[i];
+
+        run->filename = (const char *)runs->pdata[first + i];
+        run->wth = wtap_open_offline(run->filename, WTAP_TYPE_AUTO, &err, &err_info, false);
+        if (run->wth == NULL) {
+            cfile_open_failure_message(run->filename, err, err_info);
+            reorder_exit(1);
+        }
+        /* Runs hold consecutive parts of the input, so ties go to the earlier run. */
+        run->frame.num = i;
+        wtap_rec_init(&run->frame.rec, 1514);
+        if (run_read_next(run))
+            heap_push(heap, &run->frame);
+    }
+
+    while (heap->len > 0) {
+        SpillRun_t *run = (SpillRun_t *)heap_pop(heap);
+
+        rec_write(pdh, &run->frame.rec, ++written, outfile, outfile, file_type_subtype);
+        if (run_read_next(run))
+            heap_push(heap, &run->frame);
+    }
+
+    for (unsigned i = 0; i < count; i++) {
+        wtap_rec_cleanup(&run_state[i].frame.rec);
+        wtap_close(run_state[i].wth);
+    }
+    g_ptr_array_free(heap, TRUE);
+    g_free(run_state);
+}
+
+static void
+runs_remove(GPtrArray *runs, unsigned first, unsigned count)
+{
+    for (unsigned i = first; i < first + count; i++) {
+        ws_unlink((const char *)runs->pdata[i]);
+        g_ptr_array_remove(spill_files, runs->pdata[i]);
+    }
+}
+
+/********************************************************************/
+/* Reordering by external merge sort: read the input once, sorting  */
+/* runs of up to "memory_limit" bytes of frames in memory and        */
+/* spilling them to temporary files, then merge the runs. Memory use */
+/* is bounded whatever the disorder, and the input needn't be        */
+/* seekable.                                                         */
+/********************************************************************/
+static int
+reorder_external(wtap *wth, uint64_t memory_limit, bool write_output_regardless,
+                 const char *infile, const char *outfile)
+{
+    wtap_dumper *pdh;
+    wtap_dump_params params;
+    GArray *idbs_seen;
+    GPtrArray *frames, *spare, *runs;
+    FrameBuffer_t *frame;
+    nstime_t prev_time;
+    uint64_t buffered = 0;
+    unsigned frame_count = 0;
+    unsigned wrong_order_count = 0;
+    int err;
+    char *err_info;
+    int64_t data_offset;
+    int ret = EXIT_SUCCESS;
 
+    spill_files = g_ptr_array_new_with_free_func(g_free);
+    idbs_seen = g_array_new(FALSE, FALSE, sizeof(wtap_block_t));
+    frames = g_ptr_array_new();
+    spare = g_ptr_array_new_with_free_func(frame_buffer_free);
+    runs = g_ptr_array_new();
+    nstime_set_unset(&prev_time);
+
+    for (;;) {
+        frame = frame_buffer_get(spare);
+        if (!wtap_read(wth, &frame->rec, &err, &err_info, &data_offset)) {
+            frame_buffer_put(spare, frame);
+            break;
+        }
+        process_new_idbs(wth, NULL, idbs_seen, &err, &err_info);
+        frame->num = ++frame_count;
+        frame_set_time(&frame->frame_time, &frame->rec);
+        if (frame_count > 1 && nstime_cmp(&frame->frame_time, &prev_time) < 0) {
+            wrong_order_count++;
+        }
+        prev_time = frame->frame_time;
+
+        g_ptr_array_add(frames, frame);
+        buffered += sizeof(FrameBuffer_t) + ws_buffer_length(&frame->rec.data);
+        if (buffered >= memory_limit) {
+            spill_run(wth, frames, spare, idbs_seen, runs, infile);
+            buffered = 0;
+        }
+    }
+    if (err != 0) {
+        /* Print a message noting that the read failed somewhere along the line. */
+        cfile_read_failure_message(infile, err, err_info);
+    }
+    process_new_idbs(wth, NULL, idbs_seen, &err, &err_info);
+
+    printf("%u frames, %u out of order\n", frame_count, wrong_order_count);
+
+    if (!write_output_regardless && wrong_order_count == 0) {
+        printf("Not writing output file because input file is already in order.\n");
+        goto out;
+    }
+
+    if (runs->len > 0) {
+        /* Spill the rest too, and merge until few enough runs are left */
+        if (frames->len > 0) {
+            spill_run(wth, frames, spare, idbs_seen, runs, infile);
+        }
+        g_ptr_array_set_size(spare, 0);
+
+        while (runs->len > MAX_MERGE_RUNS) {
+            GPtrArray *merged = g_ptr_array_new();
+
+            for (unsigned first = 0; first < runs->len; first += MAX_MERGE_RUNS) {
+                unsigned count = MIN(MAX_MERGE_RUNS, runs->len - first);
+                char *runfile;
+
+                wtap_dump_params_init_no_idbs(&params, wth);
+                pdh = reorder_dump_open(NULL, &runfile, wth, &params, idbs_seen);
+                if (pdh == NULL)
+                    reorder_exit(OUTPUT_FILE_ERROR);
+                merge_runs(runs, first, count, pdh, runfile, wtap_file_type_subtype(wth));
+                reorder_dump_close(pdh, runfile);
+                wtap_dump_params_cleanup(&params);
+                runs_remove(runs, first, count);
+                g_ptr_array_add(merged, runfile);
+            }
+            g_ptr_array_free(runs, TRUE);
+            runs = merged;
+        }
+    } else {
+        /* Everything fit in memory */
+        g_ptr_array_sort(frames, frame_buffer_ptrs_compare);
+    }
+
+    wtap_dump_params_init_no_idbs(&params, wth);
+    pdh = reorder_dump_open(outfile, NULL, wth, &params, idbs_seen);
+    if (pdh == NULL) {
+        wtap_dump_params_cleanup(&params);
+        ret = OUTPUT_FILE_ERROR;
+        goto out;
+    }
+    if (runs->len > 0) {
+        merge_runs(runs, 0, runs->len, pdh, outfile, wtap_file_type_subtype(wth));
+    } else {
+        for (unsigned i = 0; i < frames->len; i++) {
+            frame = (FrameBuffer_t *)frames->pdata[i];
+            rec_write(pdh, &frame->rec, frame->num, infile, outfile,
+                      wtap_file_type_subtype(wth));
+        }
+    }
+    reorder_dump_close(pdh, outfile);
     wtap_dump_params_cleanup(&params);
 
+out:
+    g_ptr_array_foreach(frames, (GFunc)frame_buffer_free, NULL);
+    g_ptr_array_free(frames, TRUE);
+    g_ptr_array_free(spare, TRUE);
+    g_ptr_array_free(runs, TRUE);
+    idbs_free(idbs_seen);
+    spill_files_remove();
+
+    return ret;
+}
+
+/* Parse a size such as "512", "64k" or "2G"; a plain number is in megabytes */
+static bool
+parse_memory_limit(const char *str, uint64_t *bytes)
+{
+    const char *end;
+    uint64_t value, scale;
+
+    if (!ws_strtou64(str, &end, &value) || value == 0)
+        return false;
+    switch (*end) {
+        case '\0':
+        case 'm':
+        case 'M':
+            scale = 1024 * 1024;
+            break;
+        case 'k':
+        case 'K':
+            scale = 1024;
+            break;
+        case 'g':
+        case 'G':
+            scale = 1024 * 1024 * 1024;
+            break;
+        default:
+            return false;
+    }
+    if (*end != '\0' && end[1] != '\0')
+        return false;
+    if (value > UINT64_MAX / scale)
+        return false;
+    *bytes = value * scale;
+    return true;
+}
+
+/********************************************************************/
+/* Main function.                                                   */
+/********************************************************************/
+int
+main(int argc, char *argv[])
+{
+    char *configuration_init_error;
+    wtap *wth = NULL;
+    int err;
+    char *err_info;
+    bool write_output_regardless = true;
+    unsigned window = 0;
+    uint64_t memory_limit = 0;
+    int                          ret = EXIT_SUCCESS;
+
+    int opt;
+    static const struct ws_option long_options[] = {
+        {"help", ws_no_argument, NULL, 'h'},
+        {"version", ws_no_argument, NULL, 'v'},
+        {0, 0, 0, 0 }
+    };
+    int file_count;
+    char *infile;
+    const char *outfile;
+
+    /* Set the program name. */
+    g_set_prgname("reordercap");
+
+    cmdarg_err_init(stderr_cmdarg_err, stderr_cmdarg_err_cont);
+
+    /* Initialize log handler early so we can have proper logging during startup. */
+    ws_log_init(vcmdarg_err);
+
+    /* Early logging command-line initialization. */
+    ws_log_parse_args(&argc, argv, vcmdarg_err, WS_EXIT_INVALID_OPTION);
+
+    ws_noisy("Finished log init and parsing command line log arguments");
+
+    /*
+     * Get credential information for later use.
+     */
+    init_process_policies();
+
+    /*
+     * Attempt to get the pathname of the directory containing the
+     * executable file.
+     */
+    configuration_init_error = configuration_init(argv[0]);
+    if (configuration_init_error != NULL) {
+        fprintf(stderr,
+                "reordercap: Can't get pathname of directory containing the reordercap program: %s.\n",
+                configuration_init_error);
+        g_free(configuration_init_error);
+    }
+
+    /* Initialize the version information. */
+    ws_init_version_info("Reordercap", NULL, NULL);
+
+    init_report_failure_message("reordercap");
+
+    wtap_init(true);
+
+    /* Process the options first */
+    while ((opt = ws_getopt_long(argc, argv, "hm:nvw:", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'm':
+                if (!parse_memory_limit(ws_optarg, &memory_limit)) {
+                    cmdarg_err("\"%s\" isn't a valid memory limit", ws_optarg);
+                    ret = WS_EXIT_INVALID_OPTION;
+                    goto clean_exit;
+                }
+                break;
+            case 'n':
+                write_output_regardless = false;
+                break;
+            case 'w':
+                window = get_positive_int(ws_optarg, "window size");
+                break;
+            case 'h':
+                show_help_header("Reorder timestamps of input file frames into output file.");
+                print_usage(stdout);
+                goto clean_exit;
+            case 'v':
+                show_version();
+                goto clean_exit;
+            case '?':
+                print_usage(stderr);
+                ret = WS_EXIT_INVALID_OPTION;
+                goto clean_exit;
+        }
+    }
+
+    if (window != 0 && memory_limit != 0) {
+        cmdarg_err("-w and -m can't be used together");
+        ret = WS_EXIT_INVALID_OPTION;
+        goto clean_exit;
+    }
+    /* The output is written as the input is read, so we can't skip it. */
+    if (window != 0 && !write_output_regardless) {
+        cmdarg_err("-n can't be used with -w");
+        ret = WS_EXIT_INVALID_OPTION;
+        goto clean_exit;
+    }
+
+    /* Remaining args are file names */
+    file_count = argc - ws_optind;
+    if (file_count == 2) {
+        infile  = argv[ws_optind];
+        outfile = argv[ws_optind+1];
+    }
+    else {
+        print_usage(stderr);
+        ret = WS_EXIT_INVALID_OPTION;
+        goto clean_exit;
+    }
+
+    /* The standard input can't be read twice. */
+    if (window == 0 && memory_limit == 0 && strcmp(infile, "-") == 0) {
+        memory_limit = DEFAULT_MEMORY_LIMIT;
+    }
+
+    /* Open infile */
+    /* TODO: if reordercap is ever changed to give the user a choice of which
+       open_routine reader to use, then the following needs to change. */
+    wth = wtap_open_offline(infile, WTAP_TYPE_AUTO, &err, &err_info,
+                            window == 0 && memory_limit == 0);
+    if (wth == NULL) {
+        cfile_open_failure_message(infile, err, err_info);
+        ret = WS_EXIT_OPEN_ERROR;
+        goto clean_exit;
+    }
+    DEBUG_PRINT("file_type_subtype is %d\n", wtap_file_type_subtype(wth));
+
+    if (window != 0) {
+        ret = reorder_window(wth, window, infile, outfile);
+    } else if (memory_limit != 0) {
+        ret = reorder_external(wth, memory_limit, write_output_regardless,
+                               infile, outfile);
+    } else {
+        ret = reorder_random_access(wth, write_output_regardless,
+                                    infile, outfile);
+    }
+
     /* Finally, close infile and release resources. */
     wtap_close(wth);
 
@@ -26,6 +26,12 @@
  * the files at switch and not the capture stop, and by closing them which
  * makes possible their move or deletion after a switch).
  *
+ * Completed files can optionally be compressed by a pool of background
+ * threads, so that the capture loop never waits for the compressor. The
+ * file being written is never compressed, so that it can be read while
+ * the capture is running. When a file is to be replaced, whichever of
+ * the uncompressed and compressed files exists is removed; if it is still
+ * being compressed, the compressing thread removes both when it is done.
  */
 
 #include <config.h>
@@ -55,9 +61,21 @@
 #include <wsutil/array.h>
 #include <wsutil/file_util.h>
 
+/* Compression of a completed ringbuffer file */
+typedef struct _rb_compress_job {
+    char          *src;                 /**< Completed file */
+    char          *dst;                 /**< Compressed file */
+    bool           done;                /**< true once the compressing thread is done */
+    bool           orphaned;            /**< no longer referenced by a rb_file; the
+                                             compressing thread frees the job */
+    bool           discard;             /**< the file was replaced; remove both files */
+    int            err;                 /**< error while compressing, or 0 */
+} rb_compress_job;
+
 /* Ringbuffer file structure */
 typedef struct _rb_file {
     char          *name;
+    rb_compress_job *job;               /**< Pending compression, if any */
 } rb_file;
 
 #define MAX_FILENAME_QUEUE  100
@@ -77,10 +95,213 @@ typedef struct _ringbuf_data {
     bool          group_read_access;   /**< true if files need to be opened with group read access */
     FILE         *name_h;              /**< write names of completed files to this handle */
     const char   *compress_type;       /**< compress type */
+
+    /* Compression of completed files */
+    wtap_compression_type post_compress_type;
+    GThreadPool  *compress_pool;
+    GMutex        compress_mutex;      /**< protects the jobs, the counters below and name_h */
+    unsigned      compress_pending;    /**< files queued or being compressed */
+    unsigned      compress_failed;     /**< files that couldn't be compressed */
+    uint64_t      compress_in_bytes;   /**< size of the files compressed so far */
+    uint64_t      compress_out_bytes;  /**< size of the resulting files */
 } ringbuf_data;
 
 static ringbuf_data rb_data;
 
+#define RINGBUF_COMPRESS_BUFSIZE  (64 * 1024)
+#define RINGBUF_COMPRESS_MAX_THREADS 4
+
+/*
+ * Compress job->src to job->dst.
+ */
+static bool
+ringbuf_compress_file_real(rb_compress_job *job, uint64_t *in_bytes,
+                           uint64_t *out_bytes, int *err)
+{
+    int            in_fd, out_fd;
+    pcapio_writer *pdh;
+    uint8_t       *buf;
+    ssize_t        nread;
+    uint64_t       bytes_written = 0;
+    ws_statb64     statb;
+    bool           ok = true;
+
+    in_fd = ws_open(job->src, O_RDONLY|O_BINARY, 0000);
+    if (in_fd == -1) {
+        *err = errno;
+        return false;
+    }
+    out_fd = ws_open(job->dst, O_WRONLY|O_BINARY|O_TRUNC|O_CREAT,
+            rb_data.group_read_access ? 0640 : 0600);
+    if (out_fd == -1) {
+        *err = errno;
+        ws_close(in_fd);
+        return false;
+    }
+    pdh = writecap_fdopen(out_fd, rb_data.post_compress_type, err);
+    if (pdh == NULL) {
+        ws_close(out_fd);
+        ws_close(in_fd);
+        return false;
+    }
+
+    buf = (uint8_t *)g_malloc(RINGBUF_COMPRESS_BUFSIZE);
+    while ((nread = ws_read(in_fd, buf, RINGBUF_COMPRESS_BUFSIZE)) > 0) {
+        if (!writecap_write(pdh, buf, (size_t)nread, &bytes_written, err)) {
+            ok = false;
+            break;
+        }
+    }
+    if (nread < 0) {
+        *err = errno;
+        ok = false;
+    }
+    g_free(buf);
+    ws_close(in_fd);
+
+    if (!writecap_close(pdh, ok ? err : NULL)) {
+        ok = false;
+    }
+    if (!ok) {
+        return false;
+    }
+
+    *in_bytes = bytes_written;
+    *out_bytes = ws_stat64(job->dst, &statb) == 0 ? (uint64_t)statb.st_size : 0;
+    return true;
+}
+
+/*
+ * Thread pool function: compress a completed file, and remove the
+ * uncompressed file once the compressed one is complete.
+ */
+static void
+ringbuf_compress_file(void *data, void *user_data _U_)
+{
+    rb_compress_job *job = (rb_compress_job *)data;
+    uint64_t         in_bytes = 0, out_bytes = 0;
+    bool             discard;
+    int              err = 0;
+
+    g_mutex_lock(&rb_data.compress_mutex);
+    discard = job->discard;
+    g_mutex_unlock(&rb_data.compress_mutex);
+
+    if (!discard && !ringbuf_compress_file_real(job, &in_bytes, &out_bytes, &err)) {
+        ws_unlink(job->dst);
+        if (err == 0) {
+            err = WTAP_ERR_CANT_WRITE;
+        }
+    }
+
+    g_mutex_lock(&rb_data.compress_mutex);
+    rb_data.compress_pending--;
+    if (job->discard) {
+        /* The file was replaced while we were compressing it. */
+        ws_unlink(job->src);
+        ws_unlink(job->dst);
+    } else if (err == 0) {
+        ws_unlink(job->src);
+        rb_data.compress_in_bytes += in_bytes;
+        rb_data.compress_out_bytes += out_bytes;
+        if (rb_data.name_h != NULL) {
+            fprintf(rb_data.name_h, "%s\n", job->dst);
+            fflush(rb_data.name_h);
+        }
+    } else {
+        /* Keep the uncompressed file. */
+        rb_data.compress_failed++;
+        ws_warning("Could not compress %s: %s", job->src, wtap_strerror(err));
+        if (rb_data.name_h != NULL) {
+            fprintf(rb_data.name_h, "%s\n", job->src);
+            fflush(rb_data.name_h);
+        }
+    }
+    job->err = err;
+    job->done = true;
+    if (job->orphaned) {
+        g_free(job->src);
+        g_free(job->dst);
+        g_free(job);
+    }
+    g_mutex_unlock(&rb_data.compress_mutex);
+}
+
+/*
+ * Queue a completed file for compression.
+ */
+static void
+ringbuf_queue_compress(rb_file *rfile)
+{
+    rb_compress_job *job;
+
+    job = g_new0(rb_compress_job, 1);
+    job->src = g_strdup(rfile->name);
+    job->dst = g_strconcat(rfile->name, ".",
+            wtap_compression_type_extension(rb_data.post_compress_type), NULL);
+    rfile->job = job;
+
+    g_mutex_lock(&rb_data.compress_mutex);
+    rb_data.compress_pending++;
+    g_mutex_unlock(&rb_data.compress_mutex);
+
+    g_thread_pool_push(rb_data.compress_pool, job, NULL);
+}
+
+/*
+ * Update a ringbuffer file from its compression job, if there is one.
+ * If the job is not done, it is detached from the file, and if "discard"
+ * is true, the files are removed when it is done.
+ * Must be called with the compress mutex held.
+ */
+static void
+ringbuf_finish_compress(rb_file *rfile, bool discard)
+{
+    rb_compress_job *job = rfile->job;
+
+    if (job == NULL) {
+        return;
+    }
+    rfile->job = NULL;
+
+    if (!job->done) {
+        job->orphaned = true;
+        job->discard = discard;
+        return;
+    }
+
+    if (job->err == 0) {
+        g_free(rfile->name);
+        rfile->name = job->dst;
+        job->dst = NULL;
+    }
+    g_free(job->src);
+    g_free(job->dst);
+    g_free(job);
+}
+
+/*
+ * Wait for all pending compressions to finish.
+ */
+static void
+ringbuf_wait_compress(void)
+{
+    unsigned i;
+
+    if (rb_data.compress_pool == NULL) {
+        return;
+    }
+
+    g_thread_pool_free(rb_data.compress_pool, false, true);
+    rb_data.compress_pool = NULL;
+
+    g_mutex_lock(&rb_data.compress_mutex);
+    for (i = 0; rb_data.files != NULL && i < rb_data.num_files; i++) {
+        ringbuf_finish_compress(&rb_data.files[i], false);
+    }
+    g_mutex_unlock(&rb_data.compress_mutex);
+}
+
 /*
  * create the next filename and open a new binary file with that name
  */
@@ -92,6 +313,13 @@ ringbuf_open_file(rb_file *rfile, int *err)
     time_t  current_time;
     struct tm *tm;
 
+    if (rfile->job != NULL) {
+        /* With an unlimited number of files, the file is kept. */
+        g_mutex_lock(&rb_data.compress_mutex);
+        ringbuf_finish_compress(rfile, !rb_data.unlimited);
+        g_mutex_unlock(&rb_data.compress_mutex);
+    }
+
     if (rfile->name != NULL) {
         if (rb_data.unlimited == false) {
             /* remove old file (if any, so ignore error) */
@@ -155,6 +383,12 @@ ringbuf_init(const char *capfile_name, unsigned num_files, bool group_read_acces
     rb_data.group_read_access = group_read_access;
     rb_data.name_h = NULL;
     rb_data.compress_type = compress_type;
+    rb_data.post_compress_type = WTAP_UNCOMPRESSED;
+    rb_data.compress_pool = NULL;
+    rb_data.compress_pending = 0;
+    rb_data.compress_failed = 0;
+    rb_data.compress_in_bytes = 0;
+    rb_data.compress_out_bytes = 0;
 
     /* just to be sure ... */
     if (num_files <= RINGBUFFER_MAX_NUM_FILES) {
@@ -229,6 +463,7 @@ ringbuf_init(const char *capfile_name, unsigned num_files, bool group_read_acces
 
     for (i=0; i < rb_data.num_files; i++) {
         rb_data.files[i].name = NULL;
+        rb_data.files[i].job = NULL;
     }
 
     /* create the first file */
@@ -269,6 +504,56 @@ ringbuf_set_print_name(char *name, int *err)
     return true;
 }
 
+/*
+ * Compress completed files with the given compression type, in background
+ * threads.
+ */
+bool
+ringbuf_set_post_compression(const char *compress_type)
+{
+    wtap_compression_type ctype = wtap_name_to_compression_type(compress_type);
+    unsigned max_threads;
+
+    if (!wtap_can_write_compression_type(ctype)) {
+        return false;
+    }
+
+    /* Leave a processor for the capture. */
+    max_threads = g_get_num_processors() > 1 ? g_get_num_processors() - 1 : 1;
+    if (max_threads > RINGBUF_COMPRESS_MAX_THREADS) {
+        max_threads = RINGBUF_COMPRESS_MAX_THREADS;
+    }
+
+    rb_data.post_compress_type = ctype;
+    rb_data.compress_pool = g_thread_pool_new(ringbuf_compress_file, NULL,
+            (int)max_threads, false, NULL);
+    return true;
+}
+
+/*
+ * Get the state of the compression of completed files.
+ */
+bool
+ringbuf_get_compress_stats(unsigned *pending, unsigned *failed,
+                           uint64_t *in_bytes, uint64_t *out_bytes)
+{
+    if (rb_data.post_compress_type == WTAP_UNCOMPRESSED) {
+        return false;
+    }
+
+    /* This can be called from a signal handler (SIGINFO); don't wait. */
+    if (!g_mutex_trylock(&rb_data.compress_mutex)) {
+        return false;
+    }
+    *pending = rb_data.compress_pending;
+    *failed = rb_data.compress_failed;
+    *in_bytes = rb_data.compress_in_bytes;
+    *out_bytes = rb_data.compress_out_bytes;
+    g_mutex_unlock(&rb_data.compress_mutex);
+
+    return true;
+}
+
 /*
  * Whether the ringbuf filenames are ready.
  * (Whether ringbuf_init is called and ringbuf_free is not called.)
@@ -317,7 +602,10 @@ ringbuf_switch_file(pcapio_writer* *pdh, char **save_file, int *save_file_fd, in
     rb_data.pdh = NULL;
     rb_data.fd  = -1;
 
-    if (rb_data.name_h != NULL) {
+    if (rb_data.compress_pool != NULL) {
+        /* The name is printed once the file is compressed. */
+        ringbuf_queue_compress(&rb_data.files[rb_data.curr_file_num % rb_data.num_files]);
+    } else if (rb_data.name_h != NULL) {
         fprintf(rb_data.name_h, "%s\n", ringbuf_current_filename());
         fflush(rb_data.name_h);
     }
@@ -362,13 +650,20 @@ ringbuf_libpcap_dump_close(char **save_file, int *err)
         rb_data.fd  = -1;
     }
 
-    if (rb_data.name_h != NULL) {
+    if (rb_data.compress_pool != NULL) {
+        /* Compress the last file too, and wait for all of them. */
+        ringbuf_queue_compress(&rb_data.files[rb_data.curr_file_num % rb_data.num_files]);
+        ringbuf_wait_compress();
+    } else if (rb_data.name_h != NULL) {
         fprintf(rb_data.name_h, "%s\n", ringbuf_current_filename());
         fflush(rb_data.name_h);
+    }
 
+    if (rb_data.name_h != NULL) {
         if (EOF == fclose(rb_data.name_h)) {
             /* Can't really do much about this, can we? */
         }
+        rb_data.name_h = NULL;
     }
 
     /* set the save file name to the current file */
@@ -384,6 +679,8 @@ ringbuf_free(void)
 {
     unsigned int i;
 
+    ringbuf_wait_compress();
+
     if (rb_data.files != NULL) {
         for (i=0; i < rb_data.num_files; i++) {
             if (rb_data.files[i].name != NULL) {
@@ -426,6 +723,8 @@ ringbuf_error_cleanup(void)
         rb_data.fd = -1;
     }
 
+    ringbuf_wait_compress();
+
     if (rb_data.files != NULL) {
         for (i=0; i < rb_data.num_files; i++) {
             if (rb_data.files[i].name != NULL) {
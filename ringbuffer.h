@@ -35,5 +35,8 @@ bool ringbuf_libpcap_dump_close(char **save_file, int *err);
 void ringbuf_free(void);
 void ringbuf_error_cleanup(void);
 bool ringbuf_set_print_name(char *name, int *err);
+bool ringbuf_set_post_compression(const char *compress_type);
+bool ringbuf_get_compress_stats(unsigned *pending, unsigned *failed,
+                                uint64_t *in_bytes, uint64_t *out_bytes);
 
 #endif /* ringbuffer.h */
@@ -22,6 +22,8 @@
 
 #include <epan/exceptions.h>
 #include <epan/epan.h>
+#include <epan/conversation_table.h>
+#include <epan/expert.h>
 
 #include <wsutil/clopts_common.h>
 #include <wsutil/cmdarg_err.h>
@@ -51,6 +53,7 @@
 #include <epan/tap.h>
 #include <epan/uat-int.h>
 #include <epan/secrets.h>
+#include <epan/follow.h>
 
 #include <wsutil/codecs.h>
 
@@ -184,6 +187,18 @@ main(int argc, char *argv[])
     /* Build the column format array */
     build_column_format_array(&cfile.cinfo, prefs_p->num_cols, true);
 
+    /* Record expert info while files are read, for the "expert" tap. */
+    expert_store_set_enabled(true);
+
+    /* Accumulate the tables of the common protocols for the unfiltered
+     * "conv:" and "endpt:" taps. */
+    {
+        const char *proto_names[] = { "eth", "ip", "ipv6", "tcp", "udp" };
+
+        for (size_t i = 0; i < G_N_ELEMENTS(proto_names); i++)
+            conversation_table_store_add(get_conversation_by_proto_id(proto_get_id_by_filter_name(proto_names[i])));
+    }
+
 #ifdef HAVE_MAXMINDDB
     /* mmdbresolve is started from mmdb_resolve_start(), which is called from epan_load_settings via: read_prefs -> (...) uat_load_all -> maxmind_db_post_update_cb.
      * Need to stop it, otherwise all sharkd will have same mmdbresolve process, including pipe descriptors to read and write. */
@@ -502,7 +517,18 @@ sharkd_dissect_request(uint32_t framenum, uint32_t frame_ref_num,
 int
 sharkd_retap(void)
 {
-    uint32_t         framenum;
+    return sharkd_retap_frames(NULL, 0);
+}
+
+/*
+ * Retap only the given frames (in ascending order), or all frames
+ * if frames is NULL.
+ */
+int
+sharkd_retap_frames(const uint32_t *frames, unsigned frames_count)
+{
+    uint32_t         framenum, prev_framenum = 0;
+    unsigned         i;
     frame_data      *fdata;
     wtap_rec         rec;
     int err;
@@ -535,7 +561,14 @@ sharkd_retap(void)
 
     reset_tap_listeners();
 
-    for (framenum = 1; framenum <= cfile.count; framenum++) {
+    if (frames == NULL)
+        frames_count = cfile.count;
+
+    for (i = 0; i < frames_count; i++) {
+        framenum = frames ? frames[i] : i + 1;
+        if (framenum > cfile.count)
+            break;
+
         fdata = sharkd_get_frame(framenum);
 
         if (!wtap_seek_read(cfile.provider.wth, fdata->file_off, &rec, &err, &err_info))
@@ -543,10 +576,11 @@ sharkd_retap(void)
 
         fdata->ref_time = false;
         fdata->frame_ref_num = (framenum != 1) ? 1 : 0;
-        fdata->prev_dis_num = framenum - 1;
+        fdata->prev_dis_num = prev_framenum;
         epan_dissect_run_with_taps(&edt, cfile.cd_t, &rec, fdata, cinfo);
         wtap_rec_reset(&rec);
         epan_dissect_reset(&edt);
+        prev_framenum = framenum;
     }
 
     wtap_rec_cleanup(&rec);
@@ -571,6 +605,9 @@ sharkd_filter(const char *dftext, uint8_t **result)
     uint8_t *result_bits;
     uint8_t passed_bits;
 
+    uint32_t *index_frames;
+    unsigned index_count, index_pos = 0;
+
     epan_dissect_t edt;
 
     if (!dfilter_compile(dftext, &dfcode, NULL)) {
@@ -583,6 +620,9 @@ sharkd_filter(const char *dftext, uint8_t **result)
         return 0;
     }
 
+    /* Stream filters can only match the frames of the stream. */
+    follow_get_filter_frames(dftext, &index_frames, &index_count);
+
     frames_count = cfile.count;
 
     wtap_rec_init(&rec, 1514);
@@ -599,6 +639,12 @@ sharkd_filter(const char *dftext, uint8_t **result)
             passed_bits = 0;
         }
 
+        if (index_frames != NULL) {
+            if (index_pos >= index_count || index_frames[index_pos] != framenum)
+                continue;
+            index_pos++;
+        }
+
         if (!wtap_seek_read(cfile.provider.wth, fdata->file_off, &rec, &err, &err_info))
             break;
 
@@ -629,6 +675,7 @@ sharkd_filter(const char *dftext, uint8_t **result)
     epan_dissect_cleanup(&edt);
 
     dfilter_free(dfcode);
+    g_free(index_frames);
 
     *result = result_bits;
 
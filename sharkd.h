@@ -32,6 +32,7 @@ typedef void (*sharkd_dissect_func_t)(epan_dissect_t *edt, proto_tree *tree, str
 cf_status_t sharkd_cf_open(const char *fname, unsigned int type, bool is_tempfile, int *err);
 int sharkd_load_cap_file(void);
 int sharkd_retap(void);
+int sharkd_retap_frames(const uint32_t *frames, unsigned frames_count);
 int sharkd_filter(const char *dftext, uint8_t **result);
 frame_data *sharkd_get_frame(uint32_t framenum);
 enum dissect_request_status {
@@ -85,6 +85,17 @@ struct sharkd_filter_item
 
 static GHashTable *filter_table;
 
+struct sharkd_iograph_cache_item
+{
+    io_graph_item_t *items;
+    io_graph_pyramid_t pyramid;
+};
+
+static GHashTable *iograph_table;
+
+/* Results of earlier phs requests, per filter. */
+static GHashTable *phs_table;
+
 static int mode;
 static uint32_t rpcid;
 
@@ -386,6 +397,7 @@ json_prep(char* buf, const jsmntok_t* tokens, int count)
         {"method",     "intervals",      1, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
         {"method",     "iograph",        1, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
         {"method",     "load",           1, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
+        {"method",     "memory",         1, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
         {"method",     "setcomment",     1, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
         {"method",     "setconf",        1, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
         {"method",     "status",         1, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
@@ -742,6 +754,16 @@ sharkd_session_filter_free(void *data)
     g_free(l);
 }
 
+static void
+sharkd_session_iograph_cache_free(void *data)
+{
+    struct sharkd_iograph_cache_item *c = (struct sharkd_iograph_cache_item *) data;
+
+    io_graph_pyramid_clear(&c->pyramid);
+    g_free(c->items);
+    g_free(c);
+}
+
 static const struct sharkd_filter_item *
 sharkd_session_filter_data(const char *filter)
 {
@@ -1300,6 +1322,9 @@ sharkd_session_process_load(const char *buf, const jsmntok_t *tokens, int count)
 
     fprintf(stderr, "load: filename=%s\n", tok_file);
 
+    g_hash_table_remove_all(iograph_table);
+    g_hash_table_remove_all(phs_table);
+
     if (sharkd_cf_open(tok_file, WTAP_TYPE_AUTO, false, &err) != CF_OK)
     {
         sharkd_json_error(
@@ -1410,6 +1435,82 @@ sharkd_session_process_status(void)
     sharkd_json_result_epilogue();
 }
 
+static void
+sharkd_session_process_memory_cb(const char *allocator_name, const char *tag,
+        const wmem_stats_t *stats, void *user_data)
+{
+    bool *in_allocator = (bool *) user_data;
+
+    if (tag == NULL)
+    {
+        if (*in_allocator)
+        {
+            sharkd_json_array_close();
+            sharkd_json_object_close();
+        }
+        *in_allocator = true;
+
+        sharkd_json_object_open(NULL);
+        sharkd_json_value_string("name", allocator_name);
+    }
+    else
+    {
+        sharkd_json_object_open(NULL);
+        sharkd_json_value_string("tag", tag);
+    }
+
+    sharkd_json_value_anyf("bytes", "%zu", stats->bytes);
+    sharkd_json_value_anyf("blocks", "%zu", stats->blocks);
+    sharkd_json_value_anyf("peak", "%zu", stats->peak_bytes);
+    sharkd_json_value_anyf("allocs", "%" PRIu64, stats->total_allocs);
+
+    if (tag == NULL)
+        sharkd_json_array_open("tags");
+    else
+        sharkd_json_object_close();
+}
+
+/**
+ * sharkd_session_process_memory()
+ *
+ * Process memory request
+ *
+ * Statistics are only kept if sharkd was started with the
+ * WIRESHARK_DEBUG_WMEM_STATS environment variable set.
+ *
+ * Output object with attributes:
+ *   (m) enabled    - true if memory statistics are kept
+ *   (m) allocators - array of objects with attributes:
+ *                      'name'   - allocator name, e.g. "file"
+ *                      'bytes'  - bytes currently allocated
+ *                      'blocks' - blocks currently allocated
+ *                      'peak'   - highest number of bytes allocated
+ *                      'allocs' - number of allocations made
+ *                      'tags'   - array of objects with the same counters and
+ *                                 'tag' instead of 'name', one per protocol that
+ *                                 made allocations, the largest first
+ */
+static void
+sharkd_session_process_memory(void)
+{
+    bool in_allocator = false;
+
+    sharkd_json_result_prologue(rpcid);
+
+    sharkd_json_value_anyf("enabled", wmem_stats_enabled() ? "true" : "false");
+
+    sharkd_json_array_open("allocators");
+    wmem_stats_foreach(sharkd_session_process_memory_cb, &in_allocator);
+    if (in_allocator)
+    {
+        sharkd_json_array_close();
+        sharkd_json_object_close();
+    }
+    sharkd_json_array_close();
+
+    sharkd_json_result_epilogue();
+}
+
 struct sharkd_analyse_data
 {
     GHashTable *protocols_set;
@@ -2025,6 +2126,19 @@ sharkd_session_packet_tap_expert_cb(void *tapdata, packet_info *pinfo _U_, epan_
     return TAP_PACKET_REDRAW;
 }
 
+static void
+sharkd_session_stored_expert_cb(const expert_info_t *ei, const char *info _U_, void *user_data)
+{
+    struct sharkd_expert_tap *etd = (struct sharkd_expert_tap *) user_data;
+    expert_info_t *ei_copy;
+
+    /* The store's strings last as long as the file. */
+    ei_copy = g_new(expert_info_t, 1);
+    *ei_copy = *ei;
+
+    etd->details = g_slist_prepend(etd->details, ei_copy);
+}
+
 static void
 sharkd_session_free_tap_expert_cb(void *tapdata)
 {
@@ -2107,6 +2221,10 @@ sharkd_session_free_tap_flow_cb(void *tapdata)
     sequence_analysis_info_free(graph_analysis);
 }
 
+/* The same flags as the GUI tables, so that unfiltered tables can be
+ * copied from the conversation table store. */
+#define SHARKD_CONV_TAP_FLAGS TL_IP_AGGREGATION_ORI
+
 struct sharkd_conv_tap_data
 {
     const char *type;
@@ -2395,6 +2513,43 @@ sharkd_session_process_tap_rtp_analyse_cb(void *tapdata)
     json_dumper_end_object(&dumper);
 }
 
+/* Resolve the addresses of all conversations or endpoints in one go,
+ * instead of one at a time while writing them out.
+ */
+static void
+sharkd_session_geoip_prefetch(const struct sharkd_conv_tap_data *iu)
+{
+    GArray *addrs;
+    unsigned i;
+
+    if (iu->hash.conv_array == NULL)
+        return;
+
+    addrs = g_array_sized_new(false, false, sizeof(address), iu->hash.conv_array->len * 2);
+    if (!strncmp(iu->type, "conv:", 5))
+    {
+        for (i = 0; i < iu->hash.conv_array->len; i++)
+        {
+            conv_item_t *iui = &g_array_index(iu->hash.conv_array, conv_item_t, i);
+
+            g_array_append_val(addrs, iui->src_address);
+            g_array_append_val(addrs, iui->dst_address);
+        }
+    }
+    else if (!strncmp(iu->type, "endpt:", 6))
+    {
+        for (i = 0; i < iu->hash.conv_array->len; i++)
+        {
+            endpoint_item_t *endpoint = &g_array_index(iu->hash.conv_array, endpoint_item_t, i);
+
+            g_array_append_val(addrs, endpoint->myaddress);
+        }
+    }
+
+    maxmind_db_lookup_batch((const address *) addrs->data, addrs->len);
+    g_array_free(addrs, true);
+}
+
 /**
  * sharkd_session_process_tap_conv_cb()
  *
@@ -2460,6 +2615,8 @@ sharkd_session_process_tap_conv_cb(void *arg)
 
     proto_with_port = (!strcmp(proto, "TCP") || !strcmp(proto, "UDP") || !strcmp(proto, "SCTP"));
 
+    sharkd_session_geoip_prefetch(iu);
+
     if (iu->hash.conv_array != NULL && !strncmp(iu->type, "conv:", 5))
     {
         for (i = 0; i < iu->hash.conv_array->len; i++)
@@ -2944,6 +3101,12 @@ sharkd_session_free_tap_phs_cb(void *arg)
     free_phs(rs);
 }
 
+static void
+sharkd_session_cache_tap_phs(phs_t *rs)
+{
+    g_hash_table_replace(phs_table, g_strdup(rs->filter ? rs->filter : ""), rs);
+}
+
 struct sharkd_export_object_list
 {
     struct sharkd_export_object_list *next;
@@ -3558,9 +3721,14 @@ sharkd_session_eo_register_tap_listener(register_eo_t *eo, const char *tap_type,
 static void
 sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
 {
+    /* Indexed by request order; only the listeners need a retap. */
     void *taps_data[16];
+    tap_draw_cb taps_draw[16];
     GFreeFunc taps_free[16];
+    bool taps_listening[16];
     int taps_count = 0;
+    int listen_count = 0;
+    bool stored_expert = false;
     int i;
     const char *tap_filter = json_find_attr(buf, tokens, count, "filter");
 
@@ -3573,6 +3741,7 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
         const char *tok_tap;
 
         void *tap_data = NULL;
+        tap_draw_cb tap_draw = NULL;
         GFreeFunc tap_free = NULL;
         GString *tap_error = NULL;
 
@@ -3597,7 +3766,8 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
 
             st = stats_tree_new(cfg, NULL, tap_filter);
 
-            tap_error = register_tap_listener(st->cfg->tapname, st, st->filter, st->cfg->flags, stats_tree_reset, stats_tree_packet, sharkd_session_process_tap_stats_cb, NULL);
+            tap_draw = sharkd_session_process_tap_stats_cb;
+            tap_error = register_tap_listener(st->cfg->tapname, st, st->filter, st->cfg->flags, stats_tree_reset, stats_tree_packet, NULL, NULL);
 
             if (!tap_error && cfg->init)
                 cfg->init(st);
@@ -3612,7 +3782,22 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
             expert_tap = g_new0(struct sharkd_expert_tap, 1);
             expert_tap->text = g_string_chunk_new(100);
 
-            tap_error = register_tap_listener("expert", expert_tap, tap_filter, 0, NULL, sharkd_session_packet_tap_expert_cb, sharkd_session_process_tap_expert_cb, NULL);
+            if ((!tap_filter || !*tap_filter) && !stored_expert &&
+                expert_store_available(cfile.count, false) &&
+                expert_store_foreach(sharkd_session_stored_expert_cb, expert_tap))
+            {
+                /* Recorded by an earlier retap; no need to retap again. */
+                stored_expert = true;
+                taps_data[taps_count] = expert_tap;
+                taps_draw[taps_count] = sharkd_session_process_tap_expert_cb;
+                taps_free[taps_count] = sharkd_session_free_tap_expert_cb;
+                taps_listening[taps_count] = false;
+                taps_count++;
+                continue;
+            }
+
+            tap_draw = sharkd_session_process_tap_expert_cb;
+            tap_error = register_tap_listener("expert", expert_tap, tap_filter, 0, NULL, sharkd_session_packet_tap_expert_cb, NULL, NULL);
 
             tap_data = expert_tap;
             tap_free = sharkd_session_free_tap_expert_cb;
@@ -3644,7 +3829,8 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
             tap_flags = sequence_analysis_get_tap_flags(analysis);
             tap_func  = sequence_analysis_get_packet_func(analysis);
 
-            tap_error = register_tap_listener(tap_name, graph_analysis, tap_filter, tap_flags, NULL, tap_func, sharkd_session_process_tap_flow_cb, NULL);
+            tap_draw = sharkd_session_process_tap_flow_cb;
+            tap_error = register_tap_listener(tap_name, graph_analysis, tap_filter, tap_flags, NULL, tap_func, NULL, NULL);
 
             tap_data = graph_analysis;
             tap_free = sharkd_session_free_tap_flow_cb;
@@ -3701,7 +3887,22 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
             ct_data->resolve_name = true;
             ct_data->resolve_port = true;
 
-            tap_error = register_tap_listener(ct_tapname, &ct_data->hash, tap_filter, 0, NULL, tap_func, sharkd_session_process_tap_conv_cb, NULL);
+            if ((!tap_filter || !*tap_filter) &&
+                (tap_func == get_conversation_packet_func(ct) ?
+                    conversation_table_store_get_conversations(ct, SHARKD_CONV_TAP_FLAGS, &ct_data->hash) :
+                    conversation_table_store_get_endpoints(ct, SHARKD_CONV_TAP_FLAGS, &ct_data->hash)))
+            {
+                /* Accumulated while the file was read; no need to retap. */
+                taps_data[taps_count] = &ct_data->hash;
+                taps_draw[taps_count] = sharkd_session_process_tap_conv_cb;
+                taps_free[taps_count] = sharkd_session_free_tap_conv_cb;
+                taps_listening[taps_count] = false;
+                taps_count++;
+                continue;
+            }
+
+            tap_draw = sharkd_session_process_tap_conv_cb;
+            tap_error = register_tap_listener(ct_tapname, &ct_data->hash, tap_filter, SHARKD_CONV_TAP_FLAGS, NULL, tap_func, NULL, NULL);
 
             tap_data = &ct_data->hash;
             tap_free = sharkd_session_free_tap_conv_cb;
@@ -3726,7 +3927,8 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
             stat_data->stat_tap_data = stat_tap;
             stat_data->user_data = NULL;
 
-            tap_error = register_tap_listener(stat_tap->tap_name, stat_data, tap_filter, 0, NULL, stat_tap->packet_func, sharkd_session_process_tap_nstat_cb, NULL);
+            tap_draw = sharkd_session_process_tap_nstat_cb;
+            tap_error = register_tap_listener(stat_tap->tap_name, stat_data, tap_filter, 0, NULL, stat_tap->packet_func, NULL, NULL);
 
             tap_data = stat_data;
             tap_free = sharkd_session_free_tap_nstat_cb;
@@ -3761,7 +3963,8 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
             rtd_data->user_data = rtd;
             rtd_table_dissector_init(rtd, &rtd_data->stat_table, NULL, NULL);
 
-            tap_error = register_tap_listener(get_rtd_tap_listener_name(rtd), rtd_data, tap_filter, 0, NULL, get_rtd_packet_func(rtd), sharkd_session_process_tap_rtd_cb, NULL);
+            tap_draw = sharkd_session_process_tap_rtd_cb;
+            tap_error = register_tap_listener(get_rtd_tap_listener_name(rtd), rtd_data, tap_filter, 0, NULL, get_rtd_packet_func(rtd), NULL, NULL);
 
             tap_data = rtd_data;
             tap_free = sharkd_session_free_tap_rtd_cb;
@@ -3797,7 +4000,8 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
             srt_data->user_data = srt;
             srt_table_dissector_init(srt, srt_data->srt_array);
 
-            tap_error = register_tap_listener(get_srt_tap_listener_name(srt), srt_data, tap_filter, 0, NULL, get_srt_packet_func(srt), sharkd_session_process_tap_srt_cb, NULL);
+            tap_draw = sharkd_session_process_tap_srt_cb;
+            tap_error = register_tap_listener(get_srt_tap_listener_name(srt), srt_data, tap_filter, 0, NULL, get_srt_packet_func(srt), NULL, NULL);
 
             tap_data = srt_data;
             tap_free = sharkd_session_free_tap_srt_cb;
@@ -3815,13 +4019,15 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
                 return;
             }
 
-            tap_error = sharkd_session_eo_register_tap_listener(eo, tok_tap, tap_filter, sharkd_session_process_tap_eo_cb, &tap_data, &tap_free);
+            tap_draw = sharkd_session_process_tap_eo_cb;
+            tap_error = sharkd_session_eo_register_tap_listener(eo, tok_tap, tap_filter, NULL, &tap_data, &tap_free);
 
             /* tap_data & tap_free assigned by sharkd_session_eo_register_tap_listener */
         }
         else if (!strcmp(tok_tap, "rtp-streams"))
         {
-            tap_error = register_tap_listener("rtp", &rtp_tapinfo, tap_filter, 0, rtpstream_reset_cb, rtpstream_packet_cb, sharkd_session_process_tap_rtp_cb, NULL);
+            tap_draw = sharkd_session_process_tap_rtp_cb;
+            tap_error = register_tap_listener("rtp", &rtp_tapinfo, tap_filter, 0, rtpstream_reset_cb, rtpstream_packet_cb, NULL, NULL);
 
             tap_data = &rtp_tapinfo;
             tap_free = rtpstream_reset_cb;
@@ -3842,7 +4048,8 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
             rtp_req->statinfo.first_packet = true;
             rtp_req->statinfo.reg_pt = PT_UNDEFINED;
 
-            tap_error = register_tap_listener("rtp", rtp_req, tap_filter, 0, NULL, sharkd_session_packet_tap_rtp_analyse_cb, sharkd_session_process_tap_rtp_analyse_cb, NULL);
+            tap_draw = sharkd_session_process_tap_rtp_analyse_cb;
+            tap_error = register_tap_listener("rtp", rtp_req, tap_filter, 0, NULL, sharkd_session_packet_tap_rtp_analyse_cb, NULL, NULL);
 
             tap_data = rtp_req;
             tap_free = sharkd_session_process_tap_rtp_free_cb;
@@ -3852,7 +4059,8 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
             mcaststream_tapinfo_t *mcaststream_tapinfo;
             mcaststream_tapinfo = (mcaststream_tapinfo_t *) g_malloc0(sizeof(*mcaststream_tapinfo));
 
-            tap_error = register_tap_listener("udp", mcaststream_tapinfo, tap_filter, 0, NULL, mcaststream_packet, sharkd_session_process_tap_multicast_cb, NULL);
+            tap_draw = sharkd_session_process_tap_multicast_cb;
+            tap_error = register_tap_listener("udp", mcaststream_tapinfo, tap_filter, 0, NULL, mcaststream_packet, NULL, NULL);
             tap_data = mcaststream_tapinfo;
             tap_free = sharkd_session_process_free_tap_multicast_cb;
         }
@@ -3860,14 +4068,25 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
         {
             phs_t *rs;
 
-            pc_proto_id = proto_registrar_get_id_byname("pkt_comment");
+            rs = (phs_t *) g_hash_table_lookup(phs_table, tap_filter ? tap_filter : "");
+            if (rs)
+            {
+                /* Computed by an earlier request; no need to retap. */
+                taps_data[taps_count] = rs;
+                taps_draw[taps_count] = sharkd_session_process_tap_phs_cb;
+                taps_free[taps_count] = NULL; /* owned by phs_table */
+                taps_listening[taps_count] = false;
+                taps_count++;
+                continue;
+            }
 
             rs = new_phs_t(NULL, tap_filter);
 
+            tap_draw = sharkd_session_process_tap_phs_cb;
             tap_error = register_tap_listener("frame", rs, tap_filter,
-                                              TL_REQUIRES_PROTO_TREE|TL_REQUIRES_PROTOCOLS,
+                                              TL_REQUIRES_NOTHING,
                                               NULL, protohierstat_packet,
-                                              sharkd_session_process_tap_phs_cb, NULL);
+                                              NULL, NULL);
 
             tap_data = rs;
             tap_free = sharkd_session_free_tap_phs_cb;
@@ -3876,7 +4095,8 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
         {
             voip_stat_init_tapinfo();
 
-            tap_error = register_tap_listener("frame", &tapinfo_, tap_filter, 0, NULL, NULL, sharkd_session_process_tap_voip_calls_cb, NULL);
+            tap_draw = sharkd_session_process_tap_voip_calls_cb;
+            tap_error = register_tap_listener("frame", &tapinfo_, tap_filter, 0, NULL, NULL, NULL, NULL);
 
             tapinfo_.session = cfile.epan;
             voip_calls_init_all_taps(&tapinfo_);
@@ -3933,7 +4153,8 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
             voip_convs_req->tapinfo = &tapinfo_;
             voip_convs_req->tap_name = tok_tap;
 
-            tap_error = register_tap_listener("frame", voip_convs_req, tap_filter, 0, NULL, NULL, sharkd_session_process_tap_voip_convs_cb, NULL);
+            tap_draw = sharkd_session_process_tap_voip_convs_cb;
+            tap_error = register_tap_listener("frame", voip_convs_req, tap_filter, 0, NULL, NULL, NULL, NULL);
 
             tapinfo_.session = cfile.epan;
             voip_calls_init_all_taps(&tapinfo_);
@@ -3985,7 +4206,8 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
             hosts_req->dump_v6 = dump_v6;
             hosts_req->tap_name = tok_tap;
 
-            tap_error = register_tap_listener("frame", hosts_req, tap_filter, TL_REQUIRES_PROTO_TREE, NULL, NULL, sharkd_session_process_tap_hosts_cb, NULL);
+            tap_draw = sharkd_session_process_tap_hosts_cb;
+            tap_error = register_tap_listener("frame", hosts_req, tap_filter, TL_REQUIRES_PROTO_TREE, NULL, NULL, NULL, NULL);
 
             tap_data = hosts_req;
             tap_free = sharkd_session_free_tap_hosts_cb;
@@ -4012,32 +4234,39 @@ sharkd_session_process_tap(char *buf, const jsmntok_t *tokens, int count)
         }
 
         taps_data[taps_count] = tap_data;
+        taps_draw[taps_count] = tap_draw;
         taps_free[taps_count] = tap_free;
+        taps_listening[taps_count] = true;
         taps_count++;
+        listen_count++;
     }
 
-    fprintf(stderr, "sharkd_session_process_tap() count=%d\n", taps_count);
-    if (taps_count == 0)
-    {
-        sharkd_json_result_prologue(rpcid);
-        sharkd_json_array_open("taps");
-        sharkd_json_array_close();
-        sharkd_json_result_epilogue();
-        return;
-    }
+    fprintf(stderr, "sharkd_session_process_tap() count=%d retap=%d\n", taps_count, listen_count);
+
+    /*
+     * The listeners are registered without a draw callback; the tap
+     * framework draws them in reverse registration order, so draw every
+     * result here instead to keep the output in request order.
+     */
+    if (listen_count > 0)
+        sharkd_retap();
 
     sharkd_json_result_prologue(rpcid);
     sharkd_json_array_open("taps");
-    sharkd_retap();
+    for (i = 0; i < taps_count; i++)
+        taps_draw[i](taps_data[i]);
     sharkd_json_array_close();
     sharkd_json_result_epilogue();
 
     for (i = 0; i < taps_count; i++)
     {
-        if (taps_data[i])
+        if (taps_listening[i] && taps_data[i])
             remove_tap_listener(taps_data[i]);
 
-        if (taps_free[i])
+        if (taps_listening[i] && taps_free[i] == sharkd_session_free_tap_phs_cb)
+            /* Keep the statistics for later requests with the same filter. */
+            sharkd_session_cache_tap_phs((phs_t *)taps_data[i]);
+        else if (taps_free[i])
             taps_free[i](taps_data[i]);
     }
 }
@@ -4081,6 +4310,9 @@ sharkd_session_process_follow(char *buf, const jsmntok_t *tokens, int count)
     const char *host;
     char *port;
 
+    uint32_t *stream_frames;
+    unsigned stream_frames_count;
+
     follower = get_follow_by_name(tok_follow);
     if (!follower)
     {
@@ -4114,7 +4346,14 @@ sharkd_session_process_follow(char *buf, const jsmntok_t *tokens, int count)
         return;
     }
 
-    sharkd_retap();
+    /* Only the frames of the followed stream need to be dissected. */
+    if (follow_get_filter_frames(tok_filter, &stream_frames, &stream_frames_count))
+    {
+        sharkd_retap_frames(stream_frames, stream_frames_count);
+        g_free(stream_frames);
+    }
+    else
+        sharkd_retap();
 
     sharkd_json_result_prologue(rpcid);
 
@@ -4520,6 +4759,7 @@ sharkd_session_process_frame_cb(epan_dissect_t *edt, proto_tree *tree, struct ep
 }
 
 #define SHARKD_IOGRAPH_MAX_ITEMS 1 << 25 /* 33,554,432 limit of items, same as max_io_items_ in ui/qt/io_graph_dialog.h */
+#define SHARKD_IOGRAPH_CACHE_MAX_ITEMS (1 << 20) /* larger results are not kept for later requests */
 
 struct sharkd_iograph
 {
@@ -4528,6 +4768,8 @@ struct sharkd_iograph
     io_graph_item_unit_t calc_type;
     uint32_t interval;
     bool aot;
+    char *cache_key;
+    bool tapped;
 
     /* result */
     int space_items;
@@ -4536,6 +4778,51 @@ struct sharkd_iograph
     GString *error;
 };
 
+/*
+ * Results of earlier iograph requests are kept, with their power-of-two
+ * rollups, per graph and filter. A request for the same graph at a multiple
+ * of a cached interval is served from memory instead of retapping.
+ */
+static bool
+sharkd_iograph_from_cache(struct sharkd_iograph *graph)
+{
+    struct sharkd_iograph_cache_item *c;
+    io_graph_item_t *items;
+    size_t count;
+
+    c = (struct sharkd_iograph_cache_item *) g_hash_table_lookup(iograph_table, graph->cache_key);
+    if (!c || c->pyramid.hf_index != graph->hf_index)
+        return false;
+
+    items = io_graph_pyramid_get_items(&c->pyramid, graph->interval, &count);
+    if (!items)
+        return false;
+
+    graph->items = items;
+    graph->num_items = (int) count;
+    graph->space_items = (int) count;
+    return true;
+}
+
+static void
+sharkd_iograph_to_cache(const struct sharkd_iograph *graph)
+{
+    struct sharkd_iograph_cache_item *c;
+
+    if (graph->num_items > SHARKD_IOGRAPH_CACHE_MAX_ITEMS)
+        return;
+
+    /* Keep the finest interval, it can serve more requests. */
+    c = (struct sharkd_iograph_cache_item *) g_hash_table_lookup(iograph_table, graph->cache_key);
+    if (c && c->pyramid.interval <= graph->interval)
+        return;
+
+    c = g_new0(struct sharkd_iograph_cache_item, 1);
+    c->items = (io_graph_item_t *) g_memdup2(graph->items, sizeof(io_graph_item_t) * graph->num_items);
+    io_graph_pyramid_build(&c->pyramid, c->items, graph->num_items, graph->interval, graph->hf_index);
+    g_hash_table_replace(iograph_table, g_strdup(graph->cache_key), c);
+}
+
 static tap_packet_status
 sharkd_iograph_packet(void *g, packet_info *pinfo, epan_dissect_t *edt, const void *dummy _U_, tap_flags_t flags _U_)
 {
@@ -4590,6 +4877,9 @@ sharkd_iograph_packet(void *g, packet_info *pinfo, epan_dissect_t *edt, const vo
  * Graph requests can be one of: "packets", "bytes", "bits", "sum:<field>", "frames:<field>", "max:<field>", "min:<field>", "avg:<field>", "load:<field>",
  * if you use variant with <field>, you need to pass field name in filter request.
  *
+ * A graph requested earlier with the same filter at an interval that divides
+ * the requested one is computed from the earlier result, without retapping.
+ *
  * Output object with attributes:
  *   (m) iograph - array of graph results with attributes:
  *                  errmsg - graph cannot be constructed
@@ -4699,6 +4989,8 @@ sharkd_session_process_iograph(char *buf, const jsmntok_t *tokens, int count)
         graph->space_items = 0; /* TODO, can avoid realloc()s in sharkd_iograph_packet() by calculating: capture_time / interval */
         graph->num_items = 0;
         graph->items = NULL;
+        graph->cache_key = g_strdup_printf("%s\n%s", tok_graph, tok_filter ? tok_filter : "");
+        graph->tapped = false;
 
         snprintf(tok_format_buf, sizeof(tok_format_buf), "aot%d", i);
         tok_aot = json_find_attr(buf, tokens, count, tok_format_buf);
@@ -4709,8 +5001,11 @@ sharkd_session_process_iograph(char *buf, const jsmntok_t *tokens, int count)
             graph->aot = false;
         }
 
-        if (!graph->error)
+        if (!graph->error && !sharkd_iograph_from_cache(graph))
+        {
             graph->error = register_tap_listener("frame", graph, tok_filter, TL_REQUIRES_PROTO_TREE, NULL, sharkd_iograph_packet, NULL, NULL);
+            graph->tapped = (graph->error == NULL);
+        }
 
         graph_count++;
 
@@ -4721,14 +5016,21 @@ sharkd_session_process_iograph(char *buf, const jsmntok_t *tokens, int count)
                     "%s", graph->error->str
                     );
             g_string_free(graph->error, TRUE);
+            for (i = 0; i < graph_count; i++)
+            {
+                if (graphs[i].tapped)
+                    remove_tap_listener(&graphs[i]);
+                g_free(graphs[i].items);
+                g_free(graphs[i].cache_key);
+            }
             return;
         }
 
-        if (graph->error == NULL)
+        if (graph->tapped)
             is_any_ok = true;
     }
 
-    /* retap only if we have at least one ok */
+    /* retap only if we have at least one graph not served from the cache */
     if (is_any_ok)
         sharkd_retap();
 
@@ -4774,8 +5076,13 @@ sharkd_session_process_iograph(char *buf, const jsmntok_t *tokens, int count)
         }
         json_dumper_end_object(&dumper);
 
-        remove_tap_listener(graph);
+        if (graph->tapped)
+        {
+            remove_tap_listener(graph);
+            sharkd_iograph_to_cache(graph);
+        }
         g_free(graph->items);
+        g_free(graph->cache_key);
     }
     sharkd_json_array_close();
 
@@ -5340,6 +5647,8 @@ sharkd_session_process_setcomment(char *buf, const jsmntok_t *tokens, int count)
     else
     {
         sharkd_set_modified_block(fdata, pkt_block);
+        g_hash_table_remove_all(iograph_table);
+        g_hash_table_remove_all(phs_table);
         sharkd_json_simple_ok(rpcid);
     }
 }
@@ -5391,6 +5700,9 @@ sharkd_session_process_setconf(char *buf, const jsmntok_t *tokens, int count)
     switch (ret)
     {
         case PREFS_SET_OK:
+            /* Dissection results, and hence graphs, may change. */
+            g_hash_table_remove_all(iograph_table);
+            g_hash_table_remove_all(phs_table);
             sharkd_json_simple_ok(rpcid);
             break;
 
@@ -6085,6 +6397,8 @@ sharkd_session_process(char *buf, const jsmntok_t *tokens, int count)
             sharkd_session_process_dumpconf(buf, tokens, count);
         else if (!strcmp(tok_method, "download"))
             sharkd_session_process_download(buf, tokens, count);
+        else if (!strcmp(tok_method, "memory"))
+            sharkd_session_process_memory();
         else if (!strcmp(tok_method, "bye"))
         {
             sharkd_json_simple_ok(rpcid);
@@ -6114,6 +6428,8 @@ sharkd_session_main(int mode_setting)
     dumper.output_file = stdout;
 
     filter_table = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, sharkd_session_filter_free);
+    iograph_table = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, sharkd_session_iograph_cache_free);
+    phs_table = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, sharkd_session_free_tap_phs_cb);
 
 #ifdef HAVE_MAXMINDDB
     /* mmdbresolve was stopped before fork(), force starting it */
@@ -6164,6 +6480,8 @@ sharkd_session_main(int mode_setting)
     }
 
     g_hash_table_destroy(filter_table);
+    g_hash_table_destroy(iograph_table);
+    g_hash_table_destroy(phs_table);
     g_free(tokens);
 
     return 0;
@@ -0,0 +1,64 @@
+#
+# Wireshark tests
+#
+# SPDX-License-Identifier: GPL-2.0-or-later
+#
+'''Capinfos tests'''
+
+import hashlib
+import subprocess
+import pytest
+
+
+def run_capinfos(cmd_capinfos, args, env):
+    proc = subprocess.run([cmd_capinfos] + args, capture_output=True, env=env)
+    assert proc.returncode == 0
+    return proc.stdout.decode('utf-8')
+
+
+class TestCapinfos:
+    @pytest.mark.parametrize('capture_name', ['dhcp.pcap', 'dhcp.pcapng', 'dns+icmp.pcapng.gz'])
+    def test_capinfos_hashes(self, cmd_capinfos, capture_file, capture_name, test_env):
+        '''Hashes computed while reading match hashes of the whole file'''
+        capfile = capture_file(capture_name)
+        with open(capfile, 'rb') as f:
+            contents = f.read()
+        stdout = run_capinfos(cmd_capinfos, ['-H', capfile], test_env)
+        assert hashlib.sha256(contents).hexdigest() in stdout
+        assert hashlib.sha1(contents).hexdigest() in stdout
+
+    def test_capinfos_jobs(self, cmd_capinfos, capture_file, test_env):
+        '''Parallel processing reports the same infos in the same order'''
+        capfiles = [capture_file(name) for name in (
+            'dhcp.pcap', 'dhcp.pcapng', 'dns+icmp.pcapng.gz', 'many_interfaces.pcapng.1', 'dhcp.pcap')]
+        serial = run_capinfos(cmd_capinfos, ['-j', '1'] + capfiles, test_env)
+        parallel = run_capinfos(cmd_capinfos, ['-j', '4'] + capfiles, test_env)
+        assert serial == parallel
+
+    def test_capinfos_quick(self, cmd_capinfos, capture_file, test_env):
+        '''Packet count and times come from the trailing interface statistics'''
+        capfile = capture_file('icmp_ascii.pcapng')
+        full = run_capinfos(cmd_capinfos, ['-M', '-c', '-a', '-d', capfile], test_env)
+        quick = run_capinfos(cmd_capinfos, ['-M', '-c', '-a', '-d', '--quick', capfile], test_env)
+        count_line = [l for l in full.splitlines() if l.startswith('Number of packets')]
+        assert count_line and count_line[0] in quick
+        assert 'Data size:           n/a' in quick
+        assert 'Data size:           n/a' not in full
+
+    def test_capinfos_quick_fallback(self, cmd_capinfos, capture_file, test_env):
+        '''Files without interface statistics are read as usual'''
+        capfile = capture_file('dhcp.pcapng')
+        full = run_capinfos(cmd_capinfos, ['-M', '-c', '-d', capfile], test_env)
+        quick = run_capinfos(cmd_capinfos, ['-M', '-c', '-d', '--quick', capfile], test_env)
+        assert full == quick
+
+    def test_capinfos_quick_multi_section(self, cmd_capinfos, capture_file, result_file, test_env):
+        '''Interface statistics in a later section are not used for the first one'''
+        capfile = result_file('multi_section.pcapng')
+        with open(capfile, 'wb') as out_f:
+            for name in ('dhcp.pcapng', 'icmp_ascii.pcapng'):
+                with open(capture_file(name), 'rb') as in_f:
+                    out_f.write(in_f.read())
+        full = run_capinfos(cmd_capinfos, ['-M', '-c', '-a', '-e', '-d', capfile], test_env)
+        quick = run_capinfos(cmd_capinfos, ['-M', '-c', '-a', '-e', '-d', '--quick', capfile], test_env)
+        assert full == quick
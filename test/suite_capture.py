@@ -265,11 +265,13 @@ def check_dumpcap_autostop_stdin(cmd_dumpcap, cmd_capinfos, result_file):
 
 @pytest.fixture
 def check_dumpcap_ringbuffer_stdin(cmd_dumpcap, cmd_capinfos, result_file):
-    def check_dumpcap_ringbuffer_stdin_real(self, packets=None, filesize=None, env=None):
+    def check_dumpcap_ringbuffer_stdin_real(self, packets=None, filesize=None, compress=None, env=None):
         # Similar to check_capture_stdin.
         rb_unique = 'dhcp_rb_' + uuid.uuid4().hex[:6] # Random ID
         testout_file = result_file('testout.{}.pcapng'.format(rb_unique))
         testout_glob = result_file('testout.{}_*.pcapng'.format(rb_unique))
+        if compress is not None:
+            testout_glob += '.gz'
         cat100_dhcp_cmd = cat_dhcp_command('cat100')
         condition='oops:invalid'
 
@@ -287,12 +289,17 @@ def check_dumpcap_ringbuffer_stdin(cmd_dumpcap, cmd_capinfos, result_file):
             '-a', 'files:2',
             '-b', condition,
         ))
+        if compress is not None:
+            capture_cmd += ' -b compress:' + compress
         if sysconfig.get_platform().startswith('mingw'):
             pytest.skip('FIXME Pipes are broken with the MSYS2 shell')
         subprocesstest.check_run(cat100_dhcp_cmd + ' | ' + capture_cmd, shell=True, env=env)
 
         rb_files = glob.glob(testout_glob)
         assert len(rb_files) == 2
+        if compress is not None:
+            # The uncompressed files are removed once compressed.
+            assert not glob.glob(result_file('testout.{}_*.pcapng'.format(rb_unique)))
 
         for rbf in rb_files:
             assert os.path.isfile(rbf)
@@ -579,6 +586,10 @@ class TestDumpcapRingbuffer:
         '''Capture from stdin using Dumpcap and write multiple files until we reach a packet limit'''
         check_dumpcap_ringbuffer_stdin(self, packets=47, env=base_env) # Last prime before 50. Arbitrary.
 
+    def test_dumpcap_ringbuffer_compress(self, check_dumpcap_ringbuffer_stdin, base_env):
+        '''Capture from stdin using Dumpcap and compress the completed files in the background'''
+        check_dumpcap_ringbuffer_stdin(self, packets=47, compress='gzip', env=base_env)
+
 
 class TestDumpcapPcapngSections:
     def test_dumpcap_pcapng_single_in_single_out(self, check_dumpcap_pcapng_sections, base_env):
@@ -8,6 +8,7 @@
 #
 '''Command line option tests'''
 
+import hashlib
 import json
 import sys
 import os.path
@@ -315,6 +316,41 @@ class TestTsharkZExpert:
         assert not grep_output(proc.stdout, 'Chats')
 
 
+class TestTsharkZPhs:
+    def test_tshark_z_phs_icmp_error(self, cmd_tshark, capture_file, test_env):
+        '''The headers quoted in ICMP errors are not counted as layers'''
+        proc = subprocesstest.run((cmd_tshark, '-q', '-z', 'io,phs,icmp.type == 3',
+            '-r', capture_file('dns-mdns.pcap')), capture_output=True, env=test_env)
+        # dns-mdns.pcap has 20 ICMP port unreachable errors for mDNS.
+        protos = [line.split()[0] for line in proc.stdout.splitlines() if ' frames:' in line]
+        assert protos == ['frame', 'eth', 'ip', 'icmp']
+        assert grep_output(proc.stdout, r'icmp\s+frames:20 ')
+
+    # Objects in http-ooo.pcap: file name, SHA-1 of the contents.
+    http_objects = {
+        '1': '83f5a5c359f3dc8317519240e32f1f51f68bc051',
+        '3': 'a214ad86e2def05fcb0f4c878dfebe5a6041fb7e',
+        '4': '4a4121ecd766ed16943a0c7b54c18f743e90c3f6',
+        '5': '580393f5a94fb469585f5dd2a6859a4aab899f37',
+    }
+
+    def test_tshark_export_objects_http(self, cmd_tshark, capture_file, result_file, test_env):
+        eo_dir = result_file('eo-http')
+        for _ in range(2):
+            subprocesstest.check_run((cmd_tshark, '-q',
+                '-o', 'tcp.reassemble_out_of_order:TRUE',
+                '--export-objects', 'http,' + eo_dir,
+                '-r', capture_file('http-ooo.pcap')), env=test_env)
+        # The second run must not overwrite the files of the first, but
+        # add a "(1)" to their names.
+        expected = dict(self.http_objects)
+        expected.update({name + '(1)': sha1 for name, sha1 in self.http_objects.items()})
+        assert sorted(os.listdir(eo_dir)) == sorted(expected)
+        for name, sha1 in expected.items():
+            with open(os.path.join(eo_dir, name), 'rb') as f:
+                assert hashlib.sha1(f.read()).hexdigest() == sha1, name
+
+
 class TestTsharkExtcap:
     # dumpcap dependency has been added to run this test only with capture support
     def test_tshark_extcap_interfaces(self, cmd_tshark, cmd_dumpcap, test_env, home_path):
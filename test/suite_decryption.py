@@ -8,12 +8,17 @@
 #
 '''Decryption tests'''
 
+import hashlib
+import hmac
 import os.path
 import shutil
+import stat
+import struct
 import subprocess
 from subprocesstest import grep_output, count_output
 import sys
 import sysconfig
+import threading
 import types
 import pytest
 import binascii
@@ -41,6 +46,51 @@ class TestDecrypt80211:
             ), encoding='utf-8', env=test_env)
         assert grep_output(stdout, 'favicon.ico')
 
+    def test_80211_wpa_pwd_psk_cache(self, cmd_tshark, capture_file, conf_path, test_env):
+        '''IEEE 802.11 WPA password with the derived key cache'''
+        tshark_cmd = (cmd_tshark,
+                '-o', 'wlan.enable_decryption: TRUE',
+                '-Tfields',
+                '-e', 'http.request.uri',
+                '-r', capture_file('wpa-Induction.pcap.gz'),
+                '-Y', 'http',
+            )
+        cache_tshark_cmd = tshark_cmd + ('-o', 'wlan.cache_derived_keys: TRUE')
+
+        # Derived keys aren't saved unless asked for.
+        cache_file = os.path.join(conf_path, '80211_psk_cache')
+        stdout = subprocess.check_output(tshark_cmd, encoding='utf-8', env=test_env)
+        assert grep_output(stdout, 'favicon.ico')
+        assert not os.path.exists(cache_file)
+
+        stdout = subprocess.check_output(cache_tshark_cmd, encoding='utf-8', env=test_env)
+        assert grep_output(stdout, 'favicon.ico')
+        if sys.platform != 'win32':
+            assert stat.S_IMODE(os.stat(cache_file).st_mode) == 0o600
+
+        # The "wildcard" password "Induction" was derived for SSID "Coherer"
+        # and saved in the profile, with an HMAC of the password keyed with
+        # the salt of the file.
+        with open(cache_file) as f:
+            lines = f.readlines()
+        salt = [line.split()[1] for line in lines if line.startswith('salt ')]
+        assert len(salt) == 1
+        pwd_hmac = hmac.new(bytes.fromhex(salt[0]), b'Induction', hashlib.sha256).hexdigest()
+        ssid_hex = binascii.hexlify(b'Coherer').decode()
+        entry = [line for line in lines if line.split() == [pwd_hmac, line.split()[1], ssid_hex]]
+        assert len(entry) == 1
+        assert not grep_output(''.join(lines), hashlib.sha256(b'Induction').hexdigest())
+
+        # The next run uses the saved key instead of deriving it; a wrong
+        # key makes decryption fail.
+        with open(cache_file, 'w') as f:
+            for line in lines:
+                if line in entry:
+                    line = '%s %s %s\n' % (pwd_hmac, '00' * 32, ssid_hex)
+                f.write(line)
+        stdout = subprocess.check_output(cache_tshark_cmd, encoding='utf-8', env=test_env)
+        assert not grep_output(stdout, 'favicon.ico')
+
     def test_80211_wpa_eap(self, cmd_tshark, capture_file, test_env):
         '''IEEE 802.11 WPA EAP (EAPOL Rekey)'''
         # Included in git sources test/captures/wpa-eap-tls.pcap.gz
@@ -566,6 +616,175 @@ class TestDecryptTLS:
             fr'13|/second|{second_response}',
         ] == stdout.splitlines()
 
+    def test_tls13_rfc8446_keylog_format(self, cmd_tshark, dirs, features, capture_file, result_file, test_env):
+        '''TLS 1.3 with a key log having CRLF line endings, comments, unknown lines and no final newline.'''
+        with open(os.path.join(dirs.key_dir, 'tls13-rfc8446.keys')) as f:
+            key_lines = f.read().splitlines()
+        key_lines.insert(0, '# comment')
+        key_lines.insert(1, 'UNKNOWN_SECRET 00112233 44556677')
+        key_lines[2] += ' trailing text'
+        key_file = result_file('tls13-rfc8446-crlf.keys')
+        with open(key_file, 'w', newline='') as f:
+            f.write('\r\n'.join(key_lines))
+        stdout = subprocess.check_output((cmd_tshark,
+                '-r', capture_file('tls13-rfc8446.pcap'),
+                '-otls.keylog_file:{}'.format(key_file),
+                '-Y', 'http',
+                '-Tfields',
+                '-e', 'frame.number',
+                '-e', 'http.request.uri',
+                '-E', 'separator=|',
+            ), encoding='utf-8', env=test_env)
+        assert [
+            r'5|/first',
+            r'6|/first',
+            r'8|/early',
+            r'10|/early',
+            r'12|/second',
+            r'13|/second',
+        ] == stdout.splitlines()
+
+    # The http.request.uri of the decrypted frames of tls13-rfc8446.pcap.
+    tls13_rfc8446_uris = [
+        r'5|/first',
+        r'6|/first',
+        r'8|/early',
+        r'10|/early',
+        r'12|/second',
+        r'13|/second',
+    ]
+
+    @staticmethod
+    def tls13_rfc8446_key_lines(dirs):
+        '''Returns the key log lines of the first and second session.'''
+        with open(os.path.join(dirs.key_dir, 'tls13-rfc8446.keys')) as f:
+            key_lines = f.read().splitlines()
+        first = [line for line in key_lines if line.split()[1].startswith('2635fafc')]
+        second = [line for line in key_lines if line.split()[1].startswith('b67947da')]
+        assert len(first) + len(second) == len(key_lines)
+        return first, second
+
+    @staticmethod
+    def wrong_secrets(key_lines):
+        '''Returns the key log lines with all-zero secrets.'''
+        wrong_lines = []
+        for line in key_lines:
+            label, client_random, secret = line.split()
+            wrong_lines.append(' '.join((label, client_random, '0' * len(secret))))
+        return wrong_lines
+
+    def test_tls13_rfc8446_keylog_large(self, cmd_tshark, dirs, capture_file, result_file, test_env):
+        '''TLS 1.3 with a key log of several MiB, which is parsed in chunks in parallel.'''
+        first, second = self.tls13_rfc8446_key_lines(dirs)
+        # Secrets of other sessions, about 3.5 MB.
+        filler = ['CLIENT_RANDOM {:064x} {:096x}'.format(i, i) for i in range(20000)]
+        # Wrong secrets at the start must be replaced by the right ones
+        # later in the file, even if they are parsed in another chunk.
+        key_lines = self.wrong_secrets(first + second) + filler[:10000] + first + filler[10000:] + second
+        key_file = result_file('tls13-rfc8446-large.keys')
+        with open(key_file, 'w') as f:
+            f.write('\n'.join(key_lines) + '\n')
+        assert os.path.getsize(key_file) > 3 * 1024 * 1024
+        stdout = subprocess.check_output((cmd_tshark,
+                '-r', capture_file('tls13-rfc8446.pcap'),
+                '-otls.keylog_file:{}'.format(key_file),
+                '-Y', 'http',
+                '-Tfields',
+                '-e', 'frame.number',
+                '-e', 'http.request.uri',
+                '-E', 'separator=|',
+            ), encoding='utf-8', env=test_env)
+        assert self.tls13_rfc8446_uris == stdout.splitlines()
+
+    @pytest.mark.parametrize('update', ['append', 'truncate'])
+    def test_tls13_rfc8446_keylog_reread(self, update, cmd_tshark, dirs, capture_file, result_file, test_env):
+        '''TLS 1.3 with a key log that is updated between the two sessions.'''
+        first, second = self.tls13_rfc8446_key_lines(dirs)
+        key_file = result_file('tls13-rfc8446-update.keys')
+        with open(key_file, 'w') as f:
+            if update == 'append':
+                f.write('\n'.join(first) + '\n')
+            else:
+                # Rewriting the file with the right secrets for the second
+                # session makes it smaller than what was already read.
+                padding = ['# ' + 'x' * 100] * 100
+                f.write('\n'.join(first + self.wrong_secrets(second) + padding) + '\n')
+
+        # Split the capture after the first session, frames 1 to 6.
+        with open(capture_file('tls13-rfc8446.pcap'), 'rb') as f:
+            pcap = f.read()
+        records = []
+        offset = 24
+        while offset < len(pcap):
+            caplen = struct.unpack('<I', pcap[offset + 8:offset + 12])[0]
+            records.append(pcap[offset:offset + 16 + caplen])
+            offset += 16 + caplen
+        assert len(records) == 13
+
+        proc = subprocess.Popen((cmd_tshark,
+                '-l',
+                '-r', '-',
+                '-otls.keylog_file:{}'.format(key_file),
+                '-Tfields',
+                '-e', 'frame.number',
+                '-e', 'http.request.uri',
+                '-E', 'separator=|',
+            ), stdin=subprocess.PIPE, stdout=subprocess.PIPE, env=test_env)
+        watchdog = threading.Timer(60, proc.kill)
+        watchdog.start()
+        try:
+            proc.stdin.write(pcap[:24] + b''.join(records[:6]))
+            proc.stdin.flush()
+            lines = []
+            while not lines or not lines[-1].startswith('6|'):
+                line = proc.stdout.readline().decode('utf-8')
+                if not line:
+                    break
+                lines.append(line.rstrip('\r\n'))
+            assert lines[-1] == '6|/first'
+
+            if update == 'append':
+                with open(key_file, 'a') as f:
+                    f.write('\n'.join(second) + '\n')
+            else:
+                with open(key_file, 'w') as f:
+                    f.write('\n'.join(second) + '\n')
+
+            proc.stdin.write(b''.join(records[6:]))
+            proc.stdin.close()
+            lines += proc.stdout.read().decode('utf-8').splitlines()
+            assert proc.wait() == 0
+        finally:
+            watchdog.cancel()
+        assert self.tls13_rfc8446_uris == [line for line in lines if not line.endswith('|')]
+
+    @pytest.mark.parametrize('passes', [1, 2])
+    def test_tls13_rfc8446_dsb_and_keylog(self, passes, cmd_editcap, cmd_tshark, dirs, capture_file, result_file, test_env):
+        '''TLS 1.3 with the secrets of the first session in a Decryption Secrets Block, loaded when first needed, and those of the second in a key log.'''
+        first, second = self.tls13_rfc8446_key_lines(dirs)
+        dsb_file = result_file('tls13-rfc8446-first.keys')
+        with open(dsb_file, 'w') as f:
+            f.write('\n'.join(first) + '\n')
+        key_file = result_file('tls13-rfc8446-second.keys')
+        with open(key_file, 'w') as f:
+            f.write('\n'.join(second) + '\n')
+        outfile = result_file('tls13-rfc8446-dsb.pcapng')
+        subprocess.run((cmd_editcap,
+            '-F', 'pcapng',
+            '--inject-secrets', 'tls,%s' % dsb_file,
+            capture_file('tls13-rfc8446.pcap'), outfile
+        ), check=True, env=test_env)
+        stdout = subprocess.check_output([cmd_tshark,
+                '-r', outfile,
+                '-otls.keylog_file:{}'.format(key_file),
+                '-Y', 'http',
+                '-Tfields',
+                '-e', 'frame.number',
+                '-e', 'http.request.uri',
+                '-E', 'separator=|',
+            ] + (['-2'] if passes == 2 else []), encoding='utf-8', env=test_env)
+        assert self.tls13_rfc8446_uris == stdout.splitlines()
+
     def test_tls13_rfc8446_noearly(self, cmd_tshark, dirs, features, capture_file, test_env):
         '''TLS 1.3 (with undecryptable early data).'''
         key_file = os.path.join(dirs.key_dir, 'tls13-rfc8446-noearly.keys')
@@ -812,6 +812,44 @@ class TestDissectTcp:
             encoding='utf-8', env=test_env)
         assert stdout == '2\t16\n'
 
+class TestDissectHeuristics:
+    @staticmethod
+    def run_heuristics(cmd_tshark, capture_file, test_env, extraArgs=[]):
+        proc = subprocess.run([cmd_tshark,
+                '-r', capture_file('dns_port.pcap'),
+                '-Tfields', '-eframe.number', '-eframe.protocols',
+                '--print-heuristic-stats',
+            ] + extraArgs, encoding='utf-8', env=test_env,
+            stdout=subprocess.PIPE, stderr=subprocess.PIPE, check=True)
+        stats = [line.split('\t') for line in proc.stderr.splitlines()]
+        return proc.stdout, stats
+
+    def test_heuristic_probe_packets(self, cmd_tshark, capture_file, test_env):
+        '''The per-flow rejection cache doesn't change the first pass dissection.'''
+        plain_out, plain_stats = self.run_heuristics(cmd_tshark, capture_file, test_env)
+        assert plain_stats[0] == ['List', 'Heuristic', 'Calls', 'Accepted', 'Skipped']
+        assert all(row[4] == '0' for row in plain_stats[1:])
+
+        cached_out, cached_stats = self.run_heuristics(cmd_tshark, capture_file, test_env,
+                ['-o', 'protocols.heuristic_probe_packets:1'])
+        assert cached_stats[0] == plain_stats[0]
+        # The query of each flow is rejected by the heuristics, so they
+        # must be skipped for the response, with the same result.
+        assert cached_out == plain_out
+        cached_skips = sum(int(row[4]) for row in cached_stats[1:])
+        assert cached_skips > 0
+        plain_calls = sum(int(row[2]) for row in plain_stats[1:])
+        cached_calls = sum(int(row[2]) for row in cached_stats[1:])
+        assert cached_calls + cached_skips == plain_calls
+
+    def test_heuristic_probe_packets_twopass(self, cmd_tshark, capture_file, test_env):
+        '''Both passes make the same decisions.'''
+        onepass_out, _ = self.run_heuristics(cmd_tshark, capture_file, test_env,
+                ['-o', 'protocols.heuristic_probe_packets:1'])
+        twopass_out, _ = self.run_heuristics(cmd_tshark, capture_file, test_env,
+                ['-o', 'protocols.heuristic_probe_packets:1', '-2'])
+        assert onepass_out == twopass_out
+
 class TestDissectGit:
     def test_git_prot(self, cmd_tshark, capture_file, features, test_env):
         '''
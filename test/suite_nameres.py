@@ -10,7 +10,10 @@
 
 import os.path
 import shutil
+import socket
+import struct
 import subprocess
+import threading
 from subprocesstest import grep_output
 import pytest
 
@@ -104,3 +107,97 @@ class TestNameResolution:
                 ), encoding='utf-8', env=base_env)
         assert '174.137.42.65\twww.wireshark.org' not in stdout
         assert 'fe80::6233:4bff:fe13:c558\tCrunch.local' in stdout
+
+
+class StubDnsServer:
+    '''A minimal DNS server that answers every PTR query with a name
+    derived from the query name.'''
+    def __init__(self):
+        self.sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.sock.bind(('127.0.0.1', 0))
+        self.port = self.sock.getsockname()[1]
+        self.queries = 0
+        self.thread = threading.Thread(target=self._serve, daemon=True)
+        self.thread.start()
+
+    def _serve(self):
+        while True:
+            try:
+                query, peer = self.sock.recvfrom(512)
+            except OSError:
+                return
+            # Question name, starting after the 12 byte header.
+            labels = []
+            pos = 12
+            while query[pos] != 0:
+                labels.append(query[pos + 1:pos + 1 + query[pos]].decode('ascii'))
+                pos += 1 + query[pos]
+            question = query[12:pos + 5]
+            if labels[-2:] == ['in-addr', 'arpa']:
+                name = 'stub-' + '-'.join(reversed(labels[:-2])) + '.example'
+            else:
+                name = 'stub-v6-' + ''.join(reversed(labels[:-2]))[-4:] + '.example'
+            rdata = b''.join(bytes([len(l)]) + l.encode('ascii') for l in name.split('.')) + b'\0'
+            answer = struct.pack('!HHHIH', 0xc00c, 12, 1, 3600, len(rdata)) + rdata
+            header = query[:2] + struct.pack('!HHHHH', 0x8180, 1, 1, 0, 0)
+            self.queries += 1
+            self.sock.sendto(header + question + answer, peer)
+
+    def close(self):
+        self.sock.close()
+
+
+class TestDnsCache:
+    def run_tshark(self, cmd_tshark, capture_file, env):
+        return subprocess.run((cmd_tshark,
+            '-r', capture_file('dns+icmp.pcapng.gz'),
+            '-o', 'nameres.network_name: TRUE',
+            '-o', 'nameres.use_external_name_resolver: TRUE',
+            '-o', 'nameres.dns_pkt_addr_resolution: FALSE',
+            '-o', 'nameres.use_custom_dns_servers: TRUE',
+            '-o', 'nameres.dns_cache: TRUE',
+            ), check=True, capture_output=True, encoding='utf-8', env=env).stdout
+
+    def test_dns_cache_file(self, cmd_tshark, capture_file, conf_path, base_env):
+        '''Names resolved via DNS are reused from the cache file.'''
+        server = StubDnsServer()
+        with open(os.path.join(conf_path, 'addr_resolve_dns_servers'), 'w') as f:
+            f.write('"127.0.0.1","{0}","{0}"\n'.format(server.port))
+        try:
+            stdout = self.run_tshark(cmd_tshark, capture_file, base_env)
+        finally:
+            server.close()
+        assert server.queries > 0
+        assert 'stub-8-8-8-8.example' in stdout
+        assert os.path.isfile(os.path.join(conf_path, 'dns_cache'))
+
+        # The server is gone; names must come from the cache file.
+        stdout = self.run_tshark(cmd_tshark, capture_file, base_env)
+        assert 'stub-8-8-8-8.example' in stdout
+
+
+class TestBulkNameResolution:
+    def test_bulk_name_resolution(self, cmd_tshark, capture_file, conf_path, base_env):
+        '''Addresses queued on the first pass are resolved in bulk.'''
+        server = StubDnsServer()
+        with open(os.path.join(conf_path, 'addr_resolve_dns_servers'), 'w') as f:
+            f.write('"127.0.0.1","{0}","{0}"\n'.format(server.port))
+        try:
+            # Two passes, as a single pass resolves names synchronously.
+            # The first pass doesn't need a tree to queue the addresses.
+            stdout = subprocess.run((cmd_tshark,
+                '-r', capture_file('dns+icmp.pcapng.gz'),
+                '-2',
+                '-o', 'nameres.network_name: TRUE',
+                '-o', 'nameres.use_external_name_resolver: TRUE',
+                '-o', 'nameres.dns_pkt_addr_resolution: FALSE',
+                '-o', 'nameres.use_custom_dns_servers: TRUE',
+                '-o', 'nameres.bulk_name_resolution: TRUE',
+                '-T', 'fields',
+                '-e', 'ip.src_host',
+                '-e', 'ip.dst_host',
+                ), check=True, capture_output=True, encoding='utf-8', env=base_env).stdout
+        finally:
+            server.close()
+        assert server.queries > 0
+        assert grep_output(stdout, 'stub-8-8-8-8.example')
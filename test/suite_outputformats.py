@@ -11,6 +11,7 @@
 import json
 import os.path
 import subprocess
+import time
 from matchers import *
 import pytest
 
@@ -89,3 +90,45 @@ class TestOutputFormats:
         ''' Check that the option -j works with -Tek.'''
         check_outputformat("ek", extra_args=['-j', 'dhcp'], expected="dhcp-filter.ek",
             multiline=True, env=base_env)
+
+    def test_outputformat_arrow(self, cmd_tshark, capture_file, base_env):
+        '''Checks that -Tarrow writes typed columns as an Arrow IPC stream.'''
+        tshark_proc = subprocess.run([cmd_tshark, '-r', capture_file('dhcp.pcap'),
+                                      '-T', 'arrow', '-E', 'occurrence=f',
+                                      '-e', 'frame.number', '-e', 'ip.src',
+                                      '-e', 'udp.srcport', '-e', 'dhcp.option.type'],
+                                      check=True, capture_output=True, env=base_env)
+        stream = tshark_proc.stdout
+        # Schema message first, end-of-stream marker last.
+        assert stream[:4] == b'\xff\xff\xff\xff'
+        assert stream[-8:] == b'\xff\xff\xff\xff\x00\x00\x00\x00'
+
+        ipc = pytest.importorskip('pyarrow.ipc')
+        table = ipc.open_stream(stream).read_all()
+        assert table.column_names == ['frame.number', 'ip.src', 'udp.srcport', 'dhcp.option.type']
+        assert str(table.schema.field('frame.number').type) == 'uint32'
+        assert str(table.schema.field('ip.src').type) == 'string'
+        assert table.column('frame.number').to_pylist() == [1, 2, 3, 4]
+        assert table.column('ip.src').to_pylist() == ['0.0.0.0', '192.168.0.1', '0.0.0.0', '192.168.0.1']
+        assert table.column('udp.srcport').to_pylist() == [68, 67, 68, 67]
+        assert table.column('dhcp.option.type').to_pylist() == [53, 53, 53, 53]
+
+    def test_outputformat_ek_throughput(self, cmd_tshark, capture_file, base_env, record_property):
+        '''Benchmarks -Tek -x and records the throughput.
+
+        The rate is reported as the "ek_packets_per_second" property of the
+        test (e.g. in the JUnit XML written by "pytest --junitxml"), so it can
+        be tracked over time. No threshold is enforced here.'''
+        start = time.perf_counter()
+        tshark_proc = subprocess.run([cmd_tshark, '-r', capture_file('sip-rtp.pcapng'),
+                                      '-T', 'ek', '-x'],
+                                      check=True, capture_output=True, encoding='utf-8', env=base_env)
+        elapsed = time.perf_counter() - start
+        lines = tshark_proc.stdout.splitlines()
+        # An index line and a document line per packet.
+        assert len(lines) % 2 == 0
+        for line in lines:
+            json.loads(line)
+        packets = len(lines) // 2
+        assert packets > 0
+        record_property('ek_packets_per_second', round(packets / elapsed))
@@ -0,0 +1,86 @@
+#
+# Wireshark tests
+#
+# SPDX-License-Identifier: GPL-2.0-or-later
+#
+'''Reordercap tests'''
+
+import subprocess
+import pytest
+
+
+@pytest.fixture
+def shuffled_capture(cmd_editcap, cmd_mergecap, capture_file, result_file, test_env):
+    '''The first 40 frames of dns-mdns.pcap, with frames 21-40 before 1-20.'''
+    first = result_file('first.pcap')
+    second = result_file('second.pcap')
+    shuffled = result_file('shuffled.pcap')
+    subprocess.check_call((cmd_editcap, '-r', capture_file('dns-mdns.pcap'), first, '1-20'), env=test_env)
+    subprocess.check_call((cmd_editcap, '-r', capture_file('dns-mdns.pcap'), second, '21-40'), env=test_env)
+    subprocess.check_call((cmd_mergecap, '-a', '-F', 'pcap', '-w', shuffled, second, first), env=test_env)
+    return shuffled
+
+
+def frame_times(cmd_tshark, capfile, env):
+    stdout = subprocess.check_output((cmd_tshark, '-r', capfile,
+        '-T', 'fields', '-e', 'frame.time_epoch',
+        ), encoding='utf-8', env=env)
+    return [float(t) for t in stdout.split()]
+
+
+class TestReordercap:
+    def run_reordercap(self, cmd_reordercap, args, env, stdin=None):
+        proc = subprocess.run([cmd_reordercap] + args, input=stdin,
+            capture_output=True, env=env)
+        assert proc.returncode == 0
+        return proc.stdout.decode('utf-8')
+
+    def check_sorted(self, cmd_tshark, infile, outfile, env):
+        assert frame_times(cmd_tshark, outfile, env) == sorted(frame_times(cmd_tshark, infile, env))
+
+    def test_reordercap_random_access(self, cmd_reordercap, cmd_tshark, shuffled_capture, result_file, test_env):
+        '''Reorder by re-reading the frames in order'''
+        outfile = result_file('out.pcap')
+        stdout = self.run_reordercap(cmd_reordercap, [shuffled_capture, outfile], test_env)
+        assert '40 frames, ' in stdout
+        self.check_sorted(cmd_tshark, shuffled_capture, outfile, test_env)
+
+    def test_reordercap_window(self, cmd_reordercap, cmd_tshark, shuffled_capture, result_file, test_env):
+        '''Reorder within a window large enough for all of the disorder'''
+        outfile = result_file('out.pcap')
+        stdout = self.run_reordercap(cmd_reordercap, ['-w', '40', shuffled_capture, outfile], test_env)
+        assert 'still out of order' not in stdout
+        self.check_sorted(cmd_tshark, shuffled_capture, outfile, test_env)
+
+    def test_reordercap_window_too_small(self, cmd_reordercap, cmd_tshark, shuffled_capture, result_file, test_env):
+        '''Frames out of order by more than the window are reported and kept'''
+        outfile = result_file('out.pcap')
+        stdout = self.run_reordercap(cmd_reordercap, ['-w', '2', shuffled_capture, outfile], test_env)
+        assert 'still out of order' in stdout
+        assert len(frame_times(cmd_tshark, outfile, test_env)) == 40
+
+    def test_reordercap_external(self, cmd_reordercap, cmd_tshark, shuffled_capture, result_file, test_env):
+        '''Reorder by merging sorted runs spilled to temporary files'''
+        outfile = result_file('out.pcap')
+        self.run_reordercap(cmd_reordercap, ['-m', '1k', shuffled_capture, outfile], test_env)
+        self.check_sorted(cmd_tshark, shuffled_capture, outfile, test_env)
+
+    def test_reordercap_external_pcapng(self, cmd_reordercap, cmd_tshark, capture_file, result_file, test_env):
+        '''Spilled pcapng runs keep the interfaces of their frames'''
+        infile = capture_file('many_interfaces.pcapng.1')
+        outfile = result_file('out.pcapng')
+        self.run_reordercap(cmd_reordercap, ['-m', '1k', infile, outfile], test_env)
+        self.check_sorted(cmd_tshark, infile, outfile, test_env)
+
+    def test_reordercap_stdin(self, cmd_reordercap, cmd_tshark, shuffled_capture, result_file, test_env):
+        '''The standard input is read once'''
+        outfile = result_file('out.pcap')
+        with open(shuffled_capture, 'rb') as f:
+            self.run_reordercap(cmd_reordercap, ['-', outfile], test_env, stdin=f.read())
+        self.check_sorted(cmd_tshark, shuffled_capture, outfile, test_env)
+
+    def test_reordercap_external_in_order(self, cmd_reordercap, capture_file, result_file, test_env):
+        '''-n skips writing an ordered file'''
+        outfile = result_file('out.pcap')
+        stdout = self.run_reordercap(cmd_reordercap, ['-n', '-m', '1k', capture_file('dhcp.pcap'), outfile], test_env)
+        assert 'Not writing output file' in stdout
@@ -283,13 +283,6 @@ class TestSharkd:
             {"jsonrpc":"2.0","id":2,"error":{"code":-32600,"message":"Mandatory parameter tap0 is missing"}},
             {"jsonrpc":"2.0","id":3,"result":{
                 "taps": [
-                    {
-                        "tap": "endpt:TCP",
-                        "type": "host",
-                        "proto": "TCP",
-                        "geoip": MatchAny(bool),
-                        "hosts": [],
-                    },
                     {
                         "tap": "conv:Ethernet",
                         "type": "conv",
@@ -320,6 +313,13 @@ class TestSharkd:
                             }
                         ],
                     },
+                    {
+                        "tap": "endpt:TCP",
+                        "type": "host",
+                        "proto": "TCP",
+                        "geoip": MatchAny(bool),
+                        "hosts": [],
+                    },
                 ]
             }},
         ))
@@ -616,6 +616,100 @@ class TestSharkd:
             }},
         ))
 
+    def test_sharkd_req_tap_phs_cached(self, check_sharkd_session, capture_file):
+        phs_ipv6 = {
+            "taps": [{
+                "tap": "phs",
+                "type": "phs",
+                "filter": "ipv6",
+                "protos": [{
+                    "bytes": 7566,
+                    "frames": 39,
+                    "proto": "frame",
+                    "protos": [{
+                        "bytes": 7566,
+                        "frames": 39,
+                        "proto": "eth",
+                        "protos": [{
+                            "bytes": 7566,
+                            "frames": 39,
+                            "proto": "ipv6",
+                            "protos": [{
+                                "bytes": 3684,
+                                "frames": 36,
+                                "proto": "icmpv6"
+                            },{
+                                "bytes": 3882,
+                                "frames": 3,
+                                "proto": "udp",
+                                "protos": [{
+                                    "bytes": 3882,
+                                    "frames": 3,
+                                    "proto": "data"
+                                }]
+                            }]
+                        }]
+                    }]
+                }]
+            }]
+        }
+        # The second request is answered from the result of the first.
+        check_sharkd_session((
+            {"jsonrpc":"2.0", "id":1, "method":"load",
+             "params":{"file": capture_file('protohier-without-comments.pcapng')}
+             },
+            {"jsonrpc":"2.0", "id":2, "method":"tap", "params":{"tap0": "phs", "filter": "ipv6"}},
+            {"jsonrpc":"2.0", "id":3, "method":"tap", "params":{"tap0": "phs", "filter": "ipv6"}},
+        ), (
+            {"jsonrpc":"2.0","id":1,"result":{"status":"OK"}},
+            {"jsonrpc":"2.0","id":2,"result":phs_ipv6},
+            {"jsonrpc":"2.0","id":3,"result":phs_ipv6},
+        ))
+
+    @pytest.mark.parametrize('capture_name', ['http-ooo.pcap', 'dns-response-missing.pcap'])
+    def test_sharkd_req_tap_expert_stored(self, run_sharkd_session, capture_file, capture_name):
+        # Without a filter, expert info comes from the store once a retap
+        # has recorded every frame. It must match a retap ("frame" matches
+        # every frame but forces one), including items that dissectors
+        # only add after the first pass, like "DNS response missing".
+        commands = [
+            {"jsonrpc":"2.0", "id":1, "method":"load",
+             "params":{"file": capture_file(capture_name)}},
+            {"jsonrpc":"2.0", "id":2, "method":"tap", "params":{"tap0": "expert"}},
+            {"jsonrpc":"2.0", "id":3, "method":"tap", "params":{"tap0": "expert"}},
+            {"jsonrpc":"2.0", "id":4, "method":"tap", "params":{"tap0": "expert", "filter": "frame"}},
+        ]
+        outputs = run_sharkd_session([json.dumps(x) for x in commands])
+        assert len(outputs) == len(commands)
+        assert outputs[0]["result"] == {"status": "OK"}
+        first, stored, retapped = (output["result"]["taps"] for output in outputs[1:])
+        assert len(stored) == 1 and stored[0]["details"]
+        assert stored == first
+        assert stored == retapped
+        if capture_name == 'dns-response-missing.pcap':
+            assert [item["f"] for item in stored[0]["details"] if item["m"] == "DNS response missing"] == [3]
+
+    def test_sharkd_req_tap_conv_stored(self, run_sharkd_session, capture_file):
+        # Without a filter, the common conversation and endpoint tables come
+        # from the store filled while the file was loaded. They must match a
+        # retap.
+        taps = {"tap0": "conv:TCP", "tap1": "endpt:IPv4", "tap2": "conv:Ethernet"}
+        commands = [
+            {"jsonrpc":"2.0", "id":1, "method":"load",
+             "params":{"file": capture_file('http-ooo.pcap')}},
+            {"jsonrpc":"2.0", "id":2, "method":"tap", "params":taps},
+            {"jsonrpc":"2.0", "id":3, "method":"tap", "params":dict(taps, filter="frame")},
+        ]
+        outputs = run_sharkd_session([json.dumps(x) for x in commands])
+        assert len(outputs) == len(commands)
+        assert outputs[0]["result"] == {"status": "OK"}
+        stored, retapped = outputs[1]["result"]["taps"], outputs[2]["result"]["taps"]
+        stored = sorted(stored, key=lambda tap: tap["tap"])
+        retapped = sorted(retapped, key=lambda tap: tap["tap"])
+        assert [tap["tap"] for tap in stored] == sorted(taps.values())
+        assert all(tap.get("convs") or tap.get("hosts") for tap in stored)
+        assert stored == retapped
+
     def test_sharkd_req_tap_voip_calls(self, check_sharkd_session, capture_file):
         check_sharkd_session((
             {"jsonrpc":"2.0", "id":1, "method":"load",
@@ -1201,6 +1295,25 @@ class TestSharkd:
             },
         ))
 
+    def test_sharkd_req_follow_stream_index(self, run_sharkd_session, capture_file):
+        # "tcp.stream eq N" only dissects the frames of the stream; the
+        # parenthesized filter can't use the stream index and dissects
+        # every frame. Both must give the same result.
+        commands = [{"jsonrpc":"2.0", "id":1, "method":"load",
+                     "params":{"file": capture_file('http-ooo.pcap')}}]
+        for stream in range(3):
+            for flt in ('tcp.stream eq %d' % stream, '(tcp.stream eq %d)' % stream):
+                commands.append({"jsonrpc":"2.0", "id":len(commands) + 1, "method":"follow",
+                                 "params":{"follow": "TCP", "filter": flt}})
+                commands.append({"jsonrpc":"2.0", "id":len(commands) + 1, "method":"frames",
+                                 "params":{"filter": flt}})
+        outputs = run_sharkd_session([json.dumps(x) for x in commands])
+        assert len(outputs) == len(commands)
+        assert outputs[0]["result"] == {"status": "OK"}
+        for indexed, full in zip(outputs[1::4] + outputs[2::4], outputs[3::4] + outputs[4::4]):
+            assert "result" in indexed
+            assert indexed["result"] == full["result"]
+
     def test_sharkd_req_follow_http2(self, check_sharkd_session, capture_file, features):
         # If we don't have nghttp2, we output the compressed headers.
         # We could test against the expected output in that case, but
@@ -1252,6 +1365,28 @@ class TestSharkd:
             {"jsonrpc":"2.0","id":5,"error":{"code":-7003,"message":"Invalid interval_units parameter: 'garbage units', must be 's', 'ms' or 'us'"}},
         ))
 
+    def test_sharkd_req_iograph_rollup(self, run_sharkd_session, capture_file):
+        # Coarser intervals are computed from the result of an earlier,
+        # finer request. They must match a fresh retap.
+        graphs = {"graph0": "max:udp.length", "filter0": "udp.length",
+                  "graph1": "min:frame.len", "filter1": "frame.len",
+                  "graph2": "avg:frame.time_delta", "filter2": "frame.time_delta",
+                  "graph3": "bytes"}
+        load = {"jsonrpc":"2.0", "id":1, "method":"load",
+                "params":{"file": capture_file('dhcp.pcap')}}
+
+        def iograph(req_id, interval, units):
+            return {"jsonrpc":"2.0", "id":req_id, "method":"iograph",
+                    "params":dict(graphs, interval=interval, interval_units=units)}
+
+        cached = run_sharkd_session([json.dumps(x) for x in (
+            load, iograph(2, 250, 'us'), iograph(3, 1, 's'), iograph(4, 10, 's'))])
+        fresh_1s = run_sharkd_session([json.dumps(x) for x in (load, iograph(3, 1, 's'))])
+        fresh_10s = run_sharkd_session([json.dumps(x) for x in (load, iograph(4, 10, 's'))])
+        assert "result" in cached[2]
+        assert cached[2] == fresh_1s[1]
+        assert cached[3] == fresh_10s[1]
+
     def test_sharkd_req_iograph_basic(self, check_sharkd_session, capture_file):
         check_sharkd_session((
             {"jsonrpc":"2.0", "id":1, "method":"load",
@@ -1593,6 +1728,39 @@ class TestSharkd:
                 "file":"4","mime":"application/octet-stream","data":"Zm91cgo="}},
             {"jsonrpc":"2.0","id":6,"result":{}},
         ))
+    def test_sharkd_req_memory_disabled(self, check_sharkd_session):
+        check_sharkd_session((
+            {"jsonrpc":"2.0", "id":1, "method":"memory"},
+        ), (
+            {"jsonrpc":"2.0","id":1,"result":{"enabled":False,"allocators":[]}},
+        ))
+
+    def test_sharkd_req_memory(self, cmd_sharkd, base_env, capture_file):
+        env = base_env.copy()
+        env['WIRESHARK_DEBUG_WMEM_STATS'] = '1'
+        commands = (
+            {"jsonrpc":"2.0", "id":1, "method":"load",
+            "params":{"file": capture_file('dhcp.pcap')}
+            },
+            {"jsonrpc":"2.0", "id":2, "method":"memory"},
+        )
+        sharkd_proc = subprocess.run((cmd_sharkd, '-'),
+            input='\n'.join(json.dumps(x) for x in commands),
+            capture_output=True, encoding='utf-8', env=env)
+        outputs = [json.loads(line) for line in sharkd_proc.stdout.splitlines() if line.strip()]
+        assert outputs[0] == {"jsonrpc":"2.0","id":1,"result":{"status":"OK"}}
+        result = outputs[1]['result']
+        assert result['enabled'] is True
+        allocators = {a['name']: a for a in result['allocators']}
+        assert allocators.keys() >= {'packet', 'file', 'epan'}
+        file_scope = allocators['file']
+        assert file_scope['bytes'] > 0
+        assert file_scope['peak'] >= file_scope['bytes']
+        assert file_scope['allocs'] >= file_scope['blocks']
+        assert sum(tag['bytes'] for tag in file_scope['tags']) == file_scope['bytes']
+        tags = {tag['tag'] for a in result['allocators'] for tag in a['tags']}
+        assert 'DHCP' in tags
+
     def test_sharkd_req_bye(self, check_sharkd_session):
         check_sharkd_session((
             {"jsonrpc":"2.0", "id":1, "method":"bye"},
@@ -8,8 +8,10 @@
 #
 '''Text2pcap tests'''
 
+import random
 import re
 import subprocess
+import time
 from subprocesstest import get_capture_info, grep_output
 import json
 import pytest
@@ -359,6 +361,48 @@ class TestText2pcapParsing:
             'datasize': 33, 'expert': ''} == \
             run_text2pcap_capinfos_tshark(pdata, ("-Erawip4", "--little-endian"))
 
+    def test_text2pcap_mixed_lines(self, check_rawip):
+        '''Verify: regular hex dump lines mixed with comments, text, byte
+           groups and different line endings give the same packets.'''
+        pdata = "# comment\r\n" \
+                "0000  45 00 00 21 00 01 00 00 40 11 7c c9 7f 00 00 01  E..!....@.|.....\r\n" \
+                "0010  7f 00 00 01 ff 98 00 13  000d b548 6669 7273\r\n" \
+                "0020  74\r\n" \
+                "Some text between packets\n" \
+                "0000  45 00 00 22 00 01 00 00 40 11 7c c8 7f 00 00 01\n\r" \
+                "0010  7f 00 00 01 ff 99 00 13 00 0e bc e9 73 65 63 6f\n" \
+                "0020  6e 64"
+        check_rawip(pdata, 2, 67)
+
+    def test_text2pcap_hexdump_throughput(self, cmd_text2pcap, cmd_capinfos, result_file, base_env, record_property):
+        '''Benchmarks importing a large "hexdump -C" style dump.
+
+        The rate is reported as the "hexdump_bytes_per_second" property of the
+        test. No threshold is enforced here.'''
+        packets = 4000
+        packet_len = 600
+        rng = random.Random(39)
+        testin_file = result_file(testin_txt)
+        testout_file = result_file(testout_pcap)
+        with open(testin_file, 'w') as f:
+            for _ in range(packets):
+                data = bytes(rng.randrange(256) for _ in range(packet_len))
+                for off in range(0, packet_len, 16):
+                    line = data[off:off + 16]
+                    hex_str = ' '.join('%02x' % b for b in line[:8])
+                    if len(line) > 8:
+                        hex_str += '  ' + ' '.join('%02x' % b for b in line[8:])
+                    ascii_str = ''.join(chr(b) if 0x20 <= b < 0x7f else '.' for b in line)
+                    f.write('%08x  %-49s |%s|\n' % (off, hex_str, ascii_str))
+                f.write('%08x\n' % packet_len)
+        start = time.perf_counter()
+        subprocess.run((cmd_text2pcap, testin_file, testout_file), check=True, capture_output=True, env=base_env)
+        elapsed = time.perf_counter() - start
+        capinfo = check_capinfos_info(cmd_capinfos, testout_file)
+        assert capinfo['packets'] == packets
+        assert capinfo['datasize'] == packets * packet_len
+        record_property('hexdump_bytes_per_second', round(packets * packet_len / elapsed))
+
 class TestText2pcapRegex:
     def test_text2pcap_regex(self, run_text2pcap_capinfos_tshark):
         '''Verify basic functionality of text2pcap in regex mode.'''
@@ -142,6 +142,8 @@
 #define LONGOPT_PRINT_TIMERS            LONGOPT_BASE_APPLICATION+9
 #define LONGOPT_GLOBAL_PROFILE          LONGOPT_BASE_APPLICATION+10
 #define LONGOPT_COMPRESS                LONGOPT_BASE_APPLICATION+11
+#define LONGOPT_PRINT_HEURISTIC_STATS   LONGOPT_BASE_APPLICATION+12
+#define LONGOPT_PRINT_MEMORY_STATS      LONGOPT_BASE_APPLICATION+13
 
 capture_file cfile;
 
@@ -166,7 +168,8 @@ typedef enum {
     WRITE_FIELDS,   /* User defined list of fields */
     WRITE_JSON,     /* JSON */
     WRITE_JSON_RAW, /* JSON only raw hex */
-    WRITE_EK        /* JSON bulk insert to Elasticsearch */
+    WRITE_EK,       /* JSON bulk insert to Elasticsearch */
+    WRITE_ARROW     /* User defined list of fields, as an Arrow IPC stream */
         /* Add CSV and the like here */
 } output_action_e;
 
@@ -196,6 +199,7 @@ static bool no_duplicate_keys;
 static proto_node_children_grouper_func node_children_grouper = proto_node_group_children_by_unique;
 
 static json_dumper jdumper;
+static arrow_ipc_writer *arrow_writer;
 
 /* The line separator used between packets, changeable via the -S option */
 static const char *separator = "";
@@ -264,6 +268,8 @@ static bool write_finale(void);
 static GHashTable *output_only_tables;
 
 static bool opt_print_timers;
+static bool opt_print_heuristic_stats;
+static bool opt_print_memory_stats;
 struct elapsed_pass_s {
     int64_t dissect;
     int64_t dfilter_read;
@@ -334,6 +340,24 @@ print_elapsed_json(const char *cf_name, const char *dfilter)
     json_dumper_finish(&dumper);
 }
 
+static void
+print_memory_stats_row(const char *allocator_name, const char *tag,
+                       const wmem_stats_t *stats, void *user_data)
+{
+    FILE *fh = (FILE *)user_data;
+
+    fprintf(fh, "%s\t%s\t%zu\t%zu\t%zu\t%" PRIu64 "\n",
+            allocator_name, tag ? tag : "(total)",
+            stats->bytes, stats->blocks, stats->peak_bytes, stats->total_allocs);
+}
+
+static void
+print_memory_stats(FILE *fh)
+{
+    fprintf(fh, "Allocator\tTag\tBytes\tBlocks\tPeak bytes\tAllocations\n");
+    wmem_stats_foreach(print_memory_stats_row, fh);
+}
+
 static void
 list_capture_types(void)
 {
@@ -468,6 +492,8 @@ print_usage(FILE *output)
     fprintf(output, "                                          an exact multiple of NUM secs\n");
     fprintf(output, "                         printname:FILE - print filename to FILE when written\n");
     fprintf(output, "                                          (can use 'stdout' or 'stderr')\n");
+    fprintf(output, "                          compress:TYPE - compress completed files with TYPE\n");
+    fprintf(output, "                                          in the background\n");
 #endif  /* HAVE_LIBPCAP */
 #ifdef HAVE_PCAP_REMOTE
     fprintf(output, "RPCAP options:\n");
@@ -537,14 +563,14 @@ print_usage(FILE *output)
     fprintf(output, "     time                  include frame timestamp preamble\n");
     fprintf(output, "     notime                do not include frame timestamp preamble (-x default)\n");
     fprintf(output, "     help                  display help for --hexdump and exit\n");
-    fprintf(output, "  -T pdml|ps|psml|json|jsonraw|ek|tabs|text|fields|?\n");
+    fprintf(output, "  -T pdml|ps|psml|json|jsonraw|ek|tabs|text|fields|arrow|?\n");
     fprintf(output, "                           format of text output (def: text)\n");
     fprintf(output, "  -j <protocolfilter>      protocols layers filter if -T ek|pdml|json selected\n");
     fprintf(output, "                           (e.g. \"ip ip.flags text\", filter does not expand child\n");
     fprintf(output, "                           nodes, unless child is specified also in the filter)\n");
     fprintf(output, "  -J <protocolfilter>      top level protocol filter if -T ek|pdml|json selected\n");
     fprintf(output, "                           (e.g. \"http tcp\", filter which expands all child nodes)\n");
-    fprintf(output, "  -e <field>               field to print if -Tfields selected (e.g. tcp.port,\n");
+    fprintf(output, "  -e <field>               field to print if -Tfields or -Tarrow selected (e.g. tcp.port,\n");
     fprintf(output, "                           _ws.col.info)\n");
     fprintf(output, "                           this option can be repeated to print multiple fields\n");
     fprintf(output, "  -E<fieldsoption>=<value> set options for output when -Tfields selected:\n");
@@ -1058,6 +1084,8 @@ main(int argc, char *argv[])
         {"hexdump", ws_required_argument, NULL, LONGOPT_HEXDUMP},
         {"selected-frame", ws_required_argument, NULL, LONGOPT_SELECTED_FRAME},
         {"print-timers", ws_no_argument, NULL, LONGOPT_PRINT_TIMERS},
+        {"print-heuristic-stats", ws_no_argument, NULL, LONGOPT_PRINT_HEURISTIC_STATS},
+        {"print-memory-stats", ws_no_argument, NULL, LONGOPT_PRINT_MEMORY_STATS},
         {"global-profile", ws_no_argument, NULL, LONGOPT_GLOBAL_PROFILE},
         {"compress", ws_required_argument, NULL, LONGOPT_COMPRESS},
         {0, 0, 0, 0}
@@ -1223,6 +1251,11 @@ main(int argc, char *argv[])
             case LONGOPT_GLOBAL_PROFILE:
                     set_persconffile_dir(get_datafile_dir());
                     break;
+            case LONGOPT_PRINT_MEMORY_STATS:
+                    /* Must be enabled before the allocators are created. */
+                    opt_print_memory_stats = true;
+                    wmem_stats_enable(true);
+                    break;
             default:
                 break;
         }
@@ -1719,6 +1752,10 @@ main(int argc, char *argv[])
                     output_action = WRITE_FIELDS;
                     print_details = true;   /* Need full tree info */
                     print_summary = false;  /* Don't allow summary */
+                } else if (strcmp(ws_optarg, "arrow") == 0) {
+                    output_action = WRITE_ARROW;
+                    print_details = true;   /* Need full tree info */
+                    print_summary = false;  /* Don't allow summary */
                 } else if (strcmp(ws_optarg, "json") == 0) {
                     output_action = WRITE_JSON;
                     print_details = true;   /* Need details */
@@ -1736,6 +1773,8 @@ main(int argc, char *argv[])
                     cmdarg_err("Invalid -T parameter \"%s\"; it must be one of:", ws_optarg);                   /* x */
                     cmdarg_err_cont("\t\"fields\"  The values of fields specified with the -e option, in a form\n"
                             "\t          specified by the -E option.\n"
+                            "\t\"arrow\"   The values of fields specified with the -e option, as typed\n"
+                            "\t          columns of an Apache Arrow IPC stream.\n"
                             "\t\"pdml\"    Packet Details Markup Language, an XML-based format for the\n"
                             "\t          details of a decoded packet. This information is equivalent to\n"
                             "\t          the packet details printed with the -V flag.\n"
@@ -1922,6 +1961,12 @@ main(int argc, char *argv[])
             case LONGOPT_PRINT_TIMERS:
                 opt_print_timers = true;
                 break;
+            case LONGOPT_PRINT_HEURISTIC_STATS:
+                opt_print_heuristic_stats = true;
+                break;
+            case LONGOPT_PRINT_MEMORY_STATS:
+                /* already processed; just ignore it now */
+                break;
             case LONGOPT_GLOBAL_PROFILE:
                 /* already processed; just ignore it now */
                 break;
@@ -1982,14 +2027,14 @@ main(int argc, char *argv[])
      * This also doesn't distinguish PDML from PSML, but shouldn't allow the
      * latter.
      */
-    if ((WRITE_FIELDS != output_action && WRITE_XML != output_action && WRITE_JSON != output_action && WRITE_EK != output_action) && 0 != output_fields_num_fields(output_fields)) {
+    if ((WRITE_FIELDS != output_action && WRITE_ARROW != output_action && WRITE_XML != output_action && WRITE_JSON != output_action && WRITE_EK != output_action) && 0 != output_fields_num_fields(output_fields)) {
         cmdarg_err("Output fields were specified with \"-e\", "
-                "but \"-Tek, -Tfields, -Tjson or -Tpdml\" was not specified.");
+                "but \"-Tarrow, -Tek, -Tfields, -Tjson or -Tpdml\" was not specified.");
         exit_status = WS_EXIT_INVALID_OPTION;
         goto clean_exit;
-    } else if (WRITE_FIELDS == output_action && 0 == output_fields_num_fields(output_fields)) {
-        cmdarg_err("\"-Tfields\" was specified, but no fields were "
-                "specified with \"-e\".");
+    } else if ((WRITE_FIELDS == output_action || WRITE_ARROW == output_action) && 0 == output_fields_num_fields(output_fields)) {
+        cmdarg_err("\"-T%s\" was specified, but no fields were "
+                "specified with \"-e\".", WRITE_ARROW == output_action ? "arrow" : "fields");
 
         exit_status = WS_EXIT_INVALID_OPTION;
         goto clean_exit;
@@ -2890,6 +2935,14 @@ main(int argc, char *argv[])
         }
     }
 
+    if (opt_print_heuristic_stats) {
+        dissector_dump_heur_stats(stderr);
+    }
+
+    if (opt_print_memory_stats) {
+        print_memory_stats(stderr);
+    }
+
     /* Memory cleanup */
     reset_tap_listeners();
     funnel_dump_all_text_windows();
@@ -3839,6 +3892,13 @@ process_cap_file_second_pass(capture_file *cf, wtap_dumper *pdh,
         edt = epan_dissect_new(cf->epan, create_proto_tree, visible);
     }
 
+    /*
+     * Send lookups for the addresses collected in the first pass, if
+     * we're resolving them in bulk; switching to synchronous resolution
+     * below waits for the answers.
+     */
+    host_name_lookup_bulk();
+
     /*
      * Force synchronous resolution of IP addresses; in this pass, we
      * can't do it in the background and fix up past dissections.
@@ -4468,6 +4528,17 @@ write_preamble(capture_file *cf)
             write_fields_preamble(output_fields, stdout);
             return !ferror(stdout);
 
+        case WRITE_ARROW:
+#ifdef _WIN32
+            /*
+             * The Arrow IPC stream is binary; keep the C runtime from
+             * mangling LF bytes into CR/LF.
+             */
+            _setmode(_fileno(stdout), _O_BINARY);
+#endif  /* _WIN32 */
+            arrow_writer = write_arrow_preamble(output_fields, stdout);
+            return true;
+
         case WRITE_JSON:
         case WRITE_JSON_RAW:
             jdumper = write_json_preamble(stdout);
@@ -4823,6 +4894,16 @@ print_packet(capture_file *cf, epan_dissect_t *edt)
             }
             break;
 
+        case WRITE_ARROW:
+            if (print_summary) {
+                /*No non-verbose "arrow" format */
+                ws_assert_not_reached();
+            }
+            if (print_details) {
+                return write_arrow_proto_tree(output_fields, edt, arrow_writer);
+            }
+            break;
+
         case WRITE_JSON:
             if (print_summary)
                 ws_assert_not_reached();
@@ -4884,6 +4965,13 @@ write_finale(void)
             write_fields_finale(output_fields, stdout);
             return !ferror(stdout);
 
+        case WRITE_ARROW:
+        {
+            bool ret = write_arrow_finale(output_fields, arrow_writer);
+            arrow_writer = NULL;
+            return ret;
+        }
+
         case WRITE_JSON:
         case WRITE_JSON_RAW:
             write_json_finale(&jdumper);
@@ -434,6 +434,8 @@ capture_input_new_file(capture_session *cap_session, char *new_file)
             cf_finish_tail((capture_file *)cap_session->cf,
                            &cap_session->rec, &err,
                            &cap_session->frame_dup_cache, cap_session->frame_cksum);
+            /* The old file has been read to the end. */
+            cap_session->count_pending = 0;
             cf_close((capture_file *)cap_session->cf);
         }
         g_free(capture_opts->save_file);
@@ -448,6 +450,9 @@ capture_input_new_file(capture_session *cap_session, char *new_file)
     /* save the new filename */
     capture_opts->save_file = g_strdup(new_file);
 
+    /* A new file, so we don't have any pending packets to read. */
+    cap_session->count_pending = 0;
+
     /* if we are in real-time mode, open the new file now */
     if(capture_opts->real_time_mode) {
         /* Attempt to open the capture file and set up to read from it. */
@@ -462,8 +467,6 @@ capture_input_new_file(capture_session *cap_session, char *new_file)
                 return false;
         }
     } else {
-        /* A new file, so we don't have any pending packets to read. */
-        cap_session->count_pending = 0;
         capture_callback_invoke(capture_cb_capture_prepared, cap_session);
     }
 
@@ -560,12 +563,14 @@ capture_input_new_packets(capture_session *cap_session, int to_read)
             }
             capture_callback_invoke(capture_cb_capture_update_started, cap_session);
         }
-        /* Read from the capture file the number of records the child told us it added. */
-        to_read += cap_session->count_pending;
-        cap_session->count_pending = 0;
-        switch (cf_continue_tail((capture_file *)cap_session->cf, to_read,
+        /* Read from the capture file the number of records the child told us it added,
+           and the ones left unread last time. */
+        int tail_to_read = to_read + (int)cap_session->count_pending;
+        cf_read_status_t status = cf_continue_tail((capture_file *)cap_session->cf, &tail_to_read,
                                  &cap_session->rec, &err,
-                                 &cap_session->frame_dup_cache, cap_session->frame_cksum)) {
+                                 &cap_session->frame_dup_cache, cap_session->frame_cksum);
+        cap_session->count_pending = (uint32_t)tail_to_read;
+        switch (status) {
 
             case CF_READ_OK:
             case CF_READ_ERROR:
@@ -595,6 +600,18 @@ capture_input_new_packets(capture_session *cap_session, int to_read)
 }
 
 
+/* Read the records that capture_input_new_packets() left unread. */
+void
+capture_input_continue_pending(capture_session *cap_session)
+{
+    if (cap_session->state != CAPTURE_RUNNING || !cap_session->capture_opts->real_time_mode ||
+            cap_session->count_pending == 0 ||
+            ((capture_file *)cap_session->cf)->state != FILE_READ_IN_PROGRESS)
+        return;
+
+    capture_input_new_packets(cap_session, 0);
+}
+
 /* Capture child told us how many dropped packets it counted.
  */
 static void
@@ -758,6 +775,7 @@ capture_input_closed(capture_session *cap_session, char *msg)
             status = cf_finish_tail((capture_file *)cap_session->cf,
                                     &cap_session->rec, &err,
                                     &cap_session->frame_dup_cache, cap_session->frame_cksum);
+            cap_session->count_pending = 0;
 
             // The real-time reading of the pcap is done. Now we can clear the
             // dup-frame cache, if present. But check that we actually have
@@ -81,6 +81,17 @@ capture_stop(capture_session *cap_session);
 extern void
 capture_kill_child(capture_session *cap_session);
 
+/**
+ * Read the packets of a live capture that were left unread to keep the
+ * UI responsive. The UI should call this soon after a
+ * capture_cb_capture_update_continue event, when the session has
+ * packets pending.
+ *
+ * @param cap_session the handle for the capture session
+ */
+extern void
+capture_input_continue_pending(capture_session *cap_session);
+
 struct if_stat_cache_s;
 typedef struct if_stat_cache_s if_stat_cache_t;
 
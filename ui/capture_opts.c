@@ -135,6 +135,7 @@ capture_opts_init(capture_options *capture_opts, GList *(*get_iface_list)(int *,
     capture_opts->wait_for_extcap_cbs             = false;
     capture_opts->print_file_names                = false;
     capture_opts->print_name_to                   = NULL;
+    capture_opts->ring_compress_type              = NULL;
     capture_opts->temp_dir                        = NULL;
     capture_opts->compress_type                   = NULL;
     capture_opts->closed_msg                      = NULL;
@@ -166,6 +167,7 @@ capture_opts_cleanup(capture_options *capture_opts)
     }
     g_free(capture_opts->save_file);
     g_free(capture_opts->temp_dir);
+    g_free(capture_opts->ring_compress_type);
 
     if (capture_opts->closed_msg) {
         g_free(capture_opts->closed_msg);
@@ -286,6 +288,7 @@ capture_opts_log(const char *log_domain, enum ws_log_level log_level, capture_op
     ws_log(log_domain, log_level, "FileNameType        : %s", (capture_opts->has_nametimenum) ? "prefix_time_num.suffix"  : "prefix_num_time.suffix");
     ws_log(log_domain, log_level, "RingNumFiles    (%u) : %u", capture_opts->has_ring_num_files, capture_opts->ring_num_files);
     ws_log(log_domain, log_level, "RingPrintFiles  (%u) : %s", capture_opts->print_file_names, (capture_opts->print_file_names ? capture_opts->print_name_to : ""));
+    ws_log(log_domain, log_level, "RingCompress        : %s", capture_opts->ring_compress_type ? capture_opts->ring_compress_type : "(none)");
 
     ws_log(log_domain, log_level, "AutostopFiles   (%u) : %u", capture_opts->has_autostop_files, capture_opts->autostop_files);
     ws_log(log_domain, log_level, "AutostopPackets (%u) : %u", capture_opts->has_autostop_packets, capture_opts->autostop_packets);
@@ -490,6 +493,13 @@ get_ring_arguments(capture_options *capture_opts, const char *arg)
     } else if (strcmp(arg,"printname") == 0) {
         capture_opts->print_file_names = true;
         capture_opts->print_name_to = g_strdup(p);
+    } else if (strcmp(arg,"compress") == 0) {
+        if (!wtap_can_write_compression_type(wtap_name_to_compression_type(p))) {
+            *colonp = ':';
+            return false;
+        }
+        g_free(capture_opts->ring_compress_type);
+        capture_opts->ring_compress_type = g_strdup(p);
     }
     else {
         return false;
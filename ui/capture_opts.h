@@ -309,6 +309,8 @@ typedef struct capture_options_tag {
     bool               print_file_names;      /**< true if printing names of completed
                                                    files as we close them */
     char              *print_name_to;         /**< output file name */
+    char              *ring_compress_type;    /**< compress completed ring buffer
+                                                   files with this type */
     char              *temp_dir;              /**< temporary directory path */
 
     /* internally used (don't touch from outside) */
@@ -27,8 +27,10 @@
 #include "tap-exportobject.h"
 
 typedef struct _export_object_list_gui_t {
-    GSList *entries;
+    GPtrArray *entries;
     register_eo_t* eo;
+    char *save_in_path;
+    bool save_dir_ok;
 } export_object_list_gui_t;
 
 static GHashTable* eo_opts;
@@ -82,19 +84,77 @@ bool eo_tap_opt_add(const char *option_string)
     return false;
 }
 
+static bool
+eo_create_save_dir(export_object_list_gui_t *object_list)
+{
+    if (object_list->save_dir_ok)
+        return true;
+
+    if (!g_file_test(object_list->save_in_path, G_FILE_TEST_IS_DIR)) {
+        /* If the destination directory (or its parents) do not exist, create them. */
+        if (g_mkdir_with_parents(object_list->save_in_path, 0755) == -1) {
+            fprintf(stderr, "Failed to create export objects output directory \"%s\": %s\n",
+                    object_list->save_in_path, g_strerror(errno));
+            return false;
+        }
+    }
+    object_list->save_dir_ok = true;
+    return true;
+}
+
+static void
+eo_save_entry(export_object_list_gui_t *object_list, export_object_entry_t *entry)
+{
+    GString *safe_filename = NULL;
+    char *save_as_fullpath = NULL;
+    unsigned count = 0;
+
+    do {
+        g_free(save_as_fullpath);
+        if (entry->filename) {
+            safe_filename = eo_massage_str(entry->filename,
+                EXPORT_OBJECT_MAXFILELEN, count);
+        } else {
+            char generic_name[EXPORT_OBJECT_MAXFILELEN+1];
+            const char *ext;
+            ext = eo_ct2ext(entry->content_type);
+            snprintf(generic_name, sizeof(generic_name),
+                "object%u%s%s", entry->pkt_num, ext ? "." : "", ext ? ext : "");
+            safe_filename = eo_massage_str(generic_name,
+                EXPORT_OBJECT_MAXFILELEN, count);
+        }
+        save_as_fullpath = g_build_filename(object_list->save_in_path, safe_filename->str, NULL);
+        g_string_free(safe_filename, TRUE);
+    } while (g_file_test(save_as_fullpath, G_FILE_TEST_EXISTS) && ++count < prefs.gui_max_export_objects);
+    write_file_binary_mode(save_as_fullpath, entry->payload_data, entry->payload_len);
+    g_free(save_as_fullpath);
+}
+
 static void
 object_list_add_entry(void *gui_data, export_object_entry_t *entry)
 {
     export_object_list_gui_t *object_list = (export_object_list_gui_t*)gui_data;
 
-    object_list->entries = g_slist_append(object_list->entries, entry);
+    if (get_eo_entries_complete(object_list->eo)) {
+        /* The protocol won't change the entry again, so write it out
+         * now instead of holding every object in memory until the end. */
+        if (eo_create_save_dir(object_list)) {
+            eo_save_entry(object_list, entry);
+        }
+        eo_free_entry(entry);
+        return;
+    }
+
+    g_ptr_array_add(object_list->entries, entry);
 }
 
 static export_object_entry_t*
 object_list_get_entry(void *gui_data, int row) {
     export_object_list_gui_t *object_list = (export_object_list_gui_t*)gui_data;
 
-    return (export_object_entry_t *)g_slist_nth_data(object_list->entries, row);
+    if (row < 0 || (unsigned)row >= object_list->entries->len)
+        return NULL;
+    return (export_object_entry_t *)g_ptr_array_index(object_list->entries, row);
 }
 
 /* This is just for writing Exported Objects to a file */
@@ -103,46 +163,12 @@ eo_draw(void *tapdata)
 {
     export_object_list_t *tap_object = (export_object_list_t *)tapdata;
     export_object_list_gui_t *object_list = (export_object_list_gui_t*)tap_object->gui_data;
-    GSList *slist = object_list->entries;
-    export_object_entry_t *entry;
-    char* save_in_path = (char*)g_hash_table_lookup(eo_opts, proto_get_protocol_filter_name(get_eo_proto_id(object_list->eo)));
-    GString *safe_filename = NULL;
-    char *save_as_fullpath = NULL;
-    unsigned count = 0;
 
-    if (!g_file_test(save_in_path, G_FILE_TEST_IS_DIR)) {
-        /* If the destination directory (or its parents) do not exist, create them. */
-        if (g_mkdir_with_parents(save_in_path, 0755) == -1) {
-            fprintf(stderr, "Failed to create export objects output directory \"%s\": %s\n",
-                    save_in_path, g_strerror(errno));
-            return;
-        }
-    }
+    if (!eo_create_save_dir(object_list))
+        return;
 
-    while (slist) {
-        entry = (export_object_entry_t *)slist->data;
-        do {
-            g_free(save_as_fullpath);
-            if (entry->filename) {
-                safe_filename = eo_massage_str(entry->filename,
-                    EXPORT_OBJECT_MAXFILELEN, count);
-            } else {
-                char generic_name[EXPORT_OBJECT_MAXFILELEN+1];
-                const char *ext;
-                ext = eo_ct2ext(entry->content_type);
-                snprintf(generic_name, sizeof(generic_name),
-                    "object%u%s%s", entry->pkt_num, ext ? "." : "", ext ? ext : "");
-                safe_filename = eo_massage_str(generic_name,
-                    EXPORT_OBJECT_MAXFILELEN, count);
-            }
-            save_as_fullpath = g_build_filename(save_in_path, safe_filename->str, NULL);
-            g_string_free(safe_filename, TRUE);
-        } while (g_file_test(save_as_fullpath, G_FILE_TEST_EXISTS) && ++count < prefs.gui_max_export_objects);
-        count = 0;
-        write_file_binary_mode(save_as_fullpath, entry->payload_data, entry->payload_len);
-        g_free(save_as_fullpath);
-        save_as_fullpath = NULL;
-        slist = slist->next;
+    for (unsigned i = 0; i < object_list->entries->len; i++) {
+        eo_save_entry(object_list, (export_object_entry_t *)g_ptr_array_index(object_list->entries, i));
     }
 }
 
@@ -159,7 +185,7 @@ eo_reset(void *tapdata)
     export_object_list_t *tap_object = (export_object_list_t *)tapdata;
     export_object_list_gui_t *object_list = (export_object_list_gui_t*)tap_object->gui_data;
 
-    g_slist_free_full(g_steal_pointer(&object_list->entries), object_list_free_entry);
+    g_ptr_array_set_size(object_list->entries, 0);
 }
 
 /* Clean up our listener state, tapping is done */
@@ -169,7 +195,7 @@ eo_finish(void *tapdata)
     export_object_list_t *tap_object = (export_object_list_t *)tapdata;
     export_object_list_gui_t *object_list = (export_object_list_gui_t*)tap_object->gui_data;
 
-    g_slist_free_full(g_steal_pointer(&object_list->entries), object_list_free_entry);
+    g_ptr_array_free(object_list->entries, TRUE);
     g_free(object_list);
     g_free(tap_object);
 }
@@ -197,6 +223,8 @@ exportobject_handler(void *key, void *value _U_, void *user_data _U_)
     tap_data->gui_data = (void*)object_list;
 
     object_list->eo = eo;
+    object_list->entries = g_ptr_array_new_with_free_func(object_list_free_entry);
+    object_list->save_in_path = (char*)g_hash_table_lookup(eo_opts, (const char*)key);
 
     /* Data will be gathered via a tap callback */
     error_msg = register_tap_listener(get_eo_tap_listener_name(eo), tap_data, NULL, TL_REQUIRES_NOTHING,
@@ -205,6 +233,7 @@ exportobject_handler(void *key, void *value _U_, void *user_data _U_)
     if (error_msg) {
         cmdarg_err("Can't register %s tap: %s", (const char*)key, error_msg->str);
         g_string_free(error_msg, TRUE);
+        g_ptr_array_free(object_list->entries, TRUE);
         g_free(tap_data);
         g_free(object_list);
         return;
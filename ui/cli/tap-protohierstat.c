@@ -23,8 +23,7 @@
 #include <wsutil/cmdarg_err.h>
 #include "tap-protohierstat.h"
 
-int pc_proto_id;
-int col_proto_id;
+static int ethertype_proto_id = -1;
 
 void register_tap_listener_protohierstat(void);
 
@@ -74,58 +73,42 @@ free_phs(phs_t *rs)
 }
 
 tap_packet_status
-protohierstat_packet(void *prs, packet_info *pinfo, epan_dissect_t *edt, const void *dummy _U_, tap_flags_t flags _U_)
+protohierstat_packet(void *prs, packet_info *pinfo, epan_dissect_t *edt _U_, const void *dummy _U_, tap_flags_t flags _U_)
 {
 	phs_t *rs = (phs_t *)prs;
 	phs_t *tmprs;
-	proto_node *node;
-	field_info *fi;
+	wmem_list_frame_t *layer;
+	unsigned layer_idx = 0;
+	int proto_id;
 
-	if (!edt) {
-		return TAP_PACKET_DONT_REDRAW;
-	}
-	if (!edt->tree) {
-		return TAP_PACKET_DONT_REDRAW;
-	}
-	if (!edt->tree->first_child) {
+	if (!pinfo->layers) {
 		return TAP_PACKET_DONT_REDRAW;
 	}
 
-	for (node=edt->tree->first_child; node; node=node->next) {
-		fi = PNODE_FINFO(node);
+	if (ethertype_proto_id == -1) {
+		ethertype_proto_id = proto_get_id_by_filter_name("ethertype");
+	}
 
-		if (!fi || !(fi->hfinfo)) {
-			continue;
-		}
+	for (layer = wmem_list_head(pinfo->layers); layer; layer = wmem_list_frame_next(layer), layer_idx++) {
+		proto_id = GPOINTER_TO_INT(wmem_list_frame_data(layer));
 
 		/*
-		 * If the first child is a tree of comments, skip over it.
-		 * This keeps us from having a top-level "pkt_comment"
-		 * entry that represents a nonexistent protocol,
-		 * and matches how the GUI treats comments.
-		 * Also skip the internal non-protocol for the columns
-		 * (the GUI does its own dissection with no columns instead
-		 * of adding a tap like other dialogs, so it never has the
-		 * column protocol.)
+		 * Ethertype only dispatches on the Ethernet type of the layer
+		 * below it and adds no protocol item of its own, so skip it,
+		 * as the GUI does. Also skip the headers quoted in an ICMP (or
+		 * other) error packet.
 		 */
-		if (G_UNLIKELY(fi->hfinfo->id == pc_proto_id || fi->hfinfo->id == col_proto_id)) {
+		if (G_UNLIKELY(proto_id == ethertype_proto_id)) {
 			continue;
 		}
-
-		/* Skip non protocols, e.g. top-level desegmentation items
-		 * "[Reassembled TCP Segments]", as the GUI does.
-		 *
-		 * Note the inverse issue (handling protocols that are not at
-		 * the top-level) is something done neither here nor in the GUI.
-		 */
-		if (!proto_registrar_is_protocol(fi->hfinfo->id)) {
+		if (((const layer_info_t *)wmem_array_index(pinfo->layer_info, layer_idx))->in_error_pkt) {
 			continue;
 		}
 
 		/* first time we saw a protocol at this leaf */
 		if (rs->protocol == -1) {
-			rs->protocol = fi->hfinfo->id;
-			rs->proto_name = fi->hfinfo->abbrev;
+			rs->protocol = proto_id;
+			rs->proto_name = proto_get_protocol_filter_name(proto_id);
 			rs->frames = 1;
 			rs->bytes = pinfo->fd->pkt_len;
 			rs->child = new_phs_t(rs, NULL);
@@ -135,7 +118,7 @@ protohierstat_packet(void *prs, packet_info *pinfo, epan_dissect_t *edt, const v
 
 		/* find this protocol in the list of siblings */
 		for (tmprs=rs; tmprs; tmprs=tmprs->sibling) {
-			if (tmprs->protocol == fi->hfinfo->id) {
+			if (tmprs->protocol == proto_id) {
 				break;
 			}
 		}
@@ -146,8 +129,8 @@ protohierstat_packet(void *prs, packet_info *pinfo, epan_dissect_t *edt, const v
 				;
 			tmprs->sibling = new_phs_t(rs->parent, NULL);
 			rs = tmprs->sibling;
-			rs->protocol = fi->hfinfo->id;
-			rs->proto_name = fi->hfinfo->abbrev;
+			rs->protocol = proto_id;
+			rs->proto_name = proto_get_protocol_filter_name(proto_id);
 		} else {
 			rs = tmprs;
 		}
@@ -223,15 +206,9 @@ protohierstat_init(const char *opt_arg, void *userdata _U_)
 		return false;
 	}
 
-	pc_proto_id = proto_registrar_get_id_byname("pkt_comment");
-	/* proto_get_id_by_filter_name searches a smaller table; we can't use
-	 * it for pkt_comment, which is a PINO, but can for _ws.col
-	 */
-	col_proto_id = proto_get_id_by_filter_name("_ws.col");
-
 	rs = new_phs_t(NULL, filter);
 
-	error_string = register_tap_listener("frame", rs, filter, TL_REQUIRES_PROTO_TREE|TL_REQUIRES_PROTOCOLS, NULL, protohierstat_packet, protohierstat_draw, (tap_finish_cb)free_phs);
+	error_string = register_tap_listener("frame", rs, filter, TL_REQUIRES_NOTHING, NULL, protohierstat_packet, protohierstat_draw, (tap_finish_cb)free_phs);
 	if (error_string) {
 		/* error, we failed to attach to the tap. clean up */
 		free_phs(rs);
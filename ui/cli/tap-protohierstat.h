@@ -14,8 +14,6 @@
 extern "C" {
 #endif /* __cplusplus */
 
-extern int pc_proto_id;
-
 typedef struct _phs_t {
 	struct _phs_t *sibling;
 	struct _phs_t *child;
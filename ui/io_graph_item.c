@@ -12,6 +12,7 @@
 
 #include "config.h"
 
+#include <string.h>
 
 #include <epan/epan_dissect.h>
 
@@ -312,3 +313,173 @@ double get_io_graph_item(const io_graph_item_t *items_, io_graph_item_unit_t val
     }
     return value;
 }
+
+void merge_io_graph_item(io_graph_item_t *dst, const io_graph_item_t *src, int hf_index)
+{
+    if (src->first_frame_in_invl == 0 && src->fields == 0) {
+        /* Nothing was counted in this interval. */
+        return;
+    }
+
+    /* Frames are tapped in order, so the first frame of the merged
+     * interval is the lowest numbered one. */
+    if (src->first_frame_in_invl != 0 &&
+        (dst->first_frame_in_invl == 0 || src->first_frame_in_invl < dst->first_frame_in_invl)) {
+        dst->first_frame_in_invl = src->first_frame_in_invl;
+    }
+    if (src->last_frame_in_invl > dst->last_frame_in_invl) {
+        dst->last_frame_in_invl = src->last_frame_in_invl;
+    }
+    dst->frames += src->frames;
+    dst->bytes += src->bytes;
+
+    if (src->fields == 0) {
+        return;
+    }
+
+    /* On ties, keep the earliest frame, as update_io_graph_item does. */
+    switch (hf_index >= 0 ? proto_registrar_get_ftype(hf_index) : FT_NONE) {
+    case FT_UINT8:
+    case FT_UINT16:
+    case FT_UINT24:
+    case FT_UINT32:
+    case FT_UINT40:
+    case FT_UINT48:
+    case FT_UINT56:
+    case FT_UINT64:
+        if (dst->fields == 0 || src->uint_max > dst->uint_max ||
+            (src->uint_max == dst->uint_max && src->max_frame_in_invl < dst->max_frame_in_invl)) {
+            dst->uint_max = src->uint_max;
+            dst->max_frame_in_invl = src->max_frame_in_invl;
+        }
+        if (dst->fields == 0 || src->uint_min < dst->uint_min ||
+            (src->uint_min == dst->uint_min && src->min_frame_in_invl < dst->min_frame_in_invl)) {
+            dst->uint_min = src->uint_min;
+            dst->min_frame_in_invl = src->min_frame_in_invl;
+        }
+        dst->double_tot += src->double_tot;
+        break;
+    case FT_INT8:
+    case FT_INT16:
+    case FT_INT24:
+    case FT_INT32:
+    case FT_INT40:
+    case FT_INT48:
+    case FT_INT56:
+    case FT_INT64:
+        if (dst->fields == 0 || src->int_max > dst->int_max ||
+            (src->int_max == dst->int_max && src->max_frame_in_invl < dst->max_frame_in_invl)) {
+            dst->int_max = src->int_max;
+            dst->max_frame_in_invl = src->max_frame_in_invl;
+        }
+        if (dst->fields == 0 || src->int_min < dst->int_min ||
+            (src->int_min == dst->int_min && src->min_frame_in_invl < dst->min_frame_in_invl)) {
+            dst->int_min = src->int_min;
+            dst->min_frame_in_invl = src->min_frame_in_invl;
+        }
+        dst->double_tot += src->double_tot;
+        break;
+    case FT_FLOAT:
+    case FT_DOUBLE:
+        if (dst->fields == 0 || src->double_max > dst->double_max ||
+            (src->double_max == dst->double_max && src->max_frame_in_invl < dst->max_frame_in_invl)) {
+            dst->double_max = src->double_max;
+            dst->max_frame_in_invl = src->max_frame_in_invl;
+        }
+        if (dst->fields == 0 || src->double_min < dst->double_min ||
+            (src->double_min == dst->double_min && src->min_frame_in_invl < dst->min_frame_in_invl)) {
+            dst->double_min = src->double_min;
+            dst->min_frame_in_invl = src->min_frame_in_invl;
+        }
+        dst->double_tot += src->double_tot;
+        break;
+    case FT_RELATIVE_TIME:
+        /* For LOAD only time_tot and fields are used, and they add up. */
+        if (dst->fields == 0 || nstime_cmp(&src->time_max, &dst->time_max) > 0 ||
+            (nstime_cmp(&src->time_max, &dst->time_max) == 0 && src->max_frame_in_invl < dst->max_frame_in_invl)) {
+            dst->time_max = src->time_max;
+            dst->max_frame_in_invl = src->max_frame_in_invl;
+        }
+        if (dst->fields == 0 || nstime_cmp(&src->time_min, &dst->time_min) < 0 ||
+            (nstime_cmp(&src->time_min, &dst->time_min) == 0 && src->min_frame_in_invl < dst->min_frame_in_invl)) {
+            dst->time_min = src->time_min;
+            dst->min_frame_in_invl = src->min_frame_in_invl;
+        }
+        nstime_add(&dst->time_tot, &src->time_tot);
+        break;
+    default:
+        /* Only counted. */
+        break;
+    }
+    dst->fields += src->fields;
+}
+
+void rollup_io_graph_items(io_graph_item_t *dst, const io_graph_item_t *src, size_t count, size_t factor, int hf_index)
+{
+    size_t dst_count = (count + factor - 1) / factor;
+
+    reset_io_graph_items(dst, dst_count, hf_index);
+    for (size_t i = 0; i < count; i++) {
+        merge_io_graph_item(&dst[i / factor], &src[i], hf_index);
+    }
+}
+
+void io_graph_pyramid_clear(io_graph_pyramid_t *pyramid)
+{
+    for (unsigned level = 1; level < pyramid->num_levels; level++) {
+        g_free(pyramid->levels[level]);
+    }
+    memset(pyramid, 0, sizeof(*pyramid));
+}
+
+void io_graph_pyramid_build(io_graph_pyramid_t *pyramid, const io_graph_item_t *items, size_t count, uint32_t interval, int hf_index)
+{
+    unsigned level;
+
+    io_graph_pyramid_clear(pyramid);
+    pyramid->hf_index = hf_index;
+    pyramid->interval = interval;
+    pyramid->base = items;
+    pyramid->levels[0] = NULL;
+    pyramid->counts[0] = count;
+
+    /* Each level halves the number of items, so all the rollups together
+     * take at most as much memory as the base level. */
+    for (level = 1; level < IO_GRAPH_PYRAMID_LEVELS && pyramid->counts[level - 1] > 1; level++) {
+        const io_graph_item_t *prev = (level == 1) ? items : pyramid->levels[level - 1];
+        size_t prev_count = pyramid->counts[level - 1];
+
+        if ((uint64_t)interval << level > UINT32_MAX) {
+            break;
+        }
+        pyramid->counts[level] = (prev_count + 1) / 2;
+        pyramid->levels[level] = g_new(io_graph_item_t, pyramid->counts[level]);
+        rollup_io_graph_items(pyramid->levels[level], prev, prev_count, 2, hf_index);
+    }
+    pyramid->num_levels = level;
+}
+
+io_graph_item_t *io_graph_pyramid_get_items(const io_graph_pyramid_t *pyramid, uint32_t interval, size_t *count)
+{
+    uint32_t factor;
+    unsigned level;
+    const io_graph_item_t *src;
+    io_graph_item_t *items;
+
+    *count = 0;
+    if (pyramid->interval == 0 || pyramid->num_levels == 0 || interval % pyramid->interval != 0) {
+        return NULL;
+    }
+    factor = interval / pyramid->interval;
+
+    /* Start from the coarsest level the interval is a multiple of. */
+    for (level = 0; level + 1 < pyramid->num_levels && (factor & 1) == 0; level++) {
+        factor >>= 1;
+    }
+    src = (level == 0) ? pyramid->base : pyramid->levels[level];
+
+    *count = (pyramid->counts[level] + factor - 1) / factor;
+    items = g_new(io_graph_item_t, *count ? *count : 1);
+    rollup_io_graph_items(items, src, pyramid->counts[level], factor, pyramid->hf_index);
+    return items;
+}
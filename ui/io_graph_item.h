@@ -425,6 +425,70 @@ update_io_graph_item(io_graph_item_t *items, int idx, packet_info *pinfo, epan_d
     return true;
 }
 
+/** Merge an io_graph_item_t into another one, as if the frames of both
+ * had been counted in the same interval.
+ *
+ * @param dst [in,out] Item to merge into.
+ * @param src [in] Item to merge.
+ * @param hf_index [in] Header field index for advanced statistics.
+ */
+void merge_io_graph_item(io_graph_item_t *dst, const io_graph_item_t *src, int hf_index);
+
+/** Roll up items counted at one interval into a coarser interval that is
+ * a multiple of it.
+ *
+ * @param dst [out] Array of (count + factor - 1) / factor items.
+ * @param src [in] Items to roll up.
+ * @param count [in] The number of items in src.
+ * @param factor [in] Ratio between the coarse and fine intervals.
+ * @param hf_index [in] Header field index for advanced statistics.
+ */
+void rollup_io_graph_items(io_graph_item_t *dst, const io_graph_item_t *src, size_t count, size_t factor, int hf_index);
+
+#define IO_GRAPH_PYRAMID_LEVELS 32
+
+/** Power-of-two rollups of the items tapped at an interval, from which the
+ * items for any multiple of that interval can be computed without tapping
+ * again. Level n holds the items for interval << n.
+ */
+typedef struct _io_graph_pyramid_t {
+    int hf_index;
+    uint32_t interval;          /**< Interval of level 0, in μs */
+    unsigned num_levels;
+    const io_graph_item_t *base; /**< Level 0, owned by the caller */
+    io_graph_item_t *levels[IO_GRAPH_PYRAMID_LEVELS];
+    size_t counts[IO_GRAPH_PYRAMID_LEVELS];
+} io_graph_pyramid_t;
+
+/** Build the pyramid for a set of items. Any previous contents are freed.
+ * The items are not copied and must outlive the pyramid (or the next
+ * rebuild).
+ *
+ * @param pyramid [in,out] Zero-initialized or previously built pyramid.
+ * @param items [in] Items tapped at interval.
+ * @param count [in] The number of items.
+ * @param interval [in] Timing interval in μs.
+ * @param hf_index [in] Header field index for advanced statistics.
+ */
+void io_graph_pyramid_build(io_graph_pyramid_t *pyramid, const io_graph_item_t *items, size_t count, uint32_t interval, int hf_index);
+
+/** Free the rollups of a pyramid and reset it.
+ *
+ * @param pyramid [in,out] Pyramid to clear.
+ */
+void io_graph_pyramid_clear(io_graph_pyramid_t *pyramid);
+
+/** Get the items for an interval.
+ *
+ * @param pyramid [in] Built pyramid.
+ * @param interval [in] Timing interval in μs. Must be a multiple of the
+ *                      pyramid's interval.
+ * @param count [out] The number of items returned.
+ * @return A newly allocated array of items (free with g_free), or NULL if
+ *         the interval cannot be computed from the pyramid.
+ */
+io_graph_item_t *io_graph_pyramid_get_items(const io_graph_pyramid_t *pyramid, uint32_t interval, size_t *count);
+
 
 #ifdef __cplusplus
 }
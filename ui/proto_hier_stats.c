@@ -25,7 +25,8 @@
 #define STAT_NODE_STATS(n)   ((ph_stats_node_t*)(n)->data)
 #define STAT_NODE_HFINFO(n)  (STAT_NODE_STATS(n)->hfinfo)
 
-static int pc_proto_id = -1;
+static int ethertype_proto_id = -1;
+static bool cf_callback_registered;
 
     static GNode*
 find_stat_node(GNode *parent_stat_node, const header_field_info *needle_hfinfo)
@@ -78,97 +79,59 @@ find_stat_node(GNode *parent_stat_node, const header_field_info *needle_hfinfo)
     return needle_stat_node;
 }
 
-static bool
-ph_node_is_proto(proto_node *ptree_node)
-{
-    if (!PNODE_FINFO(ptree_node))
-        return false;
-
-    const header_field_info *hfinfo = PNODE_FINFO(ptree_node)->hfinfo;
-    return proto_registrar_is_protocol(hfinfo->id) && hfinfo->id != pc_proto_id;
-}
-
-static void
-// NOLINTNEXTLINE(misc-no-recursion)
-process_node(proto_node *ptree_node, GNode *parent_stat_node, ph_stats_t *ps)
+    static void
+process_layers(packet_info *pinfo, ph_stats_t *ps)
 {
-    field_info		*finfo;
-    ph_stats_node_t	*stats;
-    proto_node		*proto_sibling_node;
-    GNode		*stat_node;
+    wmem_list_frame_t	*layer;
+    GNode		*stat_node = ps->stats_tree;
+    ph_stats_node_t	*stats = NULL;
+    unsigned		layer_idx = 0;
+    const layer_info_t	*info;
+    uint32_t		length = 0;
 
-    finfo = PNODE_FINFO(ptree_node);
-    /* We don't fake protocol nodes we expect them to have a field_info.
+    /*
+     * Each layer is counted under the layer it was found in, with the
+     * length of the data it was handed. Ethertype only dispatches on the
+     * Ethernet type of the layer below it and adds no protocol item of
+     * its own, so skip it. The headers quoted in an ICMP (or other) error
+     * packet are part of its payload, not layers of the packet, so skip
+     * them too.
      */
-    ws_assert(finfo);
-
-    stat_node = find_stat_node(parent_stat_node, finfo->hfinfo);
+    for (layer = wmem_list_head(pinfo->layers); layer;
+            layer = wmem_list_frame_next(layer), layer_idx++) {
+        int proto_id = GPOINTER_TO_INT(wmem_list_frame_data(layer));
 
-    stats = STAT_NODE_STATS(stat_node);
-    /* Only increment the total packet count once per packet for a given
-     * node, since there could be multiple PDUs in a frame.
-     * (All the other statistics should be incremented every time,
-     * including the count for how often a protocol was the last
-     * protocol in a packet.)
-     */
-    if (stats->last_pkt != ps->tot_packets) {
-        stats->num_pkts_total++;
-        stats->last_pkt = ps->tot_packets;
-    }
-    stats->num_pdus_total++;
-    stats->num_bytes_total += finfo->length + finfo->appendix_length;
-
-    proto_sibling_node = ptree_node->next;
-
-    /* Skip entries that are not protocols, e.g.
-     * toplevel tree item of desegmentation "[Reassembled TCP Segments]")
-     * XXX: We should probably skip PINOs with field_type FT_BYTES too.
-     *
-     * XXX: We look at siblings not children, and thus don't descend into
-     * the tree to pick up embedded protocols not added to the toplevel of
-     * the tree.
-     */
-    while (proto_sibling_node) {
-        if (ph_node_is_proto(proto_sibling_node)) {
-            break;
+        if (proto_id == ethertype_proto_id) {
+            continue;
         }
-        proto_sibling_node = proto_sibling_node->next;
-    }
-
-    if (proto_sibling_node) {
-        // We recurse here but we're limited by proto tree checks
-        process_node(proto_sibling_node, stat_node, ps);
-    } else {
-        stats->num_pkts_last++;
-        stats->num_bytes_last += finfo->length + finfo->appendix_length;
-    }
-}
-
 
+        info = (const layer_info_t *)wmem_array_index(pinfo->layer_info, layer_idx);
+        if (info->in_error_pkt) {
+            continue;
+        }
 
-    static void
-process_tree(proto_tree *protocol_tree, ph_stats_t* ps)
-{
-    proto_node	*ptree_node;
+        length = info->length;
+        stat_node = find_stat_node(stat_node, proto_registrar_get_nth(proto_id));
 
-    /*
-     * Skip over non-protocols and comments. (Packet comments are a PINO
-     * with FT_PROTOCOL field type). This keeps us from having a top-level
-     * "Packet comments" item that steals items from "Frame".
-     */
-    ptree_node = ((proto_node *)protocol_tree)->first_child;
-    while (ptree_node) {
-        if (ph_node_is_proto(ptree_node)) {
-            break;
+        stats = STAT_NODE_STATS(stat_node);
+        /* Only increment the total packet count once per packet for a given
+         * node, since there could be multiple PDUs in a frame.
+         * (All the other statistics should be incremented every time,
+         * including the count for how often a protocol was the last
+         * protocol in a packet.)
+         */
+        if (stats->last_pkt != ps->tot_packets) {
+            stats->num_pkts_total++;
+            stats->last_pkt = ps->tot_packets;
         }
-        ptree_node = ptree_node->next;
+        stats->num_pdus_total++;
+        stats->num_bytes_total += length;
     }
 
-    if (!ptree_node) {
-        return;
+    if (stats) {
+        stats->num_pkts_last++;
+        stats->num_bytes_last += length;
     }
-
-    process_node(ptree_node, ps->stats_tree, ps);
 }
 
     static bool
@@ -182,14 +145,12 @@ process_record(capture_file *cf, frame_data *frame, column_info *cinfo,
     if (!cf_read_record(cf, frame, rec))
         return false;	/* failure */
 
-    /* Dissect the record   tree  not visible */
-    epan_dissect_init(&edt, cf->epan, true, false);
-    /* Don't fake protocols. We need them for the protocol hierarchy */
-    epan_dissect_fake_protocols(&edt, false);
+    /* Dissect the record without a tree; the layers are all we need */
+    epan_dissect_init(&edt, cf->epan, false, false);
     epan_dissect_run(&edt, cf->cd_t, rec, frame, cinfo);
 
-    /* Get stats from this protocol tree */
-    process_tree(edt.tree, ps);
+    /* Get stats from the protocol layers */
+    process_layers(&edt.pi, ps);
 
     if (frame->has_ts) {
         /* Update times */
@@ -207,6 +168,70 @@ process_record(capture_file *cf, frame_data *frame, column_info *cinfo,
     return true;	/* success */
 }
 
+/*
+ * The statistics last computed, and what they were computed for, so that
+ * opening the dialog again doesn't rescan the capture file. They're
+ * dropped when the file is closed, reread or rescanned.
+ */
+static ph_stats_t *cached_ps;
+static const capture_file *cached_cf;
+static uint32_t cached_count;
+static uint32_t cached_displayed_count;
+static char *cached_dfilter;
+
+    static void
+ph_stats_cache_clear(void)
+{
+    if (cached_ps) {
+        ph_stats_free(cached_ps);
+        cached_ps = NULL;
+    }
+    cached_cf = NULL;
+    g_free(cached_dfilter);
+    cached_dfilter = NULL;
+}
+
+    static void
+ph_stats_cf_callback(int event, void *data _U_, void *user_data _U_)
+{
+    switch (event) {
+    case cf_cb_file_opened:
+    case cf_cb_file_closing:
+    case cf_cb_file_read_started:
+    case cf_cb_file_reload_started:
+    case cf_cb_file_rescan_started:
+    case cf_cb_file_merge_started:
+        ph_stats_cache_clear();
+        break;
+    default:
+        break;
+    }
+}
+
+    static ph_stats_t*
+ph_stats_cache_lookup(capture_file *cf)
+{
+    if (!cached_ps || cached_cf != cf || cached_count != cf->count ||
+            cached_displayed_count != cf->displayed_count ||
+            g_strcmp0(cached_dfilter, cf->dfilter) != 0)
+        return NULL;
+
+    cached_ps->ref_count++;
+    return cached_ps;
+}
+
+    static void
+ph_stats_cache_store(capture_file *cf, ph_stats_t *ps)
+{
+    ph_stats_cache_clear();
+    ps->ref_count++;
+    cached_ps = ps;
+    cached_cf = cf;
+    cached_count = cf->count;
+    cached_displayed_count = cf->displayed_count;
+    cached_dfilter = g_strdup(cf->dfilter);
+}
+
     ph_stats_t*
 ph_stats_new(capture_file *cf)
 {
@@ -223,6 +248,16 @@ ph_stats_new(capture_file *cf)
 
     if (!cf) return NULL;
 
+    if (!cf_callback_registered) {
+        cf_callback_add(ph_stats_cf_callback, NULL);
+        cf_callback_registered = true;
+    }
+
+    ps = ph_stats_cache_lookup(cf);
+    if (ps) {
+        return ps;
+    }
+
     if (cf->read_lock) {
         ws_warning("Failing to compute protocol hierarchy stats on \"%s\" since a read is in progress", cf->filename);
         return NULL;
@@ -231,10 +266,11 @@ ph_stats_new(capture_file *cf)
 
     cf->stop_flag = false;
 
-    pc_proto_id = proto_registrar_get_id_byname("pkt_comment");
+    ethertype_proto_id = proto_get_id_by_filter_name("ethertype");
 
     /* Initialize the data */
     ps = g_new(ph_stats_t, 1);
+    ps->ref_count = 1;
     ps->tot_packets = 0;
     ps->tot_bytes = 0;
     ps->stats_tree = g_node_new(NULL);
@@ -351,6 +387,8 @@ ph_stats_new(capture_file *cf)
          */
         ph_stats_free(ps);
         ps = NULL;
+    } else {
+        ph_stats_cache_store(cf, ps);
     }
 
     ws_assert(cf->read_lock);
@@ -370,6 +408,9 @@ stat_node_free(GNode *node, void *data _U_)
     void
 ph_stats_free(ph_stats_t *ps)
 {
+    if (--ps->ref_count > 0)
+        return;
+
     if (ps->stats_tree) {
         g_node_traverse(ps->stats_tree, G_IN_ORDER,
                 G_TRAVERSE_ALL, -1,
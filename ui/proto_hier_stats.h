@@ -38,10 +38,23 @@ typedef struct {
     GNode	*stats_tree;
     double	first_time;	/* seconds (msec resolution) of first packet */
     double	last_time;	/* seconds (msec resolution) of last packet  */
+    unsigned	ref_count;
 } ph_stats_t;
 
+/** Compute the protocol hierarchy statistics of the displayed frames.
+ * The result for the current capture file and display filter is kept,
+ * so asking again returns it without rescanning the file.
+ *
+ * @param cf The capture file
+ * @return The statistics, to be released with ph_stats_free(), or NULL
+ * if they couldn't be computed or the user stopped the computation.
+ */
 ph_stats_t *ph_stats_new(capture_file *cf);
 
+/** Release protocol hierarchy statistics.
+ *
+ * @param ps Statistics returned by ph_stats_new()
+ */
 void ph_stats_free(ph_stats_t *ps);
 
 #ifdef __cplusplus
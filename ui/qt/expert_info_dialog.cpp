@@ -149,6 +149,14 @@ void ExpertInfoDialog::retapPackets()
         return;
     }
 
+    // Unless limited to the display filter, use the store once an earlier
+    // retap has recorded every frame. The listener picks up packets that
+    // arrive later.
+    if (!ui->limitCheckBox->isChecked() && expert_info_model_->loadFromStore()) {
+        updateWidgets();
+        return;
+    }
+
     cap_file_.retapPackets();
 }
 
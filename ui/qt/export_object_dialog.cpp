@@ -274,7 +274,9 @@ void ExportObjectDialog::saveCurrentEntry(QString *tempFile)
         *tempFile = path;
     }
 
-    model_.saveEntry(current, file_name);
+    if (!model_.saveEntry(cap_file_.capFile(), current, file_name) && tempFile) {
+        tempFile->clear();
+    }
 }
 
 void ExportObjectDialog::saveAllEntries()
@@ -299,5 +301,8 @@ void ExportObjectDialog::saveAllEntries()
     if (save_in_path.length() < 1)
         return;
 
-    model_.saveAllEntries(save_in_path);
+    if (!model_.saveAllEntries(cap_file_.capFile(), save_in_path)) {
+        QMessageBox::warning(this, tr("Save All Objects"),
+                             tr("Some objects could not be extracted from the capture again and were not saved."));
+    }
 }
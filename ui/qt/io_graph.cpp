@@ -39,6 +39,11 @@ IOGraph::IOGraph(QCustomPlot* parent) :
     hf_index_(-1),
     interval_(0),
     asAOT_(false),
+    tap_interval_(0),
+    tap_idx_(-1),
+    pyramid_(),
+    pyramid_valid_(false),
+    tap_overflow_(false),
     cur_idx_(-1)
 {
     GString* error_string;
@@ -61,6 +66,7 @@ IOGraph::IOGraph(QCustomPlot* parent) :
 
 IOGraph::~IOGraph() {
     removeTapListener();
+    io_graph_pyramid_clear(&pyramid_);
 }
 
 void IOGraph::removeTapListener()
@@ -274,13 +280,14 @@ int IOGraph::packetFromTime(double ts) const
 {
     int idx = ts * SCALE_F / interval_;
     if (idx >= 0 && idx <= cur_idx_) {
+        const io_graph_item_t* items = viewItems();
         switch (val_units_) {
         case IOG_ITEM_UNIT_CALC_MAX:
-            return items_[idx].max_frame_in_invl;
+            return items[idx].max_frame_in_invl;
         case IOG_ITEM_UNIT_CALC_MIN:
-            return items_[idx].min_frame_in_invl;
+            return items[idx].min_frame_in_invl;
         default:
-            return items_[idx].last_frame_in_invl;
+            return items[idx].last_frame_in_invl;
         }
     }
     return -1;
@@ -289,9 +296,16 @@ int IOGraph::packetFromTime(double ts) const
 void IOGraph::clearAllData()
 {
     cur_idx_ = -1;
+    tap_idx_ = -1;
+    // A retap counts at the current interval.
+    tap_interval_ = interval_;
     if (items_.size()) {
         reset_io_graph_items(&items_[0], items_.size(), hf_index_);
     }
+    view_items_.clear();
+    io_graph_pyramid_clear(&pyramid_);
+    pyramid_valid_ = false;
+    tap_overflow_ = false;
     Graph::clearAllData();
 }
 
@@ -309,6 +323,18 @@ void IOGraph::recalcGraphData(capture_file* cap_file)
         bars_->data()->clear();
     }
 
+    // New frames were tapped (live capture) since the rolled up view
+    // was computed. If the tapped data no longer covers them, retap at
+    // the current interval instead.
+    if (interval_ != tap_interval_ && tap_overflow_) {
+        view_items_.clear();
+        cur_idx_ = -1;
+        emit requestRetap();
+    } else if (interval_ != tap_interval_ && !pyramid_valid_ &&
+        tap_interval_ > 0 && interval_ % tap_interval_ == 0) {
+        updateView();
+    }
+
     if (moving_avg_period_ > 0 && cur_idx_ >= 0) {
         /* "Warm-up phase" - calculate average on some data not displayed;
          * just to make sure average on leftmost and rightmost displayed
@@ -487,7 +513,7 @@ bool IOGraph::hasItemToShow(int idx, double value) const
 
     bool result = false;
 
-    const io_graph_item_t* item = &items_[idx];
+    const io_graph_item_t* item = &viewItems()[idx];
 
     switch (val_units_) {
     case IOG_ITEM_UNIT_PACKETS:
@@ -522,12 +548,55 @@ bool IOGraph::hasItemToShow(int idx, double value) const
     return result;
 }
 
-void IOGraph::setInterval(int interval)
+// Returns true if the data for the new interval could be computed from the
+// tapped data, false if a retap is needed.
+bool IOGraph::setInterval(int interval)
 {
     interval_ = interval;
     if (bars_) {
         bars_->setWidth(interval_ / SCALE_F);
     }
+
+    if (need_retap_ || tap_interval_ <= 0 || interval_ <= 0 || interval_ % tap_interval_ != 0 ||
+        (tap_overflow_ && interval_ != tap_interval_)) {
+        // Nothing to show until the retap.
+        view_items_.clear();
+        cur_idx_ = -1;
+        return false;
+    }
+    updateView();
+    emit requestRecalc();
+    return true;
+}
+
+const io_graph_item_t* IOGraph::viewItems() const
+{
+    return interval_ == tap_interval_ ? items_.data() : view_items_.data();
+}
+
+// Compute the items for interval_ from the items tapped at tap_interval_.
+void IOGraph::updateView()
+{
+    if (interval_ == tap_interval_) {
+        view_items_.clear();
+        cur_idx_ = tap_idx_;
+        return;
+    }
+
+    if (!pyramid_valid_) {
+        io_graph_pyramid_build(&pyramid_, items_.data(), tap_idx_ + 1, tap_interval_, hf_index_);
+        pyramid_valid_ = true;
+    }
+
+    size_t count;
+    io_graph_item_t* items = io_graph_pyramid_get_items(&pyramid_, interval_, &count);
+    if (items) {
+        view_items_.assign(items, items + count);
+        g_free(items);
+    } else {
+        view_items_.clear();
+    }
+    cur_idx_ = (int)view_items_.size() - 1;
 }
 
 // Get the value at the given interval (idx) for the current value unit.
@@ -535,7 +604,7 @@ double IOGraph::getItemValue(int idx, const capture_file* cap_file) const
 {
     ws_assert(idx < max_io_items_);
 
-    return get_io_graph_item(&items_[0], val_units_, idx, hf_index_, cap_file, interval_, cur_idx_, asAOT_);
+    return get_io_graph_item(viewItems(), val_units_, idx, hf_index_, cap_file, interval_, cur_idx_, asAOT_);
 }
 
 // "tap_reset" callback for register_tap_listener
@@ -556,12 +625,23 @@ tap_packet_status IOGraph::tapPacket(void* iog_ptr, packet_info* pinfo, epan_dis
         return TAP_PACKET_DONT_REDRAW;
     }
 
-    int64_t tmp_idx = get_io_graph_index(pinfo, iog->interval_);
+    int64_t tmp_idx = get_io_graph_index(pinfo, iog->tap_interval_);
     bool recalc = false;
 
     /* some sanity checks */
     if ((tmp_idx < 0) || (tmp_idx >= max_io_items_)) {
-        iog->cur_idx_ = (int)iog->items_.size() - 1;
+        if (tmp_idx >= max_io_items_ && !iog->tap_overflow_) {
+            iog->tap_overflow_ = true;
+            iog->pyramid_valid_ = false;
+            if (iog->interval_ != iog->tap_interval_) {
+                /* The rolled up view is incomplete; recalcGraphData retaps. */
+                emit iog->requestRecalc();
+            }
+        }
+        iog->tap_idx_ = (int)iog->items_.size() - 1;
+        if (iog->interval_ == iog->tap_interval_) {
+            iog->cur_idx_ = iog->tap_idx_;
+        }
         return TAP_PACKET_DONT_REDRAW;
     }
 
@@ -575,7 +655,7 @@ tap_packet_status IOGraph::tapPacket(void* iog_ptr, packet_info* pinfo, epan_dis
      * enabled/disabled taps.
      */
     if (!iog->visible()) {
-        if (idx > iog->cur_idx_) {
+        if (idx > iog->tap_idx_) {
             iog->need_retap_ = true;
         }
         return TAP_PACKET_DONT_REDRAW;
@@ -604,10 +684,15 @@ tap_packet_status IOGraph::tapPacket(void* iog_ptr, packet_info* pinfo, epan_dis
     }
 
     /* update num_items */
-    if (idx > iog->cur_idx_) {
-        iog->cur_idx_ = idx;
+    if (idx > iog->tap_idx_) {
+        iog->tap_idx_ = idx;
         recalc = true;
     }
+    /* The rollups (if any) are recomputed on the next recalculation. */
+    iog->pyramid_valid_ = false;
+    if (iog->interval_ == iog->tap_interval_) {
+        iog->cur_idx_ = iog->tap_idx_;
+    }
 
     /* set start time */
     if (nstime_is_zero(&iog->start_time_)) {
@@ -620,7 +705,7 @@ tap_packet_status IOGraph::tapPacket(void* iog_ptr, packet_info* pinfo, epan_dis
         adv_edt = edt;
     }
 
-    if (!update_io_graph_item(&iog->items_[0], idx, pinfo, adv_edt, iog->hf_index_, iog->val_units_, iog->interval_)) {
+    if (!update_io_graph_item(&iog->items_[0], idx, pinfo, adv_edt, iog->hf_index_, iog->val_units_, iog->tap_interval_)) {
         return TAP_PACKET_DONT_REDRAW;
     }
 
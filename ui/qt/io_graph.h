@@ -81,7 +81,7 @@ public:
     QString valueUnitField() const { return vu_field_; }
     void setValueUnitField(const QString& vu_field);
     unsigned int movingAveragePeriod() const { return moving_avg_period_; }
-    void setInterval(int interval);
+    bool setInterval(int interval);
     int packetFromTime(double ts) const;
     bool hasItemToShow(int idx, double value) const;
     double getItemValue(int idx, const capture_file* cap_file) const;
@@ -110,6 +110,8 @@ private:
     void removeTapListener();
 
     bool showsZero() const;
+    const io_graph_item_t* viewItems() const;
+    void updateView();
 
     template<class DataMap> double maxValueFromGraphData(const DataMap& map);
     template<class DataMap> void scaleGraphData(DataMap& map, int scalar);
@@ -127,8 +129,19 @@ private:
 
     // Cached data. We should be able to change the Y axis without retapping as
     // much as is feasible.
+    // items_ holds the data tapped at tap_interval_. Coarser intervals that
+    // are a multiple of it are computed from pyramid_ into view_items_, so
+    // changing the interval doesn't require a retap.
     std::vector<io_graph_item_t> items_;
-    int cur_idx_;
+    int tap_interval_;
+    int tap_idx_;
+    io_graph_pyramid_t pyramid_;
+    bool pyramid_valid_;
+    // Packets past max_io_items_ at tap_interval_ were dropped, so the
+    // rollups don't cover the whole capture; coarser intervals need a retap.
+    bool tap_overflow_;
+    std::vector<io_graph_item_t> view_items_;
+    int cur_idx_; // Last index at interval_
 };
 
 #endif // IO_GRAPH_H
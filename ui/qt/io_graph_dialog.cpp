@@ -1629,8 +1629,9 @@ void IOGraphDialog::on_intervalComboBox_currentIndexChanged(int)
     if (uat_model_ != NULL) {
         for (int row = 0; row < uat_model_->rowCount(); row++) {
             IOGraph *iog = ioGraphs_.value(row, NULL);
-            if (iog) {
-                iog->setInterval(interval);
+            // Graphs can compute a multiple of the interval they were
+            // tapped at from the data they already have.
+            if (iog && !iog->setInterval(interval)) {
                 if (iog->visible()) {
                     need_retap = true;
                 } else {
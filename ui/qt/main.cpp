@@ -41,7 +41,9 @@
 #include <epan/tap.h>
 #include <epan/stat_tap_ui.h>
 #include <epan/column.h>
+#include <epan/conversation_table.h>
 #include <epan/disabled_protos.h>
+#include <epan/expert.h>
 #include <epan/prefs.h>
 
 #ifdef HAVE_KERBEROS
@@ -360,6 +362,31 @@ check_and_warn_user_startup()
 }
 #endif
 
+/*
+ * Accumulate the tables the conversation and endpoint dialogs open with
+ * while files are read, so that the dialogs don't have to retap.
+ */
+static void
+store_recent_conversation_tables(GList *tabs)
+{
+    if (tabs == NULL) {
+        /* The defaults of the traffic types list */
+        const char *proto_names[] = { "eth", "ip", "ipv6", "tcp", "udp" };
+
+        for (size_t i = 0; i < G_N_ELEMENTS(proto_names); i++) {
+            conversation_table_store_add(get_conversation_by_proto_id(proto_get_id_by_filter_name(proto_names[i])));
+        }
+        return;
+    }
+
+    for (GList *tab = tabs; tab; tab = tab->next) {
+        int proto_id = proto_get_id_by_short_name((const char *)tab->data);
+        if (proto_id > -1) {
+            conversation_table_store_add(get_conversation_by_proto_id(proto_id));
+        }
+    }
+}
+
 #if defined(_WIN32) && !defined(__MINGW32__)
 // Try to avoid library search path collisions. QCoreApplication will
 // search QT_INSTALL_PREFIX/plugins for platform DLLs before searching
@@ -788,6 +815,9 @@ int main(int argc, char *qt_argv[])
 
     conversation_table_set_gui_info(init_conversation_table);
     endpoint_table_set_gui_info(init_endpoint_table);
+    store_recent_conversation_tables(recent.conversation_tabs);
+    store_recent_conversation_tables(recent.endpoint_tabs);
+    expert_store_set_enabled(true);
     srt_table_iterate_tables(register_service_response_tables, NULL);
     rtd_table_iterate_tables(register_response_time_delay_tables, NULL);
     stat_tap_iterate_tables(register_simple_stat_tables, NULL);
@@ -120,6 +120,7 @@ MainStatusBar::MainStatusBar(QWidget *parent) :
     expert_button_ = new QToolButton(this);
     expert_button_->setIconSize(QSize(icon_size, icon_size));
     expert_button_->setStyleSheet(button_ss);
+    expert_button_->setToolButtonStyle(Qt::ToolButtonTextBesideIcon);
     expert_button_->hide();
 
     // We just want a clickable image. Using a QPushButton or QToolButton would require
@@ -191,8 +192,9 @@ void MainStatusBar::expertUpdate() {
     // We might have to switch to a QPushButton.
     QString stock_name = "x-expert-";
     QString tt_text = tr(" is the highest expert information level");
+    int severity = expert_get_highest_severity();
 
-    switch(expert_get_highest_severity()) {
+    switch(severity) {
     case(PI_ERROR):
         stock_name.append("error");
         tt_text.prepend(tr("ERROR"));
@@ -215,11 +217,26 @@ void MainStatusBar::expertUpdate() {
     default:
         stock_name.append("none");
         tt_text = tr("No expert information");
+        severity = 0;
         break;
     }
 
+    // Counts of the items in the store, once it has every frame (after
+    // the first retap).
+    QString count_text;
+    if (severity != 0 && cap_file_ && expert_store_available(cap_file_->count, false)) {
+        count_text = QString::number(expert_store_get_count(severity));
+        tt_text.append(QStringLiteral("\n"));
+        tt_text.append(tr("%1 errors, %2 warnings, %3 notes, %4 chats")
+                       .arg(expert_store_get_count(PI_ERROR))
+                       .arg(expert_store_get_count(PI_WARN))
+                       .arg(expert_store_get_count(PI_NOTE))
+                       .arg(expert_store_get_count(PI_CHAT)));
+    }
+
     StockIcon expert_icon(stock_name);
     expert_button_->setIcon(expert_icon);
+    expert_button_->setText(count_text);
     expert_button_->setToolTip(tt_text);
     expert_button_->show();
 }
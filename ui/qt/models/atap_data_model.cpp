@@ -56,6 +56,7 @@ ATapDataModel::ATapDataModel(dataModelType type, int protoId, QString filter, QO
 
     _type = type;
     _disableTap = true;
+    _needsRetap = true;
 
     _tapFlags = TL_IGNORE_DISPLAY_FILTER+TL_IP_AGGREGATION_ORI;
 
@@ -128,6 +129,12 @@ bool ATapDataModel::enableTap()
     if (errorString)
         g_string_free(errorString, TRUE);
 
+    /* The tap sees the packets to come; the ones already read are in the
+     * conversation table store, unless a filter is applied. Tables that
+     * aren't stored yet are from the next file on. */
+    conversation_table_store_add(registerTable());
+    _needsRetap = !(_filter.isEmpty() && loadFromStore());
+
     emit tapListenerChanged(true);
 
     return true;
@@ -142,6 +149,11 @@ void ATapDataModel::disableTap()
     emit tapListenerChanged(false);
 }
 
+bool ATapDataModel::needsRetap() const
+{
+    return !_disableTap && _needsRetap;
+}
+
 void ATapDataModel::updateFlags(unsigned flag)
 {
 
@@ -154,6 +166,7 @@ void ATapDataModel::updateFlags(unsigned flag)
                        TL_IP_AGGREGATION_RESERVED);
     }
     set_tap_flags(&hash_, _tapFlags);
+    _needsRetap = true;
 }
 
 void ATapDataModel::setMachineReadable(bool machineReadable)
@@ -177,6 +190,7 @@ void ATapDataModel::limitToDisplayFilter(bool limit)
         _tapFlags &= ~(TL_LIMIT_TO_DISPLAY_FILTER);
     }
     set_tap_flags(&hash_, _tapFlags);
+    _needsRetap = true;
 }
 
 int ATapDataModel::rowCount(const QModelIndex &parent) const
@@ -192,6 +206,8 @@ void ATapDataModel::tapReset(void *tapdata) {
     ATapDataModel * dataModel = qobject_cast<ATapDataModel *>((ATapDataModel *)hash->user_data);
 
     dataModel->resetData();
+    /* A retap is starting, which fills the data */
+    dataModel->_needsRetap = false;
 }
 
 void ATapDataModel::tapDraw(void *tapdata)
@@ -262,6 +278,43 @@ void ATapDataModel::updateData(GArray * newData)
         ((ConversationDataModel *)(this))->doDataUpdate();
 }
 
+bool ATapDataModel::loadFromStore()
+{
+    register_ct_t * table = registerTable();
+    conv_hash_t stored;
+    bool loaded = false;
+
+    if (_disableTap || !table)
+        return false;
+
+    stored.conv_array = nullptr;
+    stored.hashtable = nullptr;
+    if (_type == ATapDataModel::DATAMODEL_ENDPOINT)
+        loaded = conversation_table_store_get_endpoints(table, _tapFlags, &stored);
+    else if (_type == ATapDataModel::DATAMODEL_CONVERSATION)
+        loaded = conversation_table_store_get_conversations(table, _tapFlags, &stored);
+    if (!loaded)
+        return false;
+
+    beginResetModel();
+    storage_ = nullptr;
+    if (_type == ATapDataModel::DATAMODEL_ENDPOINT)
+        reset_endpoint_table_data(&hash_);
+    else
+        reset_conversation_table_data(&hash_);
+    hash_.conv_array = stored.conv_array;
+    hash_.hashtable = stored.hashtable;
+
+    _minRelStartTime = 0;
+    _maxRelStopTime = 0;
+
+    endResetModel();
+
+    updateData(hash_.conv_array);
+
+    return true;
+}
+
 bool ATapDataModel::resolveNames() const
 {
     return _resolveNames;
@@ -298,6 +351,7 @@ void ATapDataModel::setFilter(QString filter)
     if (_disableTap)
         return;
 
+    bool changed = (filter != _filter);
     _filter = filter;
     GString * errorString = set_tap_dfilter(&hash_, !_filter.isEmpty() ? _filter.toUtf8().constData() : nullptr);
     if (errorString && errorString->len > 0) {
@@ -308,6 +362,9 @@ void ATapDataModel::setFilter(QString filter)
 
     if (errorString)
         g_string_free(errorString, TRUE);
+
+    if (changed)
+        _needsRetap = !(_filter.isEmpty() && loadFromStore());
 }
 
 QString ATapDataModel::filter() const
@@ -198,6 +198,17 @@ public:
      */
     void disableTap();
 
+    /**
+     * @brief Does the data of this model have to be filled by a retap
+     *
+     * Models without a filter are filled from the conversation table store
+     * when the tap is enabled, and only see the packets to come.
+     *
+     * @return true a retap is needed
+     * @return false the data is complete
+     */
+    bool needsRetap() const;
+
     /**
      * @brief Return the model type
      *
@@ -234,6 +245,7 @@ protected:
 
     void resetData();
     void updateData(GArray * data);
+    bool loadFromStore();
 
     dataModelType _type;
     GArray * storage_;
@@ -247,6 +259,7 @@ protected:
     bool _resolveNames;
     bool _machineReadable;
     bool _disableTap;
+    bool _needsRetap;
 
     double _minRelStartTime;
     double _maxRelStopTime;
@@ -13,18 +13,16 @@
 #include "file.h"
 #include <epan/proto.h>
 
-ExpertPacketItem::ExpertPacketItem(const expert_info_t& expert_info, column_info *cinfo, ExpertPacketItem* parent) :
+ExpertPacketItem::ExpertPacketItem(const expert_info_t& expert_info, const char *info, ExpertPacketItem* parent) :
     packet_num_(expert_info.packet_num),
     group_(expert_info.group),
     severity_(expert_info.severity),
     hf_id_(expert_info.hf_index),
     protocol_(expert_info.protocol),
     summary_(expert_info.summary),
+    info_(info),
     parentItem_(parent)
 {
-    if (cinfo) {
-        info_ = col_get_text(cinfo, COL_INFO);
-    }
 }
 
 ExpertPacketItem::~ExpertPacketItem()
@@ -353,21 +351,45 @@ int ExpertInfoModel::columnCount(const QModelIndex&) const
     return colLast;
 }
 
-void ExpertInfoModel::addExpertInfo(const struct expert_info_s& expert_info)
+bool ExpertInfoModel::loadFromStore()
+{
+    if (!capture_file_.capFile() ||
+            !expert_store_available(capture_file_.capFile()->count, true))
+        return false;
+
+    beginResetModel();
+    eventCounts_.clear();
+    delete root_;
+    root_ = createRootItem();
+    expert_store_foreach(storeItem, this);
+    endResetModel();
+
+    return true;
+}
+
+void ExpertInfoModel::storeItem(const expert_info_t *expert_info, const char *info, void *model_ptr)
+{
+    ExpertInfoModel *model = static_cast<ExpertInfoModel*>(model_ptr);
+
+    model->addExpertInfo(*expert_info, info);
+    model->eventCounts_[(enum ExpertSeverity)expert_info->severity]++;
+}
+
+void ExpertInfoModel::addExpertInfo(const struct expert_info_s& expert_info, const char *info)
 {
     QString groupKey = ExpertPacketItem::groupKey(false, expert_info.severity, expert_info.group, QString(expert_info.protocol), expert_info.hf_index);
     QString summaryKey = ExpertPacketItem::groupKey(true, expert_info.severity, expert_info.group, QString(expert_info.protocol), expert_info.hf_index);
 
     ExpertPacketItem* expert_root = root_->child(groupKey);
     if (expert_root == NULL) {
-        ExpertPacketItem *new_item = new ExpertPacketItem(expert_info, &(capture_file_.capFile()->cinfo), root_);
+        ExpertPacketItem *new_item = new ExpertPacketItem(expert_info, info, root_);
 
         root_->appendChild(new_item, groupKey);
 
         expert_root = new_item;
     }
 
-    ExpertPacketItem *expert = new ExpertPacketItem(expert_info, &(capture_file_.capFile()->cinfo), expert_root);
+    ExpertPacketItem *expert = new ExpertPacketItem(expert_info, info, expert_root);
     expert_root->appendChild(expert, groupKey);
 
     //add the summary children off of the first child of the root children
@@ -376,13 +398,13 @@ void ExpertInfoModel::addExpertInfo(const struct expert_info_s& expert_info)
     //make a summary child
     ExpertPacketItem* expert_summary_root = summary_root->child(summaryKey);
     if (expert_summary_root == NULL) {
-        ExpertPacketItem *new_summary = new ExpertPacketItem(expert_info, &(capture_file_.capFile()->cinfo), summary_root);
+        ExpertPacketItem *new_summary = new ExpertPacketItem(expert_info, info, summary_root);
 
         summary_root->appendChild(new_summary, summaryKey);
         expert_summary_root = new_summary;
     }
 
-    ExpertPacketItem *expert_summary = new ExpertPacketItem(expert_info, &(capture_file_.capFile()->cinfo), expert_summary_root);
+    ExpertPacketItem *expert_summary = new ExpertPacketItem(expert_info, info, expert_summary_root);
     expert_summary_root->appendChild(expert_summary, summaryKey);
 }
 
@@ -404,7 +426,7 @@ tap_packet_status ExpertInfoModel::tapPacket(void *eid_ptr, struct _packet_info
     if (!pinfo || !model || !expert_info)
         return TAP_PACKET_DONT_REDRAW;
 
-    model->addExpertInfo(*expert_info);
+    model->addExpertInfo(*expert_info, col_get_text(&(model->capture_file_.capFile()->cinfo), COL_INFO));
 
     status = TAP_PACKET_REDRAW;
 
@@ -27,7 +27,7 @@
 class ExpertPacketItem
 {
 public:
-    ExpertPacketItem(const expert_info_t& expert_info, column_info *cinfo, ExpertPacketItem* parent);
+    ExpertPacketItem(const expert_info_t& expert_info, const char *info, ExpertPacketItem* parent);
     virtual ~ExpertPacketItem();
 
     unsigned int packetNum() const { return packet_num_; }
@@ -107,8 +107,11 @@ public:
     //GUI helpers
     void setGroupBySummary(bool group_by_summary);
 
-    // Called from tapPacket
-    void addExpertInfo(const struct expert_info_s& expert_info);
+    // Fill the model from the expert info store if it has every frame.
+    bool loadFromStore();
+
+    // Called from tapPacket and loadFromStore
+    void addExpertInfo(const struct expert_info_s& expert_info, const char *info);
 
     // Callbacks for register_tap_listener
     static void tapReset(void *eid_ptr);
@@ -119,6 +122,7 @@ private:
     CaptureFile& capture_file_;
 
     ExpertPacketItem* createRootItem();
+    static void storeItem(const expert_info_t *expert_info, const char *info, void *model_ptr);
 
     bool group_by_summary_;
     ExpertPacketItem* root_;
@@ -15,7 +15,14 @@
 #include <wsutil/filesystem.h>
 #include <epan/prefs.h>
 
+#include "file.h"
+
 #include <QDir>
+#include <QSet>
+
+// Payloads are kept in memory up to this total size. Beyond it, only the
+// metadata of objects that can be extracted again is kept.
+static const size_t max_retained_payload_len_ = 256 * 1024 * 1024;
 
 extern "C" {
 
@@ -44,6 +51,9 @@ object_list_get_entry(void *gui_data, int row) {
 
 ExportObjectModel::ExportObjectModel(register_eo_t* eo, QObject *parent) :
     QAbstractTableModel(parent),
+    retained_payload_len_(0),
+    extracting_(false),
+    extract_row_(0),
     eo_(eo)
 {
     eo_gui_data_.model = this;
@@ -135,6 +145,29 @@ void ExportObjectModel::addObjectEntry(export_object_entry_t *entry)
     if (entry == NULL)
         return;
 
+    if (extracting_) {
+        // Retapping to save objects whose payloads weren't kept. Entries
+        // are added in the same order as the first time.
+        int row = extract_row_++;
+        export_object_entry_t *listed = objectEntry(row);
+
+        if (listed && extract_files_.contains(row) &&
+                entry->pkt_num == listed->pkt_num && entry->payload_len == listed->payload_len) {
+            write_file_binary_mode(qUtf8Printable(extract_files_.take(row)),
+                                   entry->payload_data, entry->payload_len);
+        }
+        eo_free_entry(entry);
+        return;
+    }
+
+    if (get_eo_entries_complete(eo_) &&
+            retained_payload_len_ + entry->payload_len > max_retained_payload_len_) {
+        g_free(entry->payload_data);
+        entry->payload_data = NULL;
+    } else {
+        retained_payload_len_ += entry->payload_len;
+    }
+
     int count = static_cast<int>(objects_.count());
     beginInsertRows(QModelIndex(), count, count);
     objects_.append(VariantPointer<export_object_entry_t>::asQVariant(entry));
@@ -146,7 +179,7 @@ export_object_entry_t* ExportObjectModel::objectEntry(int row)
     return VariantPointer<export_object_entry_t>::asPtr(objects_.value(row));
 }
 
-bool ExportObjectModel::saveEntry(QModelIndex &index, QString filename)
+bool ExportObjectModel::saveEntry(capture_file *cf, QModelIndex &index, QString filename)
 {
     if (!index.isValid() || filename.isEmpty())
         return false;
@@ -155,24 +188,26 @@ bool ExportObjectModel::saveEntry(QModelIndex &index, QString filename)
     if (entry == NULL)
         return false;
 
-    if (filename.length() > 0) {
-        write_file_binary_mode(qUtf8Printable(filename), entry->payload_data, entry->payload_len);
+    if (entry->payload_data == NULL && entry->payload_len > 0) {
+        extract_files_.insert(index.row(), filename);
+        return extractEntries(cf);
     }
 
-    return true;
+    return write_file_binary_mode(qUtf8Printable(filename), entry->payload_data, entry->payload_len);
 }
 
-void ExportObjectModel::saveAllEntries(QString path)
+bool ExportObjectModel::saveAllEntries(capture_file *cf, QString path)
 {
     if (path.isEmpty())
-        return;
+        return false;
 
     QDir save_dir(path);
+    QSet<QString> extract_filenames;
     export_object_entry_t *entry;
 
-    for (QList<QVariant>::iterator it = objects_.begin(); it != objects_.end(); ++it)
+    for (int row = 0; row < objects_.count(); row++)
     {
-        entry = VariantPointer<export_object_entry_t>::asPtr(*it);
+        entry = VariantPointer<export_object_entry_t>::asPtr(objects_.at(row));
         if (entry == NULL)
             continue;
 
@@ -197,19 +232,54 @@ void ExportObjectModel::saveAllEntries(QString path)
             }
             filename = QString::fromUtf8(safe_filename->str);
             g_string_free(safe_filename, TRUE);
-        } while (save_dir.exists(filename) && ++count < prefs.gui_max_export_objects);
+        } while ((save_dir.exists(filename) || extract_filenames.contains(filename)) &&
+                 ++count < prefs.gui_max_export_objects);
+
+        if (entry->payload_data == NULL && entry->payload_len > 0) {
+            extract_filenames.insert(filename);
+            extract_files_.insert(row, save_dir.filePath(filename));
+            continue;
+        }
         write_file_binary_mode(qUtf8Printable(save_dir.filePath(filename)),
                                entry->payload_data, entry->payload_len);
     }
+
+    return extractEntries(cf);
+}
+
+// Save the objects in extract_files_ by retapping the capture. All of
+// them are written in a single pass, one at a time as they're found.
+bool ExportObjectModel::extractEntries(capture_file *cf)
+{
+    if (extract_files_.isEmpty())
+        return true;
+
+    extracting_ = true;
+    extract_row_ = 0;
+    cf_read_status_t status = cf_retap_packets(cf);
+    extracting_ = false;
+
+    bool extracted = (status == CF_READ_OK && extract_files_.isEmpty());
+    extract_files_.clear();
+    return extracted;
 }
 
 void ExportObjectModel::resetObjects()
 {
     export_object_gui_reset_cb reset_cb = get_eo_reset_func(eo_);
 
-    beginResetModel();
-    objects_.clear();
-    endResetModel();
+    if (extracting_) {
+        // Keep the list; just start matching entries from the top.
+        extract_row_ = 0;
+    } else {
+        beginResetModel();
+        foreach (QVariant v, objects_) {
+            eo_free_entry(VariantPointer<export_object_entry_t>::asPtr(v));
+        }
+        objects_.clear();
+        retained_payload_len_ = 0;
+        endResetModel();
+    }
 
     if (reset_cb)
         reset_cb();
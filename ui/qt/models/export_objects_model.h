@@ -17,9 +17,12 @@
 #include <epan/tap.h>
 #include <epan/export_object.h>
 
+#include "cfile.h"
+
 #include <QAbstractTableModel>
 #include <QSortFilterProxyModel>
 #include <QList>
+#include <QMap>
 
 typedef struct export_object_list_gui_t {
     class ExportObjectModel *model;
@@ -46,8 +49,8 @@ public:
     export_object_entry_t *objectEntry(int row);
     void resetObjects();
 
-    bool saveEntry(QModelIndex &index, QString filename);
-    void saveAllEntries(QString path);
+    bool saveEntry(capture_file *cf, QModelIndex &index, QString filename);
+    bool saveAllEntries(capture_file *cf, QString path);
 
     const char* getTapListenerName();
     void* getTapData();
@@ -62,7 +65,16 @@ public:
     int columnCount(const QModelIndex &parent = QModelIndex()) const;
 
 private:
+    bool extractEntries(capture_file *cf);
+
     QList<QVariant> objects_;
+    size_t retained_payload_len_;
+
+    // Rows whose payloads weren't kept, and the files to save them to
+    // while the capture is retapped.
+    QMap<int, QString> extract_files_;
+    bool extracting_;
+    int extract_row_;
 
     export_object_list_t export_object_list_;
     export_object_list_gui_t eo_gui_data_;
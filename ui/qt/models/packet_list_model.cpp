@@ -75,6 +75,7 @@ packet_list_recreate_visible_rows(void)
 PacketListModel::PacketListModel(QObject *parent, capture_file *cf) :
     QAbstractItemModel(parent),
     number_to_row_(QVector<int>()),
+    sort_keys_column_(-1),
     idle_dissection_row_(0)
 {
     Q_ASSERT(glbl_plist_model == Q_NULLPTR);
@@ -127,6 +128,8 @@ unsigned PacketListModel::recreateVisibleRows()
 {
     beginResetModel();
     visible_rows_.resize(0);
+    // Rows appended while the list was rebuilt are in physical_rows_.
+    new_visible_rows_.resize(0);
     number_to_row_.fill(0);
     endResetModel();
 
@@ -158,6 +161,7 @@ void PacketListModel::clear() {
     new_visible_rows_.resize(0);
     number_to_row_.resize(0);
     endResetModel();
+    invalidateSortKeys();
     idle_dissection_timer_->invalidate();
     idle_dissection_row_ = 0;
 }
@@ -195,6 +199,7 @@ void PacketListModel::invalidateAllColumnStrings()
     emit layoutAboutToBeChanged();
 #endif
     PacketListRecord::invalidateAllRecords();
+    invalidateSortKeys();
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
     emit layoutChanged();
 #else
@@ -211,6 +216,7 @@ void PacketListModel::resetColumns()
     if (cap_file_) {
         PacketListRecord::resetColumns(&cap_file_->cinfo);
     }
+    invalidateSortKeys();
 
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
     emit layoutChanged();
@@ -357,6 +363,7 @@ void PacketListModel::toggleFrameRefTime(const QModelIndex &rt_index)
         cap_file_->displayed_count--;
     }
     record->resetColumns(&cap_file_->cinfo);
+    invalidateSortKeys();
     emit dataChanged(index(0, 0), index(rowCount() - 1, columnCount() - 1));
 }
 
@@ -375,6 +382,7 @@ void PacketListModel::unsetAllFrameRefTime()
     cap_file_->ref_time_count = 0;
     cf_reftime_packets(cap_file_);
     PacketListRecord::resetColumns(&cap_file_->cinfo);
+    invalidateSortKeys();
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
     emit layoutChanged();
 #else
@@ -548,10 +556,12 @@ void PacketListModel::sort(int column, Qt::SortOrder order)
      * the sort indicator have the value that the user requested
      * regardless.
      */
-    if (PacketListRecord::textColumn(column) >= 0 && (unsigned)visible_rows_.count() > prefs.gui_packet_list_cached_rows_max) {
+    if (PacketListRecord::textColumn(column) >= 0 && !useSortKeys(column) &&
+            (unsigned)visible_rows_.count() > prefs.gui_packet_list_cached_rows_max) {
         /* Column not based on frame data but by column text that requires
          * dissection, so to sort in a reasonable amount of time the column
-         * text needs to be cached.
+         * text needs to be cached. (Numeric custom columns are sorted by
+         * sort keys instead, which don't need the text.)
          */
         /* If the sort is being triggered because the columns were already
          * sorted and the filter is being cleared (or changed to something
@@ -627,7 +637,11 @@ void PacketListModel::sort(int column, Qt::SortOrder order)
     sort_column_is_numeric_ = isNumericColumn(sort_column_);
     QVector<PacketListRecord *> sorted_visible_rows_ = visible_rows_;
     try {
-        std::sort(sorted_visible_rows_.begin(), sorted_visible_rows_.end(), recordLessThan);
+        if (useSortKeys(sort_column_)) {
+            sortByKeys(sorted_visible_rows_);
+        } else {
+            std::sort(sorted_visible_rows_.begin(), sorted_visible_rows_.end(), recordLessThan);
+        }
 
         beginResetModel();
         visible_rows_.resize(0);
@@ -673,7 +687,7 @@ bool PacketListModel::isNumericColumn(int column)
     if (column < 0) {
         return false;
     }
-    switch (sort_cap_file_->cinfo.columns[column].col_fmt) {
+    switch (cap_file_->cinfo.columns[column].col_fmt) {
     case COL_CUMULATIVE_BYTES: /**< 3) Cumulative number of bytes */
     case COL_DELTA_TIME:     /**< 5) Delta time */
     case COL_DELTA_TIME_DIS: /**< 8) Delta time displayed*/
@@ -705,10 +719,10 @@ bool PacketListModel::isNumericColumn(int column)
         return false;
     }
 
-    unsigned num_fields = g_slist_length(sort_cap_file_->cinfo.columns[column].col_custom_fields_ids);
+    unsigned num_fields = g_slist_length(cap_file_->cinfo.columns[column].col_custom_fields_ids);
     col_custom_t *col_custom;
     for (unsigned i = 0; i < num_fields; i++) {
-        col_custom = (col_custom_t *) g_slist_nth_data(sort_cap_file_->cinfo.columns[column].col_custom_fields_ids, i);
+        col_custom = (col_custom_t *) g_slist_nth_data(cap_file_->cinfo.columns[column].col_custom_fields_ids, i);
         if (col_custom->field_id == 0) {
             ftenum_t type = dfilter_get_return_type(col_custom->dfilter);
             if (FT_IS_INTEGER(type) || FT_IS_FLOATING(type) || type == FT_BOOLEAN || type == FT_RELATIVE_TIME) {
@@ -742,6 +756,138 @@ bool PacketListModel::isNumericColumn(int column)
     return true;
 }
 
+bool PacketListModel::useSortKeys(int column)
+{
+    if (!cap_file_ || column < 0 || column >= cap_file_->cinfo.num_cols) {
+        return false;
+    }
+    if (cap_file_->cinfo.columns[column].col_fmt != COL_CUSTOM) {
+        return false;
+    }
+    return isNumericColumn(column);
+}
+
+void PacketListModel::invalidateSortKeys()
+{
+    sort_keys_.clear();
+    sort_keys_column_ = -1;
+}
+
+// Extract the sort keys of sort_column_ for all the rows that don't have
+// one yet. This only primes the fields of the column in a tree that isn't
+// visible and doesn't fill in any column text.
+void PacketListModel::fillSortKeys(const QVector<PacketListRecord *> &rows)
+{
+    if (sort_keys_column_ != sort_column_) {
+        sort_keys_.clear();
+        sort_keys_column_ = sort_column_;
+    }
+
+    wtap_rec rec;
+    epan_dissect_t edt;
+    double count = 0;
+
+    wtap_rec_init(&rec, 1514);
+    epan_dissect_init(&edt, sort_cap_file_->epan, true, false);
+    foreach (PacketListRecord *record, rows) {
+        frame_data *fdata = record->frameData();
+
+        count++;
+        if (sort_keys_.size() <= fdata->num) {
+            sort_keys_.resize(fdata->num + 10000, PROTO_CUSTOM_SORT_KEY_UNSET);
+        }
+        if (sort_keys_[fdata->num] != PROTO_CUSTOM_SORT_KEY_UNSET) {
+            continue;
+        }
+
+        if (busy_timer_.elapsed() > busy_timeout_) {
+            if (progress_frame_) {
+                progress_frame_->setValue(static_cast<int>(count / rows.count() * 100));
+            }
+            mainApp->processEvents(QEventLoop::ExcludeSocketNotifiers, 1);
+            if (stop_flag_) {
+                epan_dissect_cleanup(&edt);
+                wtap_rec_cleanup(&rec);
+                throw SortAbort("Sorting aborted");
+            }
+            busy_timer_.restart();
+        }
+
+        if (!cf_read_record_no_alert(sort_cap_file_, fdata, &rec)) {
+            sort_keys_[fdata->num] = PROTO_CUSTOM_SORT_KEY_NONE;
+            wtap_rec_reset(&rec);
+            continue;
+        }
+        col_custom_prime_edt_sort_key(&edt, &sort_cap_file_->cinfo, sort_column_);
+        epan_dissect_run(&edt, sort_cap_file_->cd_t, &rec, fdata, NULL);
+        sort_keys_[fdata->num] = col_custom_get_sort_key(&edt, &sort_cap_file_->cinfo, sort_column_);
+        epan_dissect_reset(&edt);
+        wtap_rec_reset(&rec);
+    }
+    epan_dissect_cleanup(&edt);
+    wtap_rec_cleanup(&rec);
+}
+
+// Sort rows by the custom column sort keys with an LSD radix sort on
+// the 64-bit key, then the frame number, instead of comparing strings.
+// Since the sort is stable, sorting by the frame number first breaks
+// ties the same way recordLessThan does.
+void PacketListModel::sortByKeys(QVector<PacketListRecord *> &rows)
+{
+    struct SortEntry {
+        uint64_t key;
+        uint32_t num;
+        PacketListRecord *record;
+    };
+
+    fillSortKeys(rows);
+
+    // Descending order is ascending order of the complemented keys.
+    const uint64_t flip = (sort_order_ == Qt::AscendingOrder) ? 0 : UINT64_MAX;
+    const size_t count = static_cast<size_t>(rows.count());
+    std::vector<SortEntry> entries(count);
+    std::vector<SortEntry> scratch(count);
+
+    for (size_t i = 0; i < count; i++) {
+        uint32_t num = rows[i]->frameData()->num;
+        entries[i] = { sort_keys_[num] ^ flip, num ^ static_cast<uint32_t>(flip), rows[i] };
+    }
+
+    // 4 passes over the frame number, then 8 over the key.
+    for (unsigned pass = 0; pass < 12; pass++) {
+        size_t buckets[257] = { 0 };
+        unsigned shift = (pass < 4 ? pass : pass - 4) * 8;
+
+        for (const SortEntry &entry : entries) {
+            uint64_t value = pass < 4 ? entry.num : entry.key;
+            buckets[((value >> shift) & 0xff) + 1]++;
+        }
+        // All entries have the same byte; nothing to do in this pass.
+        bool trivial = false;
+        for (unsigned b = 1; b <= 256; b++) {
+            if (buckets[b] == count) {
+                trivial = true;
+                break;
+            }
+        }
+        if (trivial) {
+            continue;
+        }
+        for (unsigned b = 1; b <= 256; b++) {
+            buckets[b] += buckets[b - 1];
+        }
+        for (const SortEntry &entry : entries) {
+            uint64_t value = pass < 4 ? entry.num : entry.key;
+            scratch[buckets[(value >> shift) & 0xff]++] = entry;
+        }
+        entries.swap(scratch);
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        rows[i] = entries[i].record;
+    }
+}
+
 bool PacketListModel::recordLessThan(PacketListRecord *r1, PacketListRecord *r2)
 {
     int cmp_val = 0;
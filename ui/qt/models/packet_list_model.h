@@ -14,6 +14,8 @@
 
 #include <stdio.h>
 
+#include <vector>
+
 #include <epan/packet.h>
 
 #include <QAbstractItemModel>
@@ -111,10 +113,19 @@ private:
     static double exp_comps_;
     static double comps_;
 
+    // Numeric sort keys of custom column sort_keys_column_, indexed by
+    // frame number. PROTO_CUSTOM_SORT_KEY_UNSET if not yet extracted.
+    std::vector<uint64_t> sort_keys_;
+    int sort_keys_column_;
+
     QElapsedTimer *idle_dissection_timer_;
     int idle_dissection_row_;
 
     bool isNumericColumn(int column);
+    bool useSortKeys(int column);
+    void invalidateSortKeys();
+    void fillSortKeys(const QVector<PacketListRecord *> &rows);
+    void sortByKeys(QVector<PacketListRecord *> &rows);
 };
 
 #endif // PACKET_LIST_MODEL_H
@@ -33,6 +33,9 @@
 #endif
 #include <QAudioFormat>
 #include <QAudioOutput>
+#include <QBuffer>
+#include <QDir>
+#include <QTemporaryFile>
 #include <QVariant>
 #include <QTimer>
 
@@ -44,6 +47,7 @@ static constexpr spx_uint32_t default_visual_sample_rate_ = 1000;
 RtpAudioStream::RtpAudioStream(QObject *parent, rtpstream_id_t *id, bool stereo_required) :
     QObject(parent)
     , first_packet_(true)
+    , decoded_file_(NULL)
     , decoders_hash_(rtp_decoder_hash_table_new())
     , global_start_rel_time_(0.0)
     , start_abs_offset_(0.0)
@@ -70,6 +74,24 @@ RtpAudioStream::RtpAudioStream(QObject *parent, rtpstream_id_t *id, bool stereo_
     visual_resampler_ = speex_resampler_init(1, visual_sample_rate_,
                                                 visual_sample_rate_, SPEEX_RESAMPLER_QUALITY_MIN, NULL);
 
+    // Decoded payload is kept with the same policy as audio samples
+    QString tempname = "memory";
+    if (prefs.gui_rtp_player_use_disk1) {
+        tempname = QStringLiteral("%1/wireshark_rtp_decoded").arg(QDir::tempPath());
+        decoded_file_ = new QTemporaryFile(tempname, this);
+    } else {
+        decoded_file_ = new QBuffer(this);
+    }
+    if (!decoded_file_->open(QIODevice::ReadWrite)) {
+        // We are out of file resources
+        delete decoded_file_;
+        qWarning() << "Can't create temp file in " << tempname;
+        speex_resampler_destroy(visual_resampler_);
+        rtpstream_info_free_data(&rtpstream_);
+        rtpstream_id_free(&id_);
+        throw -1;
+    }
+
     try {
         // RtpAudioFile is ready for writing Frames
         audio_file_ = new RtpAudioFile(prefs.gui_rtp_player_use_disk1, prefs.gui_rtp_player_use_disk2);
@@ -152,6 +174,11 @@ void RtpAudioStream::clearPackets()
         g_free(rtp_packet);
     }
     rtp_packets_.clear();
+    // Decode again from the start, with new decoders
+    decoded_packets_.clear();
+    decoded_file_->seek(0);
+    g_hash_table_remove_all(decoders_hash_);
+    payload_names_.clear();
     rtpstream_info_free_data(&rtpstream_);
     memset(&rtpstream_, 0, sizeof(rtpstream_));
     rtpstream_id_copy(&id_, &rtpstream_.id);
@@ -168,6 +195,8 @@ void RtpAudioStream::reset(double global_start_time)
     visual_samples_.clear();
     out_of_seq_timestamps_.clear();
     jitter_drop_timestamps_.clear();
+    wrong_timestamp_timestamps_.clear();
+    silence_timestamps_.clear();
 }
 
 AudioRouting RtpAudioStream::getAudioRouting()
@@ -180,16 +209,96 @@ void RtpAudioStream::setAudioRouting(AudioRouting audio_routing)
     audio_routing_ = audio_routing;
 }
 
+void RtpAudioStream::decodePackets()
+{
+    qint64 decoded_pos = 0;
+
+    if (!decoded_packets_.isEmpty()) {
+        decoded_pos = decoded_packets_.last().pos + decoded_packets_.last().bytes;
+    }
+    decoded_file_->seek(decoded_pos);
+
+    // Decoders keep their state between packets, so packets added since
+    // the last call are just decoded after the ones before them.
+    for (int cur_packet = static_cast<int>(decoded_packets_.size()); cur_packet < rtp_packets_.size(); cur_packet++) {
+        SAMPLE *decode_buff = NULL;
+        unsigned int channels = 0;
+        unsigned int sample_rate = 0;
+        // TODO: Update a progress bar here.
+        rtp_packet_t *rtp_packet = rtp_packets_[cur_packet];
+
+        QString payload_name;
+        if (rtp_packet->info->info_payload_type_str) {
+            payload_name = rtp_packet->info->info_payload_type_str;
+        } else {
+            payload_name = try_val_to_str_ext(rtp_packet->info->info_payload_type, &rtp_payload_type_short_vals_ext);
+        }
+        if (!payload_name.isEmpty()) {
+            payload_names_ << payload_name;
+        }
+
+        size_t decoded_bytes = decode_rtp_packet(rtp_packet, &decode_buff, decoders_hash_, &channels, &sample_rate);
+        // XXX: We don't actually *do* anything with channels, and just treat
+        // everything as if it were mono
+
+        // Length 2 for PT_PCM mean silence packet probably, ignore
+        if (sample_rate == 0 ||
+            ((rtp_packet->info->info_payload_type == PT_PCMU ||
+              rtp_packet->info->info_payload_type == PT_PCMA
+             ) && (decoded_bytes == 2)
+            )
+           ) {
+            decoded_bytes = 0;
+        }
+
+        DecodedPacket decoded;
+        decoded.pos = decoded_pos;
+        decoded.bytes = 0;
+        decoded.sample_rate = sample_rate;
+        if (decoded_bytes > 0) {
+            if (decoded_file_->write((char *) decode_buff, decoded_bytes) == (qint64) decoded_bytes) {
+                decoded.bytes = decoded_bytes;
+                decoded_pos += decoded_bytes;
+            } else {
+                // Out of space, handle the packet as if nothing was decoded
+                decoded_file_->seek(decoded_pos);
+            }
+        }
+        decoded_packets_ << decoded;
+
+        g_free(decode_buff);
+    }
+}
+
 #if (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))
-void RtpAudioStream::decode(QAudioDevice out_device)
+void RtpAudioStream::prepareTiming(QAudioDevice out_device)
 #else
-void RtpAudioStream::decode(QAudioDeviceInfo out_device)
+void RtpAudioStream::prepareTiming(QAudioDeviceInfo out_device)
 #endif
 {
+    audio_out_rate_ = 0;
+
+    for (int cur_packet = 0; cur_packet < decoded_packets_.size(); cur_packet++) {
+        if (decoded_packets_[cur_packet].bytes > 0) {
+            first_sample_rate_ = decoded_packets_[cur_packet].sample_rate;
+
+            // We calculate audio_out_rate just for first sample_rate.
+            // All later are just resampled to it.
+            audio_out_rate_ = calculateAudioOutRate(out_device, first_sample_rate_, audio_requested_out_rate_);
+            break;
+        }
+    }
+}
+
+void RtpAudioStream::decodeTiming()
+{
+    // Waveforms depend on timing
+    visual_waveforms_.clear();
+
     if (rtp_packets_.size() < 1) return;
 
     audio_file_->setFrameWriteStage();
-    decodeAudio(out_device);
+    decodeAudio();
 
     decodeVisual();
 }
@@ -246,22 +355,20 @@ quint32 RtpAudioStream::calculateAudioOutRate(QAudioDeviceInfo out_device, unsig
     return out_rate;
 }
 
-#if (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))
-void RtpAudioStream::decodeAudio(QAudioDevice out_device)
-#else
-void RtpAudioStream::decodeAudio(QAudioDeviceInfo out_device)
-#endif
+void RtpAudioStream::decodeAudio()
 {
     // XXX This is more messy than it should be.
 
+    int32_t decode_buff_bytes = 0x1000;
+    SAMPLE *decode_buff = (SAMPLE *) g_malloc(decode_buff_bytes);
     int32_t resample_buff_bytes = 0x1000;
     SAMPLE *resample_buff = (SAMPLE *) g_malloc(resample_buff_bytes);
     char *write_buff = NULL;
     qint64 write_bytes = 0;
-    unsigned int channels = 0;
     unsigned int sample_rate = 0;
     uint32_t last_sequence = 0;
     uint32_t last_sequence_w = 0;  // Last sequence number we wrote data
+    bool first_decoded = true;
 
     double rtp_time_prev = 0.0;
     double arrive_time_prev = 0.0;
@@ -274,23 +381,16 @@ void RtpAudioStream::decodeAudio(QAudioDeviceInfo out_device)
     unsigned int audio_resampler_input_rate = 0;
     struct SpeexResamplerState_ *audio_resampler = NULL;
 
-    for (int cur_packet = 0; cur_packet < rtp_packets_.size(); cur_packet++) {
-        SAMPLE *decode_buff = NULL;
+    // Samples of decoded packets are stored one after another
+    decoded_file_->seek(0);
+
+    for (int cur_packet = 0; cur_packet < decoded_packets_.size(); cur_packet++) {
         // TODO: Update a progress bar here.
         rtp_packet_t *rtp_packet = rtp_packets_[cur_packet];
+        const DecodedPacket &decoded = decoded_packets_[cur_packet];
 
         stop_rel_time_ = start_rel_time_ + rtp_packet->arrive_offset;
 
-        QString payload_name;
-        if (rtp_packet->info->info_payload_type_str) {
-            payload_name = rtp_packet->info->info_payload_type_str;
-        } else {
-            payload_name = try_val_to_str_ext(rtp_packet->info->info_payload_type, &rtp_payload_type_short_vals_ext);
-        }
-        if (!payload_name.isEmpty()) {
-            payload_names_ << payload_name;
-        }
-
         if (cur_packet < 1) { // First packet
             start_timestamp = rtp_packet->info->info_extended_timestamp;
             start_rtp_time = 0;
@@ -298,9 +398,8 @@ void RtpAudioStream::decodeAudio(QAudioDeviceInfo out_device)
             last_sequence = rtp_packet->info->info_extended_seq_num - 1;
         }
 
-        size_t decoded_bytes = decode_rtp_packet(rtp_packet, &decode_buff, decoders_hash_, &channels, &sample_rate);
-        // XXX: We don't actually *do* anything with channels, and just treat
-        // everything as if it were mono
+        size_t decoded_bytes = (size_t) decoded.bytes;
+        sample_rate = decoded.sample_rate;
 
         unsigned rtp_clock_rate = sample_rate;
         if (rtp_packet->info->info_payload_type == PT_G722) {
@@ -317,27 +416,19 @@ void RtpAudioStream::decodeAudio(QAudioDeviceInfo out_device)
             rtp_clock_rate = 16000;
         }
 
-        // Length 2 for PT_PCM mean silence packet probably, ignore
-        if (decoded_bytes == 0 || sample_rate == 0 ||
-            ((rtp_packet->info->info_payload_type == PT_PCMU ||
-              rtp_packet->info->info_payload_type == PT_PCMA
-             ) && (decoded_bytes == 2)
-            )
-           ) {
-            // We didn't decode anything. Clean up and prep for
-            // the next packet.
+        if (decoded_bytes == 0) {
+            // We didn't decode anything. Prep for the next packet.
             last_sequence = rtp_packet->info->info_extended_seq_num;
-            g_free(decode_buff);
             continue;
         }
 
-        if (audio_out_rate_ == 0) {
-            first_sample_rate_ = sample_rate;
+        decode_buff = resizeBufferIfNeeded(decode_buff, &decode_buff_bytes, decoded_bytes);
+        if (decoded_file_->read((char *) decode_buff, decoded_bytes) != (qint64) decoded_bytes) {
+            break;
+        }
 
-            // We calculate audio_out_rate just for first sample_rate.
-            // All later are just resampled to it.
-            // Side effect: it creates and initiates resampler if needed
-            audio_out_rate_ = calculateAudioOutRate(out_device, sample_rate, audio_requested_out_rate_);
+        if (first_decoded) {
+            first_decoded = false;
 
             // Calculate count of prepend samples for the stream
             // The earliest stream starts at 0.
@@ -463,8 +554,8 @@ void RtpAudioStream::decodeAudio(QAudioDeviceInfo out_device)
             last_sequence_w = last_sequence;
         }
 
-        g_free(decode_buff);
     }
+    g_free(decode_buff);
     g_free(resample_buff);
 
     if (audio_resampler) speex_resampler_destroy(audio_resampler);
@@ -475,6 +566,16 @@ void RtpAudioStream::decodeAudio(QAudioDeviceInfo out_device)
 #define VISUAL_BUFF_BYTES (SAMPLE_BYTES * VISUAL_BUFF_LEN)
 void RtpAudioStream::decodeVisual()
 {
+    // Reuse the waveform if it was already created at this rate
+    if (visual_waveforms_.contains(visual_sample_rate_)) {
+        const VisualWaveform &waveform = visual_waveforms_[visual_sample_rate_];
+        packet_timestamps_ = waveform.packet_timestamps;
+        visual_samples_ = waveform.samples;
+        max_sample_val_ = waveform.max_sample_val;
+        max_sample_val_used_ = max_sample_val_;
+        return;
+    }
+
     spx_uint32_t read_len = 0;
     int32_t read_buff_bytes = VISUAL_BUFF_BYTES;
     SAMPLE *read_buff = (SAMPLE *) g_malloc(read_buff_bytes);
@@ -528,6 +629,12 @@ void RtpAudioStream::decodeVisual()
     g_free(resample_buff);
     g_free(read_buff);
 
+    VisualWaveform waveform;
+    waveform.packet_timestamps = packet_timestamps_;
+    waveform.samples = visual_samples_;
+    waveform.max_sample_val = max_sample_val_;
+    visual_waveforms_.insert(visual_sample_rate_, waveform);
+
     // Reset the seek position
     audio_file_->setDataReadStage();
 }
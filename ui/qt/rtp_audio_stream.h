@@ -53,11 +53,32 @@ public:
     void reset(double global_start_time);
     AudioRouting getAudioRouting();
     void setAudioRouting(AudioRouting audio_routing);
+    /**
+     * @brief Decode the payload of the packets that were not decoded yet.
+     * Decoded audio is kept until the packets are cleared, so changes of
+     * timing don't decode the payload again. Streams are independent, so
+     * this can run on a worker thread.
+     */
+    void decodePackets();
+    /**
+     * @brief Choose the output sample rate for the decoded audio. Must be
+     * called on the GUI thread, after decodePackets().
+     */
 #if (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))
-    void decode(QAudioDevice out_device);
+    void prepareTiming(QAudioDevice out_device);
 #else
-    void decode(QAudioDeviceInfo out_device);
+    void prepareTiming(QAudioDeviceInfo out_device);
 #endif
+    /**
+     * @brief Apply the timing mode and jitter buffer to the decoded audio
+     * and create the waveform. Can run on a worker thread.
+     */
+    void decodeTiming();
+    /**
+     * @brief Create the waveform for the current visual sample rate.
+     * Waveforms are kept for every visual sample rate until the timing
+     * changes. Can run on a worker thread.
+     */
     void decodeVisual();
 
     double startRelTime() const { return start_rel_time_; }
@@ -181,6 +202,14 @@ private:
     bool first_packet_;
 
     QVector<struct _rtp_packet *>rtp_packets_;
+    // Payload decoded from each packet in rtp_packets_
+    struct DecodedPacket {
+        qint64 pos;                 // Position of the samples in decoded_file_
+        qint64 bytes;               // 0 if nothing usable was decoded
+        unsigned sample_rate;
+    };
+    QVector<DecodedPacket> decoded_packets_;
+    QIODevice *decoded_file_;       // Stores decoded samples of all packets
     RtpAudioFile *audio_file_;      // Stores waveform samples in sparse file
     QIODevice *temp_file_;
     struct _GHashTable *decoders_hash_;
@@ -199,6 +228,12 @@ private:
     struct SpeexResamplerState_ *visual_resampler_;
     QMap<double, quint32> packet_timestamps_;
     QVector<qint16> visual_samples_;
+    struct VisualWaveform {
+        QMap<double, quint32> packet_timestamps;
+        QVector<qint16> samples;
+        qint16 max_sample_val;
+    };
+    QMap<unsigned, VisualWaveform> visual_waveforms_;  // By visual sample rate
     QVector<double> out_of_seq_timestamps_;
     QVector<double> jitter_drop_timestamps_;
     QVector<double> wrong_timestamp_timestamps_;
@@ -216,13 +251,12 @@ private:
 
 #if (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))
     QAudioSink *audio_output_;
-    void decodeAudio(QAudioDevice out_device);
     quint32 calculateAudioOutRate(QAudioDevice out_device, unsigned int sample_rate, unsigned int requested_out_rate);
 #else
     QAudioOutput *audio_output_;
-    void decodeAudio(QAudioDeviceInfo out_device);
     quint32 calculateAudioOutRate(QAudioDeviceInfo out_device, unsigned int sample_rate, unsigned int requested_out_rate);
 #endif
+    void decodeAudio();
     SAMPLE *resizeBufferIfNeeded(SAMPLE *buff, int32_t *buff_bytes, qint64 requested_size);
 
 private slots:
@@ -22,6 +22,7 @@
 #ifdef QT_MULTIMEDIA_LIB
 
 #include <epan/dissectors/packet-rtp.h>
+#include <epan/rtp_pt.h>
 #include <epan/to_str.h>
 
 #include <wsutil/report_message.h>
@@ -48,6 +49,7 @@
 #endif
 #include <QFrame>
 #include <QMenu>
+#include <QtConcurrent>
 #include <QVBoxLayout>
 #include <QTimer>
 
@@ -494,11 +496,13 @@ void RtpPlayerDialog::rescanPackets(bool rescale_axes)
     QAudioDeviceInfo cur_out_device = getCurrentDeviceInfo();
 #endif
     int row_count = ui->streamTreeWidget->topLevelItemCount();
+    QList<RtpAudioStream *> audio_streams;
 
     // Reset stream values
     for (int row = 0; row < row_count; row++) {
         QTreeWidgetItem *ti = ui->streamTreeWidget->topLevelItem(row);
         RtpAudioStream *audio_stream = ti->data(stream_data_col_, Qt::UserRole).value<RtpAudioStream*>();
+        audio_streams << audio_stream;
         audio_stream->setStereoRequired(stereo_available_);
         audio_stream->reset(first_stream_rel_start_time_);
 
@@ -516,11 +520,23 @@ void RtpPlayerDialog::rescanPackets(bool rescale_axes)
             break;
         }
         audio_stream->setTimingMode(timing_mode);
+    }
 
-	       //if (!cur_out_device.isNull()) {
-            audio_stream->decode(cur_out_device);
-        //}
+    // Streams are decoded in parallel. Payload is only decoded for packets
+    // added since the last time, so changes of timing just redo the timing
+    // and the waveforms.
+    // The lookup function of a value_string_ext is set on its first use,
+    // do it here rather than from several threads.
+    try_val_to_str_ext(0, &rtp_payload_type_short_vals_ext);
+    QtConcurrent::blockingMap(audio_streams, [](RtpAudioStream *audio_stream) {
+        audio_stream->decodePackets();
+    });
+    for (RtpAudioStream *audio_stream : audio_streams) {
+        audio_stream->prepareTiming(cur_out_device);
     }
+    QtConcurrent::blockingMap(audio_streams, [](RtpAudioStream *audio_stream) {
+        audio_stream->decodeTiming();
+    });
 
     for (int col = 0; col < ui->streamTreeWidget->columnCount() - 1; col++) {
         ui->streamTreeWidget->resizeColumnToContents(col);
@@ -2119,6 +2135,7 @@ void RtpPlayerDialog::on_visualSRSpinBox_editingFinished()
     mainApp->processEvents();
 
     int row_count = ui->streamTreeWidget->topLevelItemCount();
+    QList<RtpAudioStream *> audio_streams;
 
     // Reset stream values
     for (int row = 0; row < row_count; row++) {
@@ -2126,8 +2143,11 @@ void RtpPlayerDialog::on_visualSRSpinBox_editingFinished()
         RtpAudioStream *audio_stream = ti->data(stream_data_col_, Qt::UserRole).value<RtpAudioStream*>();
 
         audio_stream->setVisualSampleRate(static_cast<unsigned>(ui->visualSRSpinBox->value()));
-        audio_stream->decodeVisual();
+        audio_streams << audio_stream;
     }
+    QtConcurrent::blockingMap(audio_streams, [](RtpAudioStream *audio_stream) {
+        audio_stream->decodeVisual();
+    });
 
     for (int col = 0; col < ui->streamTreeWidget->columnCount() - 1; col++) {
         ui->streamTreeWidget->resizeColumnToContents(col);
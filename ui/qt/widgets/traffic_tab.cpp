@@ -279,7 +279,7 @@ void TrafficTab::setOpenTabs(QList<int> protocols)
     blockSignals(false);
 
     emit tabsChanged(_tabs.keys());
-    emit retapRequired();
+    requestRetap();
 }
 
 void TrafficTab::insertProtoTab(int protoId, bool emitSignals)
@@ -354,7 +354,7 @@ void TrafficTab::insertProtoTab(int protoId, bool emitSignals)
 
     if (emitSignals) {
         emit tabsChanged(_tabs.keys());
-        emit retapRequired();
+        requestRetap();
     }
 }
 
@@ -381,7 +381,7 @@ void TrafficTab::removeProtoTab(int protoId, bool emitSignals)
 
     if (emitSignals) {
         emit tabsChanged(_tabs.keys());
-        emit retapRequired();
+        requestRetap();
     }
 }
 
@@ -615,6 +615,21 @@ void TrafficTab::setFilter(QString filter)
             continue;
         atdm->setFilter(filter);
     }
+
+    requestRetap();
+}
+
+void TrafficTab::requestRetap()
+{
+    /* Models filled from the conversation table store are up to date */
+    for (int idx = 0; idx < count(); idx++ )
+    {
+        ATapDataModel * atdm = dataModelForTabIndex(idx);
+        if (atdm && atdm->needsRetap()) {
+            emit retapRequired();
+            return;
+        }
+    }
 }
 
 void TrafficTab::setNameResolution(bool checked)
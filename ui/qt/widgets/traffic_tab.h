@@ -257,6 +257,7 @@ private:
 
     void insertProtoTab(int protoId, bool emitSignals = true);
     void removeProtoTab(int protoId, bool emitSignals = true);
+    void requestRetap();
 
 #ifdef HAVE_MAXMINDDB
     bool writeGeoIPMapFile(QFile * fp, bool json_only, TrafficDataFilterProxy * model);
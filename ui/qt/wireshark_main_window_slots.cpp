@@ -175,6 +175,7 @@ DIAG_ON(frame-larger-than=)
 #include <QDesktopServices>
 #include <QUrl>
 #include <QMutex>
+#include <QTimer>
 
 // XXX You must uncomment QT_WINEXTRAS_LIB lines in CMakeList.txt and
 // cmakeconfig.h.in.
@@ -549,6 +550,16 @@ void WiresharkMainWindow::captureCaptureUpdateStarted(capture_session *session)
     setForCapturedPackets(true);
 }
 
+void WiresharkMainWindow::captureCaptureUpdateContinued(capture_session *session) {
+
+    /* Packets that arrived faster than we could dissect them are left
+       unread so that the UI gets to run; read them once it has, even if
+       the capture child has nothing new to tell us. */
+    if (session->count_pending > 0) {
+        QTimer::singleShot(0, this, [session]() { capture_input_continue_pending(session); });
+    }
+}
+
 void WiresharkMainWindow::captureCaptureUpdateFinished(capture_session *session) {
 
     /* The capture isn't stopping any more - it's stopped. */
@@ -741,6 +752,9 @@ void WiresharkMainWindow::captureEventHandler(CaptureEvent ev)
         case CaptureEvent::Started:
             captureCaptureUpdateStarted(ev.capSession());
             break;
+        case CaptureEvent::Continued:
+            captureCaptureUpdateContinued(ev.capSession());
+            break;
         case CaptureEvent::Finished:
             captureCaptureUpdateFinished(ev.capSession());
             break;
@@ -110,6 +110,11 @@
 #include "text_import_scanner_lex.h"
 #include "text_import_regex.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HAVE_HEX_DECODE_SSE2
+#include <emmintrin.h>
+#endif
+
 /*--- Options --------------------------------------------------------------------*/
 
 /* maximum time precision we can handle = 10^(-SUBSEC_PREC) */
@@ -1728,6 +1733,366 @@ parse_token(token_t token, char *str)
     return IMPORT_SUCCESS;
 }
 
+/*----------------------------------------------------------------------
+ * Fast path for hex dumps
+ *
+ * Almost every line of a typical hex dump (hexdump -C, od -Ax -tx1,
+ * xxd -g1, Wireshark's own "Copy as Hex Dump") is an offset continuing the
+ * current packet or starting a new one, followed by single bytes and perhaps
+ * an ASCII dump. Running those lines through the scanner costs a token and
+ * a strtoul() per byte, which dominates the import time of large dumps.
+ *
+ * Instead we find such lines directly in the input buffer, decode their
+ * bytes in bulk, and make the same state changes parse_token() would have
+ * made. Everything else - preambles, directives, comments, byte groups,
+ * unexpected offsets, lines that would fill the frame - is handed to the
+ * scanner, so the result is the same as scanning the whole file.
+ */
+
+#define HEXDUMP_READ_SIZE (1024 * 1024)
+
+typedef enum {
+    RUN_BYTE,       /* T_BYTE */
+    RUN_BYTES,      /* T_BYTES */
+    RUN_OFFSET,     /* T_OFFSET */
+    RUN_TEXT,       /* T_TEXT */
+    RUN_NONE        /* End of line */
+} hexdump_run_t;
+
+typedef struct {
+    const char *offset;         /* The offset at the start of the line */
+    size_t      offset_len;
+    const char *rest;           /* What follows the offset */
+    char       *hex;            /* Digits of the byte tokens */
+    uint8_t    *bytes;          /* Decoded bytes */
+    size_t      size;           /* Size of the two buffers above */
+} hexdump_fast_t;
+
+/*
+ * Returns the token the scanner would produce for a run of non-blank
+ * characters (assuming it contains no '\r' and isn't at the start of
+ * a line that starts with '#' or '>'.) As the text rule matches any such
+ * run, the other rules only win if they match the whole run.
+ */
+static hexdump_run_t
+classify_run(const char *run, size_t len)
+{
+    size_t prefix = 0;
+    size_t ndigits = 0;
+
+    if (len == 2 && g_ascii_isxdigit(run[0]) && g_ascii_isxdigit(run[1]))
+        return RUN_BYTE;
+
+    if (len > 2 && run[0] == '0' && (run[1] == 'x' || run[1] == 'X'))
+        prefix = 2;
+    while (prefix + ndigits < len && g_ascii_isxdigit(run[prefix + ndigits]))
+        ndigits++;
+
+    if (prefix == 0 && ndigits == len && (len == 4 || len == 6 || len == 8))
+        return RUN_BYTES;
+    if (ndigits >= 3 && ndigits <= 8 &&
+        (prefix + ndigits == len || (prefix + ndigits + 1 == len && run[len - 1] == ':')))
+        return RUN_OFFSET;
+
+    return RUN_TEXT;
+}
+
+#ifdef HAVE_HEX_DECODE_SSE2
+/*
+ * Convert 16 hex digits to their values. Sets the bits of *valid for
+ * the characters that are hex digits.
+ */
+static inline __m128i
+hex_values_sse2(__m128i c, int *valid)
+{
+    __m128i lc = _mm_or_si128(c, _mm_set1_epi8(0x20));
+    __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)),
+                                  _mm_cmplt_epi8(c, _mm_set1_epi8('9' + 1)));
+    __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(lc, _mm_set1_epi8('a' - 1)),
+                                  _mm_cmplt_epi8(lc, _mm_set1_epi8('f' + 1)));
+
+    *valid = _mm_movemask_epi8(_mm_or_si128(digit, alpha));
+    return _mm_or_si128(_mm_and_si128(digit, _mm_sub_epi8(c, _mm_set1_epi8('0'))),
+                        _mm_and_si128(alpha, _mm_sub_epi8(lc, _mm_set1_epi8('a' - 10))));
+}
+
+/* Combine pairs of digit values (high, low) into bytes, one per 16 bit lane. */
+static inline __m128i
+hex_pairs_sse2(__m128i v)
+{
+    return _mm_or_si128(_mm_and_si128(_mm_slli_epi16(v, 4), _mm_set1_epi16(0x00F0)),
+                        _mm_srli_epi16(v, 8));
+}
+#endif
+
+/*
+ * Decode pairs of hex digits, stopping at the first pair that isn't one.
+ * Returns the number of bytes decoded.
+ */
+static size_t
+decode_hex_pairs(const char *hex, size_t npairs, uint8_t *bytes)
+{
+    size_t i = 0;
+
+#ifdef HAVE_HEX_DECODE_SSE2
+    for (; i + 16 <= npairs; i += 16) {
+        int valid_lo, valid_hi;
+        __m128i lo = hex_values_sse2(_mm_loadu_si128((const __m128i *)(hex + 2 * i)), &valid_lo);
+        __m128i hi = hex_values_sse2(_mm_loadu_si128((const __m128i *)(hex + 2 * i + 16)), &valid_hi);
+
+        if ((valid_lo & valid_hi) != 0xFFFF)
+            break; /* Let the loop below find where it stops */
+        _mm_storeu_si128((__m128i *)(bytes + i),
+                         _mm_packus_epi16(hex_pairs_sse2(lo), hex_pairs_sse2(hi)));
+    }
+#endif
+
+    for (; i < npairs; i++) {
+        int hi = g_ascii_xdigit_value(hex[2 * i]);
+        int lo = g_ascii_xdigit_value(hex[2 * i + 1]);
+
+        if (hi < 0 || lo < 0)
+            break;
+        bytes[i] = (uint8_t)((hi << 4) | lo);
+    }
+    return i;
+}
+
+/*
+ * Check whether a line (without its end of line) starts with something
+ * that the scanner would return as an offset. Lines that don't can't be
+ * handled by the fast path.
+ */
+static bool
+hexdump_line_has_offset(hexdump_fast_t *fast, const char *line, size_t len)
+{
+    const char *end = line + len;
+    const char *p = line;
+    hexdump_run_t run;
+
+    /* A lone '\r' isn't matched by any scanner rule */
+    if (memchr(line, '\r', len) != NULL)
+        return false;
+
+    while (p < end && (*p == ' ' || *p == '\t'))
+        p++;
+    fast->offset = p;
+    while (p < end && *p != ' ' && *p != '\t')
+        p++;
+    fast->offset_len = p - fast->offset;
+    fast->rest = p;
+
+    run = classify_run(fast->offset, fast->offset_len);
+    return run == RUN_OFFSET || run == RUN_BYTES;
+}
+
+/*
+ * Process a line found by hexdump_line_has_offset(), if it continues the
+ * current packet at the expected offset or starts a new one. Returns false,
+ * without changing any state, if the line must go to the scanner instead.
+ */
+static bool
+hexdump_fast_line(hexdump_fast_t *fast, const char *line, size_t len, import_status_t *status)
+{
+    const char *end = line + len;
+    const char *p = fast->rest;
+    hexdump_run_t run = RUN_NONE;
+    char offset_str[16];
+    char *c;
+    unsigned long ulnum;
+    uint32_t num;
+    uint32_t start;
+    size_t npairs = 0;
+    size_t nbytes;
+    bool text;
+
+    if (state != START_OF_LINE)
+        return false;
+
+    /* This is parse_num(), but leaving the errors for the scanner to report */
+    if (fast->offset_len >= sizeof offset_str)
+        return false;
+    memcpy(offset_str, fast->offset, fast->offset_len);
+    offset_str[fast->offset_len] = '\0';
+    errno = 0;
+    ulnum = strtoul(offset_str, &c, offset_base);
+    if (errno != 0 || c == offset_str || ulnum > UINT32_MAX)
+        return false;
+    num = (uint32_t) ulnum;
+
+    if (num == 0) {
+        start = 0;
+    } else if ((num - packet_start) == curr_offset) {
+        start = curr_offset;
+    } else {
+        return false;
+    }
+
+    if (fast->size < len) {
+        fast->size = len;
+        fast->hex = (char *)g_realloc(fast->hex, fast->size);
+        fast->bytes = (uint8_t *)g_realloc(fast->bytes, fast->size);
+    }
+
+    /* Gather the byte tokens */
+    while (p < end) {
+        const char *run_start;
+
+        while (p < end && (*p == ' ' || *p == '\t'))
+            p++;
+        if (p == end)
+            break;
+        run_start = p;
+        while (p < end && *p != ' ' && *p != '\t')
+            p++;
+        if (p - run_start != 2) {
+            run = classify_run(run_start, p - run_start);
+            break;
+        }
+        fast->hex[2 * npairs] = run_start[0];
+        fast->hex[2 * npairs + 1] = run_start[1];
+        npairs++;
+    }
+
+    nbytes = decode_hex_pairs(fast->hex, npairs, fast->bytes);
+    if (nbytes < npairs) {
+        /* A two character run that isn't a byte is text */
+        text = true;
+    } else if (run == RUN_BYTES) {
+        return false;
+    } else {
+        text = (run != RUN_NONE);
+    }
+
+    /* write_byte() would split the packet */
+    if (nbytes > 0 && start + nbytes >= info_p->max_frame_length)
+        return false;
+
+    /* T_OFFSET in START_OF_LINE */
+    if (num == 0) {
+        if (start_new_packet(false) != IMPORT_SUCCESS) {
+            *status = IMPORT_FAILURE;
+            return true;
+        }
+        packet_start = 0;
+    } else {
+        packet_preamble_len = 0;
+    }
+    pkt_lnstart = packet_buf + num;
+
+    /* T_BYTE in READ_OFFSET and READ_BYTE */
+    memcpy(packet_buf + curr_offset, fast->bytes, nbytes);
+    curr_offset += (uint32_t) nbytes;
+
+    /* T_TEXT or T_EOL in READ_BYTE */
+    if (nbytes > 0 && info_p->hexdump.identify_ascii) {
+        process_rollback(!text);
+    }
+
+    state = START_OF_LINE;
+    return true;
+}
+
+/*
+ * Import a hex dump, using the fast path for the lines it can handle and
+ * the scanner for the others.
+ */
+static import_status_t
+text_import_scan_fast(FILE *input_file)
+{
+    hexdump_fast_t fast = { 0 };
+    void *scanner;
+    char *buf;
+    size_t buf_size = HEXDUMP_READ_SIZE;
+    size_t len = 0;             /* Bytes in buf */
+    size_t pos = 0;             /* Start of the next line */
+    size_t pending = 0;         /* Start of the lines for the scanner */
+    bool after_cr = false;
+    import_status_t status = IMPORT_SUCCESS;
+
+    if (text_import_scan_lines_init(&scanner) != IMPORT_SUCCESS)
+        return IMPORT_INIT_FAILED;
+
+    buf = (char *)g_malloc(buf_size);
+    for (;;) {
+        size_t nread = fread(buf + len, 1, buf_size - len, input_file);
+        bool eof = (nread == 0);
+
+        len += nread;
+        while (pos < len) {
+            const char *nl = (const char *)memchr(buf + pos, '\n', len - pos);
+            size_t line_len, next;
+            bool ends_cr;
+
+            if (nl == NULL)
+                break;
+            next = nl - buf + 1;
+            if (next == len && !eof)
+                break; /* We need the next character */
+
+            line_len = nl - (buf + pos);
+            if (line_len > 0 && buf[pos + line_len - 1] == '\r')
+                line_len--;
+            /* The scanner's end of line includes a '\r' after the '\n' */
+            ends_cr = (next < len && buf[next] == '\r');
+            if (ends_cr)
+                next++;
+
+            /* A line after "\n\r" isn't at the start of a line to the
+             * scanner, so it has to be scanned along with the one before. */
+            if (!after_cr && !ends_cr && hexdump_line_has_offset(&fast, buf + pos, line_len)) {
+                if (pending < pos) {
+                    status = text_import_scan_lines(scanner, buf + pending, pos - pending);
+                    pending = pos;
+                    if (status != IMPORT_SUCCESS)
+                        break;
+                }
+                if (hexdump_fast_line(&fast, buf + pos, line_len, &status))
+                    pending = next;
+                if (status != IMPORT_SUCCESS)
+                    break;
+            }
+            after_cr = ends_cr;
+            pos = next;
+        }
+        if (status != IMPORT_SUCCESS)
+            break;
+
+        if (eof) {
+            /* The rest, including any unterminated last line */
+            if (pending < len)
+                status = text_import_scan_lines(scanner, buf + pending, len - pending);
+            if (status == IMPORT_SUCCESS)
+                status = parse_token(T_EOF, NULL);
+            break;
+        }
+
+        if (!after_cr && pending < pos) {
+            status = text_import_scan_lines(scanner, buf + pending, pos - pending);
+            pending = pos;
+            if (status != IMPORT_SUCCESS)
+                break;
+        }
+
+        /* Keep what hasn't been processed yet */
+        memmove(buf, buf + pending, len - pending);
+        len -= pending;
+        pos -= pending;
+        pending = 0;
+        if (len == buf_size) {
+            buf_size *= 2;
+            buf = (char *)g_realloc(buf, buf_size);
+        }
+    }
+
+    g_free(buf);
+    g_free(fast.hex);
+    g_free(fast.bytes);
+    text_import_scan_lines_cleanup(scanner);
+
+    return status;
+}
+
 /*----------------------------------------------------------------------
  * Import a text file.
  */
@@ -1911,7 +2276,13 @@ text_import(text_import_info_t * const info)
     }
 
     if (info->mode == TEXT_IMPORT_HEXDUMP) {
-        status = text_import_scan(info->hexdump.import_text_FILE);
+        /* The fast path skips parse_token() for most tokens, so don't use
+         * it when its trace is wanted. In no offset mode every line is
+         * scanned anyway. */
+        if (offset_base != 0 && ws_log_get_level() < LOG_LEVEL_NOISY)
+            status = text_import_scan_fast(info->hexdump.import_text_FILE);
+        else
+            status = text_import_scan(info->hexdump.import_text_FILE);
         switch(status) {
         case (IMPORT_SUCCESS):
             ret = 0;
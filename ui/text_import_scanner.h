@@ -43,6 +43,15 @@ extern FILE *text_importin;
 
 import_status_t text_import_scan(FILE *input_file);
 
+/*
+ * Scan runs of complete lines with a scanner that is kept between calls.
+ * Unlike text_import_scan(), the end of each run doesn't end the input;
+ * the caller passes T_EOF to parse_token() itself.
+ */
+import_status_t text_import_scan_lines_init(void **scanner);
+import_status_t text_import_scan_lines(void *scanner, const char *buf, size_t len);
+void text_import_scan_lines_cleanup(void *scanner);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -258,6 +258,10 @@ struct wtap_reader {
     /* fast seeking */
     GPtrArray *fast_seek;
     void *fast_seek_cur;
+
+    /* observer for the raw bytes read from the file */
+    wtap_raw_data_callback_t raw_data_cb;
+    void *raw_data_cb_data;
 };
 
 /* Current read offset within a buffer. */
@@ -329,6 +333,8 @@ buf_read(FILE_T state, struct wtap_reader_buf *buf)
     }
     if (ret == 0)
         state->eof = true;
+    if (ret > 0 && state->raw_data_cb != NULL)
+        state->raw_data_cb(read_ptr, (size_t)ret, state->raw_pos, state->raw_data_cb_data);
     state->raw_pos += ret;
     buf->avail += (unsigned)ret;
     return 0;
@@ -2512,6 +2518,13 @@ file_clearerr(FILE_T stream)
     stream->eof = false;
 }
 
+void
+file_set_raw_data_callback(FILE_T stream, wtap_raw_data_callback_t cb, void *user_data)
+{
+    stream->raw_data_cb = cb;
+    stream->raw_data_cb_data = user_data;
+}
+
 void
 file_fdclose(FILE_T file)
 {
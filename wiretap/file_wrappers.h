@@ -29,6 +29,7 @@ WS_DLL_PUBLIC char *file_getsp(char *buf, int len, FILE_T stream);
 WS_DLL_PUBLIC int file_eof(FILE_T stream);
 WS_DLL_PUBLIC int file_error(FILE_T fh, char **err_info);
 extern void file_clearerr(FILE_T stream);
+extern void file_set_raw_data_callback(FILE_T stream, wtap_raw_data_callback_t cb, void *user_data);
 extern void file_fdclose(FILE_T file);
 extern bool file_fdreopen(FILE_T file, const char *path);
 extern void file_close(FILE_T file);
@@ -4328,6 +4328,126 @@ pcapng_seek_read(wtap *wth, int64_t seek_off, wtap_rec *rec,
     return true;
 }
 
+/*
+ * Read the run of Interface Statistics Blocks at the end of the file,
+ * walking backwards from the end of the file using the trailing block
+ * total length of each block, and add them to their interfaces as if
+ * they had been read sequentially.  This lets a caller get per-interface
+ * packet counts, drop counts, and start and end times without reading
+ * every packet block in between.
+ *
+ * This is only done for uncompressed files opened for random access,
+ * before any records have been read.  Only the first SHB has been read
+ * at that point, so every block back to it is walked over to make sure
+ * that the file has a single section; a later section could have a
+ * different byte order and its own interfaces.  It returns false, with
+ * *err set to 0, if the file has more than one section, if the blocks
+ * can't be walked back to the start, or if there are no trailing ISBs
+ * for known interfaces.
+ */
+bool
+pcapng_read_trailing_isbs(wtap *wth, int *err, char **err_info)
+{
+    pcapng_t *pcapng = (pcapng_t *)wth->priv;
+    section_info_t *section_info, new_section;
+    wtapng_block_t wblock;
+    pcapng_block_header_t bh;
+    pcapng_interface_statistics_block_t isb;
+    uint32_t trailer_length;
+    uint32_t interface_id;
+    int64_t min_off, pos, block_off;
+    GArray *offsets;
+    bool in_isbs = true;
+    bool ret = false;
+
+    *err = 0;
+    *err_info = NULL;
+
+    if (wth->random_fh == NULL || file_iscompressed(wth->random_fh))
+        return false;
+    section_info = &g_array_index(pcapng->sections, section_info_t, 0);
+
+    /* Nothing before the blocks read by pcapng_open() can be an ISB. */
+    min_off = file_tell(wth->fh);
+    pos = wtap_file_size(wth, err);
+    if (pos == -1)
+        return false;
+
+    offsets = g_array_new(false, false, sizeof(int64_t));
+    while (pos > min_off) {
+        if (pos - min_off < (int64_t)MIN_BLOCK_SIZE) {
+            g_array_set_size(offsets, 0);
+            break;
+        }
+        if (file_seek(wth->random_fh, pos - (int64_t)sizeof trailer_length, SEEK_SET, err) < 0)
+            goto done;
+        if (!wtap_read_bytes(wth->random_fh, &trailer_length, sizeof trailer_length, err, err_info))
+            goto done;
+        if (section_info->byte_swapped)
+            trailer_length = GUINT32_SWAP_LE_BE(trailer_length);
+        if (trailer_length < MIN_BLOCK_SIZE || trailer_length % 4 != 0 ||
+            trailer_length > pos - min_off) {
+            /* Not a block in this section's byte order; give up. */
+            g_array_set_size(offsets, 0);
+            break;
+        }
+
+        if (file_seek(wth->random_fh, pos - trailer_length, SEEK_SET, err) < 0)
+            goto done;
+        if (!wtap_read_bytes(wth->random_fh, &bh, sizeof bh, err, err_info))
+            goto done;
+        if (section_info->byte_swapped) {
+            bh.block_type         = GUINT32_SWAP_LE_BE(bh.block_type);
+            bh.block_total_length = GUINT32_SWAP_LE_BE(bh.block_total_length);
+        }
+        if (bh.block_type == BLOCK_TYPE_SHB ||
+            bh.block_total_length != trailer_length) {
+            /* Another section, or not a block after all; give up. */
+            g_array_set_size(offsets, 0);
+            break;
+        }
+
+        if (in_isbs && bh.block_type == BLOCK_TYPE_ISB &&
+            trailer_length >= MIN_ISB_SIZE) {
+            if (!wtap_read_bytes(wth->random_fh, &isb, sizeof isb, err, err_info))
+                goto done;
+            interface_id = section_info->byte_swapped ?
+                GUINT32_SWAP_LE_BE(isb.interface_id) : isb.interface_id;
+            if (interface_id >= wth->interface_data->len) {
+                /* The IDB comes after the start of the file; give up. */
+                g_array_set_size(offsets, 0);
+                break;
+            }
+            block_off = pos - trailer_length;
+            g_array_append_val(offsets, block_off);
+        } else {
+            in_isbs = false;
+        }
+
+        pos -= trailer_length;
+    }
+
+    /* Process them in file order. */
+    wblock.rec = NULL;
+    for (unsigned i = offsets->len; i > 0; i--) {
+        block_off = g_array_index(offsets, int64_t, i - 1);
+
+        if (file_seek(wth->random_fh, block_off, SEEK_SET, err) < 0)
+            goto done;
+        if (!pcapng_read_block(wth, wth->random_fh, pcapng, section_info,
+                               &new_section, &wblock, err, err_info)) {
+            wtap_block_unref(wblock.block);
+            goto done;
+        }
+        pcapng_process_internal_block(wth, pcapng, section_info, new_section, &wblock, &block_off);
+    }
+    ret = offsets->len != 0;
+
+done:
+    g_array_free(offsets, true);
+    return ret;
+}
+
 /* classic wtap: close capture file */
 static void
 pcapng_close(wtap *wth)
@@ -73,5 +73,6 @@ struct pcapng_option_header {
 #define MIN_DSB_SIZE    ((uint32_t)(MIN_BLOCK_SIZE + sizeof(pcapng_decryption_secrets_block_t)))
 
 wtap_open_return_val pcapng_open(wtap *wth, int *err, char **err_info);
+bool pcapng_read_trailing_isbs(wtap *wth, int *err, char **err_info);
 
 #endif
@@ -20,6 +20,7 @@
 #include "wtap_opttypes.h"
 
 #include "file_wrappers.h"
+#include "pcapng.h"
 #include <wsutil/file_util.h>
 #include <wsutil/buffer.h>
 #include <wsutil/ws_assert.h>
@@ -1694,6 +1695,24 @@ void wtap_set_cb_new_secrets(wtap *wth, wtap_new_secrets_callback_t add_new_secr
 	}
 }
 
+void wtap_set_cb_raw_data(wtap *wth, wtap_raw_data_callback_t cb, void *user_data) {
+	if (!wth || !wth->fh)
+		return;
+
+	file_set_raw_data_callback(wth->fh, cb, user_data);
+}
+
+bool
+wtap_read_trailing_if_stats(wtap *wth, int *err, char **err_info)
+{
+	*err = 0;
+	*err_info = NULL;
+	if (wth->file_type_subtype != wtap_pcapng_file_type_subtype())
+		return false;
+
+	return pcapng_read_trailing_isbs(wth, err, err_info);
+}
+
 void
 wtapng_process_dsb(wtap *wth, wtap_block_t dsb)
 {
@@ -1916,6 +1916,43 @@ typedef void (*wtap_new_secrets_callback_t)(uint32_t secrets_type, const void *s
 WS_DLL_PUBLIC
 void wtap_set_cb_new_secrets(wtap *wth, wtap_new_secrets_callback_t add_new_secrets);
 
+/**
+ * Set a callback function that is handed every block of raw (still
+ * compressed, if the file is compressed) bytes as it is read from the
+ * sequential-access stream, along with the offset of the block in the
+ * file. This lets a caller checksum a file while it is being read,
+ * without reading it a second time.
+ *
+ * Data read before the callback is set (e.g. while the file type was
+ * being determined) is not reported, and data may be reported more than
+ * once if the stream seeks backwards; callers that need every byte
+ * exactly once have to track the offsets themselves.
+ */
+typedef void (*wtap_raw_data_callback_t)(const uint8_t *data, size_t len, int64_t offset, void *user_data);
+WS_DLL_PUBLIC
+void wtap_set_cb_raw_data(wtap *wth, wtap_raw_data_callback_t cb, void *user_data);
+
+/**
+ * Read the interface statistics at the end of the file without reading
+ * the records in front of them, and add them to the interface
+ * descriptions returned by wtap_file_get_idb_info(). Currently
+ * pcapng-only, and only for uncompressed, single-section files opened
+ * for random access.
+ *
+ * Must be called before any records are read.
+ *
+ * @param wth The wiretap session.
+ * @param err a positive "errno" value, or a negative number indicating
+ * the type of error, if reading failed.
+ * @param err_info for some errors, a string giving more details of
+ * the error.
+ * @return true if at least one set of statistics was read, false if
+ * there were none or they could not be found this way (*err is 0),
+ * or on error (*err is nonzero).
+ */
+WS_DLL_PUBLIC
+bool wtap_read_trailing_if_stats(wtap *wth, int *err, char **err_info);
+
 /** Read the next record in the file, filling in *phdr and *buf.
  *
  * @wth a wtap * returned by a call that opened a file for reading.
@@ -451,6 +451,13 @@ write_to_file(pcapio_writer* pfile, const uint8_t* data, size_t data_length,
     return true;
 }
 
+bool
+writecap_write(pcapio_writer* pfile, const uint8_t* data, size_t data_length,
+               uint64_t *bytes_written, int *err)
+{
+    return write_to_file(pfile, data, data_length, bytes_written, err);
+}
+
 /* Writing pcap files */
 
 /* Write the file header to a dump file.
@@ -30,6 +30,14 @@ writecap_open_stdout(wtap_compression_type ctype, int *err);
 extern bool
 writecap_flush(pcapio_writer* pfile, int *err);
 
+/* Write raw data, e.g. the contents of an existing capture file, to pfile,
+ * compressing it if pfile is compressed.
+ *
+ * Return true on success, returns false and sets err on failure. */
+extern bool
+writecap_write(pcapio_writer* pfile, const uint8_t* data, size_t data_length,
+               uint64_t *bytes_written, int *err);
+
 /* Close open file handles and frees memory associated with pfile.
  *
  * Return true on success, returns false and sets err (optional) on failure.
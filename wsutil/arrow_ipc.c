@@ -0,0 +1,900 @@
+/* arrow_ipc.c
+ * Routines for writing Apache Arrow IPC streams.
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+#define WS_LOG_DOMAIN LOG_DOMAIN_WSUTIL
+
+#include "arrow_ipc.h"
+
+#include <string.h>
+
+#include <wsutil/ws_assert.h>
+
+/*
+ * The Arrow IPC stream format is a sequence of encapsulated messages:
+ *
+ *   <0xFFFFFFFF> <int32 metadata size> <Message flatbuffer> <padding> <body>
+ *
+ * The first message is a Schema, followed by any number of RecordBatch
+ * messages, and the stream ends with <0xFFFFFFFF> <0x00000000>. Everything
+ * is little-endian and 8-byte aligned.
+ *
+ * The metadata is a flatbuffer (Message.fbs and Schema.fbs in the Arrow
+ * sources). Only the handful of tables needed here are built, using a
+ * small back-to-front builder in the style of the reference flatbuffers
+ * implementation: children are serialized before the objects that refer
+ * to them, so every offset points forward in the final buffer.
+ */
+
+/* Type union members (Schema.fbs) */
+#define ARROW_FB_TYPE_INT               2
+#define ARROW_FB_TYPE_FLOATINGPOINT     3
+#define ARROW_FB_TYPE_UTF8              5
+#define ARROW_FB_TYPE_BOOL              6
+#define ARROW_FB_TYPE_TIMESTAMP         10
+#define ARROW_FB_TYPE_LIST              12
+#define ARROW_FB_TYPE_DURATION          18
+
+/* MessageHeader union members (Message.fbs) */
+#define ARROW_FB_HEADER_SCHEMA          1
+#define ARROW_FB_HEADER_RECORDBATCH     3
+
+#define ARROW_FB_METADATA_V5            4
+#define ARROW_FB_PRECISION_DOUBLE       2
+#define ARROW_FB_TIMEUNIT_NANOSECOND    3
+
+#define ARROW_IPC_CONTINUATION          0xFFFFFFFFU
+
+/*
+ * Flush a batch early once any column holds this much variable-length
+ * data, to bound memory and keep 32-bit value offsets valid.
+ */
+#define ARROW_IPC_MAX_BATCH_DATA        (64 * 1024 * 1024)
+
+#define ARROW_FB_MAX_FIELDS             8
+
+typedef struct {
+    uint8_t    *buf;
+    size_t      cap;
+    size_t      used;           /* bytes in use, at the end of buf */
+    size_t      minalign;
+    /* Table under construction */
+    size_t      table_start;
+    uint32_t    slots[ARROW_FB_MAX_FIELDS];
+    unsigned    num_slots;
+} arrow_fb_builder;
+
+typedef struct {
+    char               *name;
+    arrow_ipc_type_e    type;
+    bool                is_list;
+
+    /* Values (the child array for list columns) */
+    GByteArray         *validity;
+    GByteArray         *values;     /* fixed-width values, BOOL bitmap or UTF8 offsets */
+    GByteArray         *data;       /* UTF8 bytes */
+    uint32_t            num_values;
+    uint32_t            null_count;
+
+    /* List level, for list columns */
+    GByteArray         *list_validity;
+    GByteArray         *list_offsets;
+    uint32_t            list_null_count;
+
+    bool                row_has_value;
+} arrow_ipc_column;
+
+struct arrow_ipc_writer {
+    FILE               *fh;
+    unsigned            batch_rows;
+    GArray             *columns;
+    uint32_t            num_rows;
+    bool                schema_written;
+    bool                error;
+    arrow_fb_builder    fb;
+};
+
+/*
+ * Flatbuffer builder
+ */
+
+static void
+fb_reserve(arrow_fb_builder *b, size_t len)
+{
+    if (b->cap - b->used >= len) {
+        return;
+    }
+    size_t new_cap = b->cap ? b->cap : 1024;
+    while (new_cap - b->used < len) {
+        new_cap *= 2;
+    }
+    uint8_t *new_buf = (uint8_t *)g_malloc(new_cap);
+    if (b->used) {
+        memcpy(new_buf + new_cap - b->used, b->buf + b->cap - b->used, b->used);
+    }
+    g_free(b->buf);
+    b->buf = new_buf;
+    b->cap = new_cap;
+}
+
+static void
+fb_push(arrow_fb_builder *b, const void *data, size_t len)
+{
+    fb_reserve(b, len);
+    b->used += len;
+    memcpy(b->buf + b->cap - b->used, data, len);
+}
+
+static void
+fb_pad(arrow_fb_builder *b, size_t len)
+{
+    fb_reserve(b, len);
+    b->used += len;
+    memset(b->buf + b->cap - b->used, 0, len);
+}
+
+/* Align so that after writing "additional" bytes, "align" is respected. */
+static void
+fb_prep(arrow_fb_builder *b, size_t align, size_t additional)
+{
+    if (align > b->minalign) {
+        b->minalign = align;
+    }
+    fb_pad(b, (~(b->used + additional) + 1) & (align - 1));
+}
+
+static void
+fb_push_u8(arrow_fb_builder *b, uint8_t v)
+{
+    fb_push(b, &v, 1);
+}
+
+static void
+fb_push_u16(arrow_fb_builder *b, uint16_t v)
+{
+    v = GUINT16_TO_LE(v);
+    fb_push(b, &v, 2);
+}
+
+static void
+fb_push_u32(arrow_fb_builder *b, uint32_t v)
+{
+    v = GUINT32_TO_LE(v);
+    fb_push(b, &v, 4);
+}
+
+static void
+fb_push_u64(arrow_fb_builder *b, uint64_t v)
+{
+    v = GUINT64_TO_LE(v);
+    fb_push(b, &v, 8);
+}
+
+static void
+fb_push_uoffset(arrow_fb_builder *b, uint32_t off)
+{
+    fb_prep(b, 4, 0);
+    fb_push_u32(b, (uint32_t)(b->used + 4 - off));
+}
+
+static void
+fb_reset(arrow_fb_builder *b)
+{
+    b->used = 0;
+    b->minalign = 1;
+}
+
+static uint32_t
+fb_create_string(arrow_fb_builder *b, const char *str)
+{
+    size_t len = strlen(str);
+
+    fb_prep(b, 4, len + 1);
+    fb_pad(b, 1);
+    fb_push(b, str, len);
+    fb_push_u32(b, (uint32_t)len);
+    return (uint32_t)b->used;
+}
+
+static uint32_t
+fb_create_offset_vector(arrow_fb_builder *b, const uint32_t *offs, unsigned count)
+{
+    fb_prep(b, 4, 4 * (size_t)count);
+    for (unsigned i = count; i > 0; i--) {
+        fb_push_uoffset(b, offs[i - 1]);
+    }
+    fb_push_u32(b, count);
+    return (uint32_t)b->used;
+}
+
+/* A vector of structs made of two int64s (FieldNode and Buffer). */
+static uint32_t
+fb_create_int64_pair_vector(arrow_fb_builder *b, const int64_t *pairs, unsigned count)
+{
+    fb_prep(b, 4, 16 * (size_t)count);
+    fb_prep(b, 8, 16 * (size_t)count);
+    for (unsigned i = count; i > 0; i--) {
+        fb_push_u64(b, (uint64_t)pairs[2 * i - 1]);
+        fb_push_u64(b, (uint64_t)pairs[2 * i - 2]);
+    }
+    fb_push_u32(b, count);
+    return (uint32_t)b->used;
+}
+
+static void
+fb_start_table(arrow_fb_builder *b)
+{
+    memset(b->slots, 0, sizeof b->slots);
+    b->num_slots = 0;
+    b->table_start = b->used;
+}
+
+static void
+fb_slot(arrow_fb_builder *b, unsigned slot)
+{
+    ws_assert(slot < ARROW_FB_MAX_FIELDS);
+    b->slots[slot] = (uint32_t)b->used;
+    if (slot >= b->num_slots) {
+        b->num_slots = slot + 1;
+    }
+}
+
+static void
+fb_add_u8(arrow_fb_builder *b, unsigned slot, uint8_t v)
+{
+    fb_prep(b, 1, 0);
+    fb_push_u8(b, v);
+    fb_slot(b, slot);
+}
+
+static void
+fb_add_u16(arrow_fb_builder *b, unsigned slot, uint16_t v)
+{
+    fb_prep(b, 2, 0);
+    fb_push_u16(b, v);
+    fb_slot(b, slot);
+}
+
+static void
+fb_add_u32(arrow_fb_builder *b, unsigned slot, uint32_t v)
+{
+    fb_prep(b, 4, 0);
+    fb_push_u32(b, v);
+    fb_slot(b, slot);
+}
+
+static void
+fb_add_u64(arrow_fb_builder *b, unsigned slot, uint64_t v)
+{
+    fb_prep(b, 8, 0);
+    fb_push_u64(b, v);
+    fb_slot(b, slot);
+}
+
+static void
+fb_add_offset(arrow_fb_builder *b, unsigned slot, uint32_t off)
+{
+    fb_push_uoffset(b, off);
+    fb_slot(b, slot);
+}
+
+static uint32_t
+fb_end_table(arrow_fb_builder *b)
+{
+    uint32_t table_off, vtable_off;
+    int32_t soffset;
+
+    /* Placeholder for the offset to the vtable. */
+    fb_prep(b, 4, 0);
+    fb_push_u32(b, 0);
+    table_off = (uint32_t)b->used;
+
+    for (unsigned i = b->num_slots; i > 0; i--) {
+        uint32_t slot = b->slots[i - 1];
+        fb_push_u16(b, slot ? (uint16_t)(table_off - slot) : 0);
+    }
+    fb_push_u16(b, (uint16_t)(table_off - b->table_start));
+    fb_push_u16(b, (uint16_t)((b->num_slots + 2) * 2));
+    vtable_off = (uint32_t)b->used;
+
+    soffset = GINT32_TO_LE((int32_t)(vtable_off - table_off));
+    memcpy(b->buf + b->cap - table_off, &soffset, 4);
+    return table_off;
+}
+
+static uint32_t
+fb_empty_table(arrow_fb_builder *b)
+{
+    fb_start_table(b);
+    return fb_end_table(b);
+}
+
+static void
+fb_finish(arrow_fb_builder *b, uint32_t root)
+{
+    fb_prep(b, b->minalign > 8 ? b->minalign : 8, 4);
+    fb_push_uoffset(b, root);
+}
+
+/*
+ * Message encoding
+ */
+
+static bool
+write_bytes(arrow_ipc_writer *writer, const void *data, size_t len)
+{
+    if (len && fwrite(data, 1, len, writer->fh) != len) {
+        writer->error = true;
+    }
+    return !writer->error;
+}
+
+static bool
+write_padding(arrow_ipc_writer *writer, size_t len)
+{
+    static const uint8_t zeroes[8];
+
+    ws_assert(len <= sizeof zeroes);
+    return write_bytes(writer, zeroes, len);
+}
+
+static bool
+write_u32(arrow_ipc_writer *writer, uint32_t v)
+{
+    v = GUINT32_TO_LE(v);
+    return write_bytes(writer, &v, 4);
+}
+
+static uint32_t
+build_message(arrow_fb_builder *b, uint8_t header_type, uint32_t header, int64_t body_length)
+{
+    fb_start_table(b);
+    fb_add_u64(b, 3, (uint64_t)body_length);    /* bodyLength */
+    fb_add_offset(b, 2, header);                /* header */
+    fb_add_u16(b, 0, ARROW_FB_METADATA_V5);     /* version */
+    fb_add_u8(b, 1, header_type);               /* header_type */
+    return fb_end_table(b);
+}
+
+/* Write the metadata in the builder, framed, and pad it to 8 bytes. */
+static bool
+write_metadata(arrow_ipc_writer *writer)
+{
+    arrow_fb_builder *b = &writer->fb;
+    size_t padded = (b->used + 7) & ~(size_t)7;
+
+    write_u32(writer, ARROW_IPC_CONTINUATION);
+    write_u32(writer, (uint32_t)padded);
+    write_bytes(writer, b->buf + b->cap - b->used, b->used);
+    return write_padding(writer, padded - b->used);
+}
+
+static uint32_t
+build_type(arrow_fb_builder *b, arrow_ipc_type_e type, uint8_t *type_type)
+{
+    uint32_t tz;
+
+    switch (type) {
+    case ARROW_IPC_TYPE_BOOL:
+        *type_type = ARROW_FB_TYPE_BOOL;
+        return fb_empty_table(b);
+    case ARROW_IPC_TYPE_INT32:
+    case ARROW_IPC_TYPE_UINT32:
+    case ARROW_IPC_TYPE_INT64:
+    case ARROW_IPC_TYPE_UINT64:
+        *type_type = ARROW_FB_TYPE_INT;
+        fb_start_table(b);
+        fb_add_u32(b, 0, (type == ARROW_IPC_TYPE_INT32 || type == ARROW_IPC_TYPE_UINT32) ? 32 : 64); /* bitWidth */
+        fb_add_u8(b, 1, (type == ARROW_IPC_TYPE_INT32 || type == ARROW_IPC_TYPE_INT64));             /* is_signed */
+        return fb_end_table(b);
+    case ARROW_IPC_TYPE_DOUBLE:
+        *type_type = ARROW_FB_TYPE_FLOATINGPOINT;
+        fb_start_table(b);
+        fb_add_u16(b, 0, ARROW_FB_PRECISION_DOUBLE);
+        return fb_end_table(b);
+    case ARROW_IPC_TYPE_TIMESTAMP_NS:
+        *type_type = ARROW_FB_TYPE_TIMESTAMP;
+        tz = fb_create_string(b, "UTC");
+        fb_start_table(b);
+        fb_add_offset(b, 1, tz);                        /* timezone */
+        fb_add_u16(b, 0, ARROW_FB_TIMEUNIT_NANOSECOND); /* unit */
+        return fb_end_table(b);
+    case ARROW_IPC_TYPE_DURATION_NS:
+        *type_type = ARROW_FB_TYPE_DURATION;
+        fb_start_table(b);
+        fb_add_u16(b, 0, ARROW_FB_TIMEUNIT_NANOSECOND);
+        return fb_end_table(b);
+    case ARROW_IPC_TYPE_UTF8:
+        *type_type = ARROW_FB_TYPE_UTF8;
+        return fb_empty_table(b);
+    }
+    ws_assert_not_reached();
+    return 0;
+}
+
+static uint32_t
+build_field(arrow_fb_builder *b, const char *name, uint8_t type_type, uint32_t type,
+            const uint32_t *children, unsigned num_children)
+{
+    uint32_t name_off = fb_create_string(b, name);
+    uint32_t children_off = fb_create_offset_vector(b, children, num_children);
+
+    fb_start_table(b);
+    fb_add_offset(b, 0, name_off);      /* name */
+    fb_add_offset(b, 3, type);          /* type */
+    fb_add_offset(b, 5, children_off);  /* children */
+    fb_add_u8(b, 1, 1);                 /* nullable */
+    fb_add_u8(b, 2, type_type);         /* type_type */
+    return fb_end_table(b);
+}
+
+static bool
+write_schema(arrow_ipc_writer *writer)
+{
+    arrow_fb_builder *b = &writer->fb;
+    unsigned num_columns = writer->columns->len;
+    uint32_t *fields = g_new(uint32_t, num_columns ? num_columns : 1);
+    uint32_t fields_off, schema;
+
+    fb_reset(b);
+    for (unsigned i = 0; i < num_columns; i++) {
+        arrow_ipc_column *col = &g_array_index(writer->columns, arrow_ipc_column, i);
+        uint8_t type_type;
+        uint32_t type = build_type(b, col->type, &type_type);
+
+        if (col->is_list) {
+            uint32_t item = build_field(b, "item", type_type, type, NULL, 0);
+            uint32_t list = fb_empty_table(b);
+            fields[i] = build_field(b, col->name, ARROW_FB_TYPE_LIST, list, &item, 1);
+        } else {
+            fields[i] = build_field(b, col->name, type_type, type, NULL, 0);
+        }
+    }
+    fields_off = fb_create_offset_vector(b, fields, num_columns);
+    g_free(fields);
+
+    fb_start_table(b);
+    fb_add_offset(b, 1, fields_off);    /* fields */
+    fb_add_u16(b, 0, 0);                /* endianness: Little */
+    schema = fb_end_table(b);
+
+    fb_finish(b, build_message(b, ARROW_FB_HEADER_SCHEMA, schema, 0));
+    writer->schema_written = true;
+    return write_metadata(writer);
+}
+
+/*
+ * Column buffers
+ */
+
+static void
+bitmap_set(GByteArray *bitmap, uint32_t idx, bool value)
+{
+    static const uint8_t zero;
+
+    while (bitmap->len <= idx / 8) {
+        g_byte_array_append(bitmap, &zero, 1);
+    }
+    if (value) {
+        bitmap->data[idx / 8] |= (uint8_t)(1U << (idx % 8));
+    } else {
+        bitmap->data[idx / 8] &= (uint8_t)~(1U << (idx % 8));
+    }
+}
+
+static void
+append_offset(GByteArray *offsets, uint32_t value)
+{
+    value = GUINT32_TO_LE(value);
+    g_byte_array_append(offsets, (const uint8_t *)&value, 4);
+}
+
+static uint32_t
+get_offset(GByteArray *offsets, uint32_t idx)
+{
+    uint32_t value;
+
+    memcpy(&value, offsets->data + 4 * (size_t)idx, 4);
+    return GUINT32_FROM_LE(value);
+}
+
+static void
+column_reset(arrow_ipc_column *col)
+{
+    g_byte_array_set_size(col->validity, 0);
+    g_byte_array_set_size(col->values, 0);
+    g_byte_array_set_size(col->data, 0);
+    col->num_values = 0;
+    col->null_count = 0;
+    if (col->type == ARROW_IPC_TYPE_UTF8) {
+        append_offset(col->values, 0);
+    }
+    if (col->is_list) {
+        g_byte_array_set_size(col->list_validity, 0);
+        g_byte_array_set_size(col->list_offsets, 0);
+        col->list_null_count = 0;
+        append_offset(col->list_offsets, 0);
+    }
+    col->row_has_value = false;
+}
+
+static size_t
+type_width(arrow_ipc_type_e type)
+{
+    switch (type) {
+    case ARROW_IPC_TYPE_INT32:
+    case ARROW_IPC_TYPE_UINT32:
+        return 4;
+    case ARROW_IPC_TYPE_INT64:
+    case ARROW_IPC_TYPE_UINT64:
+    case ARROW_IPC_TYPE_DOUBLE:
+    case ARROW_IPC_TYPE_TIMESTAMP_NS:
+    case ARROW_IPC_TYPE_DURATION_NS:
+        return 8;
+    case ARROW_IPC_TYPE_BOOL:
+    case ARROW_IPC_TYPE_UTF8:
+        return 0;
+    }
+    ws_assert_not_reached();
+    return 0;
+}
+
+/*
+ * Returns the index of the value slot to fill for the current row: a new
+ * slot, or for scalar columns the row's existing one (which is replaced).
+ */
+static uint32_t
+column_value_slot(arrow_ipc_column *col)
+{
+    uint32_t idx;
+
+    if (col->row_has_value && !col->is_list) {
+        idx = col->num_values - 1;
+        if (col->type == ARROW_IPC_TYPE_UTF8) {
+            /* Drop the previous string. */
+            g_byte_array_set_size(col->data, get_offset(col->values, idx));
+            g_byte_array_set_size(col->values, 4 * (idx + 1));
+        }
+        return idx;
+    }
+
+    idx = col->num_values++;
+    col->row_has_value = true;
+    if (!col->is_list) {
+        bitmap_set(col->validity, idx, true);
+    }
+    if (type_width(col->type)) {
+        g_byte_array_set_size(col->values, (unsigned)(type_width(col->type) * col->num_values));
+    }
+    return idx;
+}
+
+static void
+column_set_fixed(arrow_ipc_column *col, uint32_t idx, uint64_t bits)
+{
+    if (col->type == ARROW_IPC_TYPE_BOOL) {
+        bitmap_set(col->values, idx, bits != 0);
+    } else if (type_width(col->type) == 4) {
+        uint32_t v = GUINT32_TO_LE((uint32_t)bits);
+        memcpy(col->values->data + 4 * (size_t)idx, &v, 4);
+    } else {
+        bits = GUINT64_TO_LE(bits);
+        memcpy(col->values->data + 8 * (size_t)idx, &bits, 8);
+    }
+}
+
+static arrow_ipc_column *
+get_column(arrow_ipc_writer *writer, unsigned column)
+{
+    ws_assert(column < writer->columns->len);
+    return &g_array_index(writer->columns, arrow_ipc_column, column);
+}
+
+/* Finish the row for one column, adding a null if it got no value. */
+static void
+column_end_row(arrow_ipc_column *col, uint32_t row)
+{
+    if (col->is_list) {
+        bitmap_set(col->list_validity, row, col->row_has_value);
+        if (!col->row_has_value) {
+            col->list_null_count++;
+        }
+        append_offset(col->list_offsets, col->num_values);
+    } else if (!col->row_has_value) {
+        uint32_t idx = col->num_values++;
+
+        bitmap_set(col->validity, idx, false);
+        col->null_count++;
+        if (col->type == ARROW_IPC_TYPE_UTF8) {
+            append_offset(col->values, col->data->len);
+        } else if (col->type == ARROW_IPC_TYPE_BOOL) {
+            bitmap_set(col->values, idx, false);
+        } else {
+            g_byte_array_set_size(col->values, (unsigned)(type_width(col->type) * col->num_values));
+            memset(col->values->data + type_width(col->type) * idx, 0, type_width(col->type));
+        }
+    }
+    col->row_has_value = false;
+}
+
+/*
+ * Record batches
+ */
+
+typedef struct {
+    const uint8_t  *data;
+    size_t          len;
+} arrow_ipc_buffer;
+
+static void
+add_buffer(GArray *buffers, GArray *layout, int64_t *body_len, const uint8_t *data, size_t len)
+{
+    arrow_ipc_buffer buffer = { data, len };
+    int64_t pair[2] = { *body_len, (int64_t)len };
+
+    g_array_append_val(buffers, buffer);
+    g_array_append_vals(layout, pair, 2);
+    *body_len += (int64_t)((len + 7) & ~(size_t)7);
+}
+
+static bool
+write_record_batch(arrow_ipc_writer *writer)
+{
+    arrow_fb_builder *b = &writer->fb;
+    GArray *nodes = g_array_new(false, false, sizeof(int64_t));
+    GArray *layout = g_array_new(false, false, sizeof(int64_t));
+    GArray *buffers = g_array_new(false, false, sizeof(arrow_ipc_buffer));
+    int64_t body_len = 0;
+    uint32_t nodes_off, buffers_off, batch;
+
+    for (unsigned i = 0; i < writer->columns->len; i++) {
+        arrow_ipc_column *col = get_column(writer, i);
+        int64_t node[2];
+        const uint8_t *validity = col->validity->data;
+        size_t validity_len = col->validity->len;
+
+        if (col->is_list) {
+            node[0] = writer->num_rows;
+            node[1] = col->list_null_count;
+            g_array_append_vals(nodes, node, 2);
+            add_buffer(buffers, layout, &body_len, col->list_validity->data, col->list_validity->len);
+            add_buffer(buffers, layout, &body_len, col->list_offsets->data, col->list_offsets->len);
+            /* List elements are never null. */
+            validity = NULL;
+            validity_len = 0;
+        }
+
+        node[0] = col->num_values;
+        node[1] = col->null_count;
+        g_array_append_vals(nodes, node, 2);
+        add_buffer(buffers, layout, &body_len, validity, validity_len);
+        add_buffer(buffers, layout, &body_len, col->values->data, col->values->len);
+        if (col->type == ARROW_IPC_TYPE_UTF8) {
+            add_buffer(buffers, layout, &body_len, col->data->data, col->data->len);
+        }
+    }
+
+    fb_reset(b);
+    nodes_off = fb_create_int64_pair_vector(b, (const int64_t *)(void *)nodes->data, nodes->len / 2);
+    buffers_off = fb_create_int64_pair_vector(b, (const int64_t *)(void *)layout->data, layout->len / 2);
+    fb_start_table(b);
+    fb_add_u64(b, 0, writer->num_rows); /* length */
+    fb_add_offset(b, 1, nodes_off);     /* nodes */
+    fb_add_offset(b, 2, buffers_off);   /* buffers */
+    batch = fb_end_table(b);
+    fb_finish(b, build_message(b, ARROW_FB_HEADER_RECORDBATCH, batch, body_len));
+
+    write_metadata(writer);
+    for (unsigned i = 0; i < buffers->len; i++) {
+        arrow_ipc_buffer *buffer = &g_array_index(buffers, arrow_ipc_buffer, i);
+
+        write_bytes(writer, buffer->data, buffer->len);
+        write_padding(writer, ((buffer->len + 7) & ~(size_t)7) - buffer->len);
+    }
+
+    g_array_free(nodes, true);
+    g_array_free(layout, true);
+    g_array_free(buffers, true);
+
+    for (unsigned i = 0; i < writer->columns->len; i++) {
+        column_reset(get_column(writer, i));
+    }
+    writer->num_rows = 0;
+    return !writer->error;
+}
+
+/*
+ * Public API
+ */
+
+arrow_ipc_writer *
+arrow_ipc_writer_new(FILE *fh, unsigned batch_rows)
+{
+    arrow_ipc_writer *writer = g_new0(arrow_ipc_writer, 1);
+
+    writer->fh = fh;
+    writer->batch_rows = batch_rows ? batch_rows : ARROW_IPC_DEFAULT_BATCH_ROWS;
+    writer->columns = g_array_new(false, true, sizeof(arrow_ipc_column));
+    return writer;
+}
+
+unsigned
+arrow_ipc_writer_add_column(arrow_ipc_writer *writer, const char *name,
+                            arrow_ipc_type_e type, bool is_list)
+{
+    arrow_ipc_column col = { 0 };
+
+    ws_assert(!writer->schema_written && writer->num_rows == 0);
+
+    col.name = g_strdup(name);
+    col.type = type;
+    col.is_list = is_list;
+    col.validity = g_byte_array_new();
+    col.values = g_byte_array_new();
+    col.data = g_byte_array_new();
+    if (is_list) {
+        col.list_validity = g_byte_array_new();
+        col.list_offsets = g_byte_array_new();
+    }
+    column_reset(&col);
+    g_array_append_val(writer->columns, col);
+    return writer->columns->len - 1;
+}
+
+void
+arrow_ipc_writer_append_int64(arrow_ipc_writer *writer, unsigned column, int64_t value)
+{
+    arrow_ipc_column *col = get_column(writer, column);
+
+    switch (col->type) {
+    case ARROW_IPC_TYPE_DOUBLE:
+        arrow_ipc_writer_append_double(writer, column, (double)value);
+        return;
+    case ARROW_IPC_TYPE_UTF8:
+    {
+        char buf[32];
+        snprintf(buf, sizeof buf, "%" PRId64, value);
+        arrow_ipc_writer_append_string(writer, column, buf, -1);
+        return;
+    }
+    default:
+        column_set_fixed(col, column_value_slot(col), (uint64_t)value);
+        return;
+    }
+}
+
+void
+arrow_ipc_writer_append_uint64(arrow_ipc_writer *writer, unsigned column, uint64_t value)
+{
+    arrow_ipc_column *col = get_column(writer, column);
+
+    switch (col->type) {
+    case ARROW_IPC_TYPE_DOUBLE:
+        arrow_ipc_writer_append_double(writer, column, (double)value);
+        return;
+    case ARROW_IPC_TYPE_UTF8:
+    {
+        char buf[32];
+        snprintf(buf, sizeof buf, "%" PRIu64, value);
+        arrow_ipc_writer_append_string(writer, column, buf, -1);
+        return;
+    }
+    default:
+        column_set_fixed(col, column_value_slot(col), value);
+        return;
+    }
+}
+
+void
+arrow_ipc_writer_append_double(arrow_ipc_writer *writer, unsigned column, double value)
+{
+    arrow_ipc_column *col = get_column(writer, column);
+    uint64_t bits;
+
+    switch (col->type) {
+    case ARROW_IPC_TYPE_DOUBLE:
+        memcpy(&bits, &value, 8);
+        column_set_fixed(col, column_value_slot(col), bits);
+        return;
+    case ARROW_IPC_TYPE_UTF8:
+    {
+        char buf[G_ASCII_DTOSTR_BUF_SIZE];
+        arrow_ipc_writer_append_string(writer, column, g_ascii_dtostr(buf, sizeof buf, value), -1);
+        return;
+    }
+    case ARROW_IPC_TYPE_BOOL:
+        column_set_fixed(col, column_value_slot(col), value != 0.0);
+        return;
+    default:
+        column_set_fixed(col, column_value_slot(col), (uint64_t)(int64_t)value);
+        return;
+    }
+}
+
+void
+arrow_ipc_writer_append_string(arrow_ipc_writer *writer, unsigned column,
+                               const char *value, ssize_t len)
+{
+    arrow_ipc_column *col = get_column(writer, column);
+
+    /* Strings only go into string columns; the caller picks the type. */
+    ws_assert(col->type == ARROW_IPC_TYPE_UTF8);
+
+    if (len < 0) {
+        len = (ssize_t)strlen(value);
+    }
+    column_value_slot(col);
+    g_byte_array_append(col->data, (const uint8_t *)value, (unsigned)len);
+    append_offset(col->values, col->data->len);
+}
+
+bool
+arrow_ipc_writer_end_row(arrow_ipc_writer *writer)
+{
+    bool flush;
+
+    if (!writer->schema_written) {
+        write_schema(writer);
+    }
+
+    flush = ++writer->num_rows >= writer->batch_rows;
+    for (unsigned i = 0; i < writer->columns->len; i++) {
+        arrow_ipc_column *col = get_column(writer, i);
+
+        column_end_row(col, writer->num_rows - 1);
+        if (col->data->len >= ARROW_IPC_MAX_BATCH_DATA) {
+            flush = true;
+        }
+    }
+
+    if (flush) {
+        write_record_batch(writer);
+    }
+    return !writer->error;
+}
+
+bool
+arrow_ipc_writer_finish(arrow_ipc_writer *writer)
+{
+    if (!writer->schema_written) {
+        write_schema(writer);
+    }
+    if (writer->num_rows) {
+        write_record_batch(writer);
+    }
+    /* End-of-stream marker */
+    write_u32(writer, ARROW_IPC_CONTINUATION);
+    write_u32(writer, 0);
+    fflush(writer->fh);
+    return !writer->error && !ferror(writer->fh);
+}
+
+void
+arrow_ipc_writer_free(arrow_ipc_writer *writer)
+{
+    if (!writer) {
+        return;
+    }
+    for (unsigned i = 0; i < writer->columns->len; i++) {
+        arrow_ipc_column *col = get_column(writer, i);
+
+        g_free(col->name);
+        g_byte_array_free(col->validity, true);
+        g_byte_array_free(col->values, true);
+        g_byte_array_free(col->data, true);
+        if (col->is_list) {
+            g_byte_array_free(col->list_validity, true);
+            g_byte_array_free(col->list_offsets, true);
+        }
+    }
+    g_array_free(writer->columns, true);
+    g_free(writer->fb.buf);
+    g_free(writer);
+}
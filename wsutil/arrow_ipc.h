@@ -0,0 +1,135 @@
+/** @file
+ * Routines for writing Apache Arrow IPC streams.
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __ARROW_IPC_H__
+#define __ARROW_IPC_H__
+
+#include <stdio.h>
+
+#include <wireshark.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * A minimal writer for the Arrow IPC streaming format
+ * (https://arrow.apache.org/docs/format/Columnar.html#ipc-streaming-format),
+ * which can be read directly by pyarrow, DuckDB, Spark, Polars and so on.
+ * It needs no external library; the flatbuffer metadata is built by hand.
+ *
+ * Rows are buffered in memory and flushed as a record batch every
+ * "batch_rows" rows (or earlier, once a batch holds a lot of string data),
+ * so memory use is bounded regardless of the length of the stream.
+ *
+ * Example:
+ *
+ *  arrow_ipc_writer *writer = arrow_ipc_writer_new(stdout, 0);
+ *  arrow_ipc_writer_add_column(writer, "frame.number", ARROW_IPC_TYPE_UINT32, false);
+ *  arrow_ipc_writer_add_column(writer, "ip.addr", ARROW_IPC_TYPE_UTF8, true);
+ *  for each row {
+ *      arrow_ipc_writer_append_uint64(writer, 0, number);
+ *      arrow_ipc_writer_append_string(writer, 1, src, -1);
+ *      arrow_ipc_writer_append_string(writer, 1, dst, -1);
+ *      arrow_ipc_writer_end_row(writer);
+ *  }
+ *  arrow_ipc_writer_finish(writer);
+ *  arrow_ipc_writer_free(writer);
+ */
+
+typedef enum {
+    ARROW_IPC_TYPE_BOOL,
+    ARROW_IPC_TYPE_INT32,
+    ARROW_IPC_TYPE_UINT32,
+    ARROW_IPC_TYPE_INT64,
+    ARROW_IPC_TYPE_UINT64,
+    ARROW_IPC_TYPE_DOUBLE,
+    ARROW_IPC_TYPE_TIMESTAMP_NS,    /**< Nanoseconds since the epoch, UTC */
+    ARROW_IPC_TYPE_DURATION_NS,     /**< Nanoseconds */
+    ARROW_IPC_TYPE_UTF8
+} arrow_ipc_type_e;
+
+/** Default number of rows per record batch. */
+#define ARROW_IPC_DEFAULT_BATCH_ROWS    65536
+
+typedef struct arrow_ipc_writer arrow_ipc_writer;
+
+/**
+ * Create a writer for the given file.
+ *
+ * @param fh Output file. It is not closed by the writer.
+ * @param batch_rows Rows per record batch, or 0 for the default.
+ */
+WS_DLL_PUBLIC arrow_ipc_writer *
+arrow_ipc_writer_new(FILE *fh, unsigned batch_rows);
+
+/**
+ * Add a column to the schema. Must be called before any value is appended.
+ *
+ * @param name Column name (copied).
+ * @param type Type of the values.
+ * @param is_list If true, the column is a list of values of "type" and
+ * every append adds an element to the row's list. Otherwise, a second
+ * append to the same row replaces the first value.
+ * @return The index of the column.
+ */
+WS_DLL_PUBLIC unsigned
+arrow_ipc_writer_add_column(arrow_ipc_writer *writer, const char *name,
+                            arrow_ipc_type_e type, bool is_list);
+
+/**
+ * Append a value to a column of the current row. Columns that do not get a
+ * value in a row are null in that row. The value is converted to the
+ * column type; integers are truncated to 32 bits for 32-bit columns, and
+ * a nonzero value is true for BOOL columns.
+ */
+WS_DLL_PUBLIC void
+arrow_ipc_writer_append_int64(arrow_ipc_writer *writer, unsigned column, int64_t value);
+
+WS_DLL_PUBLIC void
+arrow_ipc_writer_append_uint64(arrow_ipc_writer *writer, unsigned column, uint64_t value);
+
+WS_DLL_PUBLIC void
+arrow_ipc_writer_append_double(arrow_ipc_writer *writer, unsigned column, double value);
+
+/**
+ * Append a string to a UTF8 column of the current row.
+ *
+ * @param len Length of the string in bytes, or -1 if it is NUL-terminated.
+ */
+WS_DLL_PUBLIC void
+arrow_ipc_writer_append_string(arrow_ipc_writer *writer, unsigned column,
+                               const char *value, ssize_t len);
+
+/**
+ * Finish the current row, writing a record batch if the batch is full.
+ *
+ * @return false if an I/O error occurred.
+ */
+WS_DLL_PUBLIC bool
+arrow_ipc_writer_end_row(arrow_ipc_writer *writer);
+
+/**
+ * Write any pending rows and the end-of-stream marker.
+ * The schema is written even if no rows were added.
+ *
+ * @return false if an I/O error occurred.
+ */
+WS_DLL_PUBLIC bool
+arrow_ipc_writer_finish(arrow_ipc_writer *writer);
+
+WS_DLL_PUBLIC void
+arrow_ipc_writer_free(arrow_ipc_writer *writer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ARROW_IPC_H__ */
@@ -0,0 +1,357 @@
+/* roaring_bitmap.c
+ * Compressed bitmaps of 32-bit integers.
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include "roaring_bitmap.h"
+
+#include <string.h>
+
+#include <wsutil/bits_count_ones.h>
+#include <wsutil/bits_ctz.h>
+
+/* Arrays bigger than this take more room than a bitset. */
+#define ARRAY_MAX           4096
+#define BITSET_WORDS        (65536 / 64)
+
+typedef struct {
+    uint16_t key;           /* Upper 16 bits of the values */
+    bool is_bitset;
+    uint32_t cardinality;
+    uint32_t capacity;      /* Of the array */
+    union {
+        uint16_t *array;    /* Sorted lower 16 bits */
+        uint64_t *bitset;
+    } u;
+} container_t;
+
+struct roaring_bitmap {
+    wmem_allocator_t *allocator;
+    container_t *containers;    /* Sorted by key */
+    unsigned count;
+    unsigned capacity;
+};
+
+roaring_bitmap_t *
+roaring_bitmap_new(wmem_allocator_t *allocator)
+{
+    roaring_bitmap_t *bitmap = wmem_new0(allocator, roaring_bitmap_t);
+
+    bitmap->allocator = allocator;
+    return bitmap;
+}
+
+void
+roaring_bitmap_free(roaring_bitmap_t *bitmap)
+{
+    if (!bitmap)
+        return;
+
+    for (unsigned i = 0; i < bitmap->count; i++) {
+        if (bitmap->containers[i].is_bitset) {
+            wmem_free(bitmap->allocator, bitmap->containers[i].u.bitset);
+        } else {
+            wmem_free(bitmap->allocator, bitmap->containers[i].u.array);
+        }
+    }
+    wmem_free(bitmap->allocator, bitmap->containers);
+    wmem_free(bitmap->allocator, bitmap);
+}
+
+/* Find the container for a key, or where to insert it. */
+static unsigned
+find_container(const roaring_bitmap_t *bitmap, uint16_t key, bool *found)
+{
+    unsigned lo = 0, hi = bitmap->count;
+
+    /* Values are usually added in ascending order. */
+    if (hi > 0 && bitmap->containers[hi - 1].key <= key) {
+        *found = bitmap->containers[hi - 1].key == key;
+        return *found ? hi - 1 : hi;
+    }
+
+    while (lo < hi) {
+        unsigned mid = lo + (hi - lo) / 2;
+        if (bitmap->containers[mid].key < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    *found = lo < bitmap->count && bitmap->containers[lo].key == key;
+    return lo;
+}
+
+static container_t *
+insert_container(roaring_bitmap_t *bitmap, unsigned pos, uint16_t key)
+{
+    container_t *container;
+
+    if (bitmap->count == bitmap->capacity) {
+        bitmap->capacity = bitmap->capacity ? bitmap->capacity * 2 : 4;
+        bitmap->containers = (container_t *)wmem_realloc(bitmap->allocator,
+                bitmap->containers, bitmap->capacity * sizeof(container_t));
+    }
+    memmove(&bitmap->containers[pos + 1], &bitmap->containers[pos],
+            (bitmap->count - pos) * sizeof(container_t));
+    bitmap->count++;
+
+    container = &bitmap->containers[pos];
+    memset(container, 0, sizeof(*container));
+    container->key = key;
+    return container;
+}
+
+/* Find the position of a value in a sorted array, or where to insert it. */
+static uint32_t
+array_find(const container_t *container, uint16_t low, bool *found)
+{
+    uint32_t lo = 0, hi = container->cardinality;
+
+    if (hi > 0 && container->u.array[hi - 1] <= low) {
+        *found = container->u.array[hi - 1] == low;
+        return *found ? hi - 1 : hi;
+    }
+
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (container->u.array[mid] < low) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    *found = lo < container->cardinality && container->u.array[lo] == low;
+    return lo;
+}
+
+static void
+array_to_bitset(wmem_allocator_t *allocator, container_t *container)
+{
+    uint64_t *bitset = wmem_alloc0_array(allocator, uint64_t, BITSET_WORDS);
+
+    for (uint32_t i = 0; i < container->cardinality; i++) {
+        uint16_t low = container->u.array[i];
+        bitset[low / 64] |= UINT64_C(1) << (low % 64);
+    }
+    wmem_free(allocator, container->u.array);
+    container->u.bitset = bitset;
+    container->is_bitset = true;
+    container->capacity = 0;
+}
+
+void
+roaring_bitmap_add(roaring_bitmap_t *bitmap, uint32_t value)
+{
+    uint16_t key = (uint16_t)(value >> 16);
+    uint16_t low = (uint16_t)value;
+    container_t *container;
+    unsigned pos;
+    uint32_t idx;
+    bool found;
+
+    pos = find_container(bitmap, key, &found);
+    if (found) {
+        container = &bitmap->containers[pos];
+    } else {
+        container = insert_container(bitmap, pos, key);
+    }
+
+    if (container->is_bitset) {
+        uint64_t bit = UINT64_C(1) << (low % 64);
+        if (!(container->u.bitset[low / 64] & bit)) {
+            container->u.bitset[low / 64] |= bit;
+            container->cardinality++;
+        }
+        return;
+    }
+
+    idx = array_find(container, low, &found);
+    if (found)
+        return;
+
+    if (container->cardinality == ARRAY_MAX) {
+        array_to_bitset(bitmap->allocator, container);
+        container->u.bitset[low / 64] |= UINT64_C(1) << (low % 64);
+        container->cardinality++;
+        return;
+    }
+
+    if (container->cardinality == container->capacity) {
+        container->capacity = container->capacity ? MIN(container->capacity * 2, ARRAY_MAX) : 4;
+        container->u.array = (uint16_t *)wmem_realloc(bitmap->allocator,
+                container->u.array, container->capacity * sizeof(uint16_t));
+    }
+    memmove(&container->u.array[idx + 1], &container->u.array[idx],
+            (container->cardinality - idx) * sizeof(uint16_t));
+    container->u.array[idx] = low;
+    container->cardinality++;
+}
+
+bool
+roaring_bitmap_contains(const roaring_bitmap_t *bitmap, uint32_t value)
+{
+    uint16_t low = (uint16_t)value;
+    const container_t *container;
+    unsigned pos;
+    bool found;
+
+    pos = find_container(bitmap, (uint16_t)(value >> 16), &found);
+    if (!found)
+        return false;
+
+    container = &bitmap->containers[pos];
+    if (container->is_bitset) {
+        return (container->u.bitset[low / 64] >> (low % 64)) & 1;
+    }
+    array_find(container, low, &found);
+    return found;
+}
+
+uint64_t
+roaring_bitmap_cardinality(const roaring_bitmap_t *bitmap)
+{
+    uint64_t cardinality = 0;
+
+    for (unsigned i = 0; i < bitmap->count; i++) {
+        cardinality += bitmap->containers[i].cardinality;
+    }
+    return cardinality;
+}
+
+/* Intersect two containers with the same key into a new container of dst. */
+static void
+container_and(roaring_bitmap_t *dst, const container_t *a, const container_t *b)
+{
+    container_t *result;
+
+    if (a->is_bitset && b->is_bitset) {
+        uint64_t *bitset = wmem_alloc_array(dst->allocator, uint64_t, BITSET_WORDS);
+        uint32_t cardinality = 0;
+
+        for (unsigned i = 0; i < BITSET_WORDS; i++) {
+            bitset[i] = a->u.bitset[i] & b->u.bitset[i];
+            cardinality += ws_count_ones(bitset[i]);
+        }
+        if (cardinality == 0) {
+            wmem_free(dst->allocator, bitset);
+            return;
+        }
+
+        result = insert_container(dst, dst->count, a->key);
+        if (cardinality > ARRAY_MAX) {
+            result->is_bitset = true;
+            result->u.bitset = bitset;
+            result->cardinality = cardinality;
+            return;
+        }
+
+        /* Sparse enough to go back to an array. */
+        result->u.array = wmem_alloc_array(dst->allocator, uint16_t, cardinality);
+        result->capacity = cardinality;
+        for (unsigned i = 0; i < BITSET_WORDS; i++) {
+            uint64_t word = bitset[i];
+            while (word) {
+                result->u.array[result->cardinality++] = (uint16_t)(i * 64 + ws_ctz(word));
+                word &= word - 1;
+            }
+        }
+        wmem_free(dst->allocator, bitset);
+        return;
+    }
+
+    /* At least one of them is an array, so the result is one too. */
+    uint16_t *array = wmem_alloc_array(dst->allocator, uint16_t, MIN(a->cardinality, b->cardinality));
+    uint32_t cardinality = 0;
+
+    if (a->is_bitset || b->is_bitset) {
+        const container_t *arr = a->is_bitset ? b : a;
+        const container_t *set = a->is_bitset ? a : b;
+
+        for (uint32_t i = 0; i < arr->cardinality; i++) {
+            uint16_t low = arr->u.array[i];
+            if ((set->u.bitset[low / 64] >> (low % 64)) & 1) {
+                array[cardinality++] = low;
+            }
+        }
+    } else {
+        uint32_t i = 0, j = 0;
+
+        while (i < a->cardinality && j < b->cardinality) {
+            if (a->u.array[i] < b->u.array[j]) {
+                i++;
+            } else if (a->u.array[i] > b->u.array[j]) {
+                j++;
+            } else {
+                array[cardinality++] = a->u.array[i];
+                i++;
+                j++;
+            }
+        }
+    }
+
+    if (cardinality == 0) {
+        wmem_free(dst->allocator, array);
+        return;
+    }
+    result = insert_container(dst, dst->count, a->key);
+    result->u.array = array;
+    result->capacity = MIN(a->cardinality, b->cardinality);
+    result->cardinality = cardinality;
+}
+
+roaring_bitmap_t *
+roaring_bitmap_and(wmem_allocator_t *allocator, const roaring_bitmap_t *a, const roaring_bitmap_t *b)
+{
+    roaring_bitmap_t *result = roaring_bitmap_new(allocator);
+    unsigned i = 0, j = 0;
+
+    while (i < a->count && j < b->count) {
+        if (a->containers[i].key < b->containers[j].key) {
+            i++;
+        } else if (a->containers[i].key > b->containers[j].key) {
+            j++;
+        } else {
+            container_and(result, &a->containers[i], &b->containers[j]);
+            i++;
+            j++;
+        }
+    }
+    return result;
+}
+
+uint32_t *
+roaring_bitmap_to_array(const roaring_bitmap_t *bitmap, unsigned *count)
+{
+    uint64_t cardinality = roaring_bitmap_cardinality(bitmap);
+    uint32_t *values = g_new(uint32_t, MAX(cardinality, 1));
+    unsigned n = 0;
+
+    for (unsigned i = 0; i < bitmap->count; i++) {
+        const container_t *container = &bitmap->containers[i];
+        uint32_t high = (uint32_t)container->key << 16;
+
+        if (container->is_bitset) {
+            for (unsigned w = 0; w < BITSET_WORDS; w++) {
+                uint64_t word = container->u.bitset[w];
+                while (word) {
+                    values[n++] = high | (w * 64 + ws_ctz(word));
+                    word &= word - 1;
+                }
+            }
+        } else {
+            for (uint32_t v = 0; v < container->cardinality; v++) {
+                values[n++] = high | container->u.array[v];
+            }
+        }
+    }
+    *count = n;
+    return values;
+}
@@ -0,0 +1,104 @@
+/** @file
+ * Compressed bitmaps of 32-bit integers.
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __ROARING_BITMAP_H__
+#define __ROARING_BITMAP_H__
+
+#include <wireshark.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * A set of 32-bit integers stored like a "Roaring" bitmap
+ * (https://roaringbitmap.org/): values are grouped by their upper 16 bits,
+ * and each group is either a sorted array of the lower 16 bits, while it
+ * is sparse, or a bitset of 2^16 bits once it is dense. This keeps sets of
+ * frame numbers small whether they are sparse or dense, and makes
+ * intersections fast.
+ *
+ * Adding values in ascending order, as when indexing frames, is the
+ * fast path, but values can be added in any order.
+ */
+
+typedef struct roaring_bitmap roaring_bitmap_t;
+
+/**
+ * Create an empty bitmap.
+ *
+ * @param allocator The allocator for the bitmap and its storage.
+ * @return The new bitmap.
+ */
+WS_DLL_PUBLIC roaring_bitmap_t *
+roaring_bitmap_new(wmem_allocator_t *allocator);
+
+/**
+ * Free a bitmap.
+ *
+ * @param bitmap The bitmap to free.
+ */
+WS_DLL_PUBLIC void
+roaring_bitmap_free(roaring_bitmap_t *bitmap);
+
+/**
+ * Add a value to a bitmap. Adding a value already there does nothing.
+ *
+ * @param bitmap The bitmap.
+ * @param value The value to add.
+ */
+WS_DLL_PUBLIC void
+roaring_bitmap_add(roaring_bitmap_t *bitmap, uint32_t value);
+
+/**
+ * Check whether a bitmap contains a value.
+ *
+ * @param bitmap The bitmap.
+ * @param value The value to look for.
+ * @return true if the value is in the bitmap.
+ */
+WS_DLL_PUBLIC bool
+roaring_bitmap_contains(const roaring_bitmap_t *bitmap, uint32_t value);
+
+/**
+ * Get the number of values in a bitmap.
+ *
+ * @param bitmap The bitmap.
+ * @return The number of values.
+ */
+WS_DLL_PUBLIC uint64_t
+roaring_bitmap_cardinality(const roaring_bitmap_t *bitmap);
+
+/**
+ * Intersect two bitmaps.
+ *
+ * @param allocator The allocator for the result.
+ * @param a A bitmap.
+ * @param b Another bitmap.
+ * @return A new bitmap with the values that are in both a and b.
+ */
+WS_DLL_PUBLIC roaring_bitmap_t *
+roaring_bitmap_and(wmem_allocator_t *allocator, const roaring_bitmap_t *a, const roaring_bitmap_t *b);
+
+/**
+ * Get the values of a bitmap.
+ *
+ * @param bitmap The bitmap.
+ * @param count Set to the number of values.
+ * @return The values in ascending order, to be freed with g_free().
+ */
+WS_DLL_PUBLIC uint32_t *
+roaring_bitmap_to_array(const roaring_bitmap_t *bitmap, unsigned *count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ROARING_BITMAP_H__ */
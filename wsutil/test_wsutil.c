@@ -847,6 +847,58 @@ static void test_getopt_opterr1(void)
     g_test_trap_assert_stderr(PROGNAME ": unrecognized option: z\n");
 }
 
+#include "roaring_bitmap.h"
+
+static void test_roaring_bitmap(void)
+{
+    roaring_bitmap_t *sparse, *dense, *both;
+    uint32_t *values;
+    unsigned count;
+
+    sparse = roaring_bitmap_new(NULL);
+    dense = roaring_bitmap_new(NULL);
+
+    /* Out of order, with duplicates, across several containers. */
+    roaring_bitmap_add(sparse, 70000);
+    roaring_bitmap_add(sparse, 3);
+    roaring_bitmap_add(sparse, 1000);
+    roaring_bitmap_add(sparse, 3);
+    roaring_bitmap_add(sparse, 200000);
+    g_assert_cmpuint(roaring_bitmap_cardinality(sparse), ==, 4);
+    g_assert_true(roaring_bitmap_contains(sparse, 3));
+    g_assert_true(roaring_bitmap_contains(sparse, 70000));
+    g_assert_false(roaring_bitmap_contains(sparse, 4));
+    g_assert_false(roaring_bitmap_contains(sparse, 131072));
+
+    /* Enough even values to turn the first container into a bitset. */
+    for (uint32_t i = 0; i < 80000; i += 2) {
+        roaring_bitmap_add(dense, i);
+    }
+    g_assert_cmpuint(roaring_bitmap_cardinality(dense), ==, 40000);
+    g_assert_true(roaring_bitmap_contains(dense, 1000));
+    g_assert_false(roaring_bitmap_contains(dense, 1001));
+
+    both = roaring_bitmap_and(NULL, sparse, dense);
+    values = roaring_bitmap_to_array(both, &count);
+    g_assert_cmpuint(count, ==, 2);
+    g_assert_cmpuint(values[0], ==, 1000);
+    g_assert_cmpuint(values[1], ==, 70000);
+    g_free(values);
+    roaring_bitmap_free(both);
+
+    both = roaring_bitmap_and(NULL, dense, dense);
+    g_assert_cmpuint(roaring_bitmap_cardinality(both), ==, 40000);
+    values = roaring_bitmap_to_array(both, &count);
+    g_assert_cmpuint(count, ==, 40000);
+    g_assert_cmpuint(values[0], ==, 0);
+    g_assert_cmpuint(values[count - 1], ==, 79998);
+    g_free(values);
+    roaring_bitmap_free(both);
+
+    roaring_bitmap_free(sparse);
+    roaring_bitmap_free(dense);
+}
+
 int main(int argc, char **argv)
 {
     int ret;
@@ -900,6 +952,8 @@ int main(int argc, char **argv)
     g_test_add_func("/ws_getopt/optional1", test_getopt_optional_argument1);
     g_test_add_func("/ws_getopt/opterr1", test_getopt_opterr1);
 
+    g_test_add_func("/roaring_bitmap/basic", test_roaring_bitmap);
+
     ret = g_test_run();
 
     return ret;
@@ -28,6 +28,165 @@
 static bool do_override;
 static wmem_allocator_type_t override_type;
 
+/*
+ * Allocator statistics.
+ *
+ * An allocator that keeps statistics puts a header in front of every block
+ * it hands out, recording the size of the block and the tag it is charged
+ * to, so that wmem_free() and wmem_realloc() can update the counters.
+ * The header keeps the alignment that the allocators guarantee.
+ */
+typedef struct {
+    const char   *tag;
+    wmem_stats_t  stats;
+} wmem_tag_stats_t;
+
+struct _wmem_allocator_stats_t {
+    char             *name;
+    wmem_stats_t      totals;
+    GHashTable       *tags;         /* tag string -> wmem_tag_stats_t */
+    wmem_tag_stats_t *last_tag;     /* the tag of the previous allocation */
+};
+
+typedef struct {
+    size_t            size;
+    wmem_tag_stats_t *tag;
+} wmem_stats_hdr_t;
+
+#define WMEM_STATS_HDR_SIZE ((sizeof(wmem_stats_hdr_t) + 15) & ~(size_t)15)
+
+#define WMEM_STATS_NO_TAG "(untagged)"
+
+static bool stats_enabled;
+static WS_THREAD_LOCAL const char *stats_tag;
+
+/* Allocators with statistics, in order of creation. */
+static GPtrArray *stats_allocators;
+static GMutex stats_allocators_mutex;
+
+static wmem_tag_stats_t *
+wmem_stats_get_tag(struct _wmem_allocator_stats_t *stats)
+{
+    const char       *tag = stats_tag ? stats_tag : WMEM_STATS_NO_TAG;
+    wmem_tag_stats_t *tag_stats;
+
+    if (stats->last_tag && (stats->last_tag->tag == tag || strcmp(stats->last_tag->tag, tag) == 0)) {
+        return stats->last_tag;
+    }
+
+    tag_stats = (wmem_tag_stats_t *)g_hash_table_lookup(stats->tags, tag);
+    if (tag_stats == NULL) {
+        tag_stats = g_new0(wmem_tag_stats_t, 1);
+        tag_stats->tag = tag;
+        g_hash_table_insert(stats->tags, (void *)tag, tag_stats);
+    }
+    stats->last_tag = tag_stats;
+
+    return tag_stats;
+}
+
+static inline void
+wmem_stats_add(wmem_stats_t *stats, size_t size)
+{
+    stats->bytes += size;
+    if (stats->bytes > stats->peak_bytes) {
+        stats->peak_bytes = stats->bytes;
+    }
+}
+
+static void *
+wmem_stats_alloc(wmem_allocator_t *allocator, const size_t size)
+{
+    wmem_stats_hdr_t *hdr;
+
+    hdr = (wmem_stats_hdr_t *)allocator->walloc(allocator->private_data, size + WMEM_STATS_HDR_SIZE);
+    hdr->size = size;
+    hdr->tag  = wmem_stats_get_tag(allocator->stats);
+
+    wmem_stats_add(&allocator->stats->totals, size);
+    allocator->stats->totals.blocks++;
+    allocator->stats->totals.total_allocs++;
+    wmem_stats_add(&hdr->tag->stats, size);
+    hdr->tag->stats.blocks++;
+    hdr->tag->stats.total_allocs++;
+
+    return (uint8_t *)hdr + WMEM_STATS_HDR_SIZE;
+}
+
+static void
+wmem_stats_free(wmem_allocator_t *allocator, void *ptr)
+{
+    wmem_stats_hdr_t *hdr = (wmem_stats_hdr_t *)((uint8_t *)ptr - WMEM_STATS_HDR_SIZE);
+
+    allocator->stats->totals.bytes -= hdr->size;
+    allocator->stats->totals.blocks--;
+    hdr->tag->stats.bytes -= hdr->size;
+    hdr->tag->stats.blocks--;
+
+    allocator->wfree(allocator->private_data, hdr);
+}
+
+static void *
+wmem_stats_realloc(wmem_allocator_t *allocator, void *ptr, const size_t size)
+{
+    wmem_stats_hdr_t *hdr = (wmem_stats_hdr_t *)((uint8_t *)ptr - WMEM_STATS_HDR_SIZE);
+    size_t            old_size = hdr->size;
+
+    hdr = (wmem_stats_hdr_t *)allocator->wrealloc(allocator->private_data, hdr, size + WMEM_STATS_HDR_SIZE);
+    hdr->size = size;
+
+    /* The block stays charged to the tag it was allocated with. */
+    allocator->stats->totals.bytes -= old_size;
+    wmem_stats_add(&allocator->stats->totals, size);
+    hdr->tag->stats.bytes -= old_size;
+    wmem_stats_add(&hdr->tag->stats, size);
+
+    return (uint8_t *)hdr + WMEM_STATS_HDR_SIZE;
+}
+
+static void
+wmem_stats_free_all(wmem_allocator_t *allocator)
+{
+    GHashTableIter    iter;
+    wmem_tag_stats_t *tag_stats;
+
+    allocator->stats->totals.bytes  = 0;
+    allocator->stats->totals.blocks = 0;
+
+    g_hash_table_iter_init(&iter, allocator->stats->tags);
+    while (g_hash_table_iter_next(&iter, NULL, (void **)&tag_stats)) {
+        tag_stats->stats.bytes  = 0;
+        tag_stats->stats.blocks = 0;
+    }
+}
+
+static void
+wmem_stats_new(wmem_allocator_t *allocator)
+{
+    allocator->stats = g_new0(struct _wmem_allocator_stats_t, 1);
+    allocator->stats->tags = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, g_free);
+
+    g_mutex_lock(&stats_allocators_mutex);
+    if (stats_allocators == NULL) {
+        stats_allocators = g_ptr_array_new();
+    }
+    g_ptr_array_add(stats_allocators, allocator);
+    g_mutex_unlock(&stats_allocators_mutex);
+}
+
+static void
+wmem_stats_destroy(wmem_allocator_t *allocator)
+{
+    g_mutex_lock(&stats_allocators_mutex);
+    g_ptr_array_remove(stats_allocators, allocator);
+    g_mutex_unlock(&stats_allocators_mutex);
+
+    g_hash_table_destroy(allocator->stats->tags);
+    g_free(allocator->stats->name);
+    g_free(allocator->stats);
+    allocator->stats = NULL;
+}
+
 void *
 wmem_alloc(wmem_allocator_t *allocator, const size_t size)
 {
@@ -41,6 +200,10 @@ wmem_alloc(wmem_allocator_t *allocator, const size_t size)
         return NULL;
     }
 
+    if (G_UNLIKELY(allocator->stats != NULL)) {
+        return wmem_stats_alloc(allocator, size);
+    }
+
     return allocator->walloc(allocator->private_data, size);
 }
 
@@ -72,6 +235,11 @@ wmem_free(wmem_allocator_t *allocator, void *ptr)
         return;
     }
 
+    if (G_UNLIKELY(allocator->stats != NULL)) {
+        wmem_stats_free(allocator, ptr);
+        return;
+    }
+
     allocator->wfree(allocator->private_data, ptr);
 }
 
@@ -93,6 +261,10 @@ wmem_realloc(wmem_allocator_t *allocator, void *ptr, const size_t size)
 
     ws_assert(allocator->in_scope);
 
+    if (G_UNLIKELY(allocator->stats != NULL)) {
+        return wmem_stats_realloc(allocator, ptr, size);
+    }
+
     return allocator->wrealloc(allocator->private_data, ptr, size);
 }
 
@@ -102,6 +274,9 @@ wmem_free_all_real(wmem_allocator_t *allocator, bool final)
     wmem_call_callbacks(allocator,
             final ? WMEM_CB_DESTROY_EVENT : WMEM_CB_FREE_EVENT);
     allocator->free_all(allocator->private_data);
+    if (allocator->stats != NULL) {
+        wmem_stats_free_all(allocator);
+    }
 }
 
 void
@@ -122,6 +297,9 @@ wmem_destroy_allocator(wmem_allocator_t *allocator)
 
     wmem_free_all_real(allocator, true);
     allocator->cleanup(allocator->private_data);
+    if (allocator->stats != NULL) {
+        wmem_stats_destroy(allocator);
+    }
     wmem_free(NULL, allocator);
 }
 
@@ -142,6 +320,7 @@ wmem_allocator_new(const wmem_allocator_type_t type)
     allocator->type      = real_type;
     allocator->callbacks = NULL;
     allocator->in_scope  = true;
+    allocator->stats     = NULL;
 
     switch (real_type) {
         case WMEM_ALLOCATOR_SIMPLE:
@@ -161,6 +340,10 @@ wmem_allocator_new(const wmem_allocator_type_t type)
             break;
     };
 
+    if (stats_enabled) {
+        wmem_stats_new(allocator);
+    }
+
     return allocator;
 }
 
@@ -198,6 +381,10 @@ wmem_init(void)
         }
     }
 
+    if (getenv("WIRESHARK_DEBUG_WMEM_STATS") != NULL) {
+        stats_enabled = true;
+    }
+
     wmem_init_hashing();
 }
 
@@ -225,6 +412,90 @@ wmem_in_scope(wmem_allocator_t *allocator)
     return allocator->in_scope;
 }
 
+void
+wmem_stats_enable(bool enable)
+{
+    stats_enabled = enable;
+}
+
+bool
+wmem_stats_enabled(void)
+{
+    return stats_enabled;
+}
+
+void
+wmem_allocator_set_stats_name(wmem_allocator_t *allocator, const char *name)
+{
+    if (allocator->stats == NULL) {
+        return;
+    }
+
+    g_free(allocator->stats->name);
+    allocator->stats->name = g_strdup(name);
+}
+
+const char *
+wmem_stats_set_tag(const char *tag)
+{
+    const char *prev = stats_tag;
+
+    stats_tag = tag;
+    return prev;
+}
+
+bool
+wmem_allocator_get_stats(wmem_allocator_t *allocator, wmem_stats_t *stats)
+{
+    if (allocator->stats == NULL) {
+        return false;
+    }
+
+    *stats = allocator->stats->totals;
+    return true;
+}
+
+static int
+wmem_tag_stats_compare(const void *a, const void *b)
+{
+    const wmem_tag_stats_t *tag_a = *(const wmem_tag_stats_t * const *)a;
+    const wmem_tag_stats_t *tag_b = *(const wmem_tag_stats_t * const *)b;
+
+    if (tag_a->stats.peak_bytes != tag_b->stats.peak_bytes) {
+        return tag_a->stats.peak_bytes > tag_b->stats.peak_bytes ? -1 : 1;
+    }
+    return strcmp(tag_a->tag, tag_b->tag);
+}
+
+void
+wmem_stats_foreach(wmem_stats_func func, void *user_data)
+{
+    g_mutex_lock(&stats_allocators_mutex);
+    for (unsigned i = 0; stats_allocators != NULL && i < stats_allocators->len; i++) {
+        wmem_allocator_t *allocator = (wmem_allocator_t *)g_ptr_array_index(stats_allocators, i);
+        struct _wmem_allocator_stats_t *stats = allocator->stats;
+        const char *name = stats->name ? stats->name : "(unnamed)";
+        GPtrArray  *tags;
+        GHashTableIter iter;
+        void          *value;
+
+        func(name, NULL, &stats->totals, user_data);
+
+        tags = g_ptr_array_sized_new(g_hash_table_size(stats->tags));
+        g_hash_table_iter_init(&iter, stats->tags);
+        while (g_hash_table_iter_next(&iter, NULL, &value)) {
+            g_ptr_array_add(tags, value);
+        }
+        g_ptr_array_sort(tags, wmem_tag_stats_compare);
+        for (unsigned j = 0; j < tags->len; j++) {
+            wmem_tag_stats_t *tag_stats = (wmem_tag_stats_t *)g_ptr_array_index(tags, j);
+            func(name, tag_stats->tag, &tag_stats->stats, user_data);
+        }
+        g_ptr_array_free(tags, true);
+    }
+    g_mutex_unlock(&stats_allocators_mutex);
+}
+
 
 /*
  * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
@@ -232,6 +232,84 @@ WS_DLL_PUBLIC
 bool
 wmem_in_scope(wmem_allocator_t *allocator);
 
+/** @defgroup wmem-stats Allocator statistics
+ *
+ * Optional accounting of the memory held by allocators. When it is enabled,
+ * allocators created afterwards count the bytes and blocks they hand out,
+ * both in total and per allocation-site tag (e.g. the protocol whose
+ * dissector was running), and remember the high-water mark of each.
+ * This costs a small header per allocation, so it is off by default; it
+ * can be turned on with wmem_stats_enable() before the allocators of
+ * interest are created, or with the WIRESHARK_DEBUG_WMEM_STATS
+ * environment variable.
+ *
+ * @{
+ */
+
+/** Memory held by an allocator, or the part of it allocated with one tag. */
+typedef struct _wmem_stats_t {
+    size_t   bytes;         /**< bytes currently allocated, excluding allocator overhead */
+    size_t   blocks;        /**< number of blocks currently allocated */
+    size_t   peak_bytes;    /**< highest value of "bytes" so far */
+    uint64_t total_allocs;  /**< number of allocations made so far */
+} wmem_stats_t;
+
+/** Enable or disable statistics for allocators created from now on.
+ * Existing allocators are not affected.
+ */
+WS_DLL_PUBLIC
+void
+wmem_stats_enable(bool enable);
+
+WS_DLL_PUBLIC
+bool
+wmem_stats_enabled(void);
+
+/** Give an allocator a name to identify it in statistics reports. Does
+ * nothing if the allocator doesn't keep statistics.
+ *
+ * @param allocator The allocator.
+ * @param name The name, e.g. "file" (copied).
+ */
+WS_DLL_PUBLIC
+void
+wmem_allocator_set_stats_name(wmem_allocator_t *allocator, const char *name);
+
+/** Set the tag charged with the allocations made by the current thread
+ * from now on.
+ *
+ * @param tag A string that stays valid as long as the allocators, usually
+ * a protocol name, or NULL for no tag.
+ * @return The previous tag, to be restored by the caller.
+ */
+WS_DLL_PUBLIC
+const char *
+wmem_stats_set_tag(const char *tag);
+
+/** Get the statistics of an allocator.
+ *
+ * @return false if the allocator doesn't keep statistics.
+ */
+WS_DLL_PUBLIC
+bool
+wmem_allocator_get_stats(wmem_allocator_t *allocator, wmem_stats_t *stats);
+
+/** Called by wmem_stats_foreach() once for each allocator with tag NULL and
+ * its totals, then once for each of its tags, the largest first.
+ */
+typedef void (*wmem_stats_func)(const char *allocator_name, const char *tag,
+        const wmem_stats_t *stats, void *user_data);
+
+/** Report the statistics of every allocator that keeps them, in order of
+ * creation. Unnamed allocators are reported as "(unnamed)" and untagged
+ * allocations as "(untagged)".
+ */
+WS_DLL_PUBLIC
+void
+wmem_stats_foreach(wmem_stats_func func, void *user_data);
+
+/** @} */
+
 /** @} */
 
 #ifdef __cplusplus
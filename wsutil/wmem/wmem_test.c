@@ -369,6 +369,96 @@ wmem_test_allocator_strict(void)
     wmem_test_allocator_jumbo(WMEM_ALLOCATOR_STRICT, &wmem_strict_check_canaries);
 }
 
+static void
+wmem_test_stats_cb(const char *allocator_name, const char *tag,
+        const wmem_stats_t *stats, void *user_data)
+{
+    wmem_stats_t *tag_stats = (wmem_stats_t *)user_data;
+
+    if (strcmp(allocator_name, "stats") != 0) {
+        return;
+    }
+    if (tag == NULL) {
+        return;
+    }
+    if (strcmp(tag, "PROTO") == 0) {
+        tag_stats[0] = *stats;
+    }
+    else if (strcmp(tag, "(untagged)") == 0) {
+        tag_stats[1] = *stats;
+    }
+    else {
+        g_assert_not_reached();
+    }
+}
+
+static void
+wmem_test_allocator_stats(void)
+{
+    wmem_allocator_t *allocator;
+    wmem_stats_t      stats;
+    wmem_stats_t      tag_stats[2];
+    const char       *prev_tag;
+    char             *ptr1, *ptr2;
+
+    /* Allocators created without statistics don't keep them. */
+    allocator = wmem_allocator_new(WMEM_ALLOCATOR_STRICT);
+    g_assert_false(wmem_allocator_get_stats(allocator, &stats));
+    wmem_destroy_allocator(allocator);
+
+    wmem_stats_enable(true);
+    allocator = wmem_allocator_new(WMEM_ALLOCATOR_STRICT);
+    wmem_stats_enable(false);
+    wmem_allocator_set_stats_name(allocator, "stats");
+
+    ptr1 = (char *)wmem_alloc(allocator, 100);
+    memset(ptr1, 0, 100);
+    prev_tag = wmem_stats_set_tag("PROTO");
+    ptr2 = (char *)wmem_alloc(allocator, 50);
+    memset(ptr2, 0, 50);
+    wmem_stats_set_tag(prev_tag);
+    wmem_strict_check_canaries(allocator);
+
+    g_assert_true(wmem_allocator_get_stats(allocator, &stats));
+    g_assert_cmpuint(stats.bytes, ==, 150);
+    g_assert_cmpuint(stats.blocks, ==, 2);
+    g_assert_cmpuint(stats.peak_bytes, ==, 150);
+    g_assert_cmpuint(stats.total_allocs, ==, 2);
+
+    /* A reallocated block stays charged to its original tag. */
+    ptr2 = (char *)wmem_realloc(allocator, ptr2, 200);
+    memset(ptr2, 0, 200);
+    wmem_strict_check_canaries(allocator);
+    wmem_free(allocator, ptr1);
+
+    g_assert_true(wmem_allocator_get_stats(allocator, &stats));
+    g_assert_cmpuint(stats.bytes, ==, 200);
+    g_assert_cmpuint(stats.blocks, ==, 1);
+    g_assert_cmpuint(stats.peak_bytes, ==, 300);
+    g_assert_cmpuint(stats.total_allocs, ==, 2);
+
+    memset(tag_stats, 0, sizeof(tag_stats));
+    wmem_stats_foreach(wmem_test_stats_cb, tag_stats);
+    g_assert_cmpuint(tag_stats[0].bytes, ==, 200);
+    g_assert_cmpuint(tag_stats[0].peak_bytes, ==, 200);
+    g_assert_cmpuint(tag_stats[1].bytes, ==, 0);
+    g_assert_cmpuint(tag_stats[1].peak_bytes, ==, 100);
+
+    /* Freeing everything keeps the high-water marks. */
+    wmem_free_all(allocator);
+    g_assert_true(wmem_allocator_get_stats(allocator, &stats));
+    g_assert_cmpuint(stats.bytes, ==, 0);
+    g_assert_cmpuint(stats.blocks, ==, 0);
+    g_assert_cmpuint(stats.peak_bytes, ==, 300);
+
+    wmem_destroy_allocator(allocator);
+
+    /* Destroyed allocators are no longer reported. */
+    memset(tag_stats, 0, sizeof(tag_stats));
+    wmem_stats_foreach(wmem_test_stats_cb, tag_stats);
+    g_assert_cmpuint(tag_stats[0].total_allocs, ==, 0);
+}
+
 /* UTILITY TESTING FUNCTIONS (/wmem/utils/) */
 
 static void
@@ -1470,6 +1560,7 @@ main(int argc, char **argv)
     g_test_add_func("/wmem/allocator/simple",    wmem_test_allocator_simple);
     g_test_add_func("/wmem/allocator/strict",    wmem_test_allocator_strict);
     g_test_add_func("/wmem/allocator/callbacks", wmem_test_allocator_callbacks);
+    g_test_add_func("/wmem/allocator/stats",     wmem_test_allocator_stats);
 
     g_test_add_func("/wmem/utils/misc",    wmem_test_miscutls);
     g_test_add_func("/wmem/utils/strings", wmem_test_strutls);